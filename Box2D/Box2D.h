@@ -33,11 +33,13 @@ For discussion please visit http://box2d.org/forum
 
 #include <Box2D/Common/b2Settings.h>
 #include <Box2D/Common/b2Draw.h>
+#include <Box2D/Common/b2ThreadPool.h>
 #include <Box2D/Common/b2Timer.h>
 
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CompoundShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
 #include <Box2D/Collision/b2BroadPhase.h>
@@ -50,6 +52,10 @@ For discussion please visit http://box2d.org/forum
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2Scene.h>
+#include <Box2D/Dynamics/b2Recorder.h>
+#include <Box2D/Dynamics/b2AsyncStepper.h>
+#include <Box2D/Dynamics/b2WorldGroup.h>
 
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 
@@ -65,5 +71,8 @@ For discussion please visit http://box2d.org/forum
 #include <Box2D/Dynamics/Joints/b2WeldJoint.h>
 
 #include <Box2D/Rope/b2Rope.h>
+#include <Box2D/Rope/b2RopeSystem.h>
+
+#include <Box2D/Particle/b2ParticleSystem.h>
 
 #endif
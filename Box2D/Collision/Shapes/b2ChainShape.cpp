@@ -22,11 +22,71 @@
 #include <cstring>
 using namespace std;
 
+// Maximum number of edges in a leaf of the edge hierarchy.
+static const int32 b2_chainLeafEdges = 8;
+
 b2ChainShape::~b2ChainShape()
 {
 	b2Free(m_vertices);
 	m_vertices = NULL;
 	m_count = 0;
+
+	b2Free(m_nodes);
+	m_nodes = NULL;
+	m_nodeCount = 0;
+}
+
+// Number of nodes of the hierarchy over count edges.
+static int32 b2CountNodes(int32 count)
+{
+	if (count <= b2_chainLeafEdges)
+	{
+		return 1;
+	}
+
+	int32 half = count / 2;
+	return 1 + b2CountNodes(half) + b2CountNodes(count - half);
+}
+
+void b2ChainShape::CreateNodes()
+{
+	b2Assert(m_nodes == NULL && m_nodeCount == 0);
+	int32 edgeCount = m_count - 1;
+	m_nodeCount = b2CountNodes(edgeCount);
+	m_nodes = (b2ChainNode*)b2Alloc(m_nodeCount * sizeof(b2ChainNode));
+	int32 nodeCount = BuildNode(0, 0, edgeCount);
+	b2Assert(nodeCount == m_nodeCount);
+	B2_NOT_USED(nodeCount);
+}
+
+// The edges of a chain follow each other, so halving the range of edges gives
+// a spatially coherent hierarchy without sorting. Return the next free node.
+int32 b2ChainShape::BuildNode(int32 index, int32 first, int32 count)
+{
+	b2ChainNode* node = m_nodes + index;
+	node->first = first;
+	node->count = count;
+
+	if (count <= b2_chainLeafEdges)
+	{
+		node->child2 = -1;
+		node->aabb.lowerBound = m_vertices[first];
+		node->aabb.upperBound = m_vertices[first];
+		for (int32 i = first + 1; i <= first + count; ++i)
+		{
+			node->aabb.lowerBound = b2Min(node->aabb.lowerBound, m_vertices[i]);
+			node->aabb.upperBound = b2Max(node->aabb.upperBound, m_vertices[i]);
+		}
+		return index + 1;
+	}
+
+	int32 half = count / 2;
+	int32 child2 = BuildNode(index + 1, first, half);
+	int32 next = BuildNode(child2, first + half, count - half);
+
+	node->child2 = child2;
+	node->aabb.Combine(m_nodes[index + 1].aabb, m_nodes[child2].aabb);
+	return next;
 }
 
 void b2ChainShape::CreateLoop(const b2Vec2* vertices, int32 count)
@@ -41,6 +101,7 @@ void b2ChainShape::CreateLoop(const b2Vec2* vertices, int32 count)
 	m_nextVertex = m_vertices[1];
 	m_hasPrevVertex = true;
 	m_hasNextVertex = true;
+	CreateNodes();
 }
 
 void b2ChainShape::CreateChain(const b2Vec2* vertices, int32 count)
@@ -52,6 +113,7 @@ void b2ChainShape::CreateChain(const b2Vec2* vertices, int32 count)
 	memcpy(m_vertices, vertices, m_count * sizeof(b2Vec2));
 	m_hasPrevVertex = false;
 	m_hasNextVertex = false;
+	CreateNodes();
 }
 
 void b2ChainShape::SetPrevVertex(const b2Vec2& prevVertex)
@@ -84,6 +146,11 @@ int32 b2ChainShape::GetChildCount() const
 	return m_count - 1;
 }
 
+int32 b2ChainShape::GetMemory() const
+{
+	return m_count * sizeof(b2Vec2) + m_nodeCount * sizeof(b2ChainNode);
+}
+
 void b2ChainShape::GetChildEdge(b2EdgeShape* edge, int32 index) const
 {
 	b2Assert(0 <= index && index < m_count - 1);
@@ -20,15 +20,32 @@
 #define B2_CHAIN_SHAPE_H
 
 #include <Box2D/Collision/Shapes/b2Shape.h>
+#include <Box2D/Common/b2GrowableStack.h>
 
 class b2EdgeShape;
 
+/// A node of the edge hierarchy of a chain. It bounds a range of consecutive
+/// edges in the chain's local frame.
+struct b2ChainNode
+{
+	b2AABB aabb;
+	int32 first;
+	int32 count;
+	int32 child2;	///< the first child follows this node, -1 for a leaf
+};
+
 /// A chain shape is a free form sequence of line segments.
 /// The chain has two-sided collision, so you can use inside and outside collision.
 /// Therefore, you may use any winding order.
 /// Since there may be many vertices, they are allocated using b2Alloc.
 /// Connectivity information is used to create smooth collisions.
 /// WARNING: The chain will not collide properly if there are self-intersections.
+///
+/// The edges are grouped by b2_chainProxyEdges in the broad-phase and a static
+/// hierarchy over the edges resolves a group to the touching edges. Very long
+/// terrain can also be streamed: create each chunk as its own chain fixture,
+/// with ghost vertices set to the neighbouring chunks, and destroy the fixtures
+/// left behind.
 class b2ChainShape : public b2Shape
 {
 public:
@@ -61,6 +78,9 @@ public:
 	/// @see b2Shape::GetChildCount
 	int32 GetChildCount() const;
 
+	/// Get the number of bytes allocated with b2Alloc by this shape.
+	int32 GetMemory() const;
+
 	/// Get a child edge.
 	void GetChildEdge(b2EdgeShape* edge, int32 index) const;
 
@@ -92,8 +112,26 @@ public:
 	/// Get the vertices (read-only).
 	const b2Vec2* GetVertices() const { return m_vertices; }
 
+	/// Is there a vertex before the first vertex? See SetPrevVertex.
+	bool HasPrevVertex() const { return m_hasPrevVertex; }
+	const b2Vec2& GetPrevVertex() const { return m_prevVertex; }
+
+	/// Is there a vertex after the last vertex? See SetNextVertex.
+	bool HasNextVertex() const { return m_hasNextVertex; }
+	const b2Vec2& GetNextVertex() const { return m_nextVertex; }
+
+	/// Query the edges [first, first + count) that may overlap an AABB given in
+	/// the local frame. The callback gets each edge index and returns false to
+	/// stop the query.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb, int32 first, int32 count) const;
+
 protected:
 
+	// Build the edge hierarchy from the vertices.
+	void CreateNodes();
+	int32 BuildNode(int32 index, int32 first, int32 count);
+
 	/// The vertices. Owned by this class.
 	b2Vec2* m_vertices;
 
@@ -102,6 +140,10 @@ protected:
 
 	b2Vec2 m_prevVertex, m_nextVertex;
 	bool m_hasPrevVertex, m_hasNextVertex;
+
+	/// The edge hierarchy, root first. Owned by this class.
+	b2ChainNode* m_nodes;
+	int32 m_nodeCount;
 };
 
 inline b2ChainShape::b2ChainShape()
@@ -112,6 +154,55 @@ inline b2ChainShape::b2ChainShape()
 	m_count = 0;
 	m_hasPrevVertex = NULL;
 	m_hasNextVertex = NULL;
+	m_nodes = NULL;
+	m_nodeCount = 0;
+}
+
+template <typename T>
+inline void b2ChainShape::Query(T* callback, const b2AABB& aabb, int32 first, int32 count) const
+{
+	if (m_nodeCount == 0)
+	{
+		return;
+	}
+
+	b2GrowableStack<int32, 64> stack;
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 nodeId = stack.Pop();
+		const b2ChainNode* node = m_nodes + nodeId;
+
+		if (node->first >= first + count || node->first + node->count <= first)
+		{
+			continue;
+		}
+
+		if (b2TestOverlap(node->aabb, aabb) == false)
+		{
+			continue;
+		}
+
+		if (node->child2 == -1)
+		{
+			int32 begin = b2Max(node->first, first);
+			int32 end = b2Min(node->first + node->count, first + count);
+			for (int32 i = begin; i < end; ++i)
+			{
+				bool proceed = callback->QueryCallback(i);
+				if (proceed == false)
+				{
+					return;
+				}
+			}
+		}
+		else
+		{
+			stack.Push(nodeId + 1);
+			stack.Push(node->child2);
+		}
+	}
 }
 
 #endif
@@ -0,0 +1,230 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/Shapes/b2CompoundShape.h>
+#include <new>
+#include <algorithm>
+using namespace std;
+
+// Maximum number of children in a leaf of the child hierarchy.
+static const int32 b2_compoundLeafChildren = 4;
+
+b2CompoundShape::~b2CompoundShape()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_children[i].~b2PolygonShape();
+	}
+	b2Free(m_children);
+	m_children = NULL;
+	m_count = 0;
+	m_capacity = 0;
+
+	b2Free(m_order);
+	b2Free(m_nodes);
+	m_order = NULL;
+	m_nodes = NULL;
+	m_nodeCount = 0;
+}
+
+void b2CompoundShape::AddChild(const b2PolygonShape& polygon)
+{
+	if (m_count == m_capacity)
+	{
+		b2PolygonShape* oldChildren = m_children;
+		m_capacity = b2Max(2 * m_capacity, 8);
+		m_children = (b2PolygonShape*)b2Alloc(m_capacity * sizeof(b2PolygonShape));
+		for (int32 i = 0; i < m_count; ++i)
+		{
+			new (m_children + i) b2PolygonShape(oldChildren[i]);
+			oldChildren[i].~b2PolygonShape();
+		}
+		b2Free(oldChildren);
+	}
+
+	new (m_children + m_count) b2PolygonShape(polygon);
+	++m_count;
+}
+
+b2Shape* b2CompoundShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2CompoundShape));
+	b2CompoundShape* clone = new (mem) b2CompoundShape;
+	clone->m_capacity = m_count;
+	clone->m_children = (b2PolygonShape*)b2Alloc(m_count * sizeof(b2PolygonShape));
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		new (clone->m_children + i) b2PolygonShape(m_children[i]);
+	}
+	clone->m_count = m_count;
+	clone->CreateNodes();
+	return clone;
+}
+
+int32 b2CompoundShape::GetChildCount() const
+{
+	return m_count;
+}
+
+int32 b2CompoundShape::GetMemory() const
+{
+	int32 memory = m_capacity * sizeof(b2PolygonShape) + m_nodeCount * sizeof(b2CompoundNode);
+	if (m_order != NULL)
+	{
+		memory += m_count * sizeof(int32);
+	}
+	return memory;
+}
+
+// Number of nodes of the hierarchy over count children.
+static int32 b2CountNodes(int32 count)
+{
+	if (count <= b2_compoundLeafChildren)
+	{
+		return 1;
+	}
+
+	int32 half = count / 2;
+	return 1 + b2CountNodes(half) + b2CountNodes(count - half);
+}
+
+void b2CompoundShape::CreateNodes()
+{
+	b2Assert(m_nodes == NULL && m_nodeCount == 0);
+	if (m_count == 0)
+	{
+		return;
+	}
+
+	b2Transform identity;
+	identity.SetIdentity();
+
+	b2AABB* aabbs = (b2AABB*)b2Alloc(m_count * sizeof(b2AABB));
+	m_order = (int32*)b2Alloc(m_count * sizeof(int32));
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_children[i].ComputeAABB(aabbs + i, identity, 0);
+		m_order[i] = i;
+	}
+
+	m_nodeCount = b2CountNodes(m_count);
+	m_nodes = (b2CompoundNode*)b2Alloc(m_nodeCount * sizeof(b2CompoundNode));
+	int32 nodeCount = BuildNode(0, 0, m_count, aabbs);
+	b2Assert(nodeCount == m_nodeCount);
+	B2_NOT_USED(nodeCount);
+
+	b2Free(aabbs);
+}
+
+// Orders children by the center of their AABB along an axis.
+struct b2CompoundCenterLess
+{
+	bool operator()(int32 i1, int32 i2) const
+	{
+		const b2AABB& a1 = aabbs[i1];
+		const b2AABB& a2 = aabbs[i2];
+		if (axis == 0)
+		{
+			return a1.lowerBound.x + a1.upperBound.x < a2.lowerBound.x + a2.upperBound.x;
+		}
+		return a1.lowerBound.y + a1.upperBound.y < a2.lowerBound.y + a2.upperBound.y;
+	}
+
+	const b2AABB* aabbs;
+	int32 axis;
+};
+
+// Split the children at the median of their centers along the longest axis
+// of the node. Return the next free node.
+int32 b2CompoundShape::BuildNode(int32 index, int32 first, int32 count, const b2AABB* aabbs)
+{
+	b2CompoundNode* node = m_nodes + index;
+	node->first = first;
+	node->count = count;
+
+	node->aabb = aabbs[m_order[first]];
+	for (int32 i = first + 1; i < first + count; ++i)
+	{
+		node->aabb.Combine(aabbs[m_order[i]]);
+	}
+
+	if (count <= b2_compoundLeafChildren)
+	{
+		node->child2 = -1;
+		return index + 1;
+	}
+
+	b2Vec2 extents = node->aabb.GetExtents();
+	b2CompoundCenterLess less;
+	less.aabbs = aabbs;
+	less.axis = extents.x >= extents.y ? 0 : 1;
+
+	int32 half = count / 2;
+	std::nth_element(m_order + first, m_order + first + half, m_order + first + count, less);
+
+	int32 child2 = BuildNode(index + 1, first, half, aabbs);
+	node->child2 = child2;
+	return BuildNode(child2, first + half, count - half, aabbs);
+}
+
+bool b2CompoundShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		if (m_children[i].TestPoint(xf, p))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool b2CompoundShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+								const b2Transform& xf, int32 childIndex) const
+{
+	b2Assert(0 <= childIndex && childIndex < m_count);
+	return m_children[childIndex].RayCast(output, input, xf, 0);
+}
+
+void b2CompoundShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	b2Assert(0 <= childIndex && childIndex < m_count);
+	m_children[childIndex].ComputeAABB(aabb, xf, 0);
+}
+
+void b2CompoundShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+
+	// The child inertias are about the body origin, they just add up.
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2MassData childData;
+		m_children[i].ComputeMass(&childData, density);
+		massData->mass += childData.mass;
+		massData->center += childData.mass * childData.center;
+		massData->I += childData.I;
+	}
+
+	if (massData->mass > 0.0f)
+	{
+		massData->center *= 1.0f / massData->mass;
+	}
+}
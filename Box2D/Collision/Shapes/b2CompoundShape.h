@@ -0,0 +1,247 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_COMPOUND_SHAPE_H
+#define B2_COMPOUND_SHAPE_H
+
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <Box2D/Common/b2GrowableStack.h>
+
+/// A node of the child hierarchy of a compound. It bounds a range of the
+/// sorted children in the compound's local frame.
+struct b2CompoundNode
+{
+	b2AABB aabb;
+	int32 first;
+	int32 count;
+	int32 child2;	///< the first child follows this node, -1 for a leaf
+};
+
+/// A compound shape holds many convex polygons under a single fixture.
+/// The fixture has one broad-phase proxy for the whole compound and a static
+/// hierarchy over the children resolves it to the children overlapping another
+/// proxy. So contacts only exist for children that may touch something.
+/// The children are in the body frame, like the shapes of separate fixtures.
+/// Since there may be many children, they are allocated using b2Alloc.
+class b2CompoundShape : public b2Shape
+{
+public:
+	b2CompoundShape();
+
+	/// The destructor frees the children using b2Free.
+	~b2CompoundShape();
+
+	/// Add a child. The polygon is copied.
+	void AddChild(const b2PolygonShape& polygon);
+
+	/// Implement b2Shape. Children are cloned using b2Alloc and the
+	/// hierarchy of the clone is built.
+	b2Shape* Clone(b2BlockAllocator* allocator) const;
+
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const;
+
+	/// Get the number of bytes allocated with b2Alloc by this shape.
+	int32 GetMemory() const;
+
+	/// Get a child polygon.
+	const b2PolygonShape* GetChild(int32 index) const;
+
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const;
+
+	/// Implement b2Shape.
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+					const b2Transform& transform, int32 childIndex) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const;
+
+	/// The mass of all the children.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// Query the children that may overlap an AABB given in the local frame.
+	/// The callback gets each child index and returns false to stop the query.
+	/// Only the shapes attached to a fixture have a hierarchy.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb) const;
+
+	/// Ray cast against the children that may cross a ray given in the local
+	/// frame. The callback gets the clipped ray and each child index and returns
+	/// the new max fraction like b2DynamicTree::RayCast, 0 to stop the cast.
+	template <typename T>
+	void RayCast(T* callback, const b2RayCastInput& input) const;
+
+protected:
+
+	// Build the child hierarchy.
+	void CreateNodes();
+	int32 BuildNode(int32 index, int32 first, int32 count, const b2AABB* aabbs);
+
+	/// The children. Owned by this class.
+	b2PolygonShape* m_children;
+	int32 m_count;
+	int32 m_capacity;
+
+	/// The children sorted along the hierarchy and the hierarchy, root first.
+	int32* m_order;
+	b2CompoundNode* m_nodes;
+	int32 m_nodeCount;
+};
+
+inline b2CompoundShape::b2CompoundShape()
+{
+	m_type = e_compound;
+	m_radius = b2_polygonRadius;
+	m_children = NULL;
+	m_count = 0;
+	m_capacity = 0;
+	m_order = NULL;
+	m_nodes = NULL;
+	m_nodeCount = 0;
+}
+
+inline const b2PolygonShape* b2CompoundShape::GetChild(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return m_children + index;
+}
+
+template <typename T>
+inline void b2CompoundShape::Query(T* callback, const b2AABB& aabb) const
+{
+	if (m_nodeCount == 0)
+	{
+		return;
+	}
+
+	b2GrowableStack<int32, 64> stack;
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 nodeId = stack.Pop();
+		const b2CompoundNode* node = m_nodes + nodeId;
+
+		if (b2TestOverlap(node->aabb, aabb) == false)
+		{
+			continue;
+		}
+
+		if (node->child2 == -1)
+		{
+			for (int32 i = node->first; i < node->first + node->count; ++i)
+			{
+				bool proceed = callback->QueryCallback(m_order[i]);
+				if (proceed == false)
+				{
+					return;
+				}
+			}
+		}
+		else
+		{
+			stack.Push(nodeId + 1);
+			stack.Push(node->child2);
+		}
+	}
+}
+
+template <typename T>
+inline void b2CompoundShape::RayCast(T* callback, const b2RayCastInput& input) const
+{
+	if (m_nodeCount == 0)
+	{
+		return;
+	}
+
+	b2Vec2 p1 = input.p1;
+	b2Vec2 p2 = input.p2;
+	b2Vec2 r = p2 - p1;
+	b2Assert(r.LengthSquared() > 0.0f);
+	r.Normalize();
+
+	// Separating axis for segment (Gino, p80), as in b2DynamicTree::RayCast.
+	b2Vec2 v = b2Cross(1.0f, r);
+	b2Vec2 abs_v = b2Abs(v);
+
+	float32 maxFraction = input.maxFraction;
+
+	b2AABB segmentAABB;
+	{
+		b2Vec2 t = p1 + maxFraction * (p2 - p1);
+		segmentAABB.lowerBound = b2Min(p1, t);
+		segmentAABB.upperBound = b2Max(p1, t);
+	}
+
+	b2GrowableStack<int32, 64> stack;
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 nodeId = stack.Pop();
+		const b2CompoundNode* node = m_nodes + nodeId;
+
+		if (b2TestOverlap(node->aabb, segmentAABB) == false)
+		{
+			continue;
+		}
+
+		b2Vec2 c = node->aabb.GetCenter();
+		b2Vec2 h = node->aabb.GetExtents();
+		float32 separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h);
+		if (separation > 0.0f)
+		{
+			continue;
+		}
+
+		if (node->child2 == -1)
+		{
+			for (int32 i = node->first; i < node->first + node->count; ++i)
+			{
+				b2RayCastInput subInput;
+				subInput.p1 = input.p1;
+				subInput.p2 = input.p2;
+				subInput.maxFraction = maxFraction;
+
+				float32 value = callback->RayCastCallback(subInput, m_order[i]);
+
+				if (value == 0.0f)
+				{
+					return;
+				}
+
+				if (value > 0.0f)
+				{
+					maxFraction = value;
+					b2Vec2 t = p1 + maxFraction * (p2 - p1);
+					segmentAABB.lowerBound = b2Min(p1, t);
+					segmentAABB.upperBound = b2Max(p1, t);
+				}
+			}
+		}
+		else
+		{
+			stack.Push(nodeId + 1);
+			stack.Push(node->child2);
+		}
+	}
+}
+
+#endif
@@ -84,6 +84,13 @@ inline b2PolygonShape::b2PolygonShape()
 	m_radius = b2_polygonRadius;
 	m_vertexCount = 0;
 	m_centroid.SetZero();
+
+	// The collision functions read every vertex slot, including the unused ones.
+	for (int32 i = 0; i < b2_maxPolygonVertices; ++i)
+	{
+		m_vertices[i].SetZero();
+		m_normals[i].SetZero();
+	}
 }
 
 inline const b2Vec2& b2PolygonShape::GetVertex(int32 index) const
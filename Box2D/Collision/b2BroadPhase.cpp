@@ -31,6 +31,7 @@ b2BroadPhase::b2BroadPhase()
 	m_moveCapacity = 16;
 	m_moveCount = 0;
 	m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	m_bufferedMoveCount = 0;
 }
 
 b2BroadPhase::~b2BroadPhase()
@@ -81,6 +82,7 @@ void b2BroadPhase::BufferMove(int32 proxyId)
 
 	m_moveBuffer[m_moveCount] = proxyId;
 	++m_moveCount;
+	++m_bufferedMoveCount;
 }
 
 void b2BroadPhase::UnBufferMove(int32 proxyId)
@@ -100,6 +100,27 @@ public:
 	/// Get the quality metric of the embedded tree.
 	float32 GetTreeQuality() const;
 
+	/// Get the number of bytes allocated for the tree and the buffers.
+	int32 GetMemory() const;
+
+	/// See b2DynamicTree::SetAdaptiveMargins.
+	void SetAdaptiveMargins(bool flag);
+
+	/// Get the number of proxies re-inserted in the tree since the last
+	/// ResetCounters.
+	int32 GetReinsertCount() const;
+
+	/// Get the number of moves buffered for UpdatePairs since the last
+	/// ResetCounters.
+	int32 GetBufferedMoveCount() const;
+
+	/// Reset the churn counters.
+	void ResetCounters();
+
+	/// See b2DynamicTree::BeginBulkInsert. The new proxies are buffered as usual.
+	void BeginBulkInsert();
+	void EndBulkInsert();
+
 private:
 
 	friend class b2DynamicTree;
@@ -116,6 +137,7 @@ private:
 	int32* m_moveBuffer;
 	int32 m_moveCapacity;
 	int32 m_moveCount;
+	int32 m_bufferedMoveCount;
 
 	b2Pair* m_pairBuffer;
 	int32 m_pairCapacity;
@@ -177,6 +199,42 @@ inline float32 b2BroadPhase::GetTreeQuality() const
 	return m_tree.GetAreaRatio();
 }
 
+inline int32 b2BroadPhase::GetMemory() const
+{
+	return m_tree.GetMemory() + m_moveCapacity * sizeof(int32) + m_pairCapacity * sizeof(b2Pair);
+}
+
+inline void b2BroadPhase::SetAdaptiveMargins(bool flag)
+{
+	m_tree.SetAdaptiveMargins(flag);
+}
+
+inline int32 b2BroadPhase::GetReinsertCount() const
+{
+	return m_tree.GetReinsertCount();
+}
+
+inline int32 b2BroadPhase::GetBufferedMoveCount() const
+{
+	return m_bufferedMoveCount;
+}
+
+inline void b2BroadPhase::ResetCounters()
+{
+	m_tree.ResetReinsertCount();
+	m_bufferedMoveCount = 0;
+}
+
+inline void b2BroadPhase::BeginBulkInsert()
+{
+	m_tree.BeginBulkInsert();
+}
+
+inline void b2BroadPhase::EndBulkInsert()
+{
+	m_tree.EndBulkInsert();
+}
+
 template <typename T>
 void b2BroadPhase::UpdatePairs(T* callback)
 {
@@ -48,42 +48,45 @@ void b2CollideCircles(
 	manifold->points[0].id.key = 0;
 }
 
-void b2CollidePolygonAndCircle(
+// Collide a polygon with a circle whose center is given in the frame of the polygon.
+static void b2CollidePolygonAndCircle(
 	b2Manifold* manifold,
-	const b2PolygonShape* polygonA, const b2Transform& xfA,
-	const b2CircleShape* circleB, const b2Transform& xfB)
+	const b2PolygonShape* polygonA, const b2Vec2& cLocal,
+	const b2CircleShape* circleB)
 {
 	manifold->pointCount = 0;
 
-	// Compute circle position in the frame of the polygon.
-	b2Vec2 c = b2Mul(xfB, circleB->m_p);
-	b2Vec2 cLocal = b2MulT(xfA, c);
-
-	// Find the min separating edge.
-	int32 normalIndex = 0;
-	float32 separation = -b2_maxFloat;
 	float32 radius = polygonA->m_radius + circleB->m_radius;
 	int32 vertexCount = polygonA->m_vertexCount;
 	const b2Vec2* vertices = polygonA->m_vertices;
 	const b2Vec2* normals = polygonA->m_normals;
 
-	for (int32 i = 0; i < vertexCount; ++i)
+	// Separation from every edge. The loop runs over all the vertex slots so
+	// that it has a fixed count and vectorizes, the unused slots are ignored below.
+	float32 separations[b2_maxPolygonVertices];
+	for (int32 i = 0; i < b2_maxPolygonVertices; ++i)
 	{
-		float32 s = b2Dot(normals[i], cLocal - vertices[i]);
-
-		if (s > radius)
-		{
-			// Early out.
-			return;
-		}
+		separations[i] = b2Dot(normals[i], cLocal - vertices[i]);
+	}
 
-		if (s > separation)
+	// Find the min separating edge.
+	int32 normalIndex = 0;
+	float32 separation = -b2_maxFloat;
+	for (int32 i = 0; i < vertexCount; ++i)
+	{
+		if (separations[i] > separation)
 		{
-			separation = s;
+			separation = separations[i];
 			normalIndex = i;
 		}
 	}
 
+	if (separation > radius)
+	{
+		// Early out.
+		return;
+	}
+
 	// Vertices that subtend the incident face.
 	int32 vertIndex1 = normalIndex;
 	int32 vertIndex2 = vertIndex1 + 1 < vertexCount ? vertIndex1 + 1 : 0;
@@ -152,3 +155,108 @@ void b2CollidePolygonAndCircle(
 		manifold->points[0].id.key = 0;
 	}
 }
+
+void b2CollidePolygonAndCircle(
+	b2Manifold* manifold,
+	const b2PolygonShape* polygonA, const b2Transform& xfA,
+	const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	// Compute circle position in the frame of the polygon.
+	b2Vec2 c = b2Mul(xfB, circleB->m_p);
+	b2Vec2 cLocal = b2MulT(xfA, c);
+
+	b2CollidePolygonAndCircle(manifold, polygonA, cLocal, circleB);
+}
+
+void b2CircleBatch::Add(b2Manifold* manifold,
+						const b2Shape* shapeA, const b2Transform& xfA,
+						const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	b2Assert(count < b2_narrowPhaseBatch);
+	int32 i = count++;
+
+	manifolds[i] = manifold;
+	shapesA[i] = shapeA;
+	circlesB[i] = circleB;
+
+	pAx[i] = xfA.p.x;
+	pAy[i] = xfA.p.y;
+	cA[i] = xfA.q.c;
+	sA[i] = xfA.q.s;
+	pBx[i] = xfB.p.x;
+	pBy[i] = xfB.p.y;
+	cB[i] = xfB.q.c;
+	sB[i] = xfB.q.s;
+
+	b2Vec2 centerA = shapeA->m_type == b2Shape::e_circle ? ((b2CircleShape*)shapeA)->m_p : b2Vec2_zero;
+	centerAx[i] = centerA.x;
+	centerAy[i] = centerA.y;
+	centerBx[i] = circleB->m_p.x;
+	centerBy[i] = circleB->m_p.y;
+	radius[i] = shapeA->m_radius + circleB->m_radius;
+}
+
+// Compute the center of every circle B in the frame of its shape A. The loop
+// has no branch and works on separate arrays so that it vectorizes.
+static void b2LocalizeCircles(b2CircleBatch* batch)
+{
+	int32 count = batch->count;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 cx = batch->cB[i] * batch->centerBx[i] - batch->sB[i] * batch->centerBy[i] + batch->pBx[i];
+		float32 cy = batch->sB[i] * batch->centerBx[i] + batch->cB[i] * batch->centerBy[i] + batch->pBy[i];
+		float32 dx = cx - batch->pAx[i];
+		float32 dy = cy - batch->pAy[i];
+		batch->localBx[i] = batch->cA[i] * dx + batch->sA[i] * dy;
+		batch->localBy[i] = batch->cA[i] * dy - batch->sA[i] * dx;
+	}
+}
+
+void b2CollideCircles(b2CircleBatch* batch)
+{
+	b2LocalizeCircles(batch);
+
+	int32 count = batch->count;
+	int32 touching[b2_narrowPhaseBatch];
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 dx = batch->localBx[i] - batch->centerAx[i];
+		float32 dy = batch->localBy[i] - batch->centerAy[i];
+		float32 radius = batch->radius[i];
+		touching[i] = dx * dx + dy * dy <= radius * radius;
+	}
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Manifold* manifold = batch->manifolds[i];
+		manifold->pointCount = 0;
+		if (touching[i] == 0)
+		{
+			continue;
+		}
+
+		manifold->type = b2Manifold::e_circles;
+		manifold->localPoint = ((b2CircleShape*)batch->shapesA[i])->m_p;
+		manifold->localNormal.SetZero();
+		manifold->pointCount = 1;
+
+		manifold->points[0].localPoint = batch->circlesB[i]->m_p;
+		manifold->points[0].id.key = 0;
+	}
+
+	batch->count = 0;
+}
+
+void b2CollidePolygonAndCircle(b2CircleBatch* batch)
+{
+	b2LocalizeCircles(batch);
+
+	int32 count = batch->count;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Vec2 cLocal(batch->localBx[i], batch->localBy[i]);
+		b2CollidePolygonAndCircle(batch->manifolds[i], (b2PolygonShape*)batch->shapesA[i], cLocal, batch->circlesB[i]);
+	}
+
+	batch->count = 0;
+}
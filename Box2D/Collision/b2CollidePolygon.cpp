@@ -19,123 +19,72 @@
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
-// Find the separation between poly1 and poly2 for a give edge normal on poly1.
-static float32 b2EdgeSeparation(const b2PolygonShape* poly1, const b2Transform& xf1, int32 edge1,
-							  const b2PolygonShape* poly2, const b2Transform& xf2)
+// Find the separation between poly1 and poly2 for a given edge normal on poly1.
+// xf is the transform of poly1 in the frame of poly2. The loop runs over all the
+// vertex slots of poly2 so that it has a fixed count and vectorizes, the unused
+// slots are ignored.
+static float32 b2EdgeSeparation(const b2PolygonShape* poly1, const b2Transform& xf, int32 edge1,
+							  const b2PolygonShape* poly2)
 {
-	const b2Vec2* vertices1 = poly1->m_vertices;
-	const b2Vec2* normals1 = poly1->m_normals;
-
 	int32 count2 = poly2->m_vertexCount;
 	const b2Vec2* vertices2 = poly2->m_vertices;
 
 	b2Assert(0 <= edge1 && edge1 < poly1->m_vertexCount);
 
-	// Convert normal from poly1's frame into poly2's frame.
-	b2Vec2 normal1World = b2Mul(xf1.q, normals1[edge1]);
-	b2Vec2 normal1 = b2MulT(xf2.q, normal1World);
+	b2Vec2 n = b2Mul(xf.q, poly1->m_normals[edge1]);
+	b2Vec2 v1 = b2Mul(xf, poly1->m_vertices[edge1]);
 
-	// Find support vertex on poly2 for -normal.
-	int32 index = 0;
-	float32 minDot = b2_maxFloat;
+	float32 separations[b2_maxPolygonVertices];
+	for (int32 j = 0; j < b2_maxPolygonVertices; ++j)
+	{
+		separations[j] = b2Dot(n, vertices2[j] - v1);
+	}
 
-	for (int32 i = 0; i < count2; ++i)
+	// Find the support vertex of poly2 for -n.
+	float32 separation = b2_maxFloat;
+	for (int32 j = 0; j < count2; ++j)
 	{
-		float32 dot = b2Dot(vertices2[i], normal1);
-		if (dot < minDot)
-		{
-			minDot = dot;
-			index = i;
-		}
+		separation = b2Min(separation, separations[j]);
 	}
 
-	b2Vec2 v1 = b2Mul(xf1, vertices1[edge1]);
-	b2Vec2 v2 = b2Mul(xf2, vertices2[index]);
-	float32 separation = b2Dot(v2 - v1, normal1World);
 	return separation;
 }
 
 // Find the max separation between poly1 and poly2 using edge normals from poly1.
+// Every edge is tested. xf is the transform of poly1 in the frame of poly2.
 static float32 b2FindMaxSeparation(int32* edgeIndex,
-								 const b2PolygonShape* poly1, const b2Transform& xf1,
-								 const b2PolygonShape* poly2, const b2Transform& xf2)
+								 const b2PolygonShape* poly1, const b2Transform& xf,
+								 const b2PolygonShape* poly2)
 {
 	int32 count1 = poly1->m_vertexCount;
-	const b2Vec2* normals1 = poly1->m_normals;
-
-	// Vector pointing from the centroid of poly1 to the centroid of poly2.
-	b2Vec2 d = b2Mul(xf2, poly2->m_centroid) - b2Mul(xf1, poly1->m_centroid);
-	b2Vec2 dLocal1 = b2MulT(xf1.q, d);
 
-	// Find edge normal on poly1 that has the largest projection onto d.
-	int32 edge = 0;
-	float32 maxDot = -b2_maxFloat;
+	int32 bestEdge = 0;
+	float32 maxSeparation = -b2_maxFloat;
 	for (int32 i = 0; i < count1; ++i)
 	{
-		float32 dot = b2Dot(normals1[i], dLocal1);
-		if (dot > maxDot)
+		float32 si = b2EdgeSeparation(poly1, xf, i, poly2);
+		if (si > maxSeparation)
 		{
-			maxDot = dot;
-			edge = i;
+			maxSeparation = si;
+			bestEdge = i;
 		}
 	}
 
-	// Get the separation for the edge normal.
-	float32 s = b2EdgeSeparation(poly1, xf1, edge, poly2, xf2);
-
-	// Check the separation for the previous edge normal.
-	int32 prevEdge = edge - 1 >= 0 ? edge - 1 : count1 - 1;
-	float32 sPrev = b2EdgeSeparation(poly1, xf1, prevEdge, poly2, xf2);
-
-	// Check the separation for the next edge normal.
-	int32 nextEdge = edge + 1 < count1 ? edge + 1 : 0;
-	float32 sNext = b2EdgeSeparation(poly1, xf1, nextEdge, poly2, xf2);
-
-	// Find the best edge and the search direction.
-	int32 bestEdge;
-	float32 bestSeparation;
-	int32 increment;
-	if (sPrev > s && sPrev > sNext)
-	{
-		increment = -1;
-		bestEdge = prevEdge;
-		bestSeparation = sPrev;
-	}
-	else if (sNext > s)
-	{
-		increment = 1;
-		bestEdge = nextEdge;
-		bestSeparation = sNext;
-	}
-	else
-	{
-		*edgeIndex = edge;
-		return s;
-	}
+	*edgeIndex = bestEdge;
+	return maxSeparation;
+}
 
-	// Perform a local search for the best edge normal.
-	for ( ; ; )
+// Did two polygons move relative to each other by less than the cache tolerances?
+static bool b2IsCacheValid(const b2SATCache* cache, const b2Transform& relative)
+{
+	b2Vec2 dp = relative.p - cache->relative.p;
+	if (b2Dot(dp, dp) > b2_satCacheLinearTolerance * b2_satCacheLinearTolerance)
 	{
-		if (increment == -1)
-			edge = bestEdge - 1 >= 0 ? bestEdge - 1 : count1 - 1;
-		else
-			edge = bestEdge + 1 < count1 ? bestEdge + 1 : 0;
-
-		s = b2EdgeSeparation(poly1, xf1, edge, poly2, xf2);
-
-		if (s > bestSeparation)
-		{
-			bestEdge = edge;
-			bestSeparation = s;
-		}
-		else
-		{
-			break;
-		}
+		return false;
 	}
 
-	*edgeIndex = bestEdge;
-	return bestSeparation;
+	b2Rot dq = b2MulT(cache->relative.q, relative.q);
+	return dq.c > 0.0f && b2Abs(dq.s) <= b2_satCacheAngularTolerance;
 }
 
 static void b2FindIncidentEdge(b2ClipVertex c[2],
@@ -192,38 +141,114 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 // The normal points from 1 to 2
 void b2CollidePolygons(b2Manifold* manifold,
 					  const b2PolygonShape* polyA, const b2Transform& xfA,
-					  const b2PolygonShape* polyB, const b2Transform& xfB)
+					  const b2PolygonShape* polyB, const b2Transform& xfB,
+					  b2SATCache* cache)
 {
 	manifold->pointCount = 0;
 	float32 totalRadius = polyA->m_radius + polyB->m_radius;
 
-	int32 edgeA = 0;
-	float32 separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
-	if (separationA > totalRadius)
-		return;
+	// Transforms of B in the frame of A and of A in the frame of B.
+	b2Transform xfBA = b2MulT(xfA, xfB);
+	b2Transform xfAB = b2MulT(xfB, xfA);
 
-	int32 edgeB = 0;
-	float32 separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
-	if (separationB > totalRadius)
-		return;
+	if (cache && cache->edge >= (cache->flip ? polyB : polyA)->m_vertexCount)
+	{
+		// The polygon was changed.
+		cache->state = b2SATCache::e_empty;
+	}
+
+	int32 edge1;		// reference edge
+	uint8 flip;
+	bool hit = false;
+
+	if (cache)
+	{
+		cache->hit = 0;
+
+		if (cache->state == b2SATCache::e_separated)
+		{
+			// A separating axis usually keeps separating for a while.
+			float32 separation = cache->flip ?
+				b2EdgeSeparation(polyB, xfBA, cache->edge, polyA) :
+				b2EdgeSeparation(polyA, xfAB, cache->edge, polyB);
+			if (separation > totalRadius)
+			{
+				cache->hit = 1;
+				return;
+			}
+		}
+		else if (cache->state == b2SATCache::e_touching && b2IsCacheValid(cache, xfBA))
+		{
+			// The polygons barely moved: keep the reference face.
+			cache->hit = 1;
+			edge1 = cache->edge;
+			flip = cache->flip;
+			hit = true;
+		}
+	}
+
+	if (hit == false)
+	{
+		int32 edgeA = 0;
+		float32 separationA = b2FindMaxSeparation(&edgeA, polyA, xfAB, polyB);
+		if (separationA > totalRadius)
+		{
+			if (cache)
+			{
+				cache->state = b2SATCache::e_separated;
+				cache->flip = 0;
+				cache->edge = (uint8)edgeA;
+			}
+			return;
+		}
+
+		int32 edgeB = 0;
+		float32 separationB = b2FindMaxSeparation(&edgeB, polyB, xfBA, polyA);
+		if (separationB > totalRadius)
+		{
+			if (cache)
+			{
+				cache->state = b2SATCache::e_separated;
+				cache->flip = 1;
+				cache->edge = (uint8)edgeB;
+			}
+			return;
+		}
+
+		const float32 k_relativeTol = 0.98f;
+		const float32 k_absoluteTol = 0.001f;
+
+		if (separationB > k_relativeTol * separationA + k_absoluteTol)
+		{
+			edge1 = edgeB;
+			flip = 1;
+		}
+		else
+		{
+			edge1 = edgeA;
+			flip = 0;
+		}
+
+		if (cache)
+		{
+			cache->state = b2SATCache::e_touching;
+			cache->flip = flip;
+			cache->edge = (uint8)edge1;
+			cache->relative = xfBA;
+		}
+	}
 
 	const b2PolygonShape* poly1;	// reference polygon
 	const b2PolygonShape* poly2;	// incident polygon
 	b2Transform xf1, xf2;
-	int32 edge1;		// reference edge
-	uint8 flip;
-	const float32 k_relativeTol = 0.98f;
-	const float32 k_absoluteTol = 0.001f;
 
-	if (separationB > k_relativeTol * separationA + k_absoluteTol)
+	if (flip)
 	{
 		poly1 = polyB;
 		poly2 = polyA;
 		xf1 = xfB;
 		xf2 = xfA;
-		edge1 = edgeB;
 		manifold->type = b2Manifold::e_faceB;
-		flip = 1;
 	}
 	else
 	{
@@ -231,9 +256,7 @@ void b2CollidePolygons(b2Manifold* manifold,
 		poly2 = polyB;
 		xf1 = xfA;
 		xf2 = xfB;
-		edge1 = edgeA;
 		manifold->type = b2Manifold::e_faceA;
-		flip = 0;
 	}
 
 	b2ClipVertex incidentEdge[2];
@@ -224,10 +224,33 @@ void b2CollidePolygonAndCircle(b2Manifold* manifold,
 							   const b2PolygonShape* polygonA, const b2Transform& xfA,
 							   const b2CircleShape* circleB, const b2Transform& xfB);
 
-/// Compute the collision manifold between two polygons.
+/// Separating axis search of b2CollidePolygons kept between calls on the same
+/// pair. A previous separating axis is tested first, and the previous reference
+/// face is reused while the polygons barely move relative to each other.
+struct b2SATCache
+{
+	b2SATCache() : state(e_empty), flip(0), edge(0), hit(0) {}
+
+	enum State
+	{
+		e_empty,
+		e_separated,	///< the edge separates the polygons
+		e_touching		///< the edge is the reference face
+	};
+
+	uint8 state;
+	uint8 flip;		///< the edge belongs to polygon B
+	uint8 edge;
+	uint8 hit;		///< the last call skipped the full search
+	b2Transform relative;	///< transform of B in the frame of A when the face was found
+};
+
+/// Compute the collision manifold between two polygons. The optional cache
+/// carries the separating axis search over from the previous call.
 void b2CollidePolygons(b2Manifold* manifold,
 					   const b2PolygonShape* polygonA, const b2Transform& xfA,
-					   const b2PolygonShape* polygonB, const b2Transform& xfB);
+					   const b2PolygonShape* polygonB, const b2Transform& xfB,
+					   b2SATCache* cache = NULL);
 
 /// Compute the collision manifold between an edge and a circle.
 void b2CollideEdgeAndCircle(b2Manifold* manifold,
@@ -239,6 +262,46 @@ void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 							   const b2EdgeShape* edgeA, const b2Transform& xfA,
 							   const b2PolygonShape* circleB, const b2Transform& xfB);
 
+/// Pairs of circles, or of a polygon and a circle, collided together by the
+/// narrow-phase. The transforms are stored per component so that the kernels
+/// run over several pairs per SIMD instruction.
+struct b2CircleBatch
+{
+	b2CircleBatch() : count(0) {}
+
+	/// Append a pair. shapeA is a circle or a polygon. The manifold is written
+	/// by the batched collide function.
+	void Add(b2Manifold* manifold,
+			 const b2Shape* shapeA, const b2Transform& xfA,
+			 const b2CircleShape* circleB, const b2Transform& xfB);
+
+	/// Is the batch full?
+	bool IsFull() const { return count == b2_narrowPhaseBatch; }
+
+	int32 count;
+
+	b2Manifold* manifolds[b2_narrowPhaseBatch];
+	const b2Shape* shapesA[b2_narrowPhaseBatch];
+	const b2CircleShape* circlesB[b2_narrowPhaseBatch];
+
+	float32 pAx[b2_narrowPhaseBatch], pAy[b2_narrowPhaseBatch];
+	float32 cA[b2_narrowPhaseBatch], sA[b2_narrowPhaseBatch];
+	float32 pBx[b2_narrowPhaseBatch], pBy[b2_narrowPhaseBatch];
+	float32 cB[b2_narrowPhaseBatch], sB[b2_narrowPhaseBatch];
+	float32 centerAx[b2_narrowPhaseBatch], centerAy[b2_narrowPhaseBatch];
+	float32 centerBx[b2_narrowPhaseBatch], centerBy[b2_narrowPhaseBatch];
+	float32 radius[b2_narrowPhaseBatch];
+
+	// Center of circle B in the frame of shape A.
+	float32 localBx[b2_narrowPhaseBatch], localBy[b2_narrowPhaseBatch];
+};
+
+/// Compute the collision manifolds of a batch of circle pairs and empty it.
+void b2CollideCircles(b2CircleBatch* batch);
+
+/// Compute the collision manifolds of a batch of polygon and circle pairs and empty it.
+void b2CollidePolygonAndCircle(b2CircleBatch* batch);
+
 /// Clipping for contact manifolds.
 int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 							const b2Vec2& normal, float32 offset, int32 vertexIndexA);
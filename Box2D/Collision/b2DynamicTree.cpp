@@ -19,6 +19,7 @@
 #include <Box2D/Collision/b2DynamicTree.h>
 #include <cstring>
 #include <cfloat>
+#include <algorithm>
 using namespace std;
 
 
@@ -44,6 +45,10 @@ b2DynamicTree::b2DynamicTree()
 	m_path = 0;
 
 	m_insertionCount = 0;
+
+	m_adaptiveMargins = false;
+	m_reinsertCount = 0;
+	m_bulkInsert = false;
 }
 
 b2DynamicTree::~b2DynamicTree()
@@ -110,13 +115,16 @@ int32 b2DynamicTree::CreateProxy(const b2AABB& aabb, void* userData)
 	int32 proxyId = AllocateNode();
 
 	// Fatten the aabb.
-	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
-	m_nodes[proxyId].aabb.lowerBound = aabb.lowerBound - r;
-	m_nodes[proxyId].aabb.upperBound = aabb.upperBound + r;
+	m_nodes[proxyId].marginScale = 1.0f;
+	SetFatAABB(proxyId, aabb, b2Vec2_zero);
 	m_nodes[proxyId].userData = userData;
 	m_nodes[proxyId].height = 0;
 
-	InsertLeaf(proxyId);
+	// A bulk insertion links the leaf in EndBulkInsert.
+	if (m_bulkInsert == false)
+	{
+		InsertLeaf(proxyId);
+	}
 
 	return proxyId;
 }
@@ -125,6 +133,7 @@ void b2DynamicTree::DestroyProxy(int32 proxyId)
 {
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
 	b2Assert(m_nodes[proxyId].IsLeaf());
+	b2Assert(m_bulkInsert == false);
 
 	RemoveLeaf(proxyId);
 	FreeNode(proxyId);
@@ -135,22 +144,59 @@ bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& d
 	b2Assert(0 <= proxyId && proxyId < m_nodeCapacity);
 
 	b2Assert(m_nodes[proxyId].IsLeaf());
+	b2Assert(m_bulkInsert == false);
 
-	if (m_nodes[proxyId].aabb.Contains(aabb))
+	b2TreeNode* node = m_nodes + proxyId;
+	if (node->aabb.Contains(aabb))
 	{
+		++node->moveCount;
+
+		// Shrink the margin of a proxy that doesn't use it. The displacement
+		// prediction can push the new fat AABB past the old one, so it is clipped
+		// to the old one: it cannot overlap new proxies and the move is not buffered.
+		if (m_adaptiveMargins && node->moveCount >= b2_aabbIdleMoves && node->marginScale > b2_aabbMinScale)
+		{
+			b2AABB oldAABB = node->aabb;
+			node->marginScale = b2Max(0.5f * node->marginScale, b2_aabbMinScale);
+			RemoveLeaf(proxyId);
+			SetFatAABB(proxyId, aabb, displacement);
+			node->aabb.lowerBound = b2Max(node->aabb.lowerBound, oldAABB.lowerBound);
+			node->aabb.upperBound = b2Min(node->aabb.upperBound, oldAABB.upperBound);
+			InsertLeaf(proxyId);
+			++m_reinsertCount;
+		}
+
 		return false;
 	}
 
+	// Grow the margin of a proxy that keeps leaving its fat AABB.
+	if (m_adaptiveMargins && node->moveCount < b2_aabbChurnMoves)
+	{
+		node->marginScale = b2Min(2.0f * node->marginScale, b2_aabbMaxScale);
+	}
+
 	RemoveLeaf(proxyId);
+	SetFatAABB(proxyId, aabb, displacement);
+	InsertLeaf(proxyId);
+	++m_reinsertCount;
+	return true;
+}
 
-	// Extend AABB.
+void b2DynamicTree::SetFatAABB(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
+{
+	b2TreeNode* node = m_nodes + proxyId;
+	node->moveCount = 0;
+
+	// Extend AABB. Only idle proxies get a smaller extension, growing it for
+	// fast ones would add pairs all around them.
 	b2AABB b = aabb;
-	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	float32 extension = b2Min(node->marginScale, 1.0f) * b2_aabbExtension;
+	b2Vec2 r(extension, extension);
 	b.lowerBound = b.lowerBound - r;
 	b.upperBound = b.upperBound + r;
 
 	// Predict AABB displacement.
-	b2Vec2 d = b2_aabbMultiplier * displacement;
+	b2Vec2 d = (b2Max(node->marginScale, 1.0f) * b2_aabbMultiplier) * displacement;
 
 	if (d.x < 0.0f)
 	{
@@ -170,10 +216,7 @@ bool b2DynamicTree::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& d
 		b.upperBound.y += d.y;
 	}
 
-	m_nodes[proxyId].aabb = b;
-
-	InsertLeaf(proxyId);
-	return true;
+	node->aabb = b;
 }
 
 void b2DynamicTree::InsertLeaf(int32 leaf)
@@ -530,6 +573,11 @@ int32 b2DynamicTree::GetHeight() const
 	return m_nodes[m_root].height;
 }
 
+int32 b2DynamicTree::GetMemory() const
+{
+	return m_nodeCapacity * sizeof(b2TreeNode);
+}
+
 //
 float32 b2DynamicTree::GetAreaRatio() const
 {
@@ -769,3 +817,99 @@ void b2DynamicTree::RebuildBottomUp()
 
 	Validate();
 }
+
+// Orders leaves by the center of their AABB along an axis.
+struct b2LeafCenterCompare
+{
+	bool operator()(int32 a, int32 b) const
+	{
+		const b2AABB& aabbA = nodes[a].aabb;
+		const b2AABB& aabbB = nodes[b].aabb;
+		return aabbA.lowerBound(axis) + aabbA.upperBound(axis) < aabbB.lowerBound(axis) + aabbB.upperBound(axis);
+	}
+
+	const b2TreeNode* nodes;
+	int32 axis;
+};
+
+void b2DynamicTree::BeginBulkInsert()
+{
+	b2Assert(m_bulkInsert == false);
+	m_bulkInsert = true;
+}
+
+void b2DynamicTree::EndBulkInsert()
+{
+	b2Assert(m_bulkInsert == true);
+	m_bulkInsert = false;
+
+	int32* leaves = (int32*)b2Alloc(m_nodeCount * sizeof(int32));
+	int32 count = 0;
+
+	// Gather the leaves, old and new. Free the rest.
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		if (m_nodes[i].height < 0)
+		{
+			continue;
+		}
+
+		if (m_nodes[i].IsLeaf())
+		{
+			leaves[count++] = i;
+		}
+		else
+		{
+			FreeNode(i);
+		}
+	}
+
+	m_root = b2_nullNode;
+	if (count > 0)
+	{
+		m_root = BuildTopDown(leaves, count);
+		m_nodes[m_root].parent = b2_nullNode;
+	}
+
+	b2Free(leaves);
+}
+
+int32 b2DynamicTree::BuildTopDown(int32* leaves, int32 count)
+{
+	if (count == 1)
+	{
+		return leaves[0];
+	}
+
+	// Split at the median center along the longest axis of the centers.
+	b2Vec2 lower = m_nodes[leaves[0]].aabb.GetCenter();
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		b2Vec2 center = m_nodes[leaves[i]].aabb.GetCenter();
+		lower = b2Min(lower, center);
+		upper = b2Max(upper, center);
+	}
+
+	b2LeafCenterCompare compare;
+	compare.nodes = m_nodes;
+	compare.axis = upper.x - lower.x >= upper.y - lower.y ? 0 : 1;
+
+	int32 half = count / 2;
+	std::nth_element(leaves, leaves + half, leaves + count, compare);
+
+	int32 child1 = BuildTopDown(leaves, half);
+	int32 child2 = BuildTopDown(leaves + half, count - half);
+
+	int32 index = AllocateNode();
+	b2TreeNode* node = m_nodes + index;
+	node->child1 = child1;
+	node->child2 = child2;
+	node->aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+	node->height = 1 + b2Max(m_nodes[child1].height, m_nodes[child2].height);
+
+	m_nodes[child1].parent = index;
+	m_nodes[child2].parent = index;
+
+	return index;
+}
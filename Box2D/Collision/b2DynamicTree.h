@@ -48,6 +48,11 @@ struct b2TreeNode
 
 	// leaf = 0, free node = -1
 	int32 height;
+
+	// Leaf margin relative to the default one, and the moves since the leaf
+	// was inserted. See b2DynamicTree::SetAdaptiveMargins.
+	float32 marginScale;
+	int32 moveCount;
 };
 
 /// A dynamic AABB tree broad-phase, inspired by Nathanael Presson's btDbvt.
@@ -79,6 +84,23 @@ public:
 	/// @return true if the proxy was re-inserted.
 	bool MoveProxy(int32 proxyId, const b2AABB& aabb1, const b2Vec2& displacement);
 
+	/// Adapt the margin of every proxy to its recent motion. Proxies that keep
+	/// leaving their fat AABB predict their displacement further, proxies that
+	/// don't leave it get a smaller extension. Off by default, the margins are
+	/// then b2_aabbExtension plus twice the displacement.
+	void SetAdaptiveMargins(bool flag) { m_adaptiveMargins = flag; }
+
+	/// Get the number of proxies re-inserted since the last ResetReinsertCount.
+	int32 GetReinsertCount() const { return m_reinsertCount; }
+	void ResetReinsertCount() { m_reinsertCount = 0; }
+
+	/// Don't insert the new proxies until EndBulkInsert, which then builds the
+	/// tree top-down from all the leaves. This is much faster than inserting many
+	/// proxies one by one. The tree can't be queried and the proxies can't be
+	/// moved or destroyed in between.
+	void BeginBulkInsert();
+	void EndBulkInsert();
+
 	/// Get proxy user data.
 	/// @return the proxy user data or 0 if the id is invalid.
 	void* GetUserData(int32 proxyId) const;
@@ -115,6 +137,9 @@ public:
 	/// Get the ratio of the sum of the node areas to the root area.
 	float32 GetAreaRatio() const;
 
+	/// Get the number of bytes allocated for the nodes.
+	int32 GetMemory() const;
+
 	/// Build an optimal tree. Very expensive. For testing.
 	void RebuildBottomUp();
 
@@ -126,8 +151,14 @@ private:
 	void InsertLeaf(int32 node);
 	void RemoveLeaf(int32 node);
 
+	// Fatten the AABB of a leaf by its margin.
+	void SetFatAABB(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement);
+
 	int32 Balance(int32 index);
 
+	// Build a subtree over the leaves by median splits, return its root.
+	int32 BuildTopDown(int32* leaves, int32 count);
+
 	int32 ComputeHeight() const;
 	int32 ComputeHeight(int32 nodeId) const;
 
@@ -146,6 +177,11 @@ private:
 	uint32 m_path;
 
 	int32 m_insertionCount;
+
+	bool m_adaptiveMargins;
+	int32 m_reinsertCount;
+
+	bool m_bulkInsert;
 };
 
 inline void* b2DynamicTree::GetUserData(int32 proxyId) const
@@ -25,9 +25,6 @@
 #include <cstdio>
 using namespace std;
 
-int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
-int32 b2_toiRootIters, b2_toiMaxRootIters;
-
 struct b2SeparationFunction
 {
 	enum Type
@@ -256,10 +253,12 @@ struct b2SeparationFunction
 // by computing the largest time at which separation is maintained.
 void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 {
-	++b2_toiCalls;
-
 	output->state = b2TOIOutput::e_unknown;
 	output->t = input->tMax;
+	output->iterations = 0;
+	output->rootIterations = 0;
+	output->distanceCalls = 0;
+	output->distanceIterations = 0;
 
 	const b2DistanceProxy* proxyA = &input->proxyA;
 	const b2DistanceProxy* proxyB = &input->proxyB;
@@ -305,6 +304,8 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		distanceInput.transformB = xfB;
 		b2DistanceOutput distanceOutput;
 		b2Distance(&distanceOutput, &cache, &distanceInput);
+		++output->distanceCalls;
+		output->distanceIterations += distanceOutput.iterations;
 
 		// If the shapes are overlapped, we give up on continuous collision.
 		if (distanceOutput.distance <= 0.0f)
@@ -444,7 +445,7 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 
 				++rootIterCount;
-				++b2_toiRootIters;
+				++output->rootIterations;
 
 				if (rootIterCount == 50)
 				{
@@ -452,8 +453,6 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 			}
 
-			b2_toiMaxRootIters = b2Max(b2_toiMaxRootIters, rootIterCount);
-
 			++pushBackIter;
 
 			if (pushBackIter == b2_maxPolygonVertices)
@@ -463,7 +462,6 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 
 		++iter;
-		++b2_toiIters;
 
 		if (done)
 		{
@@ -479,5 +477,5 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 	}
 
-	b2_toiMaxIters = b2Max(b2_toiMaxIters, iter);
+	output->iterations = iter;
 }
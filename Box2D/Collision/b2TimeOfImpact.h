@@ -46,6 +46,10 @@ struct b2TOIOutput
 
 	State state;
 	float32 t;
+	int32 iterations;			///< number of separating axis iterations used
+	int32 rootIterations;		///< number of root finder iterations, over all axes
+	int32 distanceCalls;		///< number of GJK distance queries
+	int32 distanceIterations;	///< number of GJK iterations, over all queries
 };
 
 /// Compute the upper bound on time before two shapes penetrate. Time is represented as
@@ -23,22 +23,31 @@
 #include <memory>
 using namespace std;
 
+// Steps of 16 bytes up to 256, where the bodies, fixtures, shapes and contacts
+// are, so they don't round up by much.
 int32 b2BlockAllocator::s_blockSizes[b2_blockSizes] = 
 {
 	16,		// 0
 	32,		// 1
-	64,		// 2
-	96,		// 3
-	128,	// 4
-	160,	// 5
-	192,	// 6
-	224,	// 7
-	256,	// 8
-	320,	// 9
-	384,	// 10
-	448,	// 11
-	512,	// 12
-	640,	// 13
+	48,		// 2
+	64,		// 3
+	80,		// 4
+	96,		// 5
+	112,	// 6
+	128,	// 7
+	144,	// 8
+	160,	// 9
+	176,	// 10
+	192,	// 11
+	208,	// 12
+	224,	// 13
+	240,	// 14
+	256,	// 15
+	320,	// 16
+	384,	// 17
+	448,	// 18
+	512,	// 19
+	640,	// 20
 };
 uint8 b2BlockAllocator::s_blockSizeLookup[b2_maxBlockSize + 1];
 bool b2BlockAllocator::s_blockSizeLookupInitialized;
@@ -96,6 +105,27 @@ b2BlockAllocator::~b2BlockAllocator()
 	b2Free(m_chunks);
 }
 
+int32 b2BlockAllocator::GetBlockSize(int32 size)
+{
+	if (size <= 0)
+	{
+		return 0;
+	}
+
+	if (size > b2_maxBlockSize)
+	{
+		return size;
+	}
+
+	b2Assert(s_blockSizeLookupInitialized);
+	return s_blockSizes[s_blockSizeLookup[size]];
+}
+
+int32 b2BlockAllocator::GetMemory() const
+{
+	return m_chunkCount * b2_chunkSize + m_chunkSpace * int32(sizeof(b2Chunk));
+}
+
 void* b2BlockAllocator::Allocate(int32 size)
 {
 	if (size == 0)
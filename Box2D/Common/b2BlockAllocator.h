@@ -23,7 +23,7 @@
 
 const int32 b2_chunkSize = 16 * 1024;
 const int32 b2_maxBlockSize = 640;
-const int32 b2_blockSizes = 14;
+const int32 b2_blockSizes = 21;
 const int32 b2_chunkArrayIncrement = 128;
 
 struct b2Block;
@@ -46,6 +46,12 @@ public:
 
 	void Clear();
 
+	/// Get the bytes taken by an allocation of this size, the size of its block.
+	static int32 GetBlockSize(int32 size);
+
+	/// Get the bytes reserved by the chunks, used or free.
+	int32 GetMemory() const;
+
 private:
 
 	b2Chunk* m_chunks;
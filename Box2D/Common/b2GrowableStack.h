@@ -69,11 +69,23 @@ public:
 		return m_stack[m_count];
 	}
 
-	int32 GetCount()
+	int32 GetCount() const
 	{
 		return m_count;
 	}
 
+	/// Get the elements, from the bottom of the stack.
+	const T* GetData() const
+	{
+		return m_stack;
+	}
+
+	/// Remove all the elements. The capacity is kept.
+	void Clear()
+	{
+		m_count = 0;
+	}
+
 private:
 	T* m_stack;
 	T m_array[N];
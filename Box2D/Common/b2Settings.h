@@ -42,6 +42,40 @@ typedef double float64;
 /// Global tuning constants based on meters-kilograms-seconds (MKS) units.
 ///
 
+// Configuration
+
+/// A build replaces the settings defined under #ifndef below by defining
+/// B2_USER_SETTINGS and putting its own b2UserSettings.h in the include path.
+/// That header is read first. The library and the code using it must be
+/// compiled with the same settings, since some change the size of structures.
+#ifdef B2_USER_SETTINGS
+#include <b2UserSettings.h>
+#endif
+
+/// Only support circle shapes. The contacts then have one point and a circles
+/// manifold, so the narrow-phase and the contact solver leave out the paths of
+/// the other shape types. Creating another shape asserts.
+#ifndef b2_circlesOnly
+#define b2_circlesOnly			0
+#endif
+
+/// Set to 0 to leave the continuous collision out of the step, as if
+/// b2World::SetContinuousPhysics(false) was called.
+#ifndef b2_enableContinuous
+#define b2_enableContinuous		1
+#endif
+
+/// Solve the islands with this many velocity and position iterations whatever
+/// b2World::Step is given, 0 to use the ones of the step. A constant count lets
+/// the compiler specialize the solver loops. The velocity tolerance, see
+/// b2World::SetVelocityTolerance, is then ignored.
+#ifndef b2_fixedVelocityIterations
+#define b2_fixedVelocityIterations	0
+#endif
+#ifndef b2_fixedPositionIterations
+#define b2_fixedPositionIterations	0
+#endif
+
 // Collision
 
 /// The maximum number of contact points between two convex shapes. Do
@@ -50,51 +84,107 @@ typedef double float64;
 
 /// The maximum number of vertices on a convex polygon. You cannot increase
 /// this too much because b2BlockAllocator has a maximum object size.
+#ifndef b2_maxPolygonVertices
 #define b2_maxPolygonVertices	8
+#endif
+
+/// The number of contacts the narrow-phase gathers before running a batched
+/// collision kernel. Keep this a multiple of the SIMD width.
+#define b2_narrowPhaseBatch		32
+
+/// The number of joints of one type solved together by the joint solver.
+/// Keep this a multiple of the SIMD width.
+#define b2_jointBatchWidth		4
+
+/// The relative motion of two polygons below which b2CollidePolygons keeps the
+/// reference face found at a previous step. In meters and radians.
+#define b2_satCacheLinearTolerance		(0.25f * b2_linearSlop)
+#define b2_satCacheAngularTolerance		(0.25f * b2_angularSlop)
+
+/// The number of consecutive chain edges sharing one broad-phase proxy. The
+/// contacts are still created per edge.
+#define b2_chainProxyEdges		32
 
 /// This is used to fatten AABBs in the dynamic tree. This allows proxies
 /// to move by a small amount without triggering a tree adjustment.
 /// This is in meters.
+#ifndef b2_aabbExtension
 #define b2_aabbExtension		0.1f
+#endif
 
 /// This is used to fatten AABBs in the dynamic tree. This is used to predict
 /// the future position based on the current displacement.
 /// This is a dimensionless multiplier.
+#ifndef b2_aabbMultiplier
 #define b2_aabbMultiplier		2.0f
+#endif
 
+/// Adaptive fat AABB margins. A proxy that leaves its fat AABB within
+/// b2_aabbChurnMoves moves doubles its scale, one that stays in its fat AABB for
+/// b2_aabbIdleMoves moves halves it. The scale is kept in [b2_aabbMinScale,
+/// b2_aabbMaxScale]. Above 1 it multiplies the displacement prediction, which
+/// only grows the AABB ahead of the motion. Below 1 it multiplies b2_aabbExtension.
+#define b2_aabbChurnMoves		2
+#define b2_aabbIdleMoves		60
+#define b2_aabbMinScale			0.25f
+#define b2_aabbMaxScale			4.0f
+
+/// The approach speed above which a contact starting to touch records a hit
+/// event, see b2World::SetContactEventsEnabled. In meters per second.
+#define b2_hitEventThreshold	1.0f
+
 /// A small length used as a collision and constraint tolerance. Usually it is
 /// chosen to be numerically significant, but visually insignificant.
+#ifndef b2_linearSlop
 #define b2_linearSlop			0.005f
+#endif
 
 /// A small angle used as a collision and constraint tolerance. Usually it is
 /// chosen to be numerically significant, but visually insignificant.
+#ifndef b2_angularSlop
 #define b2_angularSlop			(2.0f / 180.0f * b2_pi)
+#endif
 
 /// The radius of the polygon/edge shape skin. This should not be modified. Making
 /// this smaller means polygons will have an insufficient buffer for continuous collision.
 /// Making it larger may create artifacts for vertex collision.
 #define b2_polygonRadius		(2.0f * b2_linearSlop)
 
+/// Speculative contacts are only added between shapes that can close a gap larger than
+/// this during a time step. Slower shapes are caught by the regular contacts, within the
+/// polygon skin.
+#define b2_speculativeDistance	(4.0f * b2_linearSlop)
+
 /// Maximum number of sub-steps per contact in continuous physics simulation.
+#ifndef b2_maxSubSteps
 #define b2_maxSubSteps			8
+#endif
 
 
 // Dynamics
 
 /// Maximum number of contacts to be handled to solve a TOI impact.
+#ifndef b2_maxTOIContacts
 #define b2_maxTOIContacts			32
+#endif
 
 /// A velocity threshold for elastic collisions. Any collision with a relative linear
 /// velocity below this threshold will be treated as inelastic.
+#ifndef b2_velocityThreshold
 #define b2_velocityThreshold		.1f
+#endif
 
 /// The maximum linear position correction used when solving constraints. This helps to
 /// prevent overshoot.
+#ifndef b2_maxLinearCorrection
 #define b2_maxLinearCorrection		0.2f
+#endif
 
 /// The maximum angular position correction used when solving constraints. This helps to
 /// prevent overshoot.
+#ifndef b2_maxAngularCorrection
 #define b2_maxAngularCorrection		(8.0f / 180.0f * b2_pi)
+#endif
 
 /// The maximum linear velocity of a body. This limit is very large and is used
 /// to prevent numerical problems. You shouldn't need to adjust this.
@@ -112,17 +202,45 @@ typedef double float64;
 #define b2_baumgarte				0.2f
 #define b2_toiBaugarte				0.75f
 
+/// Stiffness of the soft contacts used by the sub-stepping solver, in Hertz. It is
+/// capped to a quarter of the sub-step rate. Contacts against static bodies are twice as stiff.
+#define b2_contactHertz				30.0f
+
+/// Damping ratio of the soft contacts used by the sub-stepping solver. Overdamped so
+/// that stacks don't bounce.
+#define b2_contactDampingRatio		10.0f
+
+/// The maximum velocity used to push apart overlapping shapes in the sub-stepping solver.
+#define b2_contactPushVelocity		3.0f
+
+/// Islands with fewer contacts and joints than this are solved on one thread, even
+/// when the world has a thread pool.
+#define b2_minParallelConstraints	256
+
+/// The number of colors of the parallel island solver, at most 32. The constraints
+/// left without a color go to one more color, solved on a single thread.
+#define b2_graphColorCount			24
+
+/// The largest step interval of an island, see b2LevelOfDetail.
+#define b2_maxStepInterval			16
+
 
 // Sleep
 
 /// The time that a body must be still before it will go to sleep.
+#ifndef b2_timeToSleep
 #define b2_timeToSleep				0.5f
+#endif
 
 /// A body cannot sleep if its linear velocity is above this tolerance.
+#ifndef b2_linearSleepTolerance
 #define b2_linearSleepTolerance		0.01f
+#endif
 
 /// A body cannot sleep if its angular velocity is above this tolerance.
+#ifndef b2_angularSleepTolerance
 #define b2_angularSleepTolerance	(2.0f / 180.0f * b2_pi)
+#endif
 
 // Memory Allocation
 
@@ -18,6 +18,7 @@
 
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Math.h>
+#include <cstddef>
 
 b2StackAllocator::b2StackAllocator()
 {
@@ -37,21 +38,27 @@ void* b2StackAllocator::Allocate(int32 size)
 {
 	b2Assert(m_entryCount < b2_maxStackEntries);
 
+	// Round up so the next block stays aligned. Only the first block pays
+	// padding, and only when m_data itself is not aligned.
+	size = (size + b2_stackAlignment - 1) & ~(b2_stackAlignment - 1);
+	int32 padding = int32((b2_stackAlignment - (size_t)(m_data + m_index) % b2_stackAlignment) % b2_stackAlignment);
+
 	b2StackEntry* entry = m_entries + m_entryCount;
 	entry->size = size;
-	if (m_index + size > b2_stackSize)
+	if (m_index + padding + size > b2_stackSize)
 	{
 		entry->data = (char*)b2Alloc(size);
 		entry->usedMalloc = true;
 	}
 	else
 	{
-		entry->data = m_data + m_index;
+		entry->size += padding;
+		entry->data = m_data + m_index + padding;
 		entry->usedMalloc = false;
-		m_index += size;
+		m_index += entry->size;
 	}
 
-	m_allocation += size;
+	m_allocation += entry->size;
 	m_maxAllocation = b2Max(m_maxAllocation, m_allocation);
 	++m_entryCount;
 
@@ -23,6 +23,7 @@
 
 const int32 b2_stackSize = 100 * 1024;	// 100k
 const int32 b2_maxStackEntries = 32;
+const int32 b2_stackAlignment = 16;	// SoA solver batches need this
 
 struct b2StackEntry
 {
@@ -34,6 +35,7 @@ struct b2StackEntry
 // This is a stack allocator used for fast per step allocations.
 // You must nest allocate/free pairs. The code will assert
 // if you try to interleave multiple allocate/free pairs.
+// Every block is aligned to b2_stackAlignment bytes.
 class b2StackAllocator
 {
 public:
@@ -0,0 +1,197 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2ThreadPool.h>
+#include <Box2D/Common/b2Math.h>
+
+#if defined(__linux__) || defined (__APPLE__)
+
+#include <sched.h>
+
+// Polls of an idle worker before it goes to sleep. The polls yield, so the
+// workers don't starve the other threads when there are fewer cores.
+static const int32 b2_spinCount = 4000;
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+	m_threadCount = b2Max(threadCount, 1);
+
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_wake, NULL);
+
+	m_task = NULL;
+	m_count = 0;
+	m_grain = 1;
+	m_rangeCount = 0;
+	m_nextRange = 0;
+	m_doneRanges = 0;
+	m_generation = 0;
+	m_sleeping = 0;
+	m_quit = false;
+
+	m_workers = (b2Worker*)b2Alloc(m_threadCount * sizeof(b2Worker));
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		b2Worker* worker = m_workers + i;
+		worker->pool = this;
+		worker->index = i;
+		if (pthread_create(&worker->thread, NULL, WorkerMain, worker) != 0)
+		{
+			// Run with the threads we got.
+			m_threadCount = i;
+			break;
+		}
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	pthread_mutex_lock(&m_mutex);
+	m_quit = true;
+	pthread_cond_broadcast(&m_wake);
+	pthread_mutex_unlock(&m_mutex);
+
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		pthread_join(m_workers[i].thread, NULL);
+	}
+
+	b2Free(m_workers);
+	pthread_cond_destroy(&m_wake);
+	pthread_mutex_destroy(&m_mutex);
+}
+
+void* b2ThreadPool::WorkerMain(void* data)
+{
+	b2Worker* worker = (b2Worker*)data;
+	b2ThreadPool* pool = worker->pool;
+
+	int32 generation = 0;
+	for (;;)
+	{
+		// Workers spin on the generation outside the mutex, so it is read and
+		// written atomically.
+		for (int32 i = 0; i < b2_spinCount && __atomic_load_n(&pool->m_generation, __ATOMIC_ACQUIRE) == generation; ++i)
+		{
+			sched_yield();
+		}
+
+		pthread_mutex_lock(&pool->m_mutex);
+		while (pool->m_generation == generation && pool->m_quit == false)
+		{
+			++pool->m_sleeping;
+			pthread_cond_wait(&pool->m_wake, &pool->m_mutex);
+			--pool->m_sleeping;
+		}
+
+		if (pool->m_quit)
+		{
+			pthread_mutex_unlock(&pool->m_mutex);
+			return NULL;
+		}
+
+		generation = pool->m_generation;
+		pthread_mutex_unlock(&pool->m_mutex);
+
+		pool->Work(worker->index);
+	}
+}
+
+void b2ThreadPool::Work(int32 threadIndex)
+{
+	for (;;)
+	{
+		// The task is read with its range: a late worker may pick up the next task.
+		pthread_mutex_lock(&m_mutex);
+		int32 range = m_nextRange < m_rangeCount ? m_nextRange++ : -1;
+		b2ParallelTask* task = m_task;
+		int32 count = m_count;
+		int32 grain = m_grain;
+		pthread_mutex_unlock(&m_mutex);
+
+		if (range == -1)
+		{
+			return;
+		}
+
+		int32 begin = range * grain;
+		task->Execute(begin, b2Min(begin + grain, count), threadIndex);
+
+		__sync_fetch_and_add(&m_doneRanges, 1);
+	}
+}
+
+void b2ThreadPool::ParallelFor(b2ParallelTask* task, int32 count, int32 grain)
+{
+	grain = b2Max(grain, 1);
+	int32 rangeCount = (count + grain - 1) / grain;
+	if (m_threadCount == 1 || rangeCount <= 1)
+	{
+		if (count > 0)
+		{
+			task->Execute(0, count, 0);
+		}
+		return;
+	}
+
+	pthread_mutex_lock(&m_mutex);
+	m_task = task;
+	m_count = count;
+	m_grain = grain;
+	m_rangeCount = rangeCount;
+	m_nextRange = 0;
+	m_doneRanges = 0;
+	__sync_fetch_and_add(&m_generation, 1);
+	if (m_sleeping > 0)
+	{
+		pthread_cond_broadcast(&m_wake);
+	}
+	pthread_mutex_unlock(&m_mutex);
+
+	Work(0);
+
+	// The atomic read orders the results of the workers before what follows, the
+	// worlds of b2WorldGroup are read by the application right after.
+	while (__sync_fetch_and_add(&m_doneRanges, 0) < rangeCount)
+	{
+		sched_yield();
+	}
+}
+
+#else
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+	B2_NOT_USED(threadCount);
+	m_threadCount = 1;
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+}
+
+void b2ThreadPool::ParallelFor(b2ParallelTask* task, int32 count, int32 grain)
+{
+	B2_NOT_USED(grain);
+	if (count > 0)
+	{
+		task->Execute(0, count, 0);
+	}
+}
+
+#endif
@@ -0,0 +1,93 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <Box2D/Common/b2Settings.h>
+
+#if defined(__linux__) || defined (__APPLE__)
+#include <pthread.h>
+#endif
+
+/// Work split in ranges by b2ThreadPool::ParallelFor.
+class b2ParallelTask
+{
+public:
+	virtual ~b2ParallelTask() {}
+
+	/// Process the items [begin, end). The ranges of one ParallelFor run concurrently.
+	/// threadIndex is in [0, thread count), 0 being the thread calling ParallelFor.
+	virtual void Execute(int32 begin, int32 end, int32 threadIndex) = 0;
+};
+
+/// Threads used by the solver of large islands, see b2World::SetThreadPool. The
+/// thread calling ParallelFor works too, a pool of n threads starts n - 1 workers.
+/// Idle workers spin for a while before they sleep, since the solver hands out
+/// many short range sets in a row. This has platform specific code, the pool has
+/// a single thread where threads aren't supported.
+class b2ThreadPool
+{
+public:
+	b2ThreadPool(int32 threadCount);
+	~b2ThreadPool();
+
+	/// Get the number of threads, including the calling one.
+	int32 GetThreadCount() const { return m_threadCount; }
+
+	/// Split [0, count) in ranges of grain items and run them on all the threads.
+	/// Returns once every range is done. Only one thread may call this at a time.
+	void ParallelFor(b2ParallelTask* task, int32 count, int32 grain);
+
+private:
+
+	int32 m_threadCount;
+
+#if defined(__linux__) || defined (__APPLE__)
+	struct b2Worker
+	{
+		b2ThreadPool* pool;
+		int32 index;
+		pthread_t thread;
+	};
+
+	static void* WorkerMain(void* data);
+
+	// Run ranges of the current task until none is left.
+	void Work(int32 threadIndex);
+
+	b2Worker* m_workers;
+
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_wake;
+
+	// The task and the next range are protected by the mutex.
+	b2ParallelTask* m_task;
+	int32 m_count;
+	int32 m_grain;
+	int32 m_rangeCount;
+	int32 m_nextRange;
+
+	volatile int32 m_doneRanges;
+	volatile int32 m_generation;
+	int32 m_sleeping;
+	bool m_quit;
+#endif
+};
+
+#endif
@@ -0,0 +1,89 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Contacts/b2CompoundContact.h>
+#include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2CompoundShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+
+#include <new>
+using namespace std;
+
+b2Contact* b2CompoundContact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2CompoundContact));
+	return new (mem) b2CompoundContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+void b2CompoundContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2CompoundContact*)contact)->~b2CompoundContact();
+	allocator->Free(contact, sizeof(b2CompoundContact));
+}
+
+b2CompoundContact::b2CompoundContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+: b2Contact(fixtureA, indexA, fixtureB, indexB)
+{
+	b2Assert(m_fixtureA->GetType() == b2Shape::e_compound || m_fixtureB->GetType() == b2Shape::e_compound);
+}
+
+void b2CompoundContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
+{
+	const b2Shape* shapeB = m_fixtureB->GetShape();
+	if (shapeB->GetType() == b2Shape::e_compound)
+	{
+		shapeB = ((b2CompoundShape*)shapeB)->GetChild(m_indexB);
+	}
+
+	switch (m_fixtureA->GetType())
+	{
+	case b2Shape::e_compound:
+		{
+			const b2PolygonShape* polygonA = ((b2CompoundShape*)m_fixtureA->GetShape())->GetChild(m_indexA);
+			if (shapeB->GetType() == b2Shape::e_circle)
+			{
+				b2CollidePolygonAndCircle(manifold, polygonA, xfA, (b2CircleShape*)shapeB, xfB);
+			}
+			else
+			{
+				b2CollidePolygons(manifold, polygonA, xfA, (b2PolygonShape*)shapeB, xfB, &m_satCache);
+				CountSATCall(m_satCache);
+			}
+		}
+		break;
+
+	case b2Shape::e_edge:
+		b2CollideEdgeAndPolygon(manifold, (b2EdgeShape*)m_fixtureA->GetShape(), xfA, (b2PolygonShape*)shapeB, xfB);
+		break;
+
+	case b2Shape::e_chain:
+		{
+			b2EdgeShape edge;
+			((b2ChainShape*)m_fixtureA->GetShape())->GetChildEdge(&edge, m_indexA);
+			b2CollideEdgeAndPolygon(manifold, &edge, xfA, (b2PolygonShape*)shapeB, xfB);
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+}
@@ -24,6 +24,7 @@
 #include <Box2D/Dynamics/Contacts/b2EdgeAndPolygonContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndCircleContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndPolygonContact.h>
+#include <Box2D/Dynamics/Contacts/b2CompoundContact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 
 #include <Box2D/Collision/b2Collision.h>
@@ -39,16 +40,26 @@ bool b2Contact::s_initialized = false;
 
 void b2Contact::InitializeRegisters()
 {
-	AddType(b2CircleContact::Create, b2CircleContact::Destroy, b2Shape::e_circle, b2Shape::e_circle);
-	AddType(b2PolygonAndCircleContact::Create, b2PolygonAndCircleContact::Destroy, b2Shape::e_polygon, b2Shape::e_circle);
-	AddType(b2PolygonContact::Create, b2PolygonContact::Destroy, b2Shape::e_polygon, b2Shape::e_polygon);
-	AddType(b2EdgeAndCircleContact::Create, b2EdgeAndCircleContact::Destroy, b2Shape::e_edge, b2Shape::e_circle);
-	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2Shape::e_edge, b2Shape::e_polygon);
-	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2Shape::e_chain, b2Shape::e_circle);
-	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2CircleContact::Create, b2CircleContact::Destroy, sizeof(b2CircleContact), b2Shape::e_circle, b2Shape::e_circle);
+	if (b2_circlesOnly)
+	{
+		return;
+	}
+
+	AddType(b2PolygonAndCircleContact::Create, b2PolygonAndCircleContact::Destroy, sizeof(b2PolygonAndCircleContact), b2Shape::e_polygon, b2Shape::e_circle);
+	AddType(b2PolygonContact::Create, b2PolygonContact::Destroy, sizeof(b2PolygonContact), b2Shape::e_polygon, b2Shape::e_polygon);
+	AddType(b2EdgeAndCircleContact::Create, b2EdgeAndCircleContact::Destroy, sizeof(b2EdgeAndCircleContact), b2Shape::e_edge, b2Shape::e_circle);
+	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, sizeof(b2EdgeAndPolygonContact), b2Shape::e_edge, b2Shape::e_polygon);
+	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, sizeof(b2ChainAndCircleContact), b2Shape::e_chain, b2Shape::e_circle);
+	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, sizeof(b2ChainAndPolygonContact), b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, sizeof(b2CompoundContact), b2Shape::e_compound, b2Shape::e_circle);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, sizeof(b2CompoundContact), b2Shape::e_compound, b2Shape::e_polygon);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, sizeof(b2CompoundContact), b2Shape::e_compound, b2Shape::e_compound);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, sizeof(b2CompoundContact), b2Shape::e_edge, b2Shape::e_compound);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, sizeof(b2CompoundContact), b2Shape::e_chain, b2Shape::e_compound);
 }
 
-void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
+void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn, int32 size,
 						b2Shape::Type type1, b2Shape::Type type2)
 {
 	b2Assert(0 <= type1 && type1 < b2Shape::e_typeCount);
@@ -56,12 +67,14 @@ void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* dest
 	
 	s_registers[type1][type2].createFcn = createFcn;
 	s_registers[type1][type2].destroyFcn = destoryFcn;
+	s_registers[type1][type2].size = size;
 	s_registers[type1][type2].primary = true;
 
 	if (type1 != type2)
 	{
 		s_registers[type2][type1].createFcn = createFcn;
 		s_registers[type2][type1].destroyFcn = destoryFcn;
+		s_registers[type2][type1].size = size;
 		s_registers[type2][type1].primary = false;
 	}
 }
@@ -102,7 +115,9 @@ void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 {
 	b2Assert(s_initialized == true);
 
-	if (contact->m_manifold.pointCount > 0)
+	// Wake the bodies only if they were touching. A speculative manifold has a
+	// point while the shapes are still apart, and a sensor has no points.
+	if (contact->IsTouching() && contact->m_manifold.pointCount > 0)
 	{
 		contact->GetFixtureA()->GetBody()->SetAwake(true);
 		contact->GetFixtureB()->GetBody()->SetAwake(true);
@@ -118,6 +133,20 @@ void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 	destroyFcn(contact, allocator);
 }
 
+void b2Contact::CountSATCall(const b2SATCache& cache)
+{
+	b2ContactManager& contactManager = m_fixtureA->m_body->m_world->m_contactManager;
+	++contactManager.m_satCallCount;
+	contactManager.m_satCacheHitCount += cache.hit;
+}
+
+int32 b2Contact::GetMemory() const
+{
+	b2Shape::Type typeA = m_fixtureA->GetType();
+	b2Shape::Type typeB = m_fixtureB->GetType();
+	return b2BlockAllocator::GetBlockSize(s_registers[typeA][typeB].size);
+}
+
 b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 {
 	m_flags = e_enabledFlag;
@@ -143,7 +172,8 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_nodeB.next = NULL;
 	m_nodeB.other = NULL;
 
-	m_toiCount = 0;
+	m_toiCount = 0;
+	m_arrivalSpeed = 0.0f;
 
 	m_friction = b2MixFriction(m_fixtureA->m_friction, m_fixtureB->m_friction);
 	m_restitution = b2MixRestitution(m_fixtureA->m_restitution, m_fixtureB->m_restitution);
@@ -151,7 +181,7 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
-void b2Contact::Update(b2ContactListener* listener)
+void b2Contact::Update(b2ContactListener* listener, float32 speculativeTime)
 {
 	b2Manifold oldManifold = m_manifold;
 
@@ -159,16 +189,13 @@ void b2Contact::Update(b2ContactListener* listener)
 	m_flags |= e_enabledFlag;
 
 	bool touching = false;
-	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
 
 	bool sensorA = m_fixtureA->IsSensor();
 	bool sensorB = m_fixtureB->IsSensor();
 	bool sensor = sensorA || sensorB;
 
-	b2Body* bodyA = m_fixtureA->GetBody();
-	b2Body* bodyB = m_fixtureB->GetBody();
-	const b2Transform& xfA = bodyA->GetTransform();
-	const b2Transform& xfB = bodyB->GetTransform();
+	const b2Transform& xfA = m_fixtureA->GetBody()->GetTransform();
+	const b2Transform& xfB = m_fixtureB->GetBody()->GetTransform();
 
 	// Is this contact a sensor?
 	if (sensor)
@@ -184,7 +211,22 @@ void b2Contact::Update(b2ContactListener* listener)
 	{
 		Evaluate(&m_manifold, xfA, xfB);
 		touching = m_manifold.pointCount > 0;
+	}
+
+	Update(listener, oldManifold, touching, speculativeTime);
+}
 
+void b2Contact::Update(b2ContactListener* listener, const b2Manifold& oldManifold, bool touching, float32 speculativeTime)
+{
+	bool wasTouching = (m_flags & e_touchingFlag) == e_touchingFlag;
+	m_flags &= ~e_speculativeFlag;
+
+	bool sensorA = m_fixtureA->IsSensor();
+	bool sensorB = m_fixtureB->IsSensor();
+	bool sensor = sensorA || sensorB;
+
+	if (sensor == false)
+	{
 		// Match old contact ids to new contact ids and copy the
 		// stored impulses to warm start the solver.
 		for (int32 i = 0; i < m_manifold.pointCount; ++i)
@@ -196,7 +238,7 @@ void b2Contact::Update(b2ContactListener* listener)
 
 			for (int32 j = 0; j < oldManifold.pointCount; ++j)
 			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
+				const b2ManifoldPoint* mp1 = oldManifold.points + j;
 
 				if (mp1->id.key == id2.key)
 				{
@@ -209,8 +251,13 @@ void b2Contact::Update(b2ContactListener* listener)
 
 		if (touching != wasTouching)
 		{
-			bodyA->SetAwake(true);
-			bodyB->SetAwake(true);
+			m_fixtureA->GetBody()->SetAwake(true);
+			m_fixtureB->GetBody()->SetAwake(true);
+		}
+
+		if (touching == false && speculativeTime > 0.0f)
+		{
+			UpdateSpeculative(speculativeTime);
 		}
 	}
 
@@ -233,8 +280,93 @@ void b2Contact::Update(b2ContactListener* listener)
 		listener->EndContact(this);
 	}
 
-	if (sensor == false && touching && listener)
+	// Speculative contacts are solved too, so they can be disabled.
+	bool speculative = (m_flags & e_speculativeFlag) == e_speculativeFlag;
+	if (touching == false && speculative == false)
+	{
+		m_arrivalSpeed = 0.0f;
+	}
+
+	if (sensor == false && (touching || speculative) && listener)
 	{
 		listener->PreSolve(this, &oldManifold);
 	}
 }
+
+void b2Contact::UpdateSpeculative(float32 dt)
+{
+	b2Body* bodyA = m_fixtureA->GetBody();
+	b2Body* bodyB = m_fixtureB->GetBody();
+
+	b2DistanceInput input;
+	input.proxyA.Set(m_fixtureA->GetShape(), m_indexA);
+	input.proxyB.Set(m_fixtureB->GetShape(), m_indexB);
+	input.transformA = bodyA->GetTransform();
+	input.transformB = bodyB->GetTransform();
+	input.useRadii = false;
+
+	// Bound the approach of the shapes over the step. The rotation moves the
+	// farthest vertex the most.
+	float32 extentA = 0.0f;
+	for (int32 i = 0; i < input.proxyA.GetVertexCount(); ++i)
+	{
+		extentA = b2Max(extentA, b2DistanceSquared(input.proxyA.GetVertex(i), bodyA->GetLocalCenter()));
+	}
+	float32 extentB = 0.0f;
+	for (int32 i = 0; i < input.proxyB.GetVertexCount(); ++i)
+	{
+		extentB = b2Max(extentB, b2DistanceSquared(input.proxyB.GetVertex(i), bodyB->GetLocalCenter()));
+	}
+	extentA = b2Sqrt(extentA) + input.proxyA.m_radius;
+	extentB = b2Sqrt(extentB) + input.proxyB.m_radius;
+
+	b2Vec2 dv = bodyB->GetLinearVelocity() - bodyA->GetLinearVelocity();
+	float32 reach = dt * (dv.Length() + b2Abs(bodyA->GetAngularVelocity()) * extentA + b2Abs(bodyB->GetAngularVelocity()) * extentB);
+	// Slow shapes are left to the regular contacts, unless they were stopped at
+	// the surface and still wait to touch for their bounce.
+	if (reach < b2_speculativeDistance)
+	{
+		if (m_arrivalSpeed == 0.0f)
+		{
+			return;
+		}
+
+		reach = b2_speculativeDistance;
+	}
+
+	b2SimplexCache cache;
+	cache.count = 0;
+	b2DistanceOutput output;
+	b2Distance(&output, &cache, &input);
+
+	b2ContactManager& contactManager = m_fixtureA->m_body->m_world->m_contactManager;
+	++contactManager.m_gjkCallCount;
+	contactManager.m_gjkIterCount += output.iterations;
+
+	float32 separation = output.distance - input.proxyA.m_radius - input.proxyB.m_radius;
+	if (output.distance < 10.0f * b2_epsilon || separation > reach)
+	{
+		return;
+	}
+
+	// One point on the plane of A through its closest point, like a face
+	// manifold, so the solvers find the separation the usual way.
+	b2Vec2 normal = (1.0f / output.distance) * (output.pointB - output.pointA);
+	m_manifold.type = b2Manifold::e_faceA;
+	m_manifold.localNormal = b2MulT(input.transformA.q, normal);
+	m_manifold.localPoint = b2MulT(input.transformA, output.pointA);
+	m_manifold.pointCount = 1;
+
+	b2ManifoldPoint* mp = m_manifold.points + 0;
+	mp->localPoint = b2MulT(input.transformB, output.pointB);
+	mp->normalImpulse = 0.0f;
+	mp->tangentImpulse = 0.0f;
+
+	// Not a feature pair, so it never warm starts a touching point.
+	mp->id.cf.indexA = 0;
+	mp->id.cf.indexB = 0;
+	mp->id.cf.typeA = 0xFF;
+	mp->id.cf.typeB = 0xFF;
+
+	m_flags |= e_speculativeFlag;
+}
@@ -55,6 +55,7 @@ struct b2ContactRegister
 {
 	b2ContactCreateFcn* createFcn;
 	b2ContactDestroyFcn* destroyFcn;
+	int32 size;
 	bool primary;
 };
 
@@ -164,38 +165,57 @@ protected:
 		e_bulletHitFlag		= 0x0010,
 
 		// This contact has a valid TOI in m_toi
-		e_toiFlag			= 0x0020
+		e_toiFlag			= 0x0020,
+
+		// The shapes are apart but may touch during the time step. The manifold
+		// holds one speculative point.
+		e_speculativeFlag	= 0x0040
 	};
 
 	/// Flag this contact for filtering. Filtering will occur the next time step.
 	void FlagForFiltering();
 
-	static void AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destroyFcn,
+	static void AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destroyFcn, int32 size,
 						b2Shape::Type typeA, b2Shape::Type typeB);
 	static void InitializeRegisters();
 	static b2Contact* Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2Shape::Type typeA, b2Shape::Type typeB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
 
+	// Count a b2CollidePolygons call with the cache of this contact in the
+	// profile of the world.
+	void CountSATCall(const b2SATCache& cache);
+
+	// Get the bytes taken by the contact in the block allocator.
+	int32 GetMemory() const;
+
 	b2Contact() : m_fixtureA(NULL), m_fixtureB(NULL) {}
 	b2Contact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
 	virtual ~b2Contact() {}
 
-	void Update(b2ContactListener* listener);
+	// Update the manifold. When the shapes don't touch and speculativeTime is
+	// positive, look for a speculative point over that time.
+	void Update(b2ContactListener* listener, float32 speculativeTime);
+
+	// Second half of Update, once m_manifold holds the new manifold. This is
+	// called directly by the batched narrow-phase.
+	void Update(b2ContactListener* listener, const b2Manifold& oldManifold, bool touching, float32 speculativeTime);
+
+	// Replace the empty manifold by the closest points of the shapes if they can
+	// meet within dt at the current velocities.
+	void UpdateSpeculative(float32 dt);
 
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
 
+	// The members used by the narrow-phase come first, the nodes of the island
+	// search last. The order avoids padding.
 	uint32 m_flags;
+	int32 m_toiCount;
 
 	// World pool and list pointers.
-	b2Contact* m_prev;
 	b2Contact* m_next;
 
-	// Nodes for connecting bodies.
-	b2ContactEdge m_nodeA;
-	b2ContactEdge m_nodeB;
-
 	b2Fixture* m_fixtureA;
 	b2Fixture* m_fixtureB;
 
@@ -204,11 +224,20 @@ protected:
 
 	b2Manifold m_manifold;
 
-	int32 m_toiCount;
-	float32 m_toi;
-
 	float32 m_friction;
 	float32 m_restitution;
+
+	// The approach speed of a speculative contact stopped at the surface, used
+	// for the restitution once the shapes touch.
+	float32 m_arrivalSpeed;
+
+	float32 m_toi;
+
+	b2Contact* m_prev;
+
+	// Nodes for connecting bodies.
+	b2ContactEdge m_nodeA;
+	b2ContactEdge m_nodeB;
 };
 
 inline b2Manifold* b2Contact::GetManifold()
@@ -41,6 +41,26 @@ struct b2ContactPositionConstraint
 	int32 pointCount;
 };
 
+// The point count of a constraint. Circles touch at one point, which turns the
+// point loops into straight code when only circles are supported.
+inline int32 b2GetPointCount(int32 pointCount)
+{
+	return b2_circlesOnly ? 1 : pointCount;
+}
+
+// Position state at the start of the time step, used by the soft step solver to
+// track the separation of each point as the bodies move during the sub-steps.
+struct b2ContactSoftConstraint
+{
+	float32 separations[b2_maxManifoldPoints];
+	float32 maxNormalImpulses[b2_maxManifoldPoints];
+	b2Vec2 cA, cB;
+	float32 aA, aB;
+	float32 biasRate;
+	float32 massScale;
+	float32 impulseScale;
+};
+
 b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 {
 	m_step = def->step;
@@ -48,6 +68,7 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_count = def->count;
 	m_positionConstraints = (b2ContactPositionConstraint*)m_allocator->Allocate(m_count * sizeof(b2ContactPositionConstraint));
 	m_velocityConstraints = (b2ContactVelocityConstraint*)m_allocator->Allocate(m_count * sizeof(b2ContactVelocityConstraint));
+	m_softConstraints = NULL;
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
@@ -129,6 +150,10 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
 b2ContactSolver::~b2ContactSolver()
 {
+	if (m_softConstraints)
+	{
+		m_allocator->Free(m_softConstraints);
+	}
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
@@ -143,7 +168,8 @@ void b2ContactSolver::InitializeVelocityConstraints()
 
 		float32 radiusA = pc->radiusA;
 		float32 radiusB = pc->radiusB;
-		b2Manifold* manifold = m_contacts[vc->contactIndex]->GetManifold();
+		b2Contact* contact = m_contacts[vc->contactIndex];
+		b2Manifold* manifold = contact->GetManifold();
 
 		int32 indexA = vc->indexA;
 		int32 indexB = vc->indexB;
@@ -178,7 +204,21 @@ void b2ContactSolver::InitializeVelocityConstraints()
 
 		vc->normal = worldManifold.normal;
 
-		int32 pointCount = vc->pointCount;
+		// The gap of a speculative contact. Its single point is on the plane of A.
+		// The shapes are allowed to close it down to the slop, so they touch next.
+		float32 gapBias = 0.0f;
+		bool speculative = (contact->m_flags & b2Contact::e_speculativeFlag) == b2Contact::e_speculativeFlag;
+		if (speculative)
+		{
+			b2Assert(manifold->type == b2Manifold::e_faceA && manifold->pointCount == 1);
+			b2Vec2 planePoint = b2Mul(xfA, manifold->localPoint);
+			b2Vec2 clipPoint = b2Mul(xfB, manifold->points[0].localPoint);
+			float32 separation = b2Dot(clipPoint - planePoint, vc->normal) - radiusA - radiusB;
+			gapBias = -b2Max(separation + b2_linearSlop, 0.0f) * m_step.inv_dt;
+		}
+		float32 arrivalSpeed = contact->m_arrivalSpeed;
+
+		int32 pointCount = b2GetPointCount(vc->pointCount);
 		for (int32 j = 0; j < pointCount; ++j)
 		{
 			b2VelocityConstraintPoint* vcp = vc->points + j;
@@ -205,12 +245,36 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			// Setup a velocity bias for restitution.
 			vcp->velocityBias = 0.0f;
 			float32 vRel = b2Dot(vc->normal, vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA));
+
+			// A speculative point only removes the velocity that would close the gap
+			// during the step, so the shapes arrive at the surface without bouncing.
+			// The approach speed is kept for the bounce. The soft step solver finds
+			// the gap itself.
+			if (speculative)
+			{
+				arrivalSpeed = b2Max(arrivalSpeed, -vRel);
+
+				if (m_step.subStepCount == 0)
+				{
+					vcp->velocityBias = gapBias;
+				}
+				continue;
+			}
+
+			// The shapes bounce once touching, with the speed they arrived at.
+			if (arrivalSpeed > 0.0f && vRel < b2_velocityThreshold)
+			{
+				vRel = b2Min(vRel, -arrivalSpeed);
+			}
+
 			if (vRel < -b2_velocityThreshold)
 			{
 				vcp->velocityBias = -vc->restitution * vRel;
 			}
 		}
 
+		contact->m_arrivalSpeed = speculative ? arrivalSpeed : 0.0f;
+
 		// If we have two points, then prepare the block solver.
 		if (vc->pointCount == 2)
 		{
@@ -258,7 +322,7 @@ void b2ContactSolver::WarmStart()
 		float32 iA = vc->invIA;
 		float32 mB = vc->invMassB;
 		float32 iB = vc->invIB;
-		int32 pointCount = vc->pointCount;
+		int32 pointCount = b2GetPointCount(vc->pointCount);
 
 		b2Vec2 vA = m_velocities[indexA].v;
 		float32 wA = m_velocities[indexA].w;
@@ -285,9 +349,16 @@ void b2ContactSolver::WarmStart()
 	}
 }
 
-void b2ContactSolver::SolveVelocityConstraints()
+float32 b2ContactSolver::SolveVelocityConstraints()
 {
-	for (int32 i = 0; i < m_count; ++i)
+	return SolveVelocityConstraints(0, m_count);
+}
+
+float32 b2ContactSolver::SolveVelocityConstraints(int32 begin, int32 end)
+{
+	float32 maxImpulseDelta = 0.0f;
+
+	for (int32 i = begin; i < end; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
 
@@ -297,7 +368,7 @@ void b2ContactSolver::SolveVelocityConstraints()
 		float32 iA = vc->invIA;
 		float32 mB = vc->invMassB;
 		float32 iB = vc->invIB;
-		int32 pointCount = vc->pointCount;
+		int32 pointCount = b2GetPointCount(vc->pointCount);
 
 		b2Vec2 vA = m_velocities[indexA].v;
 		float32 wA = m_velocities[indexA].w;
@@ -328,6 +399,7 @@ void b2ContactSolver::SolveVelocityConstraints()
 			float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
 			lambda = newImpulse - vcp->tangentImpulse;
 			vcp->tangentImpulse = newImpulse;
+			maxImpulseDelta = b2Max(maxImpulseDelta, b2Abs(lambda));
 
 			// Apply contact impulse
 			b2Vec2 P = lambda * tangent;
@@ -340,7 +412,7 @@ void b2ContactSolver::SolveVelocityConstraints()
 		}
 
 		// Solve normal constraints
-		if (vc->pointCount == 1)
+		if (pointCount == 1)
 		{
 			b2VelocityConstraintPoint* vcp = vc->points + 0;
 
@@ -355,6 +427,7 @@ void b2ContactSolver::SolveVelocityConstraints()
 			float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
 			lambda = newImpulse - vcp->normalImpulse;
 			vcp->normalImpulse = newImpulse;
+			maxImpulseDelta = b2Max(maxImpulseDelta, b2Abs(lambda));
 
 			// Apply contact impulse
 			b2Vec2 P = lambda * normal;
@@ -586,6 +659,9 @@ void b2ContactSolver::SolveVelocityConstraints()
 				// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
 				break;
 			}
+
+			maxImpulseDelta = b2Max(maxImpulseDelta, b2Abs(cp1->normalImpulse - a.x));
+			maxImpulseDelta = b2Max(maxImpulseDelta, b2Abs(cp2->normalImpulse - a.y));
 		}
 
 		m_velocities[indexA].v = vA;
@@ -593,6 +669,8 @@ void b2ContactSolver::SolveVelocityConstraints()
 		m_velocities[indexB].v = vB;
 		m_velocities[indexB].w = wB;
 	}
+
+	return maxImpulseDelta;
 }
 
 void b2ContactSolver::StoreImpulses()
@@ -663,10 +741,19 @@ struct b2PositionSolverManifold
 
 // Sequential solver.
 bool b2ContactSolver::SolvePositionConstraints()
+{
+	float32 minSeparation = SolvePositionConstraints(0, m_count);
+
+	// We can't expect minSpeparation >= -b2_linearSlop because we don't
+	// push the separation above -b2_linearSlop.
+	return minSeparation >= -3.0f * b2_linearSlop;
+}
+
+float32 b2ContactSolver::SolvePositionConstraints(int32 begin, int32 end)
 {
 	float32 minSeparation = 0.0f;
 
-	for (int32 i = 0; i < m_count; ++i)
+	for (int32 i = begin; i < end; ++i)
 	{
 		b2ContactPositionConstraint* pc = m_positionConstraints + i;
 
@@ -678,7 +765,7 @@ bool b2ContactSolver::SolvePositionConstraints()
 		b2Vec2 localCenterB = pc->localCenterB;
 		float32 mB = pc->invMassB;
 		float32 iB = pc->invIB;
-		int32 pointCount = pc->pointCount;
+		int32 pointCount = b2GetPointCount(pc->pointCount);
 
 		b2Vec2 cA = m_positions[indexA].c;
 		float32 aA = m_positions[indexA].a;
@@ -735,9 +822,7 @@ bool b2ContactSolver::SolvePositionConstraints()
 		m_positions[indexB].a = aB;
 	}
 
-	// We can't expect minSpeparation >= -b2_linearSlop because we don't
-	// push the separation above -b2_linearSlop.
-	return minSeparation >= -3.0f * b2_linearSlop;
+	return minSeparation;
 }
 
 // Sequential position solver for position constraints.
@@ -753,7 +838,7 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 		int32 indexB = pc->indexB;
 		b2Vec2 localCenterA = pc->localCenterA;
 		b2Vec2 localCenterB = pc->localCenterB;
-		int32 pointCount = pc->pointCount;
+		int32 pointCount = b2GetPointCount(pc->pointCount);
 
 		float32 mA = 0.0f;
 		float32 iA = 0.0f;
@@ -830,3 +915,244 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 	// push the separation above -b2_linearSlop.
 	return minSeparation >= -1.5f * b2_linearSlop;
 }
+
+void b2ContactSolver::InitializeSoftConstraints(float32 h)
+{
+	m_softConstraints = (b2ContactSoftConstraint*)m_allocator->Allocate(m_count * sizeof(b2ContactSoftConstraint));
+
+	// Soft constraint coefficients for a damped spring of the given stiffness,
+	// integrated implicitly over one sub-step.
+	float32 hertz = b2Min(b2_contactHertz, 0.25f / h);
+	float32 zeta = b2_contactDampingRatio;
+
+	float32 omega = 2.0f * b2_pi * hertz;
+	float32 a1 = 2.0f * zeta + h * omega;
+	float32 a2 = h * omega * a1;
+	float32 a3 = 1.0f / (1.0f + a2);
+
+	float32 staticOmega = 2.0f * omega;
+	float32 staticA1 = 2.0f * zeta + h * staticOmega;
+	float32 staticA2 = h * staticOmega * staticA1;
+	float32 staticA3 = 1.0f / (1.0f + staticA2);
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		b2ContactPositionConstraint* pc = m_positionConstraints + i;
+		b2ContactSoftConstraint* sc = m_softConstraints + i;
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+
+		sc->cA = m_positions[indexA].c;
+		sc->aA = m_positions[indexA].a;
+		sc->cB = m_positions[indexB].c;
+		sc->aB = m_positions[indexB].a;
+
+		if (vc->invMassA == 0.0f || vc->invMassB == 0.0f)
+		{
+			sc->biasRate = staticOmega / staticA1;
+			sc->massScale = staticA2 * staticA3;
+			sc->impulseScale = staticA3;
+		}
+		else
+		{
+			sc->biasRate = omega / a1;
+			sc->massScale = a2 * a3;
+			sc->impulseScale = a3;
+		}
+
+		b2Transform xfA, xfB;
+		xfA.q.Set(sc->aA);
+		xfB.q.Set(sc->aB);
+		xfA.p = sc->cA - b2Mul(xfA.q, pc->localCenterA);
+		xfB.p = sc->cB - b2Mul(xfB.q, pc->localCenterB);
+
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			b2PositionSolverManifold psm;
+			psm.Initialize(pc, xfA, xfB, j);
+			sc->separations[j] = psm.separation;
+			sc->maxNormalImpulses[j] = 0.0f;
+		}
+	}
+}
+
+float32 b2ContactSolver::SolveSoftVelocityConstraints(bool useBias)
+{
+	float32 inv_h = m_step.inv_dt;
+	float32 minSeparation = 0.0f;
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		b2ContactSoftConstraint* sc = m_softConstraints + i;
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float32 mA = vc->invMassA;
+		float32 iA = vc->invIA;
+		float32 mB = vc->invMassB;
+		float32 iB = vc->invIB;
+		int32 pointCount = b2GetPointCount(vc->pointCount);
+
+		b2Vec2 vA = m_velocities[indexA].v;
+		float32 wA = m_velocities[indexA].w;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float32 wB = m_velocities[indexB].w;
+
+		// Body displacement since the start of the step. The rotation is
+		// linearized, it is small over one time step.
+		b2Vec2 dcA = m_positions[indexA].c - sc->cA;
+		float32 daA = m_positions[indexA].a - sc->aA;
+		b2Vec2 dcB = m_positions[indexB].c - sc->cB;
+		float32 daB = m_positions[indexB].a - sc->aB;
+
+		b2Vec2 normal = vc->normal;
+		b2Vec2 tangent = b2Cross(normal, 1.0f);
+		float32 friction = vc->friction;
+
+		b2Assert(pointCount == 1 || pointCount == 2);
+
+		// Solve tangent constraints first because non-penetration is more important
+		// than friction.
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+
+			float32 vt = b2Dot(dv, tangent);
+			float32 lambda = vcp->tangentMass * (-vt);
+
+			float32 maxFriction = friction * vcp->normalImpulse;
+			float32 newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
+			lambda = newImpulse - vcp->tangentImpulse;
+			vcp->tangentImpulse = newImpulse;
+
+			b2Vec2 P = lambda * tangent;
+
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			// Current separation
+			b2Vec2 dpA = dcA + b2Cross(daA, vcp->rA);
+			b2Vec2 dpB = dcB + b2Cross(daB, vcp->rB);
+			float32 separation = b2Dot(dpB - dpA, normal) + sc->separations[j];
+			minSeparation = b2Min(minSeparation, separation);
+
+			float32 bias = 0.0f;
+			float32 massScale = 1.0f;
+			float32 impulseScale = 0.0f;
+			if (separation > 0.0f)
+			{
+				// Speculative: only remove the velocity that would close the gap.
+				bias = separation * inv_h;
+			}
+			else if (useBias)
+			{
+				// Allow some slop, like the position solver.
+				bias = b2Max(sc->biasRate * b2Min(separation + b2_linearSlop, 0.0f), -b2_contactPushVelocity);
+				massScale = sc->massScale;
+				impulseScale = sc->impulseScale;
+			}
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float32 vn = b2Dot(dv, normal);
+
+			float32 lambda = -vcp->normalMass * massScale * (vn + bias) - impulseScale * vcp->normalImpulse;
+
+			float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+			sc->maxNormalImpulses[j] = b2Max(sc->maxNormalImpulses[j], newImpulse);
+
+			b2Vec2 P = lambda * normal;
+
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+
+	return minSeparation;
+}
+
+// Restitution is applied once, after the sub-steps, using the approach velocity
+// stored in velocityBias by InitializeVelocityConstraints.
+void b2ContactSolver::ApplySoftRestitution()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		b2ContactSoftConstraint* sc = m_softConstraints + i;
+
+		if (vc->restitution == 0.0f)
+		{
+			continue;
+		}
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float32 mA = vc->invMassA;
+		float32 iA = vc->invIA;
+		float32 mB = vc->invMassB;
+		float32 iB = vc->invIB;
+		int32 pointCount = b2GetPointCount(vc->pointCount);
+
+		b2Vec2 vA = m_velocities[indexA].v;
+		float32 wA = m_velocities[indexA].w;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float32 wB = m_velocities[indexB].w;
+
+		b2Vec2 normal = vc->normal;
+
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			// Skip points that were not approaching or never pushed.
+			if (vcp->velocityBias == 0.0f || sc->maxNormalImpulses[j] == 0.0f)
+			{
+				continue;
+			}
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float32 vn = b2Dot(dv, normal);
+
+			float32 lambda = -vcp->normalMass * (vn - vcp->velocityBias);
+
+			float32 newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+
+			b2Vec2 P = lambda * normal;
+
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
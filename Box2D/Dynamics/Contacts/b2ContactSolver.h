@@ -27,6 +27,7 @@ class b2Contact;
 class b2Body;
 class b2StackAllocator;
 struct b2ContactPositionConstraint;
+struct b2ContactSoftConstraint;
 
 struct b2VelocityConstraintPoint
 {
@@ -74,18 +75,36 @@ public:
 	void InitializeVelocityConstraints();
 
 	void WarmStart();
-	void SolveVelocityConstraints();
+
+	/// One sweep over the velocity constraints. Returns the largest change of an
+	/// accumulated impulse, which goes to zero as the solver converges.
+	float32 SolveVelocityConstraints();
+
+	/// Sweep over the velocity constraints [begin, end) only.
+	float32 SolveVelocityConstraints(int32 begin, int32 end);
+
 	void StoreImpulses();
 
 	bool SolvePositionConstraints();
+
+	/// Sweep over the position constraints [begin, end) only. Returns the smallest separation.
+	float32 SolvePositionConstraints(int32 begin, int32 end);
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	/// Soft step solver. Call InitializeVelocityConstraints first. The bias pass
+	/// pushes overlapping shapes apart with soft springs, the relax pass removes
+	/// the velocity added by the springs. Returns the smallest separation.
+	void InitializeSoftConstraints(float32 h);
+	float32 SolveSoftVelocityConstraints(bool useBias);
+	void ApplySoftRestitution();
+
 	b2TimeStep m_step;
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
 	b2StackAllocator* m_allocator;
 	b2ContactPositionConstraint* m_positionConstraints;
 	b2ContactVelocityConstraint* m_velocityConstraints;
+	b2ContactSoftConstraint* m_softConstraints;
 	b2Contact** m_contacts;
 	int m_count;
 };
@@ -34,6 +34,9 @@ public:
 	~b2PolygonContact() {}
 
 	void Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB);
+
+protected:
+	b2SATCache m_satCache;
 };
 
 #endif
@@ -236,3 +236,13 @@ float32 b2DistanceJoint::GetReactionTorque(float32 inv_dt) const
 	B2_NOT_USED(inv_dt);
 	return 0.0f;
 }
+
+void b2DistanceJoint::GetDef(b2DistanceJointDef* def) const
+{
+	b2Joint::GetDef(def);
+	def->localAnchorA = m_localAnchorA;
+	def->localAnchorB = m_localAnchorB;
+	def->length = m_length;
+	def->frequencyHz = m_frequencyHz;
+	def->dampingRatio = m_dampingRatio;
+}
@@ -91,9 +91,13 @@ public:
 	void SetDampingRatio(float32 ratio);
 	float32 GetDampingRatio() const;
 
+	/// Fill a definition that creates a copy of this joint.
+	void GetDef(b2DistanceJointDef* def) const;
+
 protected:
 
 	friend class b2Joint;
+	friend class b2JointSolver;
 	b2DistanceJoint(const b2DistanceJointDef* data);
 
 	void InitVelocityConstraints(const b2SolverData& data);
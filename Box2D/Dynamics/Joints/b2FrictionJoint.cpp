@@ -18,6 +18,7 @@
 
 #include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 // Point-to-point constraint
@@ -214,6 +215,7 @@ float32 b2FrictionJoint::GetReactionTorque(float32 inv_dt) const
 
 void b2FrictionJoint::SetMaxForce(float32 force)
 {
+	Record(b2_recordSetMaxForce, force);
 	b2Assert(b2IsValid(force) && force >= 0.0f);
 	m_maxForce = force;
 }
@@ -225,6 +227,7 @@ float32 b2FrictionJoint::GetMaxForce() const
 
 void b2FrictionJoint::SetMaxTorque(float32 torque)
 {
+	Record(b2_recordSetMaxTorque, torque);
 	b2Assert(b2IsValid(torque) && torque >= 0.0f);
 	m_maxTorque = torque;
 }
@@ -233,3 +236,12 @@ float32 b2FrictionJoint::GetMaxTorque() const
 {
 	return m_maxTorque;
 }
+
+void b2FrictionJoint::GetDef(b2FrictionJointDef* def) const
+{
+	b2Joint::GetDef(def);
+	def->localAnchorA = m_localAnchorA;
+	def->localAnchorB = m_localAnchorB;
+	def->maxForce = m_maxForce;
+	def->maxTorque = m_maxTorque;
+}
@@ -73,6 +73,9 @@ public:
 	/// Get the maximum friction torque in N*m.
 	float32 GetMaxTorque() const;
 
+	/// Fill a definition that creates a copy of this joint.
+	void GetDef(b2FrictionJointDef* def) const;
+
 protected:
 
 	friend class b2Joint;
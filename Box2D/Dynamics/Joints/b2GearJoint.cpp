@@ -20,6 +20,7 @@
 #include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
 #include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 // Gear Joint:
@@ -44,6 +45,9 @@
 b2GearJoint::b2GearJoint(const b2GearJointDef* def)
 : b2Joint(def)
 {
+	m_joint1 = def->joint1;
+	m_joint2 = def->joint2;
+
 	m_typeA = def->joint1->GetType();
 	m_typeB = def->joint2->GetType();
 
@@ -390,6 +394,7 @@ float32 b2GearJoint::GetReactionTorque(float32 inv_dt) const
 
 void b2GearJoint::SetRatio(float32 ratio)
 {
+	Record(b2_recordSetRatio, ratio);
 	b2Assert(b2IsValid(ratio));
 	m_ratio = ratio;
 }
@@ -398,3 +403,11 @@ float32 b2GearJoint::GetRatio() const
 {
 	return m_ratio;
 }
+
+void b2GearJoint::GetDef(b2GearJointDef* def) const
+{
+	b2Joint::GetDef(def);
+	def->joint1 = m_joint1;
+	def->joint2 = m_joint2;
+	def->ratio = m_ratio;
+}
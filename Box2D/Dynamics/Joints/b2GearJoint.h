@@ -66,6 +66,9 @@ public:
 	void SetRatio(float32 ratio);
 	float32 GetRatio() const;
 
+	/// Fill a definition that creates a copy of this joint, on the same joints.
+	void GetDef(b2GearJointDef* def) const;
+
 protected:
 
 	friend class b2Joint;
@@ -75,6 +78,9 @@ protected:
 	void SolveVelocityConstraints(const b2SolverData& data);
 	bool SolvePositionConstraints(const b2SolverData& data);
 
+	b2Joint* m_joint1;
+	b2Joint* m_joint2;
+
 	b2JointType m_typeA;
 	b2JointType m_typeB;
 
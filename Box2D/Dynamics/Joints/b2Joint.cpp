@@ -29,6 +29,7 @@
 #include <Box2D/Dynamics/Joints/b2RopeJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 
 #include <new>
@@ -117,57 +118,58 @@ b2Joint* b2Joint::Create(const b2JointDef* def, b2BlockAllocator* allocator)
 	return joint;
 }
 
-void b2Joint::Destroy(b2Joint* joint, b2BlockAllocator* allocator)
+// The size of a joint class.
+static int32 b2GetJointSize(b2JointType type)
 {
-	joint->~b2Joint();
-	switch (joint->m_type)
+	switch (type)
 	{
 	case e_distanceJoint:
-		allocator->Free(joint, sizeof(b2DistanceJoint));
-		break;
+		return sizeof(b2DistanceJoint);
 
 	case e_mouseJoint:
-		allocator->Free(joint, sizeof(b2MouseJoint));
-		break;
+		return sizeof(b2MouseJoint);
 
 	case e_prismaticJoint:
-		allocator->Free(joint, sizeof(b2PrismaticJoint));
-		break;
+		return sizeof(b2PrismaticJoint);
 
 	case e_revoluteJoint:
-		allocator->Free(joint, sizeof(b2RevoluteJoint));
-		break;
+		return sizeof(b2RevoluteJoint);
 
 	case e_pulleyJoint:
-		allocator->Free(joint, sizeof(b2PulleyJoint));
-		break;
+		return sizeof(b2PulleyJoint);
 
 	case e_gearJoint:
-		allocator->Free(joint, sizeof(b2GearJoint));
-		break;
+		return sizeof(b2GearJoint);
 
 	case e_wheelJoint:
-		allocator->Free(joint, sizeof(b2WheelJoint));
-		break;
-    
+		return sizeof(b2WheelJoint);
+
 	case e_weldJoint:
-		allocator->Free(joint, sizeof(b2WeldJoint));
-		break;
+		return sizeof(b2WeldJoint);
 
 	case e_frictionJoint:
-		allocator->Free(joint, sizeof(b2FrictionJoint));
-		break;
+		return sizeof(b2FrictionJoint);
 
 	case e_ropeJoint:
-		allocator->Free(joint, sizeof(b2RopeJoint));
-		break;
+		return sizeof(b2RopeJoint);
 
 	default:
 		b2Assert(false);
-		break;
+		return 0;
 	}
 }
 
+void b2Joint::Destroy(b2Joint* joint, b2BlockAllocator* allocator)
+{
+	joint->~b2Joint();
+	allocator->Free(joint, b2GetJointSize(joint->m_type));
+}
+
+int32 b2Joint::GetMemory() const
+{
+	return b2BlockAllocator::GetBlockSize(b2GetJointSize(m_type));
+}
+
 b2Joint::b2Joint(const b2JointDef* def)
 {
 	b2Assert(def->bodyA != def->bodyB);
@@ -179,6 +181,8 @@ b2Joint::b2Joint(const b2JointDef* def)
 	m_bodyB = def->bodyB;
 	m_collideConnected = def->collideConnected;
 	m_islandFlag = false;
+	m_index = 0;
+	m_recordId = 0;
 	m_userData = def->userData;
 
 	m_edgeA.joint = NULL;
@@ -192,6 +196,23 @@ b2Joint::b2Joint(const b2JointDef* def)
 	m_edgeB.next = NULL;
 }
 
+void b2Joint::GetDef(b2JointDef* def) const
+{
+	def->userData = m_userData;
+	def->bodyA = m_bodyA;
+	def->bodyB = m_bodyB;
+	def->collideConnected = m_collideConnected;
+}
+
+void b2Joint::Record(int32 op, float32 a, float32 b)
+{
+	b2Recorder* recorder = m_bodyA->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordJoint(op, this, a, b);
+	}
+}
+
 bool b2Joint::IsActive() const
 {
 	return m_bodyA->IsActive() && m_bodyB->IsActive();
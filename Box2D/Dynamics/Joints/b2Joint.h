@@ -146,13 +146,25 @@ protected:
 	friend class b2World;
 	friend class b2Body;
 	friend class b2Island;
+	friend class b2JointSolver;
+	friend class b2Recorder;
+	friend class b2Replayer;
 
 	static b2Joint* Create(const b2JointDef* def, b2BlockAllocator* allocator);
 	static void Destroy(b2Joint* joint, b2BlockAllocator* allocator);
 
+	// Get the bytes taken by the joint in the block allocator.
+	int32 GetMemory() const;
+
 	b2Joint(const b2JointDef* def);
 	virtual ~b2Joint() {}
 
+	// Fill the fields common to all the joint definitions.
+	void GetDef(b2JointDef* def) const;
+
+	// Record a setter call if the world has a recorder, see b2RecordOp.
+	void Record(int32 op, float32 a, float32 b = 0.0f);
+
 	virtual void InitVelocityConstraints(const b2SolverData& data) = 0;
 	virtual void SolveVelocityConstraints(const b2SolverData& data) = 0;
 
@@ -168,6 +180,12 @@ protected:
 	b2Body* m_bodyB;
 
 	bool m_islandFlag;
+
+	// The index of the joint in a scene, see b2World::Save.
+	int32 m_index;
+
+	// The id of the joint in a recording, see b2Recorder.
+	int32 m_recordId;
 	bool m_collideConnected;
 
 	void* m_userData;
@@ -0,0 +1,640 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Joints/b2JointSolver.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Dynamics/Joints/b2DistanceJoint.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Common/b2StackAllocator.h>
+
+#include <string.h>
+
+// The lanes of a batch are solved with fixed count loops so the compiler can
+// vectorize them. Unused lanes have no mass and leave the bodies unchanged.
+
+struct b2RevoluteBatch
+{
+	b2RevoluteJoint* joints[b2_jointBatchWidth];
+	int32 count;
+	int32 indexA[b2_jointBatchWidth];
+	int32 indexB[b2_jointBatchWidth];
+	float32 rAx[b2_jointBatchWidth], rAy[b2_jointBatchWidth];
+	float32 rBx[b2_jointBatchWidth], rBy[b2_jointBatchWidth];
+	float32 mA[b2_jointBatchWidth], mB[b2_jointBatchWidth];
+	float32 iA[b2_jointBatchWidth], iB[b2_jointBatchWidth];
+
+	// Point-to-point effective mass, K is symmetric.
+	float32 k11[b2_jointBatchWidth], k12[b2_jointBatchWidth], k22[b2_jointBatchWidth];
+	float32 invDet[b2_jointBatchWidth];
+
+	// Motor, zero mass and impulse range when disabled.
+	float32 motorMass[b2_jointBatchWidth];
+	float32 motorSpeed[b2_jointBatchWidth];
+	float32 maxMotorImpulse[b2_jointBatchWidth];
+
+	float32 impulseX[b2_jointBatchWidth], impulseY[b2_jointBatchWidth];
+	float32 motorImpulse[b2_jointBatchWidth];
+};
+
+struct b2DistanceBatch
+{
+	b2DistanceJoint* joints[b2_jointBatchWidth];
+	int32 count;
+	int32 indexA[b2_jointBatchWidth];
+	int32 indexB[b2_jointBatchWidth];
+	float32 rAx[b2_jointBatchWidth], rAy[b2_jointBatchWidth];
+	float32 rBx[b2_jointBatchWidth], rBy[b2_jointBatchWidth];
+	float32 ux[b2_jointBatchWidth], uy[b2_jointBatchWidth];
+	float32 mA[b2_jointBatchWidth], mB[b2_jointBatchWidth];
+	float32 iA[b2_jointBatchWidth], iB[b2_jointBatchWidth];
+	float32 mass[b2_jointBatchWidth];
+	float32 bias[b2_jointBatchWidth];
+	float32 gamma[b2_jointBatchWidth];
+	float32 impulse[b2_jointBatchWidth];
+};
+
+// A batch that still has free lanes, with its joints and the island index of
+// its dynamic bodies.
+struct b2OpenBatch
+{
+	int32 jointCount;
+	int32 joints[b2_jointBatchWidth];
+	int32 bodyCount;
+	int32 bodies[2 * b2_jointBatchWidth];
+};
+
+// A joint only looks for a free lane among the last open batches. This bounds
+// the cost when many joints share a body.
+static const int32 b2_openBatchCount = 8;
+
+// A batch needs this many joints to be faster than solving them one by one.
+static const int32 b2_minBatchJoints = 3;
+
+static bool b2HasBody(const b2OpenBatch* batch, int32 body)
+{
+	for (int32 i = 0; i < batch->bodyCount; ++i)
+	{
+		if (batch->bodies[i] == body)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Greedily assigns the joints of a type to batches, in island order. A joint
+// goes to the oldest open batch that doesn't hold one of its dynamic bodies.
+// Static and kinematic bodies get no impulse, joints may share them within a
+// batch. Batches are numbered once closed and their joints get the batch index.
+// The joints of a batch too small keep the lane -1.
+struct b2BatchBuilder
+{
+	b2BatchBuilder(int32* lanes) : lanes(lanes), openCount(0), batchCount(0) {}
+
+	void Add(int32 joint, int32 indexA, int32 indexB)
+	{
+		int32 k = 0;
+		while (k < openCount &&
+			   ((indexA != -1 && b2HasBody(open + k, indexA)) || (indexB != -1 && b2HasBody(open + k, indexB))))
+		{
+			++k;
+		}
+
+		if (k == openCount)
+		{
+			if (openCount == b2_openBatchCount)
+			{
+				// Give up on the oldest open batch.
+				Close(0);
+				--k;
+			}
+
+			open[k].jointCount = 0;
+			open[k].bodyCount = 0;
+			++openCount;
+		}
+
+		b2OpenBatch* batch = open + k;
+		if (indexA != -1)
+		{
+			batch->bodies[batch->bodyCount++] = indexA;
+		}
+		if (indexB != -1)
+		{
+			batch->bodies[batch->bodyCount++] = indexB;
+		}
+		batch->joints[batch->jointCount++] = joint;
+
+		if (batch->jointCount == b2_jointBatchWidth)
+		{
+			Close(k);
+		}
+	}
+
+	void Close(int32 k)
+	{
+		const b2OpenBatch* batch = open + k;
+		if (batch->jointCount >= b2_minBatchJoints)
+		{
+			for (int32 i = 0; i < batch->jointCount; ++i)
+			{
+				lanes[batch->joints[i]] = batchCount;
+			}
+			++batchCount;
+		}
+
+		memmove(open + k, open + k + 1, (openCount - k - 1) * sizeof(b2OpenBatch));
+		--openCount;
+	}
+
+	int32 Finish()
+	{
+		while (openCount > 0)
+		{
+			Close(0);
+		}
+		return batchCount;
+	}
+
+	int32* lanes;
+	b2OpenBatch open[b2_openBatchCount];
+	int32 openCount;
+	int32 batchCount;
+};
+
+void b2JointSolver::AssignBatches()
+{
+	b2BatchBuilder revolutes(m_lanes);
+	b2BatchBuilder distances(m_lanes);
+
+	for (int32 c = 0; c < m_colorCount; ++c)
+	{
+		b2JointColor* color = m_colors + c;
+		color->revoluteBatch = revolutes.batchCount;
+		color->distanceBatch = distances.batchCount;
+
+		for (int32 i = color->joint; i < color[1].joint; ++i)
+		{
+			m_lanes[i] = -1;
+
+			b2Joint* joint = m_joints[i];
+			b2BatchBuilder* builder;
+			if (joint->m_type == e_revoluteJoint)
+			{
+				// The limit needs the block solver, it stays with the joint.
+				if (((b2RevoluteJoint*)joint)->m_enableLimit)
+				{
+					continue;
+				}
+				builder = &revolutes;
+			}
+			else if (joint->m_type == e_distanceJoint)
+			{
+				builder = &distances;
+			}
+			else
+			{
+				continue;
+			}
+
+			b2Body* bodyA = joint->m_bodyA;
+			b2Body* bodyB = joint->m_bodyB;
+			int32 indexA = bodyA->m_type == b2_dynamicBody ? bodyA->m_islandIndex : -1;
+			int32 indexB = bodyB->m_type == b2_dynamicBody ? bodyB->m_islandIndex : -1;
+			builder->Add(i, indexA, indexB);
+		}
+
+		// A batch holds the joints of a single color.
+		revolutes.Finish();
+		distances.Finish();
+	}
+
+	m_revoluteBatchCount = revolutes.batchCount;
+	m_distanceBatchCount = distances.batchCount;
+	m_colors[m_colorCount].revoluteBatch = m_revoluteBatchCount;
+	m_colors[m_colorCount].distanceBatch = m_distanceBatchCount;
+}
+
+b2JointSolver::b2JointSolver(b2JointSolverDef* def)
+{
+	m_allocator = def->allocator;
+	m_joints = def->joints;
+	m_count = def->count;
+	m_colorCount = def->colors ? def->colorCount : 1;
+	m_colors = (b2JointColor*)m_allocator->Allocate((m_colorCount + 1) * sizeof(b2JointColor));
+	for (int32 i = 0; i <= m_colorCount; ++i)
+	{
+		m_colors[i].joint = def->colors ? def->colors[i] : b2Min(i, 1) * m_count;
+	}
+	m_others = (b2Joint**)m_allocator->Allocate(m_count * sizeof(b2Joint*));
+	m_otherCount = 0;
+
+	m_lanes = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	AssignBatches();
+
+	m_revoluteBatches = (b2RevoluteBatch*)m_allocator->Allocate(m_revoluteBatchCount * sizeof(b2RevoluteBatch));
+	m_distanceBatches = (b2DistanceBatch*)m_allocator->Allocate(m_distanceBatchCount * sizeof(b2DistanceBatch));
+	for (int32 i = 0; i < m_revoluteBatchCount; ++i)
+	{
+		m_revoluteBatches[i].count = 0;
+	}
+	for (int32 i = 0; i < m_distanceBatchCount; ++i)
+	{
+		m_distanceBatches[i].count = 0;
+	}
+
+	// Turn the batch indices into lanes, the distance lanes follow the revolute ones.
+	int32 revoluteLaneCount = m_revoluteBatchCount * b2_jointBatchWidth;
+	int32 color = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		while (m_colors[color].joint == i)
+		{
+			m_colors[color++].other = m_otherCount;
+		}
+
+		b2Joint* joint = m_joints[i];
+		if (m_lanes[i] == -1)
+		{
+			m_others[m_otherCount++] = joint;
+		}
+		else if (joint->GetType() == e_revoluteJoint)
+		{
+			b2RevoluteBatch* batch = m_revoluteBatches + m_lanes[i];
+			m_lanes[i] = m_lanes[i] * b2_jointBatchWidth + batch->count;
+			batch->joints[batch->count++] = (b2RevoluteJoint*)joint;
+		}
+		else
+		{
+			b2DistanceBatch* batch = m_distanceBatches + m_lanes[i];
+			m_lanes[i] = revoluteLaneCount + m_lanes[i] * b2_jointBatchWidth + batch->count;
+			batch->joints[batch->count++] = (b2DistanceJoint*)joint;
+		}
+	}
+
+	while (color <= m_colorCount)
+	{
+		m_colors[color++].other = m_otherCount;
+	}
+
+	// Unused lanes read the bodies of the first lane and have no mass.
+	for (int32 i = 0; i < m_revoluteBatchCount; ++i)
+	{
+		b2RevoluteBatch* batch = m_revoluteBatches + i;
+		for (int32 j = batch->count; j < b2_jointBatchWidth; ++j)
+		{
+			batch->indexA[j] = batch->joints[0]->m_bodyA->m_islandIndex;
+			batch->indexB[j] = batch->joints[0]->m_bodyB->m_islandIndex;
+			batch->rAx[j] = batch->rAy[j] = batch->rBx[j] = batch->rBy[j] = 0.0f;
+			batch->mA[j] = batch->mB[j] = batch->iA[j] = batch->iB[j] = 0.0f;
+			batch->k11[j] = batch->k12[j] = batch->k22[j] = batch->invDet[j] = 0.0f;
+			batch->motorMass[j] = batch->motorSpeed[j] = batch->maxMotorImpulse[j] = 0.0f;
+			batch->impulseX[j] = batch->impulseY[j] = batch->motorImpulse[j] = 0.0f;
+		}
+	}
+
+	for (int32 i = 0; i < m_distanceBatchCount; ++i)
+	{
+		b2DistanceBatch* batch = m_distanceBatches + i;
+		for (int32 j = batch->count; j < b2_jointBatchWidth; ++j)
+		{
+			batch->indexA[j] = batch->joints[0]->m_bodyA->m_islandIndex;
+			batch->indexB[j] = batch->joints[0]->m_bodyB->m_islandIndex;
+			batch->rAx[j] = batch->rAy[j] = batch->rBx[j] = batch->rBy[j] = 0.0f;
+			batch->ux[j] = batch->uy[j] = 0.0f;
+			batch->mA[j] = batch->mB[j] = batch->iA[j] = batch->iB[j] = 0.0f;
+			batch->mass[j] = batch->bias[j] = batch->gamma[j] = batch->impulse[j] = 0.0f;
+		}
+	}
+}
+
+b2JointSolver::~b2JointSolver()
+{
+	m_allocator->Free(m_distanceBatches);
+	m_allocator->Free(m_revoluteBatches);
+	m_allocator->Free(m_lanes);
+	m_allocator->Free(m_others);
+	m_allocator->Free(m_colors);
+}
+
+void b2JointSolver::InitVelocityConstraints(const b2SolverData& data)
+{
+	// The joints are initialized and warm started in island order. A batched
+	// joint is gathered right away, while it is in the cache.
+	int32 revoluteLaneCount = m_revoluteBatchCount * b2_jointBatchWidth;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_joints[i]->InitVelocityConstraints(data);
+
+		int32 lane = m_lanes[i];
+		if (lane == -1)
+		{
+			continue;
+		}
+
+		if (lane < revoluteLaneCount)
+		{
+			const b2RevoluteJoint* joint = (b2RevoluteJoint*)m_joints[i];
+			b2RevoluteBatch* batch = m_revoluteBatches + lane / b2_jointBatchWidth;
+			int32 j = lane % b2_jointBatchWidth;
+			batch->indexA[j] = joint->m_indexA;
+			batch->indexB[j] = joint->m_indexB;
+			batch->rAx[j] = joint->m_rA.x;
+			batch->rAy[j] = joint->m_rA.y;
+			batch->rBx[j] = joint->m_rB.x;
+			batch->rBy[j] = joint->m_rB.y;
+			batch->mA[j] = joint->m_invMassA;
+			batch->mB[j] = joint->m_invMassB;
+			batch->iA[j] = joint->m_invIA;
+			batch->iB[j] = joint->m_invIB;
+
+			const b2Mat33& K = joint->m_mass;
+			batch->k11[j] = K.ex.x;
+			batch->k12[j] = K.ey.x;
+			batch->k22[j] = K.ey.y;
+			float32 det = K.ex.x * K.ey.y - K.ey.x * K.ex.y;
+			batch->invDet[j] = det != 0.0f ? 1.0f / det : 0.0f;
+
+			bool fixedRotation = (joint->m_invIA + joint->m_invIB == 0.0f);
+			if (joint->m_enableMotor && fixedRotation == false)
+			{
+				batch->motorMass[j] = joint->m_motorMass;
+				batch->motorSpeed[j] = joint->m_motorSpeed;
+				batch->maxMotorImpulse[j] = data.step.dt * joint->m_maxMotorTorque;
+			}
+			else
+			{
+				batch->motorMass[j] = 0.0f;
+				batch->motorSpeed[j] = 0.0f;
+				batch->maxMotorImpulse[j] = 0.0f;
+			}
+
+			batch->impulseX[j] = joint->m_impulse.x;
+			batch->impulseY[j] = joint->m_impulse.y;
+			batch->motorImpulse[j] = joint->m_motorImpulse;
+		}
+		else
+		{
+			lane -= revoluteLaneCount;
+			const b2DistanceJoint* joint = (b2DistanceJoint*)m_joints[i];
+			b2DistanceBatch* batch = m_distanceBatches + lane / b2_jointBatchWidth;
+			int32 j = lane % b2_jointBatchWidth;
+			batch->indexA[j] = joint->m_indexA;
+			batch->indexB[j] = joint->m_indexB;
+			batch->rAx[j] = joint->m_rA.x;
+			batch->rAy[j] = joint->m_rA.y;
+			batch->rBx[j] = joint->m_rB.x;
+			batch->rBy[j] = joint->m_rB.y;
+			batch->ux[j] = joint->m_u.x;
+			batch->uy[j] = joint->m_u.y;
+			batch->mA[j] = joint->m_invMassA;
+			batch->mB[j] = joint->m_invMassB;
+			batch->iA[j] = joint->m_invIA;
+			batch->iB[j] = joint->m_invIB;
+			batch->mass[j] = joint->m_mass;
+			batch->bias[j] = joint->m_bias;
+			batch->gamma[j] = joint->m_gamma;
+			batch->impulse[j] = joint->m_impulse;
+		}
+	}
+}
+
+static void b2SolveRevoluteBatch(b2RevoluteBatch* batch, b2Velocity* velocities)
+{
+	float32 vAx[b2_jointBatchWidth], vAy[b2_jointBatchWidth], wA[b2_jointBatchWidth];
+	float32 vBx[b2_jointBatchWidth], vBy[b2_jointBatchWidth], wB[b2_jointBatchWidth];
+
+	for (int32 j = 0; j < b2_jointBatchWidth; ++j)
+	{
+		const b2Velocity& velocityA = velocities[batch->indexA[j]];
+		const b2Velocity& velocityB = velocities[batch->indexB[j]];
+		vAx[j] = velocityA.v.x;
+		vAy[j] = velocityA.v.y;
+		wA[j] = velocityA.w;
+		vBx[j] = velocityB.v.x;
+		vBy[j] = velocityB.v.y;
+		wB[j] = velocityB.w;
+	}
+
+	for (int32 j = 0; j < b2_jointBatchWidth; ++j)
+	{
+		// Solve motor constraint.
+		float32 Cdot = wB[j] - wA[j] - batch->motorSpeed[j];
+		float32 impulse = -batch->motorMass[j] * Cdot;
+		float32 oldImpulse = batch->motorImpulse[j];
+		float32 maxImpulse = batch->maxMotorImpulse[j];
+		batch->motorImpulse[j] = b2Clamp(oldImpulse + impulse, -maxImpulse, maxImpulse);
+		impulse = batch->motorImpulse[j] - oldImpulse;
+
+		wA[j] -= batch->iA[j] * impulse;
+		wB[j] += batch->iB[j] * impulse;
+
+		// Solve point-to-point constraint.
+		float32 Cdotx = vBx[j] - wB[j] * batch->rBy[j] - vAx[j] + wA[j] * batch->rAy[j];
+		float32 Cdoty = vBy[j] + wB[j] * batch->rBx[j] - vAy[j] - wA[j] * batch->rAx[j];
+		float32 Px = batch->invDet[j] * (batch->k12[j] * Cdoty - batch->k22[j] * Cdotx);
+		float32 Py = batch->invDet[j] * (batch->k12[j] * Cdotx - batch->k11[j] * Cdoty);
+
+		batch->impulseX[j] += Px;
+		batch->impulseY[j] += Py;
+
+		vAx[j] -= batch->mA[j] * Px;
+		vAy[j] -= batch->mA[j] * Py;
+		wA[j] -= batch->iA[j] * (batch->rAx[j] * Py - batch->rAy[j] * Px);
+
+		vBx[j] += batch->mB[j] * Px;
+		vBy[j] += batch->mB[j] * Py;
+		wB[j] += batch->iB[j] * (batch->rBx[j] * Py - batch->rBy[j] * Px);
+	}
+
+	for (int32 j = 0; j < batch->count; ++j)
+	{
+		b2Velocity& velocityA = velocities[batch->indexA[j]];
+		b2Velocity& velocityB = velocities[batch->indexB[j]];
+		velocityA.v.Set(vAx[j], vAy[j]);
+		velocityA.w = wA[j];
+		velocityB.v.Set(vBx[j], vBy[j]);
+		velocityB.w = wB[j];
+	}
+}
+
+static void b2SolveDistanceBatch(b2DistanceBatch* batch, b2Velocity* velocities)
+{
+	float32 vAx[b2_jointBatchWidth], vAy[b2_jointBatchWidth], wA[b2_jointBatchWidth];
+	float32 vBx[b2_jointBatchWidth], vBy[b2_jointBatchWidth], wB[b2_jointBatchWidth];
+
+	for (int32 j = 0; j < b2_jointBatchWidth; ++j)
+	{
+		const b2Velocity& velocityA = velocities[batch->indexA[j]];
+		const b2Velocity& velocityB = velocities[batch->indexB[j]];
+		vAx[j] = velocityA.v.x;
+		vAy[j] = velocityA.v.y;
+		wA[j] = velocityA.w;
+		vBx[j] = velocityB.v.x;
+		vBy[j] = velocityB.v.y;
+		wB[j] = velocityB.w;
+	}
+
+	for (int32 j = 0; j < b2_jointBatchWidth; ++j)
+	{
+		// Cdot = dot(u, v + cross(w, r))
+		float32 dvx = vBx[j] - wB[j] * batch->rBy[j] - vAx[j] + wA[j] * batch->rAy[j];
+		float32 dvy = vBy[j] + wB[j] * batch->rBx[j] - vAy[j] - wA[j] * batch->rAx[j];
+		float32 Cdot = batch->ux[j] * dvx + batch->uy[j] * dvy;
+
+		float32 impulse = -batch->mass[j] * (Cdot + batch->bias[j] + batch->gamma[j] * batch->impulse[j]);
+		batch->impulse[j] += impulse;
+
+		float32 Px = impulse * batch->ux[j];
+		float32 Py = impulse * batch->uy[j];
+
+		vAx[j] -= batch->mA[j] * Px;
+		vAy[j] -= batch->mA[j] * Py;
+		wA[j] -= batch->iA[j] * (batch->rAx[j] * Py - batch->rAy[j] * Px);
+
+		vBx[j] += batch->mB[j] * Px;
+		vBy[j] += batch->mB[j] * Py;
+		wB[j] += batch->iB[j] * (batch->rBx[j] * Py - batch->rBy[j] * Px);
+	}
+
+	for (int32 j = 0; j < batch->count; ++j)
+	{
+		b2Velocity& velocityA = velocities[batch->indexA[j]];
+		b2Velocity& velocityB = velocities[batch->indexB[j]];
+		velocityA.v.Set(vAx[j], vAy[j]);
+		velocityA.w = wA[j];
+		velocityB.v.Set(vBx[j], vBy[j]);
+		velocityB.w = wB[j];
+	}
+}
+
+void b2JointSolver::SolveVelocityConstraints(const b2SolverData& data)
+{
+	for (int32 i = 0; i < m_revoluteBatchCount; ++i)
+	{
+		b2SolveRevoluteBatch(m_revoluteBatches + i, data.velocities);
+	}
+
+	for (int32 i = 0; i < m_distanceBatchCount; ++i)
+	{
+		b2SolveDistanceBatch(m_distanceBatches + i, data.velocities);
+	}
+
+	for (int32 i = 0; i < m_otherCount; ++i)
+	{
+		m_others[i]->SolveVelocityConstraints(data);
+	}
+}
+
+int32 b2JointSolver::GetItemCount(int32 color) const
+{
+	const b2JointColor* c = m_colors + color;
+	return (c[1].revoluteBatch - c->revoluteBatch) + (c[1].distanceBatch - c->distanceBatch) + (c[1].other - c->other);
+}
+
+void b2JointSolver::SolveVelocityConstraints(const b2SolverData& data, int32 color, int32 begin, int32 end)
+{
+	const b2JointColor* c = m_colors + color;
+	int32 revoluteCount = c[1].revoluteBatch - c->revoluteBatch;
+	int32 distanceCount = c[1].distanceBatch - c->distanceBatch;
+	for (int32 i = begin; i < end; ++i)
+	{
+		if (i < revoluteCount)
+		{
+			b2SolveRevoluteBatch(m_revoluteBatches + c->revoluteBatch + i, data.velocities);
+		}
+		else if (i < revoluteCount + distanceCount)
+		{
+			b2SolveDistanceBatch(m_distanceBatches + c->distanceBatch + i - revoluteCount, data.velocities);
+		}
+		else
+		{
+			m_others[c->other + i - revoluteCount - distanceCount]->SolveVelocityConstraints(data);
+		}
+	}
+}
+
+void b2JointSolver::StoreImpulses()
+{
+	for (int32 i = 0; i < m_revoluteBatchCount; ++i)
+	{
+		const b2RevoluteBatch* batch = m_revoluteBatches + i;
+		for (int32 j = 0; j < batch->count; ++j)
+		{
+			b2RevoluteJoint* joint = batch->joints[j];
+			joint->m_impulse.x = batch->impulseX[j];
+			joint->m_impulse.y = batch->impulseY[j];
+			joint->m_motorImpulse = batch->motorImpulse[j];
+		}
+	}
+
+	for (int32 i = 0; i < m_distanceBatchCount; ++i)
+	{
+		const b2DistanceBatch* batch = m_distanceBatches + i;
+		for (int32 j = 0; j < batch->count; ++j)
+		{
+			batch->joints[j]->m_impulse = batch->impulse[j];
+		}
+	}
+}
+
+bool b2JointSolver::SolvePositionConstraints(const b2SolverData& data)
+{
+	bool jointsOkay = true;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		bool jointOkay = m_joints[i]->SolvePositionConstraints(data);
+		jointsOkay = jointsOkay && jointOkay;
+	}
+	return jointsOkay;
+}
+
+bool b2JointSolver::SolvePositionConstraints(const b2SolverData& data, int32 color, int32 begin, int32 end)
+{
+	const b2JointColor* c = m_colors + color;
+	int32 revoluteCount = c[1].revoluteBatch - c->revoluteBatch;
+	int32 distanceCount = c[1].distanceBatch - c->distanceBatch;
+	bool jointsOkay = true;
+	for (int32 i = begin; i < end; ++i)
+	{
+		if (i < revoluteCount)
+		{
+			const b2RevoluteBatch* batch = m_revoluteBatches + c->revoluteBatch + i;
+			for (int32 j = 0; j < batch->count; ++j)
+			{
+				bool jointOkay = batch->joints[j]->SolvePositionConstraints(data);
+				jointsOkay = jointsOkay && jointOkay;
+			}
+		}
+		else if (i < revoluteCount + distanceCount)
+		{
+			const b2DistanceBatch* batch = m_distanceBatches + c->distanceBatch + i - revoluteCount;
+			for (int32 j = 0; j < batch->count; ++j)
+			{
+				bool jointOkay = batch->joints[j]->SolvePositionConstraints(data);
+				jointsOkay = jointsOkay && jointOkay;
+			}
+		}
+		else
+		{
+			bool jointOkay = m_others[c->other + i - revoluteCount - distanceCount]->SolvePositionConstraints(data);
+			jointsOkay = jointsOkay && jointOkay;
+		}
+	}
+	return jointsOkay;
+}
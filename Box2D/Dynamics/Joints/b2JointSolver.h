@@ -0,0 +1,103 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_JOINT_SOLVER_H
+#define B2_JOINT_SOLVER_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+
+class b2Joint;
+class b2StackAllocator;
+struct b2RevoluteBatch;
+struct b2DistanceBatch;
+
+struct b2JointSolverDef
+{
+	b2Joint** joints;
+	int32 count;
+
+	/// The joints sorted by color, see b2ParallelSolver: colorCount + 1 offsets into
+	/// joints. NULL for a single color.
+	const int32* colors;
+	int32 colorCount;
+
+	b2StackAllocator* allocator;
+};
+
+/// The first joint, batches and other joint of a color.
+struct b2JointColor
+{
+	int32 joint;
+	int32 revoluteBatch;
+	int32 distanceBatch;
+	int32 other;
+};
+
+/// Solves the joints of an island. Revolute joints without a limit and distance
+/// joints are grouped by type in batches of b2_jointBatchWidth joints that
+/// don't share a dynamic body. The velocity constraints of a batch are stored
+/// as structure of arrays and solved together. The other joints use their own
+/// solver. The batches are built in island order, so the order stays deterministic.
+/// With colors, the batches are built per color and the batches and other joints
+/// of a color, the items, can be solved in parallel.
+class b2JointSolver
+{
+public:
+	b2JointSolver(b2JointSolverDef* def);
+	~b2JointSolver();
+
+	/// Initialize and warm start all the joints, then gather the batches.
+	void InitVelocityConstraints(const b2SolverData& data);
+
+	/// One sweep over the batches, then over the other joints.
+	void SolveVelocityConstraints(const b2SolverData& data);
+
+	/// Get the number of items of a color: its revolute batches, distance batches
+	/// and other joints, in this order.
+	int32 GetItemCount(int32 color) const;
+
+	/// Sweep over the items [begin, end) of a color.
+	void SolveVelocityConstraints(const b2SolverData& data, int32 color, int32 begin, int32 end);
+
+	/// Copy the accumulated impulses of the batches back to the joints.
+	void StoreImpulses();
+
+	bool SolvePositionConstraints(const b2SolverData& data);
+
+	/// Solve the position constraints of the joints of the items [begin, end) of a color.
+	bool SolvePositionConstraints(const b2SolverData& data, int32 color, int32 begin, int32 end);
+
+	// Assign the batched joints to batches and count them.
+	void AssignBatches();
+
+	b2StackAllocator* m_allocator;
+	b2Joint** m_joints;
+	int32 m_count;
+	b2JointColor* m_colors;
+	int32 m_colorCount;
+	b2Joint** m_others;
+	int32 m_otherCount;
+	int32* m_lanes;
+	b2RevoluteBatch* m_revoluteBatches;
+	int32 m_revoluteBatchCount;
+	b2DistanceBatch* m_distanceBatches;
+	int32 m_distanceBatchCount;
+};
+
+#endif
@@ -18,6 +18,7 @@
 
 #include <Box2D/Dynamics/Joints/b2MouseJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 // p = attached point, m = mouse point
@@ -51,6 +52,7 @@ b2MouseJoint::b2MouseJoint(const b2MouseJointDef* def)
 
 void b2MouseJoint::SetTarget(const b2Vec2& target)
 {
+	Record(b2_recordSetTarget, target.x, target.y);
 	if (m_bodyB->IsAwake() == false)
 	{
 		m_bodyB->SetAwake(true);
@@ -65,6 +67,7 @@ const b2Vec2& b2MouseJoint::GetTarget() const
 
 void b2MouseJoint::SetMaxForce(float32 force)
 {
+	Record(b2_recordSetMaxForce, force);
 	m_maxForce = force;
 }
 
@@ -75,6 +78,7 @@ float32 b2MouseJoint::GetMaxForce() const
 
 void b2MouseJoint::SetFrequency(float32 hz)
 {
+	Record(b2_recordSetFrequency, hz);
 	m_frequencyHz = hz;
 }
 
@@ -85,6 +89,7 @@ float32 b2MouseJoint::GetFrequency() const
 
 void b2MouseJoint::SetDampingRatio(float32 ratio)
 {
+	Record(b2_recordSetDampingRatio, ratio);
 	m_dampingRatio = ratio;
 }
 
@@ -215,3 +220,13 @@ float32 b2MouseJoint::GetReactionTorque(float32 inv_dt) const
 {
 	return inv_dt * 0.0f;
 }
+
+void b2MouseJoint::GetDef(b2MouseJointDef* def) const
+{
+	b2Joint::GetDef(def);
+	// The anchor is taken from the target when the joint is created.
+	def->target = GetAnchorB();
+	def->maxForce = m_maxForce;
+	def->frequencyHz = m_frequencyHz;
+	def->dampingRatio = m_dampingRatio;
+}
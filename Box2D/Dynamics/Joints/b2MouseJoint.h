@@ -89,6 +89,10 @@ public:
 	void SetDampingRatio(float32 ratio);
 	float32 GetDampingRatio() const;
 
+	/// Fill a definition that creates a copy of this joint. The target of the
+	/// definition is the anchor, set the target of the copy afterwards.
+	void GetDef(b2MouseJointDef* def) const;
+
 protected:
 	friend class b2Joint;
 
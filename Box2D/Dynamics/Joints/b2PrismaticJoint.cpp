@@ -18,6 +18,7 @@
 
 #include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 // Linear constraint (point-to-line)
@@ -537,6 +538,7 @@ bool b2PrismaticJoint::IsLimitEnabled() const
 
 void b2PrismaticJoint::EnableLimit(bool flag)
 {
+	Record(b2_recordEnableLimit, flag ? 1.0f : 0.0f);
 	if (flag != m_enableLimit)
 	{
 		m_bodyA->SetAwake(true);
@@ -558,6 +560,7 @@ float32 b2PrismaticJoint::GetUpperLimit() const
 
 void b2PrismaticJoint::SetLimits(float32 lower, float32 upper)
 {
+	Record(b2_recordSetLimits, lower, upper);
 	b2Assert(lower <= upper);
 	if (lower != m_lowerTranslation || upper != m_upperTranslation)
 	{
@@ -576,6 +579,7 @@ bool b2PrismaticJoint::IsMotorEnabled() const
 
 void b2PrismaticJoint::EnableMotor(bool flag)
 {
+	Record(b2_recordEnableMotor, flag ? 1.0f : 0.0f);
 	m_bodyA->SetAwake(true);
 	m_bodyB->SetAwake(true);
 	m_enableMotor = flag;
@@ -583,6 +587,7 @@ void b2PrismaticJoint::EnableMotor(bool flag)
 
 void b2PrismaticJoint::SetMotorSpeed(float32 speed)
 {
+	Record(b2_recordSetMotorSpeed, speed);
 	m_bodyA->SetAwake(true);
 	m_bodyB->SetAwake(true);
 	m_motorSpeed = speed;
@@ -590,6 +595,7 @@ void b2PrismaticJoint::SetMotorSpeed(float32 speed)
 
 void b2PrismaticJoint::SetMaxMotorForce(float32 force)
 {
+	Record(b2_recordSetMaxMotor, force);
 	m_bodyA->SetAwake(true);
 	m_bodyB->SetAwake(true);
 	m_maxMotorForce = force;
@@ -599,3 +605,18 @@ float32 b2PrismaticJoint::GetMotorForce(float32 inv_dt) const
 {
 	return inv_dt * m_motorImpulse;
 }
+
+void b2PrismaticJoint::GetDef(b2PrismaticJointDef* def) const
+{
+	b2Joint::GetDef(def);
+	def->localAnchorA = m_localAnchorA;
+	def->localAnchorB = m_localAnchorB;
+	def->localAxisA = m_localXAxisA;
+	def->referenceAngle = m_refAngle;
+	def->enableLimit = m_enableLimit;
+	def->lowerTranslation = m_lowerTranslation;
+	def->upperTranslation = m_upperTranslation;
+	def->enableMotor = m_enableMotor;
+	def->maxMotorForce = m_maxMotorForce;
+	def->motorSpeed = m_motorSpeed;
+}
@@ -131,6 +131,9 @@ public:
 	/// Get the current motor force given the inverse time step, usually in N.
 	float32 GetMotorForce(float32 inv_dt) const;
 
+	/// Fill a definition that creates a copy of this joint.
+	void GetDef(b2PrismaticJointDef* def) const;
+
 protected:
 	friend class b2Joint;
 	friend class b2GearJoint;
@@ -308,3 +308,17 @@ float32 b2PulleyJoint::GetRatio() const
 {
 	return m_ratio;
 }
+
+void b2PulleyJoint::GetDef(b2PulleyJointDef* def) const
+{
+	b2Joint::GetDef(def);
+	def->groundAnchorA = m_groundAnchorA;
+	def->groundAnchorB = m_groundAnchorB;
+	def->localAnchorA = m_localAnchorA;
+	def->localAnchorB = m_localAnchorB;
+
+	// Only the sum of the lengths is kept.
+	def->lengthA = GetLengthA();
+	def->lengthB = (m_constant - def->lengthA) / m_ratio;
+	def->ratio = m_ratio;
+}
@@ -100,6 +100,9 @@ public:
 	/// Get the pulley ratio.
 	float32 GetRatio() const;
 
+	/// Fill a definition that creates a copy of this joint.
+	void GetDef(b2PulleyJointDef* def) const;
+
 protected:
 
 	friend class b2Joint;
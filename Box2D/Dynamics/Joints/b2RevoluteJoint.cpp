@@ -18,6 +18,7 @@
 
 #include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 // Point-to-point constraint
@@ -418,6 +419,7 @@ bool b2RevoluteJoint::IsMotorEnabled() const
 
 void b2RevoluteJoint::EnableMotor(bool flag)
 {
+	Record(b2_recordEnableMotor, flag ? 1.0f : 0.0f);
 	m_bodyA->SetAwake(true);
 	m_bodyB->SetAwake(true);
 	m_enableMotor = flag;
@@ -430,6 +432,7 @@ float32 b2RevoluteJoint::GetMotorTorque(float32 inv_dt) const
 
 void b2RevoluteJoint::SetMotorSpeed(float32 speed)
 {
+	Record(b2_recordSetMotorSpeed, speed);
 	m_bodyA->SetAwake(true);
 	m_bodyB->SetAwake(true);
 	m_motorSpeed = speed;
@@ -437,6 +440,7 @@ void b2RevoluteJoint::SetMotorSpeed(float32 speed)
 
 void b2RevoluteJoint::SetMaxMotorTorque(float32 torque)
 {
+	Record(b2_recordSetMaxMotor, torque);
 	m_bodyA->SetAwake(true);
 	m_bodyB->SetAwake(true);
 	m_maxMotorTorque = torque;
@@ -449,6 +453,7 @@ bool b2RevoluteJoint::IsLimitEnabled() const
 
 void b2RevoluteJoint::EnableLimit(bool flag)
 {
+	Record(b2_recordEnableLimit, flag ? 1.0f : 0.0f);
 	if (flag != m_enableLimit)
 	{
 		m_bodyA->SetAwake(true);
@@ -470,6 +475,7 @@ float32 b2RevoluteJoint::GetUpperLimit() const
 
 void b2RevoluteJoint::SetLimits(float32 lower, float32 upper)
 {
+	Record(b2_recordSetLimits, lower, upper);
 	b2Assert(lower <= upper);
 	
 	if (lower != m_lowerAngle || upper != m_upperAngle)
@@ -481,3 +487,17 @@ void b2RevoluteJoint::SetLimits(float32 lower, float32 upper)
 		m_upperAngle = upper;
 	}
 }
+
+void b2RevoluteJoint::GetDef(b2RevoluteJointDef* def) const
+{
+	b2Joint::GetDef(def);
+	def->localAnchorA = m_localAnchorA;
+	def->localAnchorB = m_localAnchorB;
+	def->referenceAngle = m_referenceAngle;
+	def->enableLimit = m_enableLimit;
+	def->lowerAngle = m_lowerAngle;
+	def->upperAngle = m_upperAngle;
+	def->enableMotor = m_enableMotor;
+	def->motorSpeed = m_motorSpeed;
+	def->maxMotorTorque = m_maxMotorTorque;
+}
@@ -141,10 +141,14 @@ public:
 	/// Unit is N*m.
 	float32 GetMotorTorque(float32 inv_dt) const;
 
+	/// Fill a definition that creates a copy of this joint.
+	void GetDef(b2RevoluteJointDef* def) const;
+
 protected:
 	
 	friend class b2Joint;
 	friend class b2GearJoint;
+	friend class b2JointSolver;
 
 	b2RevoluteJoint(const b2RevoluteJointDef* def);
 
@@ -224,3 +224,11 @@ b2LimitState b2RopeJoint::GetLimitState() const
 {
 	return m_state;
 }
+
+void b2RopeJoint::GetDef(b2RopeJointDef* def) const
+{
+	b2Joint::GetDef(def);
+	def->localAnchorA = m_localAnchorA;
+	def->localAnchorB = m_localAnchorB;
+	def->maxLength = m_maxLength;
+}
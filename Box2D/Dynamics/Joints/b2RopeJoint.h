@@ -69,6 +69,9 @@ public:
 
 	b2LimitState GetLimitState() const;
 
+	/// Fill a definition that creates a copy of this joint.
+	void GetDef(b2RopeJointDef* def) const;
+
 protected:
 
 	friend class b2Joint;
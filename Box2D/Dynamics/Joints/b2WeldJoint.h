@@ -59,6 +59,9 @@ public:
 	b2Vec2 GetReactionForce(float32 inv_dt) const;
 	float32 GetReactionTorque(float32 inv_dt) const;
 
+	/// Fill a definition that creates a copy of this joint.
+	void GetDef(b2WeldJointDef* def) const;
+
 protected:
 
 	friend class b2Joint;
@@ -18,6 +18,7 @@
 
 #include <Box2D/Dynamics/Joints/b2WheelJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 // Linear constraint (point-to-line)
@@ -374,6 +375,7 @@ bool b2WheelJoint::IsMotorEnabled() const
 
 void b2WheelJoint::EnableMotor(bool flag)
 {
+	Record(b2_recordEnableMotor, flag ? 1.0f : 0.0f);
 	m_bodyA->SetAwake(true);
 	m_bodyB->SetAwake(true);
 	m_enableMotor = flag;
@@ -381,6 +383,7 @@ void b2WheelJoint::EnableMotor(bool flag)
 
 void b2WheelJoint::SetMotorSpeed(float32 speed)
 {
+	Record(b2_recordSetMotorSpeed, speed);
 	m_bodyA->SetAwake(true);
 	m_bodyB->SetAwake(true);
 	m_motorSpeed = speed;
@@ -388,6 +391,7 @@ void b2WheelJoint::SetMotorSpeed(float32 speed)
 
 void b2WheelJoint::SetMaxMotorTorque(float32 torque)
 {
+	Record(b2_recordSetMaxMotor, torque);
 	m_bodyA->SetAwake(true);
 	m_bodyB->SetAwake(true);
 	m_maxMotorTorque = torque;
@@ -402,3 +406,16 @@ float32 b2WheelJoint::GetMotorTorque(float32 inv_dt) const
 
 
 
+
+void b2WheelJoint::GetDef(b2WheelJointDef* def) const
+{
+	b2Joint::GetDef(def);
+	def->localAnchorA = m_localAnchorA;
+	def->localAnchorB = m_localAnchorB;
+	def->localAxisA = m_localXAxisA;
+	def->enableMotor = m_enableMotor;
+	def->maxMotorTorque = m_maxMotorTorque;
+	def->motorSpeed = m_motorSpeed;
+	def->frequencyHz = m_frequencyHz;
+	def->dampingRatio = m_dampingRatio;
+}
@@ -118,6 +118,9 @@ public:
 	void SetSpringDampingRatio(float32 ratio);
 	float32 GetSpringDampingRatio() const;
 
+	/// Fill a definition that creates a copy of this joint.
+	void GetDef(b2WheelJointDef* def) const;
+
 protected:
 
 	friend class b2Joint;
@@ -0,0 +1,206 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2AsyncStepper.h>
+#include <Box2D/Dynamics/b2World.h>
+
+b2AsyncStepper::b2AsyncStepper(b2World* world)
+{
+	m_world = world;
+
+	for (int32 i = 0; i < 2; ++i)
+	{
+		m_buffers[i] = NULL;
+		m_capacities[i] = 0;
+		m_snapshots[i].bodies = NULL;
+		m_snapshots[i].bodyCount = 0;
+		m_snapshots[i].stepCount = 0;
+	}
+	m_front = 0;
+	m_stepCount = 0;
+
+	m_timeStep = 0.0f;
+	m_velocityIterations = 0;
+	m_positionIterations = 0;
+	m_stepping = false;
+
+#if defined(__linux__) || defined (__APPLE__)
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_start, NULL);
+	pthread_cond_init(&m_done, NULL);
+	m_started = false;
+	m_pending = false;
+	m_quit = false;
+#endif
+
+	Capture(m_front);
+}
+
+b2AsyncStepper::~b2AsyncStepper()
+{
+	Wait();
+
+#if defined(__linux__) || defined (__APPLE__)
+	if (m_started)
+	{
+		pthread_mutex_lock(&m_mutex);
+		m_quit = true;
+		pthread_cond_signal(&m_start);
+		pthread_mutex_unlock(&m_mutex);
+		pthread_join(m_thread, NULL);
+	}
+
+	pthread_cond_destroy(&m_done);
+	pthread_cond_destroy(&m_start);
+	pthread_mutex_destroy(&m_mutex);
+#endif
+
+	b2Free(m_buffers[0]);
+	b2Free(m_buffers[1]);
+}
+
+void b2AsyncStepper::Capture(int32 index)
+{
+	int32 count = m_world->GetBodyCount();
+	if (count > m_capacities[index])
+	{
+		b2Free(m_buffers[index]);
+		m_capacities[index] = b2Max(2 * m_capacities[index], count);
+		m_buffers[index] = (b2BodySnapshot*)b2Alloc(m_capacities[index] * sizeof(b2BodySnapshot));
+	}
+
+	b2BodySnapshot* snapshot = m_buffers[index];
+	for (const b2Body* b = m_world->GetBodyList(); b; b = b->GetNext())
+	{
+		snapshot->body = b;
+		snapshot->userData = b->GetUserData();
+		snapshot->transform = b->GetTransform();
+		snapshot->worldCenter = b->GetWorldCenter();
+		snapshot->linearVelocity = b->GetLinearVelocity();
+		snapshot->angularVelocity = b->GetAngularVelocity();
+		snapshot->type = b->GetType();
+		snapshot->awake = b->IsAwake();
+		snapshot->active = b->IsActive();
+		++snapshot;
+	}
+
+	m_snapshots[index].bodies = m_buffers[index];
+	m_snapshots[index].bodyCount = count;
+	m_snapshots[index].stepCount = m_stepCount;
+}
+
+void b2AsyncStepper::Run()
+{
+	m_world->Step(m_timeStep, m_velocityIterations, m_positionIterations);
+	++m_stepCount;
+	Capture(1 - m_front);
+}
+
+#if defined(__linux__) || defined (__APPLE__)
+
+void* b2AsyncStepper::ThreadMain(void* data)
+{
+	b2AsyncStepper* stepper = (b2AsyncStepper*)data;
+
+	pthread_mutex_lock(&stepper->m_mutex);
+	for (;;)
+	{
+		while (stepper->m_pending == false && stepper->m_quit == false)
+		{
+			pthread_cond_wait(&stepper->m_start, &stepper->m_mutex);
+		}
+
+		if (stepper->m_quit)
+		{
+			break;
+		}
+
+		pthread_mutex_unlock(&stepper->m_mutex);
+		stepper->Run();
+		pthread_mutex_lock(&stepper->m_mutex);
+
+		stepper->m_pending = false;
+		pthread_cond_signal(&stepper->m_done);
+	}
+	pthread_mutex_unlock(&stepper->m_mutex);
+
+	return NULL;
+}
+
+void b2AsyncStepper::Step(float32 timeStep, int32 velocityIterations, int32 positionIterations)
+{
+	Wait();
+
+	m_timeStep = timeStep;
+	m_velocityIterations = velocityIterations;
+	m_positionIterations = positionIterations;
+
+	if (m_started == false)
+	{
+		if (pthread_create(&m_thread, NULL, ThreadMain, this) != 0)
+		{
+			// Step on this thread.
+			Run();
+			m_front = 1 - m_front;
+			return;
+		}
+		m_started = true;
+	}
+
+	pthread_mutex_lock(&m_mutex);
+	m_pending = true;
+	m_stepping = true;
+	pthread_cond_signal(&m_start);
+	pthread_mutex_unlock(&m_mutex);
+}
+
+void b2AsyncStepper::Wait()
+{
+	if (m_stepping == false)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&m_mutex);
+	while (m_pending)
+	{
+		pthread_cond_wait(&m_done, &m_mutex);
+	}
+	pthread_mutex_unlock(&m_mutex);
+
+	m_stepping = false;
+	m_front = 1 - m_front;
+}
+
+#else
+
+void b2AsyncStepper::Step(float32 timeStep, int32 velocityIterations, int32 positionIterations)
+{
+	m_timeStep = timeStep;
+	m_velocityIterations = velocityIterations;
+	m_positionIterations = positionIterations;
+
+	Run();
+	m_front = 1 - m_front;
+}
+
+void b2AsyncStepper::Wait()
+{
+}
+
+#endif
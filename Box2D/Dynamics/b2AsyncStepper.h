@@ -0,0 +1,132 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_ASYNC_STEPPER_H
+#define B2_ASYNC_STEPPER_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Dynamics/b2Body.h>
+
+#if defined(__linux__) || defined (__APPLE__)
+#include <pthread.h>
+#endif
+
+class b2World;
+
+/// The state of a body at the end of a step, copied by b2AsyncStepper.
+struct b2BodySnapshot
+{
+	/// The body, to match the snapshot with the application objects. Don't use
+	/// it while a step is running.
+	const b2Body* body;
+	void* userData;
+	b2Transform transform;
+	b2Vec2 worldCenter;
+	b2Vec2 linearVelocity;
+	float32 angularVelocity;
+	b2BodyType type;
+	bool awake;
+	bool active;
+};
+
+/// The bodies of a world at the end of a step, in the order of the world body list.
+struct b2WorldSnapshot
+{
+	const b2BodySnapshot* bodies;
+	int32 bodyCount;
+
+	/// The number of steps completed by the stepper when the snapshot was taken.
+	int32 stepCount;
+};
+
+/// Runs b2World::Step on a background thread. Between Step and Wait the world
+/// belongs to that thread: the application must not touch it, and the world
+/// callbacks (contact listener, destruction listener, ...) are called from it.
+/// Meanwhile the application reads the bodies from GetSnapshot, without locks.
+/// Wait is the synchronization point: once it returns, the world may be changed
+/// (forces, new bodies, ...) until the next Step.
+///
+/// The snapshots are double-buffered. The background thread fills one buffer at
+/// the end of the step, Wait publishes it. The published buffer is not written
+/// until the next Wait, so a snapshot stays valid until then.
+///
+/// This has platform specific code. Where threads aren't supported, Step runs
+/// the world step right away.
+class b2AsyncStepper
+{
+public:
+	/// Take a first snapshot of the world, the thread is started on demand.
+	b2AsyncStepper(b2World* world);
+
+	/// Wait for the running step, if any, and stop the thread.
+	~b2AsyncStepper();
+
+	/// Start a world step on the background thread and return. Calls Wait first
+	/// if a step is already running.
+	void Step(float32 timeStep, int32 velocityIterations, int32 positionIterations);
+
+	/// Wait for the running step to finish and publish its snapshot. Returns
+	/// immediately if no step is running.
+	void Wait();
+
+	/// Is a step running?
+	bool IsStepping() const { return m_stepping; }
+
+	/// Get the snapshot published by the last Wait, or taken by the constructor.
+	const b2WorldSnapshot& GetSnapshot() const { return m_snapshots[m_front]; }
+
+	/// Get the world.
+	b2World* GetWorld() { return m_world; }
+
+private:
+
+	// Step the world and fill the back snapshot. Runs on the background thread.
+	void Run();
+
+	// Copy the bodies into a snapshot.
+	void Capture(int32 index);
+
+	b2World* m_world;
+
+	b2WorldSnapshot m_snapshots[2];
+	b2BodySnapshot* m_buffers[2];
+	int32 m_capacities[2];
+	int32 m_front;
+	int32 m_stepCount;
+
+	float32 m_timeStep;
+	int32 m_velocityIterations;
+	int32 m_positionIterations;
+	bool m_stepping;
+
+#if defined(__linux__) || defined (__APPLE__)
+	static void* ThreadMain(void* data);
+
+	pthread_t m_thread;
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_start;
+	pthread_cond_t m_done;
+
+	// Protected by the mutex.
+	bool m_started;
+	bool m_pending;
+	bool m_quit;
+#endif
+};
+
+#endif
@@ -19,6 +19,7 @@
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Joints/b2Joint.h>
 
@@ -41,6 +42,10 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	{
 		m_flags |= e_fixedRotationFlag;
 	}
+	if (bd->contactEvents)
+	{
+		m_flags |= e_contactEventsFlag;
+	}
 	if (bd->allowSleep)
 	{
 		m_flags |= e_autoSleepFlag;
@@ -66,6 +71,9 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_sweep.a = bd->angle;
 	m_sweep.alpha0 = 0.0f;
 
+	m_position0 = m_xf.p;
+	m_angle0 = bd->angle;
+
 	m_jointList = NULL;
 	m_contactList = NULL;
 	m_prev = NULL;
@@ -82,6 +90,12 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_torque = 0.0f;
 
 	m_sleepTime = 0.0f;
+	m_recordId = 0;
+
+	m_lodPhase = world->m_bodyCount;
+	m_skippedSteps = 0;
+	m_skippedTime = 0.0f;
+	m_solvedTime = 0.0f;
 
 	m_type = bd->type;
 
@@ -123,6 +137,11 @@ void b2Body::SetType(b2BodyType type)
 		return;
 	}
 
+	if (m_world->m_recorder)
+	{
+		m_world->m_recorder->RecordSetType(this, type);
+	}
+
 	m_type = type;
 
 	ResetMassData();
@@ -156,6 +175,8 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 		return NULL;
 	}
 
+	b2Assert(b2_circlesOnly == 0 || def->shape->GetType() == b2Shape::e_circle);
+
 	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
 
 	void* memory = allocator->Allocate(sizeof(b2Fixture));
@@ -184,6 +205,11 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 	// to be created at the beginning of the next time step.
 	m_world->m_flags |= b2World::e_newFixture;
 
+	if (m_world->m_recorder)
+	{
+		m_world->m_recorder->RecordCreateFixture(fixture);
+	}
+
 	return fixture;
 }
 
@@ -206,6 +232,11 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 
 	b2Assert(fixture->m_body == this);
 
+	if (m_world->m_recorder)
+	{
+		m_world->m_recorder->RecordDestroyFixture(fixture);
+	}
+
 	// Remove the fixture from this body's singly linked list.
 	b2Assert(m_fixtureCount > 0);
 	b2Fixture** node = &m_fixtureList;
@@ -399,6 +430,21 @@ bool b2Body::ShouldCollide(const b2Body* other) const
 	return true;
 }
 
+b2Transform b2Body::GetInterpolatedTransform(float32 alpha) const
+{
+	// Interpolate the center of mass, like b2Sweep::GetTransform, so a spinning
+	// body turns about it. The previous center is found from the current local
+	// center in case the mass changed since the step.
+	b2Rot q0(m_angle0);
+	b2Vec2 c0 = m_position0 + b2Mul(q0, m_sweep.localCenter);
+
+	b2Transform xf;
+	xf.p = (1.0f - alpha) * c0 + alpha * m_sweep.c;
+	xf.q.Set((1.0f - alpha) * m_angle0 + alpha * m_sweep.a);
+	xf.p -= b2Mul(xf.q, m_sweep.localCenter);
+	return xf;
+}
+
 void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 {
 	b2Assert(m_world->IsLocked() == false);
@@ -407,6 +453,11 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 		return;
 	}
 
+	if (m_world->m_recorder)
+	{
+		m_world->m_recorder->RecordSetTransform(this, position, angle);
+	}
+
 	m_xf.q.Set(angle);
 	m_xf.p = position;
 
@@ -416,6 +467,9 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 	m_sweep.c0 = m_sweep.c;
 	m_sweep.a0 = angle;
 
+	m_position0 = position;
+	m_angle0 = angle;
+
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
@@ -438,6 +492,19 @@ void b2Body::SynchronizeFixtures()
 	}
 }
 
+void b2Body::SynchronizeFixtures(float32 dt)
+{
+	b2Transform xf2;
+	xf2.q.Set(m_sweep.a + dt * m_angularVelocity);
+	xf2.p = m_sweep.c + dt * m_linearVelocity - b2Mul(xf2.q, m_sweep.localCenter);
+
+	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	{
+		f->Synchronize(broadPhase, m_xf, xf2);
+	}
+}
+
 void b2Body::SetActive(bool flag)
 {
 	b2Assert(m_world->IsLocked() == false);
@@ -447,6 +514,11 @@ void b2Body::SetActive(bool flag)
 		return;
 	}
 
+	if (m_world->m_recorder)
+	{
+		m_world->m_recorder->RecordSetActive(this, flag);
+	}
+
 	if (flag)
 	{
 		m_flags |= e_activeFlag;
@@ -464,6 +536,9 @@ void b2Body::SetActive(bool flag)
 	{
 		m_flags &= ~e_activeFlag;
 
+		m_position0 = m_xf.p;
+		m_angle0 = m_sweep.a;
+
 		// Destroy all proxies.
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
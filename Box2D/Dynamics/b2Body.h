@@ -31,6 +31,7 @@ class b2World;
 struct b2FixtureDef;
 struct b2JointEdge;
 struct b2ContactEdge;
+struct b2SceneBody;
 
 /// The body type.
 /// static: zero mass, zero velocity, may be manually moved
@@ -64,6 +65,7 @@ struct b2BodyDef
 		awake = true;
 		fixedRotation = false;
 		bullet = false;
+		contactEvents = false;
 		type = b2_staticBody;
 		active = true;
 		gravityScale = 1.0f;
@@ -112,6 +114,9 @@ struct b2BodyDef
 	/// @warning You should use this flag sparingly since it increases processing time.
 	bool bullet;
 
+	/// Should the contacts of this body record events? See b2World::SetContactEventsEnabled.
+	bool contactEvents;
+
 	/// Does this body start out active?
 	bool active;
 
@@ -172,6 +177,14 @@ public:
 	/// @return the current world rotation angle in radians.
 	float32 GetAngle() const;
 
+	/// Get the body origin transform between the beginning and the end of the last
+	/// step. Use this to draw a world stepped at a fixed rate at any frame rate:
+	/// alpha is the time accumulated since the last step divided by the time step.
+	/// A body that was asleep or moved by SetTransform doesn't move between the two.
+	/// @param alpha the fraction of the last step, in [0,1].
+	/// @return the interpolated world transform of the body's origin.
+	b2Transform GetInterpolatedTransform(float32 alpha) const;
+
 	/// Get the world position of the center of mass.
 	const b2Vec2& GetWorldCenter() const;
 
@@ -306,6 +319,12 @@ public:
 	/// Is this body treated like a bullet for continuous collision detection?
 	bool IsBullet() const;
 
+	/// Should the contacts of this body record events? See b2World::SetContactEventsEnabled.
+	void SetContactEventsEnabled(bool flag);
+
+	/// Do the contacts of this body record events?
+	bool IsContactEventsEnabled() const;
+
 	/// You can disable sleeping on this body. If you disable sleeping, the
 	/// body will be woken.
 	void SetSleepingAllowed(bool flag);
@@ -381,6 +400,9 @@ private:
 	friend class b2Island;
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
+	friend class b2JointSolver;
+	friend class b2ParallelSolver;
+	friend class b2ParticleSystem;
 	friend class b2Contact;
 	
 	friend class b2DistanceJoint;
@@ -394,6 +416,11 @@ private:
 	friend class b2FrictionJoint;
 	friend class b2RopeJoint;
 
+	friend class b2Recorder;
+	friend class b2Replayer;
+	friend void b2SaveBody(b2SceneBody* out, const b2Body* body, bool state);
+	friend b2Body* b2LoadBody(b2World* world, const b2SceneBody* body);
+
 	// m_flags
 	enum
 	{
@@ -403,13 +430,18 @@ private:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_activeFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_contactEventsFlag	= 0x0080
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
 	~b2Body();
 
 	void SynchronizeFixtures();
+
+	// Cover the motion from the current transform over the next time step of
+	// length dt instead of the motion of the last step.
+	void SynchronizeFixtures(float32 dt);
 	void SynchronizeTransform();
 
 	// This is used to prevent connected bodies from colliding.
@@ -418,12 +450,19 @@ private:
 
 	void Advance(float32 t);
 
+	// The members read by every step for an awake body come first and fit in
+	// 128 bytes. The rest is used by the queries, the setters and the tools.
 	b2BodyType m_type;
 
 	uint16 m_flags;
 
+	// The steps skipped since the body was last solved, see b2LevelOfDetail.
+	uint16 m_skippedSteps;
+
 	int32 m_islandIndex;
 
+	float32 m_sleepTime;
+
 	b2Transform m_xf;		// the body origin transform
 	b2Sweep m_sweep;		// the swept motion for CCD
 
@@ -433,28 +472,45 @@ private:
 	b2Vec2 m_force;
 	float32 m_torque;
 
+	float32 m_invMass;
+
+	// Inverse rotational inertia about the center of mass.
+	float32 m_invI;
+
+	float32 m_linearDamping;
+	float32 m_angularDamping;
+	float32 m_gravityScale;
+
+	b2ContactEdge* m_contactList;
+	b2JointEdge* m_jointList;
+
+	b2Fixture* m_fixtureList;
 	b2World* m_world;
 	b2Body* m_prev;
 	b2Body* m_next;
 
-	b2Fixture* m_fixtureList;
-	int32 m_fixtureCount;
+	void* m_userData;
 
-	b2JointEdge* m_jointList;
-	b2ContactEdge* m_contactList;
+	// The origin and the angle at the beginning of the last step, for interpolation.
+	b2Vec2 m_position0;
+	float32 m_angle0;
 
-	float32 m_mass, m_invMass;
+	float32 m_mass;
 
 	// Rotational inertia about the center of mass.
-	float32 m_I, m_invI;
+	float32 m_I;
 
-	float32 m_linearDamping;
-	float32 m_angularDamping;
-	float32 m_gravityScale;
+	int32 m_fixtureCount;
 
-	float32 m_sleepTime;
+	// The id of the body in a recording, see b2Recorder.
+	int32 m_recordId;
 
-	void* m_userData;
+	// Level of detail. The phase staggers the steps of the far islands, the
+	// time is the one skipped since the body was last solved and the solved
+	// time is the step it was last solved with, zero when unknown.
+	int32 m_lodPhase;
+	float32 m_skippedTime;
+	float32 m_solvedTime;
 };
 
 inline b2BodyType b2Body::GetType() const
@@ -621,6 +677,23 @@ inline bool b2Body::IsBullet() const
 	return (m_flags & e_bulletFlag) == e_bulletFlag;
 }
 
+inline void b2Body::SetContactEventsEnabled(bool flag)
+{
+	if (flag)
+	{
+		m_flags |= e_contactEventsFlag;
+	}
+	else
+	{
+		m_flags &= ~e_contactEventsFlag;
+	}
+}
+
+inline bool b2Body::IsContactEventsEnabled() const
+{
+	return (m_flags & e_contactEventsFlag) == e_contactEventsFlag;
+}
+
 inline void b2Body::SetAwake(bool flag)
 {
 	if (flag)
@@ -635,6 +708,8 @@ inline void b2Body::SetAwake(bool flag)
 	{
 		m_flags &= ~e_awakeFlag;
 		m_sleepTime = 0.0f;
+		m_position0 = m_xf.p;
+		m_angle0 = m_sweep.a;
 		m_linearVelocity.SetZero();
 		m_angularVelocity = 0.0f;
 		m_force.SetZero();
@@ -21,7 +21,116 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CompoundShape.h>
 
+// Persisting contacts of one shape pair type waiting for a batched collide
+// function, with their manifold before the update.
+struct b2ContactBatch
+{
+	b2ContactBatch(bool circlesA) : circlesA(circlesA) {}
+
+	bool circlesA;
+	b2CircleBatch pairs;
+	b2Contact* contacts[b2_narrowPhaseBatch];
+	b2Manifold oldManifolds[b2_narrowPhaseBatch];
+};
+
+// Does a child overlap an AABB? Chain and compound proxies cover several
+// children, so each child is tested on its own.
+static bool b2TestChildOverlap(const b2Fixture* fixture, int32 child, const b2AABB& aabb, b2AABB* childAABB)
+{
+	fixture->GetShape()->ComputeAABB(childAABB, fixture->GetBody()->GetTransform(), child);
+	return b2TestOverlap(*childAABB, aabb);
+}
+
+// Report the children of a proxy that may overlap a world AABB. The chain
+// and compound hierarchies are in the local frame of the shape.
+template <typename T>
+static void b2QueryChildren(T* callback, const b2FixtureProxy* proxy, const b2AABB& aabb)
+{
+	if (proxy->childCount == 1)
+	{
+		callback->QueryCallback(proxy->childIndex);
+		return;
+	}
+
+	const b2Transform& xf = proxy->fixture->GetBody()->GetTransform();
+	b2Vec2 lower = aabb.lowerBound;
+	b2Vec2 upper = aabb.upperBound;
+	b2Vec2 v1 = b2MulT(xf, lower);
+	b2Vec2 v2 = b2MulT(xf, b2Vec2(upper.x, lower.y));
+	b2Vec2 v3 = b2MulT(xf, upper);
+	b2Vec2 v4 = b2MulT(xf, b2Vec2(lower.x, upper.y));
+	b2AABB localAABB;
+	localAABB.lowerBound = b2Min(b2Min(v1, v2), b2Min(v3, v4));
+	localAABB.upperBound = b2Max(b2Max(v1, v2), b2Max(v3, v4));
+
+	const b2Shape* shape = proxy->fixture->GetShape();
+	if (shape->m_type == b2Shape::e_chain)
+	{
+		((const b2ChainShape*)shape)->Query(callback, localAABB, proxy->childIndex, proxy->childCount);
+	}
+	else
+	{
+		b2Assert(shape->m_type == b2Shape::e_compound);
+		((const b2CompoundShape*)shape)->Query(callback, localAABB);
+	}
+}
+
+// Create the contacts between a child of proxy A and the children of proxy B
+// overlapping it.
+struct b2ChildPairQueryB
+{
+	bool QueryCallback(int32 childB)
+	{
+		b2AABB aabbB;
+		if (proxyB->childCount == 1 || b2TestChildOverlap(proxyB->fixture, childB, aabbA, &aabbB))
+		{
+			manager->AddPair(proxyA->fixture, childA, proxyB->fixture, childB);
+		}
+		return true;
+	}
+
+	b2ContactManager* manager;
+	const b2FixtureProxy* proxyA;
+	const b2FixtureProxy* proxyB;
+	int32 childA;
+	b2AABB aabbA;
+};
+
+// Resolve the children of proxy A overlapping the fat AABB of proxy B.
+struct b2ChildPairQueryA
+{
+	bool QueryCallback(int32 childA)
+	{
+		b2ChildPairQueryB query;
+		query.manager = manager;
+		query.proxyA = proxyA;
+		query.proxyB = proxyB;
+		query.childA = childA;
+
+		if (proxyA->childCount == 1)
+		{
+			query.aabbA = fatAABBA;
+		}
+		else if (b2TestChildOverlap(proxyA->fixture, childA, fatAABBB, &query.aabbA) == false)
+		{
+			return true;
+		}
+
+		b2QueryChildren(&query, proxyB, query.aabbA);
+		return true;
+	}
+
+	b2ContactManager* manager;
+	const b2FixtureProxy* proxyA;
+	const b2FixtureProxy* proxyB;
+	b2AABB fatAABBA;
+	b2AABB fatAABBB;
+};
+
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
 
@@ -32,6 +141,16 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = NULL;
+	m_speculativeTime = 0.0f;
+	m_falsePairCount = 0;
+	m_satCallCount = 0;
+	m_satCacheHitCount = 0;
+	m_gjkCallCount = 0;
+	m_gjkIterCount = 0;
+	m_toiCallCount = 0;
+	m_toiIterCount = 0;
+	m_toiRootIterCount = 0;
+	m_recordEvents = false;
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -46,6 +165,11 @@ void b2ContactManager::Destroy(b2Contact* c)
 		m_contactListener->EndContact(c);
 	}
 
+	if (c->IsTouching())
+	{
+		AddEvents(c, true, false);
+	}
+
 	// Remove from the world.
 	if (c->m_prev)
 	{
@@ -104,6 +228,14 @@ void b2ContactManager::Destroy(b2Contact* c)
 // contact list.
 void b2ContactManager::Collide()
 {
+	// Circle and polygon against circle contacts are gathered by type and
+	// collided in batches. A body woken by a batched contact has its other
+	// contacts updated on the next step.
+	b2ContactBatch circles(true);
+	b2ContactBatch polygons(false);
+
+	m_falsePairCount = 0;
+
 	// Update awake contacts.
 	b2Contact* c = m_contactList;
 	while (c)
@@ -150,9 +282,21 @@ void b2ContactManager::Collide()
 			c->m_flags &= ~b2Contact::e_filterFlag;
 		}
 
-		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+		const b2FixtureProxy* proxyA = fixtureA->m_proxies + fixtureA->GetProxyIndex(indexA);
+		const b2FixtureProxy* proxyB = fixtureB->m_proxies + fixtureB->GetProxyIndex(indexB);
+		bool overlap = m_broadPhase.TestOverlap(proxyA->proxyId, proxyB->proxyId);
+
+		// The children of a grouped proxy must overlap the other proxy too.
+		b2AABB childAABB;
+		if (overlap && proxyA->childCount > 1)
+		{
+			overlap = b2TestChildOverlap(fixtureA, indexA, m_broadPhase.GetFatAABB(proxyB->proxyId), &childAABB);
+		}
+
+		if (overlap && proxyB->childCount > 1)
+		{
+			overlap = b2TestChildOverlap(fixtureB, indexB, m_broadPhase.GetFatAABB(proxyA->proxyId), &childAABB);
+		}
 
 		// Here we destroy contacts that cease to overlap in the broad-phase.
 		if (overlap == false)
@@ -163,10 +307,148 @@ void b2ContactManager::Collide()
 			continue;
 		}
 
-		// The contact persists.
-		c->Update(m_contactListener);
+		// The contact persists. It is only there for the margins if the
+		// tight AABBs are apart.
+		if (b2TestOverlap(proxyA->aabb, proxyB->aabb) == false)
+		{
+			++m_falsePairCount;
+		}
+
+		b2Shape::Type typeA = fixtureA->GetType();
+		b2Shape::Type typeB = fixtureB->GetType();
+		bool sensor = fixtureA->IsSensor() || fixtureB->IsSensor();
+		if (sensor == false && (b2_circlesOnly || (typeB == b2Shape::e_circle && (typeA == b2Shape::e_circle || typeA == b2Shape::e_polygon))))
+		{
+			b2ContactBatch* batch = b2_circlesOnly || typeA == b2Shape::e_circle ? &circles : &polygons;
+			int32 i = batch->pairs.count;
+			batch->contacts[i] = c;
+			batch->oldManifolds[i] = c->m_manifold;
+
+			// Re-enable this contact.
+			c->m_flags |= b2Contact::e_enabledFlag;
+
+			batch->pairs.Add(&c->m_manifold,
+							 fixtureA->GetShape(), bodyA->GetTransform(),
+							 (b2CircleShape*)fixtureB->GetShape(), bodyB->GetTransform());
+			if (batch->pairs.IsFull())
+			{
+				Collide(batch);
+			}
+		}
+		else
+		{
+			bool wasTouching = c->IsTouching();
+			c->Update(m_contactListener, m_speculativeTime);
+			AddEvents(c, wasTouching, c->IsTouching());
+		}
+
 		c = c->GetNext();
 	}
+
+	Collide(&circles);
+	Collide(&polygons);
+}
+
+void b2ContactManager::Collide(b2ContactBatch* batch)
+{
+	int32 count = batch->pairs.count;
+	if (count == 0)
+	{
+		return;
+	}
+
+	if (batch->circlesA)
+	{
+		b2CollideCircles(&batch->pairs);
+	}
+	else
+	{
+		b2CollidePolygonAndCircle(&batch->pairs);
+	}
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Contact* c = batch->contacts[i];
+		bool wasTouching = c->IsTouching();
+		c->Update(m_contactListener, batch->oldManifolds[i], c->m_manifold.pointCount > 0, m_speculativeTime);
+		AddEvents(c, wasTouching, c->IsTouching());
+	}
+}
+
+// Only sensors and bodies asking for them get events, so this stays cheap for
+// the other contacts.
+void b2ContactManager::AddEvents(b2Contact* c, bool wasTouching, bool touching)
+{
+	if (m_recordEvents == false || touching == wasTouching)
+	{
+		return;
+	}
+
+	b2Fixture* fixtureA = c->GetFixtureA();
+	b2Fixture* fixtureB = c->GetFixtureB();
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	bool sensor = fixtureA->IsSensor() || fixtureB->IsSensor();
+	if (sensor == false && bodyA->IsContactEventsEnabled() == false && bodyB->IsContactEventsEnabled() == false)
+	{
+		return;
+	}
+
+	if (touching == false)
+	{
+		b2ContactEndEvent event;
+		event.fixtureA = fixtureA;
+		event.fixtureB = fixtureB;
+		m_endEvents.Push(event);
+		return;
+	}
+
+	b2ContactBeginEvent event;
+	event.fixtureA = fixtureA;
+	event.fixtureB = fixtureB;
+	m_beginEvents.Push(event);
+
+	if (sensor)
+	{
+		return;
+	}
+
+	// The velocities are the ones the solver is about to resolve. A speculative
+	// contact stopped the shapes short of touching, it kept their speed.
+	b2WorldManifold worldManifold;
+	c->GetWorldManifold(&worldManifold);
+
+	b2ContactHitEvent hit;
+	hit.fixtureA = fixtureA;
+	hit.fixtureB = fixtureB;
+	hit.point = worldManifold.points[0];
+	hit.normal = worldManifold.normal;
+	hit.approachSpeed = 0.0f;
+	for (int32 i = 0; i < c->GetManifold()->pointCount; ++i)
+	{
+		b2Vec2 point = worldManifold.points[i];
+		b2Vec2 dv = bodyB->GetLinearVelocityFromWorldPoint(point) - bodyA->GetLinearVelocityFromWorldPoint(point);
+		float32 approachSpeed = -b2Dot(dv, worldManifold.normal);
+		if (approachSpeed > hit.approachSpeed)
+		{
+			hit.point = point;
+			hit.approachSpeed = approachSpeed;
+		}
+	}
+	hit.approachSpeed = b2Max(hit.approachSpeed, c->m_arrivalSpeed);
+
+	if (hit.approachSpeed > b2_hitEventThreshold)
+	{
+		m_hitEvents.Push(hit);
+	}
+}
+
+void b2ContactManager::ClearEvents()
+{
+	m_beginEvents.Clear();
+	m_endEvents.Clear();
+	m_hitEvents.Clear();
 }
 
 void b2ContactManager::FindNewContacts()
@@ -179,12 +461,36 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	b2FixtureProxy* proxyA = (b2FixtureProxy*)proxyUserDataA;
 	b2FixtureProxy* proxyB = (b2FixtureProxy*)proxyUserDataB;
 
-	b2Fixture* fixtureA = proxyA->fixture;
-	b2Fixture* fixtureB = proxyB->fixture;
+	if (proxyA->childCount == 1 && proxyB->childCount == 1)
+	{
+		AddPair(proxyA->fixture, proxyA->childIndex, proxyB->fixture, proxyB->childIndex);
+		return;
+	}
 
-	int32 indexA = proxyA->childIndex;
-	int32 indexB = proxyB->childIndex;
+	if (proxyA->fixture->GetBody() == proxyB->fixture->GetBody())
+	{
+		return;
+	}
+
+	// Chains don't collide with each other.
+	if (proxyA->fixture->GetType() == b2Shape::e_chain && proxyB->fixture->GetType() == b2Shape::e_chain)
+	{
+		return;
+	}
 
+	// Resolve the grouped proxies to the child pairs that overlap. These are
+	// the only child contacts of a chain or a compound.
+	b2ChildPairQueryA query;
+	query.manager = this;
+	query.proxyA = proxyA;
+	query.proxyB = proxyB;
+	query.fatAABBA = m_broadPhase.GetFatAABB(proxyA->proxyId);
+	query.fatAABBB = m_broadPhase.GetFatAABB(proxyB->proxyId);
+	b2QueryChildren(&query, proxyA, query.fatAABBB);
+}
+
+void b2ContactManager::AddPair(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+{
 	b2Body* bodyA = fixtureA->GetBody();
 	b2Body* bodyB = fixtureB->GetBody();
 
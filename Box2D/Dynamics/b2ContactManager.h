@@ -20,11 +20,15 @@
 #define B2_CONTACT_MANAGER_H
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Common/b2GrowableStack.h>
+#include <Box2D/Dynamics/b2WorldCallbacks.h>
 
 class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
+class b2Fixture;
 class b2BlockAllocator;
+struct b2ContactBatch;
 
 // Delegate of b2World.
 class b2ContactManager
@@ -35,11 +39,23 @@ public:
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
 
+	// Create the contact between two children if it doesn't exist.
+	void AddPair(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
+
 	void FindNewContacts();
 
 	void Destroy(b2Contact* c);
 
 	void Collide();
+
+	// Run a batched collide function and finish the update of its contacts.
+	void Collide(b2ContactBatch* batch);
+
+	// Record the events of a contact whose touching state was updated.
+	void AddEvents(b2Contact* c, bool wasTouching, bool touching);
+
+	// Remove the events of the previous step.
+	void ClearEvents();
             
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
@@ -47,6 +63,33 @@ public:
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+
+	// Time step over which Collide looks for speculative contacts, zero when
+	// speculative contacts are off.
+	float32 m_speculativeTime;
+
+	// Contacts kept by Collide whose fat AABBs overlap but not their tight ones.
+	int32 m_falsePairCount;
+
+	// b2CollidePolygons calls with a cache during the step and those that
+	// skipped the full search, counted by the contacts.
+	int32 m_satCallCount;
+	int32 m_satCacheHitCount;
+
+	// GJK queries of the speculative contacts and time of impact queries during
+	// the step, with their iterations. The GJK queries made by the time of
+	// impact are included.
+	int32 m_gjkCallCount;
+	int32 m_gjkIterCount;
+	int32 m_toiCallCount;
+	int32 m_toiIterCount;
+	int32 m_toiRootIterCount;
+
+	// Contact events, recorded during the step when enabled.
+	bool m_recordEvents;
+	b2GrowableStack<b2ContactBeginEvent, 16> m_beginEvents;
+	b2GrowableStack<b2ContactEndEvent, 16> m_endEvents;
+	b2GrowableStack<b2ContactHitEvent, 16> m_hitEvents;
 };
 
 #endif
@@ -19,10 +19,12 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CompoundShape.h>
 #include <Box2D/Collision/b2BroadPhase.h>
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Common/b2BlockAllocator.h>
@@ -38,6 +40,22 @@ b2Fixture::b2Fixture()
 	m_density = 0.0f;
 }
 
+// Number of broad-phase proxies of a shape. Chains group their edges and a
+// compound has a single proxy.
+static int32 b2GetProxyCount(const b2Shape* shape)
+{
+	int32 childCount = shape->GetChildCount();
+	if (shape->m_type == b2Shape::e_chain)
+	{
+		return (childCount + b2_chainProxyEdges - 1) / b2_chainProxyEdges;
+	}
+	if (shape->m_type == b2Shape::e_compound)
+	{
+		return b2Min(childCount, 1);
+	}
+	return childCount;
+}
+
 void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2FixtureDef* def)
 {
 	m_userData = def->userData;
@@ -54,9 +72,9 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2Fixtur
 	m_shape = def->shape->Clone(allocator);
 
 	// Reserve proxy space
-	int32 childCount = m_shape->GetChildCount();
-	m_proxies = (b2FixtureProxy*)allocator->Allocate(childCount * sizeof(b2FixtureProxy));
-	for (int32 i = 0; i < childCount; ++i)
+	int32 proxyCount = b2GetProxyCount(m_shape);
+	m_proxies = (b2FixtureProxy*)allocator->Allocate(proxyCount * sizeof(b2FixtureProxy));
+	for (int32 i = 0; i < proxyCount; ++i)
 	{
 		m_proxies[i].fixture = NULL;
 		m_proxies[i].proxyId = b2BroadPhase::e_nullProxy;
@@ -72,8 +90,8 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 	b2Assert(m_proxyCount == 0);
 
 	// Free the proxy array.
-	int32 childCount = m_shape->GetChildCount();
-	allocator->Free(m_proxies, childCount * sizeof(b2FixtureProxy));
+	int32 proxyCount = b2GetProxyCount(m_shape);
+	allocator->Free(m_proxies, proxyCount * sizeof(b2FixtureProxy));
 	m_proxies = NULL;
 
 	// Free the child shape.
@@ -111,6 +129,14 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 		}
 		break;
 
+	case b2Shape::e_compound:
+		{
+			b2CompoundShape* s = (b2CompoundShape*)m_shape;
+			s->~b2CompoundShape();
+			allocator->Free(s, sizeof(b2CompoundShape));
+		}
+		break;
+
 	default:
 		b2Assert(false);
 		break;
@@ -119,20 +145,78 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 	m_shape = NULL;
 }
 
+int32 b2Fixture::GetMemory() const
+{
+	int32 shapeSize = 0;
+	switch (m_shape->m_type)
+	{
+	case b2Shape::e_circle:
+		shapeSize = sizeof(b2CircleShape);
+		break;
+
+	case b2Shape::e_edge:
+		shapeSize = sizeof(b2EdgeShape);
+		break;
+
+	case b2Shape::e_polygon:
+		shapeSize = sizeof(b2PolygonShape);
+		break;
+
+	case b2Shape::e_chain:
+		shapeSize = sizeof(b2ChainShape);
+		break;
+
+	case b2Shape::e_compound:
+		shapeSize = sizeof(b2CompoundShape);
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+
+	int32 proxySize = b2GetProxyCount(m_shape) * sizeof(b2FixtureProxy);
+	return b2BlockAllocator::GetBlockSize(sizeof(b2Fixture)) +
+		b2BlockAllocator::GetBlockSize(proxySize) +
+		b2BlockAllocator::GetBlockSize(shapeSize);
+}
+
 void b2Fixture::CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf)
 {
 	b2Assert(m_proxyCount == 0);
 
 	// Create proxies in the broad-phase.
-	m_proxyCount = m_shape->GetChildCount();
+	m_proxyCount = b2GetProxyCount(m_shape);
+	int32 childCount = m_shape->GetChildCount();
+	int32 childrenPerProxy = 1;
+	if (m_shape->m_type == b2Shape::e_chain)
+	{
+		childrenPerProxy = b2_chainProxyEdges;
+	}
+	else if (m_shape->m_type == b2Shape::e_compound)
+	{
+		childrenPerProxy = childCount;
+	}
 
 	for (int32 i = 0; i < m_proxyCount; ++i)
 	{
 		b2FixtureProxy* proxy = m_proxies + i;
-		m_shape->ComputeAABB(&proxy->aabb, xf, i);
+		proxy->childIndex = i * childrenPerProxy;
+		proxy->childCount = b2Min(childrenPerProxy, childCount - proxy->childIndex);
+		ComputeAABB(&proxy->aabb, xf, proxy);
 		proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy);
 		proxy->fixture = this;
-		proxy->childIndex = i;
+	}
+}
+
+void b2Fixture::ComputeAABB(b2AABB* aabb, const b2Transform& xf, const b2FixtureProxy* proxy) const
+{
+	m_shape->ComputeAABB(aabb, xf, proxy->childIndex);
+	for (int32 i = 1; i < proxy->childCount; ++i)
+	{
+		b2AABB childAABB;
+		m_shape->ComputeAABB(&childAABB, xf, proxy->childIndex + i);
+		aabb->Combine(childAABB);
 	}
 }
 
@@ -162,19 +246,32 @@ void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transfo
 
 		// Compute an AABB that covers the swept shape (may miss some rotation effect).
 		b2AABB aabb1, aabb2;
-		m_shape->ComputeAABB(&aabb1, transform1, proxy->childIndex);
-		m_shape->ComputeAABB(&aabb2, transform2, proxy->childIndex);
+		ComputeAABB(&aabb1, transform1, proxy);
+		ComputeAABB(&aabb2, transform2, proxy);
 	
 		proxy->aabb.Combine(aabb1, aabb2);
 
 		b2Vec2 displacement = transform2.p - transform1.p;
 
 		broadPhase->MoveProxy(proxy->proxyId, proxy->aabb, displacement);
+
+		if (proxy->childCount > 1)
+		{
+			// The children move inside the proxy, the contact manager has to
+			// look for new child pairs.
+			broadPhase->TouchProxy(proxy->proxyId);
+		}
 	}
 }
 
 void b2Fixture::SetFilterData(const b2Filter& filter)
 {
+	b2Recorder* recorder = m_body->GetWorld()->GetRecorder();
+	if (recorder)
+	{
+		recorder->RecordSetFilterData(this, filter);
+	}
+
 	m_filter = filter;
 
 	Refilter();
@@ -221,6 +318,12 @@ void b2Fixture::SetSensor(bool sensor)
 {
 	if (sensor != m_isSensor)
 	{
+		b2Recorder* recorder = m_body->GetWorld()->GetRecorder();
+		if (recorder)
+		{
+			recorder->RecordSetSensor(this, sensor);
+		}
+
 		m_body->SetAwake(true);
 		m_isSensor = sensor;
 	}
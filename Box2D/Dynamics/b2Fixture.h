@@ -87,11 +87,13 @@ struct b2FixtureDef
 };
 
 /// This proxy is used internally to connect fixtures to the broad-phase.
+/// A proxy covers the children [childIndex, childIndex + childCount).
 struct b2FixtureProxy
 {
 	b2AABB aabb;
 	b2Fixture* fixture;
 	int32 childIndex;
+	int32 childCount;
 	int32 proxyId;
 };
 
@@ -185,7 +187,8 @@ public:
 
 	/// Get the fixture's AABB. This AABB may be enlarge and/or stale.
 	/// If you need a more accurate AABB, compute it using the shape and
-	/// the body transform.
+	/// the body transform. For a chain this bounds the group of edges
+	/// containing the child, for a compound all the children.
 	const b2AABB& GetAABB(int32 childIndex) const;
 
 protected:
@@ -194,6 +197,7 @@ protected:
 	friend class b2World;
 	friend class b2Contact;
 	friend class b2ContactManager;
+	friend class b2Recorder;
 
 	b2Fixture();
 
@@ -202,29 +206,39 @@ protected:
 	void Create(b2BlockAllocator* allocator, b2Body* body, const b2FixtureDef* def);
 	void Destroy(b2BlockAllocator* allocator);
 
+	// Get the bytes taken by the fixture, its proxies and its shape in the block
+	// allocator. The memory allocated with b2Alloc by chains and compounds isn't
+	// included.
+	int32 GetMemory() const;
+
 	// These support body activation/deactivation.
 	void CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf);
 	void DestroyProxies(b2BroadPhase* broadPhase);
 
 	void Synchronize(b2BroadPhase* broadPhase, const b2Transform& xf1, const b2Transform& xf2);
 
-	float32 m_density;
+	// Chains group their edges by b2_chainProxyEdges in the broad-phase and
+	// the children of a compound share one proxy.
+	int32 GetProxyIndex(int32 childIndex) const;
+	void ComputeAABB(b2AABB* aabb, const b2Transform& xf, const b2FixtureProxy* proxy) const;
 
-	b2Fixture* m_next;
+	// Ordered to avoid padding, the fixture fits in 64 bytes.
 	b2Body* m_body;
-
 	b2Shape* m_shape;
 
-	float32 m_friction;
-	float32 m_restitution;
-
 	b2FixtureProxy* m_proxies;
 	int32 m_proxyCount;
 
+	float32 m_friction;
+	float32 m_restitution;
+	float32 m_density;
+
 	b2Filter m_filter;
 
 	bool m_isSensor;
 
+	b2Fixture* m_next;
+
 	void* m_userData;
 };
 
@@ -331,8 +345,24 @@ inline void b2Fixture::GetMassData(b2MassData* massData) const
 
 inline const b2AABB& b2Fixture::GetAABB(int32 childIndex) const
 {
-	b2Assert(0 <= childIndex && childIndex < m_proxyCount);
-	return m_proxies[childIndex].aabb;
+	int32 proxyIndex = GetProxyIndex(childIndex);
+	b2Assert(0 <= proxyIndex && proxyIndex < m_proxyCount);
+	return m_proxies[proxyIndex].aabb;
+}
+
+inline int32 b2Fixture::GetProxyIndex(int32 childIndex) const
+{
+	switch (m_shape->m_type)
+	{
+	case b2Shape::e_chain:
+		return childIndex / b2_chainProxyEdges;
+
+	case b2Shape::e_compound:
+		return 0;
+
+	default:
+		return childIndex;
+	}
 }
 
 #endif
@@ -20,12 +20,15 @@
 #include <Box2D/Dynamics/b2Island.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2ParallelSolver.h>
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 #include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <Box2D/Dynamics/Joints/b2JointSolver.h>
 #include <Box2D/Common/b2StackAllocator.h>
 #include <Box2D/Common/b2Timer.h>
+#include <cstring>
 
 /*
 Position Correction Notes
@@ -161,6 +164,7 @@ b2Island::b2Island(
 
 	m_allocator = allocator;
 	m_listener = listener;
+	m_impulses = NULL;
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
@@ -168,10 +172,46 @@ b2Island::b2Island(
 
 	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
 	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
+
+	m_bodyOffset = 0;
+	m_isRange = false;
+}
+
+b2Island::b2Island(b2Island* islands, const b2IslandRange& range, b2StackAllocator* allocator)
+{
+	m_bodyCapacity = range.bodyCount;
+	m_contactCapacity = range.contactCount;
+	m_jointCapacity = range.jointCount;
+	m_bodyCount = range.bodyCount;
+	m_contactCount = range.contactCount;
+	m_jointCount = range.jointCount;
+
+	m_allocator = allocator;
+	m_listener = NULL;
+	m_impulses = NULL;
+	if (islands->m_impulses)
+	{
+		m_impulses = islands->m_impulses + range.contactStart;
+	}
+
+	m_bodies = islands->m_bodies + range.bodyStart;
+	m_contacts = islands->m_contacts + range.contactStart;
+	m_joints = islands->m_joints + range.jointStart;
+
+	m_velocities = islands->m_velocities + range.bodyStart;
+	m_positions = islands->m_positions + range.bodyStart;
+
+	m_bodyOffset = range.bodyStart;
+	m_isRange = true;
 }
 
 b2Island::~b2Island()
 {
+	if (m_isRange)
+	{
+		return;
+	}
+
 	// Warning: the order should reverse the constructor order.
 	m_allocator->Free(m_positions);
 	m_allocator->Free(m_velocities);
@@ -182,6 +222,12 @@ b2Island::~b2Island()
 
 void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
 {
+	if (step.subStepCount > 0)
+	{
+		SolveSoft(profile, step, gravity, allowSleep);
+		return;
+	}
+
 	b2Timer timer;
 
 	float32 h = step.dt;
@@ -228,16 +274,29 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	// Solver data
 	b2SolverData solverData;
 	solverData.step = step;
-	solverData.positions = m_positions;
-	solverData.velocities = m_velocities;
+	solverData.positions = m_positions - m_bodyOffset;
+	solverData.velocities = m_velocities - m_bodyOffset;
+
+	// Large islands are sorted by color before the constraints are gathered.
+	b2ParallelSolverDef parallelSolverDef;
+	parallelSolverDef.contacts = m_contacts;
+	parallelSolverDef.contactCount = m_contactCount;
+	parallelSolverDef.joints = m_joints;
+	parallelSolverDef.jointCount = m_jointCount;
+	parallelSolverDef.bodyCount = m_bodyOffset + m_bodyCount;
+	parallelSolverDef.threadPool = step.threadPool;
+	parallelSolverDef.allocator = m_allocator;
+
+	b2ParallelSolver parallelSolver(&parallelSolverDef);
+	bool parallel = parallelSolver.IsActive();
 
 	// Initialize velocity constraints.
 	b2ContactSolverDef contactSolverDef;
 	contactSolverDef.step = step;
 	contactSolverDef.contacts = m_contacts;
 	contactSolverDef.count = m_contactCount;
-	contactSolverDef.positions = m_positions;
-	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.positions = m_positions - m_bodyOffset;
+	contactSolverDef.velocities = m_velocities - m_bodyOffset;
 	contactSolverDef.allocator = m_allocator;
 
 	b2ContactSolver contactSolver(&contactSolverDef);
@@ -248,27 +307,88 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		contactSolver.WarmStart();
 	}
 	
-	for (int32 i = 0; i < m_jointCount; ++i)
-	{
-		m_joints[i]->InitVelocityConstraints(solverData);
-	}
+	b2JointSolverDef jointSolverDef;
+	jointSolverDef.joints = m_joints;
+	jointSolverDef.count = m_jointCount;
+	jointSolverDef.colors = parallel ? parallelSolver.m_jointColors : NULL;
+	jointSolverDef.colorCount = parallelSolver.m_jointColorCount;
+	jointSolverDef.allocator = m_allocator;
+
+	b2JointSolver jointSolver(&jointSolverDef);
+	jointSolver.InitVelocityConstraints(solverData);
 
 	profile->solveInit = timer.GetMilliseconds();
 
 	// Solve velocity constraints
 	timer.Reset();
-	for (int32 i = 0; i < step.velocityIterations; ++i)
+	bool adaptive = b2_fixedVelocityIterations == 0 && step.velocityTolerance > 0.0f;
+
+	// Joints don't report their impulses, the adaptive mode measures them
+	// from the body velocities before and after the joint pass.
+	b2Velocity* jointVelocities = NULL;
+	if (adaptive && m_jointCount > 0)
 	{
-		for (int32 j = 0; j < m_jointCount; ++j)
+		jointVelocities = (b2Velocity*)m_allocator->Allocate(m_bodyCount * sizeof(b2Velocity));
+	}
+
+	int32 velocityIterationCount = b2_fixedVelocityIterations > 0 ? b2_fixedVelocityIterations : step.velocityIterations;
+	int32 velocityIterations = 0;
+	for (int32 i = 0; i < velocityIterationCount; ++i)
+	{
+		if (jointVelocities)
 		{
-			m_joints[j]->SolveVelocityConstraints(solverData);
+			memcpy(jointVelocities, m_velocities, m_bodyCount * sizeof(b2Velocity));
 		}
 
-		contactSolver.SolveVelocityConstraints();
+		float32 maxImpulseDelta;
+		if (parallel)
+		{
+			parallelSolver.SolveVelocityConstraints(&jointSolver, solverData);
+			maxImpulseDelta = parallelSolver.SolveVelocityConstraints(&contactSolver);
+		}
+		else
+		{
+			jointSolver.SolveVelocityConstraints(solverData);
+			maxImpulseDelta = contactSolver.SolveVelocityConstraints();
+		}
+		++velocityIterations;
+
+		if (adaptive == false || velocityIterations < step.minVelocityIterations)
+		{
+			continue;
+		}
+
+		if (jointVelocities)
+		{
+			for (int32 j = 0; j < m_bodyCount && maxImpulseDelta <= step.velocityTolerance; ++j)
+			{
+				b2Body* b = m_bodies[j];
+				if (b->m_type != b2_dynamicBody)
+				{
+					continue;
+				}
+
+				b2Vec2 dv = m_velocities[j].v - jointVelocities[j].v;
+				float32 dw = m_velocities[j].w - jointVelocities[j].w;
+				maxImpulseDelta = b2Max(maxImpulseDelta, b->m_mass * dv.Length());
+				maxImpulseDelta = b2Max(maxImpulseDelta, b->m_I * b2Abs(dw));
+			}
+		}
+
+		if (maxImpulseDelta <= step.velocityTolerance)
+		{
+			break;
+		}
+	}
+
+	if (jointVelocities)
+	{
+		m_allocator->Free(jointVelocities);
 	}
 
 	// Store impulses for warm starting
 	contactSolver.StoreImpulses();
+	jointSolver.StoreImpulses();
 	profile->solveVelocity = timer.GetMilliseconds();
 
 	// Integrate positions
@@ -307,15 +427,21 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	// Solve position constraints
 	timer.Reset();
 	bool positionSolved = false;
-	for (int32 i = 0; i < step.positionIterations; ++i)
+	int32 positionIterationCount = b2_fixedPositionIterations > 0 ? b2_fixedPositionIterations : step.positionIterations;
+	int32 positionIterations = 0;
+	for (int32 i = 0; i < positionIterationCount; ++i)
 	{
-		bool contactsOkay = contactSolver.SolvePositionConstraints();
-
-		bool jointsOkay = true;
-		for (int32 i = 0; i < m_jointCount; ++i)
+		++positionIterations;
+		bool contactsOkay, jointsOkay;
+		if (parallel)
+		{
+			contactsOkay = parallelSolver.SolvePositionConstraints(&contactSolver);
+			jointsOkay = parallelSolver.SolvePositionConstraints(&jointSolver, solverData);
+		}
+		else
 		{
-			bool jointOkay = m_joints[i]->SolvePositionConstraints(solverData);
-			jointsOkay = jointsOkay && jointOkay;
+			contactsOkay = contactSolver.SolvePositionConstraints();
+			jointsOkay = jointSolver.SolvePositionConstraints(solverData);
 		}
 
 		if (contactsOkay && jointsOkay)
@@ -338,46 +464,215 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	}
 
 	profile->solvePosition = timer.GetMilliseconds();
+	profile->velocityIterations = velocityIterations;
+	profile->positionIterations = positionIterations;
 
 	Report(contactSolver.m_velocityConstraints);
 
 	if (allowSleep)
 	{
-		float32 minSleepTime = b2_maxFloat;
+		UpdateSleep(h, positionSolved);
+	}
+}
+
+void b2Island::UpdateSleep(float32 h, bool positionSolved)
+{
+	float32 minSleepTime = b2_maxFloat;
+
+	const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
+	const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
+			b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
+			b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
+		{
+			b->m_sleepTime = 0.0f;
+			minSleepTime = 0.0f;
+		}
+		else
+		{
+			b->m_sleepTime += h;
+			minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
+		}
+	}
+
+	if (minSleepTime >= b2_timeToSleep && positionSolved)
+	{
+		for (int32 i = 0; i < m_bodyCount; ++i)
+		{
+			b2Body* b = m_bodies[i];
+			b->SetAwake(false);
+		}
+	}
+}
+
+void b2Island::SolveSoft(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
+{
+	b2Timer timer;
+
+	int32 subStepCount = step.subStepCount;
+	float32 h = step.dt / subStepCount;
+
+	// Initialize the body state. Velocities are integrated in every sub-step.
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+
+		// Store positions for continuous collision.
+		b->m_sweep.c0 = b->m_sweep.c;
+		b->m_sweep.a0 = b->m_sweep.a;
+
+		m_positions[i].c = b->m_sweep.c;
+		m_positions[i].a = b->m_sweep.a;
+		m_velocities[i].v = b->m_linearVelocity;
+		m_velocities[i].w = b->m_angularVelocity;
+	}
+
+	b2TimeStep subStep = step;
+	subStep.dt = h;
+	subStep.inv_dt = subStepCount * step.inv_dt;
+
+	// Solver data
+	b2SolverData solverData;
+	solverData.step = subStep;
+	solverData.positions = m_positions - m_bodyOffset;
+	solverData.velocities = m_velocities - m_bodyOffset;
+
+	b2ContactSolverDef contactSolverDef;
+	contactSolverDef.step = subStep;
+	contactSolverDef.contacts = m_contacts;
+	contactSolverDef.count = m_contactCount;
+	contactSolverDef.positions = m_positions - m_bodyOffset;
+	contactSolverDef.velocities = m_velocities - m_bodyOffset;
+	contactSolverDef.allocator = m_allocator;
 
-		const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
-		const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+	b2ContactSolver contactSolver(&contactSolverDef);
+	contactSolver.InitializeVelocityConstraints();
+	contactSolver.InitializeSoftConstraints(h);
+
+	b2JointSolverDef jointSolverDef;
+	jointSolverDef.joints = m_joints;
+	jointSolverDef.count = m_jointCount;
+	jointSolverDef.colors = NULL;
+	jointSolverDef.colorCount = 0;
+	jointSolverDef.allocator = m_allocator;
+
+	b2JointSolver jointSolver(&jointSolverDef);
+
+	profile->solveInit = timer.GetMilliseconds();
 
+	timer.Reset();
+	float32 minSeparation = 0.0f;
+	bool jointsOkay = true;
+	for (int32 k = 0; k < subStepCount; ++k)
+	{
+		// Integrate velocities and apply damping.
 		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
 			b2Body* b = m_bodies[i];
-			if (b->GetType() == b2_staticBody)
+			if (b->m_type != b2_dynamicBody)
 			{
 				continue;
 			}
 
-			if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
-				b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
-				b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
-			{
-				b->m_sleepTime = 0.0f;
-				minSleepTime = 0.0f;
-			}
-			else
-			{
-				b->m_sleepTime += h;
-				minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
-			}
+			b2Vec2 v = m_velocities[i].v;
+			float32 w = m_velocities[i].w;
+
+			v += h * (b->m_gravityScale * gravity + b->m_invMass * b->m_force);
+			w += h * b->m_invI * b->m_torque;
+
+			v *= b2Clamp(1.0f - h * b->m_linearDamping, 0.0f, 1.0f);
+			w *= b2Clamp(1.0f - h * b->m_angularDamping, 0.0f, 1.0f);
+
+			m_velocities[i].v = v;
+			m_velocities[i].w = w;
 		}
 
-		if (minSleepTime >= b2_timeToSleep && positionSolved)
+		// Impulses carried over from the previous sub-step have the same time scale.
+		solverData.step.dtRatio = k == 0 ? step.dtRatio : 1.0f;
+
+		if (step.warmStarting)
 		{
-			for (int32 i = 0; i < m_bodyCount; ++i)
+			contactSolver.WarmStart();
+		}
+
+		// Joints are rebuilt from the current positions in every sub-step.
+		jointSolver.InitVelocityConstraints(solverData);
+
+		// Solve with bias
+		jointSolver.SolveVelocityConstraints(solverData);
+		contactSolver.SolveSoftVelocityConstraints(true);
+
+		// Integrate positions. The velocity limits are the ones of a full step.
+		for (int32 i = 0; i < m_bodyCount; ++i)
+		{
+			b2Vec2 v = m_velocities[i].v;
+			float32 w = m_velocities[i].w;
+
+			b2Vec2 translation = step.dt * v;
+			if (b2Dot(translation, translation) > b2_maxTranslationSquared)
 			{
-				b2Body* b = m_bodies[i];
-				b->SetAwake(false);
+				float32 ratio = b2_maxTranslation / translation.Length();
+				v *= ratio;
 			}
+
+			float32 rotation = step.dt * w;
+			if (rotation * rotation > b2_maxRotationSquared)
+			{
+				float32 ratio = b2_maxRotation / b2Abs(rotation);
+				w *= ratio;
+			}
+
+			m_positions[i].c += h * v;
+			m_positions[i].a += h * w;
+			m_velocities[i].v = v;
+			m_velocities[i].w = w;
 		}
+
+		// Joints have no soft position bias, correct their drift once per sub-step.
+		jointsOkay = jointSolver.SolvePositionConstraints(solverData);
+
+		// Relax: remove the velocity added by the soft contacts.
+		jointSolver.SolveVelocityConstraints(solverData);
+		jointSolver.StoreImpulses();
+		minSeparation = contactSolver.SolveSoftVelocityConstraints(false);
+	}
+
+	contactSolver.ApplySoftRestitution();
+
+	// Store impulses for warm starting
+	contactSolver.StoreImpulses();
+	profile->solveVelocity = timer.GetMilliseconds();
+
+	// Copy state buffers back to the bodies
+	timer.Reset();
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* body = m_bodies[i];
+		body->m_sweep.c = m_positions[i].c;
+		body->m_sweep.a = m_positions[i].a;
+		body->m_linearVelocity = m_velocities[i].v;
+		body->m_angularVelocity = m_velocities[i].w;
+		body->SynchronizeTransform();
+	}
+	profile->solvePosition = timer.GetMilliseconds();
+	profile->velocityIterations = 2 * subStepCount;
+	profile->positionIterations = m_jointCount > 0 ? subStepCount : 0;
+
+	Report(contactSolver.m_velocityConstraints);
+
+	if (allowSleep)
+	{
+		bool positionSolved = minSeparation >= -3.0f * b2_linearSlop && jointsOkay;
+		UpdateSleep(step.dt, positionSolved);
 	}
 }
 
@@ -515,7 +810,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 {
-	if (m_listener == NULL)
+	if (m_listener == NULL && m_impulses == NULL)
 	{
 		return;
 	}
@@ -534,6 +829,14 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		if (m_impulses)
+		{
+			m_impulses[i] = impulse;
+		}
+		else
+		{
+			m_listener->PostSolve(c, &impulse);
+		}
 	}
 }
+
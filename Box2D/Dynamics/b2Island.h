@@ -27,15 +27,36 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2ContactImpulse;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
+/// The bodies, contacts and joints of an island gathered with other islands in
+/// a larger b2Island, see b2World::SolveRegions.
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+};
+
 /// This is an internal class.
 class b2Island
 {
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
 			b2StackAllocator* allocator, b2ContactListener* listener);
+
+	/// An island stored in a range of the arrays of islands. The bodies keep their
+	/// index in islands, which also holds the static bodies shared by the ranges.
+	/// Only the solvers allocate from the allocator, so ranges can be solved
+	/// concurrently with one allocator per thread. The impulses are stored in
+	/// islands->m_impulses, if any, instead of being reported.
+	b2Island(b2Island* islands, const b2IslandRange& range, b2StackAllocator* allocator);
+
 	~b2Island();
 
 	void Clear()
@@ -47,6 +68,9 @@ public:
 
 	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
+	/// Sub-stepping solver with soft contacts, used when step.subStepCount > 0.
+	void SolveSoft(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
+
 	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
 
 	void Add(b2Body* body)
@@ -71,9 +95,15 @@ public:
 
 	void Report(const b2ContactVelocityConstraint* constraints);
 
+	void UpdateSleep(float32 h, bool positionSolved);
+
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
 
+	// One per contact. When not NULL, Report stores the impulses here instead of
+	// calling the listener.
+	b2ContactImpulse* m_impulses;
+
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
 	b2Joint** m_joints;
@@ -88,6 +118,13 @@ public:
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
 	int32 m_jointCapacity;
+
+	// The index of m_bodies[0] in the position and velocity arrays seen by the
+	// solvers. Not 0 for a range.
+	int32 m_bodyOffset;
+
+	// Is this a range? The arrays then belong to the other island.
+	bool m_isRange;
 };
 
 #endif
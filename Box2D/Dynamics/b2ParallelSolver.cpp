@@ -0,0 +1,347 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2ParallelSolver.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
+#include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <Box2D/Dynamics/Joints/b2JointSolver.h>
+#include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2ThreadPool.h>
+
+#include <string.h>
+
+// Constraints of a color don't share a dynamic body, so their threads never write
+// the same body. They may write the velocity of a shared static or kinematic body,
+// but the solvers store it unchanged since it has no mass.
+
+// Constraints per range handed to a thread. Joint items are batches or joints.
+static const int32 b2_contactGrain = 32;
+static const int32 b2_jointGrain = 8;
+
+// Per thread results, padded to a cache line so that the threads don't share one.
+struct b2ParallelResult
+{
+	float32 maxImpulseDelta;
+	float32 minSeparation;
+	bool jointsOkay;
+	char padding[52];
+};
+
+static void b2GetBodies(b2Contact* contact, b2Body** bodyA, b2Body** bodyB)
+{
+	*bodyA = contact->GetFixtureA()->GetBody();
+	*bodyB = contact->GetFixtureB()->GetBody();
+}
+
+static void b2GetBodies(b2Joint* joint, b2Body** bodyA, b2Body** bodyB)
+{
+	*bodyA = joint->GetBodyA();
+	*bodyB = joint->GetBodyB();
+}
+
+static bool b2HasMoreBodies(b2Contact* contact)
+{
+	B2_NOT_USED(contact);
+	return false;
+}
+
+static bool b2HasMoreBodies(b2Joint* joint)
+{
+	// A gear joint also moves the bodies of its two joints.
+	return joint->GetType() == e_gearJoint;
+}
+
+// Colors the items greedily in island order, each one takes the first color free
+// on its dynamic bodies. Then sorts the items by color, keeping the island order
+// within a color. Returns the number of non empty colors.
+template <typename T>
+static int32 b2SortByColor(T** items, int32 count, int32 bodyCount, int32* offsets, bool* overflow, b2StackAllocator* allocator)
+{
+	uint32* bodyColors = (uint32*)allocator->Allocate(bodyCount * sizeof(uint32));
+	memset(bodyColors, 0, bodyCount * sizeof(uint32));
+	int32* itemColors = (int32*)allocator->Allocate(count * sizeof(int32));
+
+	int32 counts[b2_graphColorCount + 1];
+	memset(counts, 0, sizeof(counts));
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* bodyA;
+		b2Body* bodyB;
+		b2GetBodies(items[i], &bodyA, &bodyB);
+		int32 indexA = b2ParallelSolver::GetDynamicIndex(bodyA);
+		int32 indexB = b2ParallelSolver::GetDynamicIndex(bodyB);
+
+		uint32 used = 0;
+		if (indexA != -1)
+		{
+			used |= bodyColors[indexA];
+		}
+		if (indexB != -1)
+		{
+			used |= bodyColors[indexB];
+		}
+
+		int32 color = b2_graphColorCount;
+		if (b2HasMoreBodies(items[i]) == false)
+		{
+			color = 0;
+			while (color < b2_graphColorCount && (used & (1u << color)))
+			{
+				++color;
+			}
+		}
+
+		if (color < b2_graphColorCount)
+		{
+			if (indexA != -1)
+			{
+				bodyColors[indexA] |= 1u << color;
+			}
+			if (indexB != -1)
+			{
+				bodyColors[indexB] |= 1u << color;
+			}
+		}
+
+		itemColors[i] = color;
+		++counts[color];
+	}
+
+	int32 starts[b2_graphColorCount + 1];
+	int32 colorCount = 0;
+	int32 offset = 0;
+	for (int32 c = 0; c <= b2_graphColorCount; ++c)
+	{
+		starts[c] = offset;
+		if (counts[c] > 0)
+		{
+			offsets[colorCount++] = offset;
+			offset += counts[c];
+		}
+	}
+	offsets[colorCount] = offset;
+	*overflow = counts[b2_graphColorCount] > 0;
+
+	T** sorted = (T**)allocator->Allocate(count * sizeof(T*));
+	for (int32 i = 0; i < count; ++i)
+	{
+		sorted[starts[itemColors[i]]++] = items[i];
+	}
+	memcpy(items, sorted, count * sizeof(T*));
+
+	allocator->Free(sorted);
+	allocator->Free(itemColors);
+	allocator->Free(bodyColors);
+
+	return colorCount;
+}
+
+int32 b2ParallelSolver::GetDynamicIndex(const b2Body* body)
+{
+	return body->m_type == b2_dynamicBody ? body->m_islandIndex : -1;
+}
+
+b2ParallelSolver::b2ParallelSolver(b2ParallelSolverDef* def)
+{
+	m_threadPool = NULL;
+	m_allocator = def->allocator;
+	m_results = NULL;
+	m_contactColorCount = 0;
+	m_contactOverflow = false;
+	m_jointColorCount = 0;
+	m_jointOverflow = false;
+
+	if (def->threadPool == NULL || def->contactCount + def->jointCount < b2_minParallelConstraints)
+	{
+		return;
+	}
+
+	m_threadPool = def->threadPool;
+	m_results = (b2ParallelResult*)m_allocator->Allocate(m_threadPool->GetThreadCount() * sizeof(b2ParallelResult));
+
+	m_contactColorCount = b2SortByColor(def->contacts, def->contactCount, def->bodyCount,
+										m_contactColors, &m_contactOverflow, m_allocator);
+	m_jointColorCount = b2SortByColor(def->joints, def->jointCount, def->bodyCount,
+									  m_jointColors, &m_jointOverflow, m_allocator);
+}
+
+b2ParallelSolver::~b2ParallelSolver()
+{
+	if (m_results)
+	{
+		m_allocator->Free(m_results);
+	}
+}
+
+struct b2JointVelocityTask : public b2ParallelTask
+{
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+		jointSolver->SolveVelocityConstraints(*data, color, begin, end);
+	}
+
+	b2JointSolver* jointSolver;
+	const b2SolverData* data;
+	int32 color;
+};
+
+struct b2ContactVelocityTask : public b2ParallelTask
+{
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		float32 maxImpulseDelta = contactSolver->SolveVelocityConstraints(offset + begin, offset + end);
+		b2ParallelResult* result = results + threadIndex;
+		result->maxImpulseDelta = b2Max(result->maxImpulseDelta, maxImpulseDelta);
+	}
+
+	b2ContactSolver* contactSolver;
+	b2ParallelResult* results;
+	int32 offset;
+};
+
+struct b2ContactPositionTask : public b2ParallelTask
+{
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		float32 minSeparation = contactSolver->SolvePositionConstraints(offset + begin, offset + end);
+		b2ParallelResult* result = results + threadIndex;
+		result->minSeparation = b2Min(result->minSeparation, minSeparation);
+	}
+
+	b2ContactSolver* contactSolver;
+	b2ParallelResult* results;
+	int32 offset;
+};
+
+struct b2JointPositionTask : public b2ParallelTask
+{
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		bool jointsOkay = jointSolver->SolvePositionConstraints(*data, color, begin, end);
+		b2ParallelResult* result = results + threadIndex;
+		result->jointsOkay = result->jointsOkay && jointsOkay;
+	}
+
+	b2JointSolver* jointSolver;
+	const b2SolverData* data;
+	b2ParallelResult* results;
+	int32 color;
+};
+
+void b2ParallelSolver::SolveVelocityConstraints(b2JointSolver* jointSolver, const b2SolverData& data)
+{
+	b2JointVelocityTask task;
+	task.jointSolver = jointSolver;
+	task.data = &data;
+	for (int32 i = 0; i < m_jointColorCount; ++i)
+	{
+		int32 count = jointSolver->GetItemCount(i);
+		bool serial = m_jointOverflow && i == m_jointColorCount - 1;
+		task.color = i;
+		m_threadPool->ParallelFor(&task, count, serial ? count : b2_jointGrain);
+	}
+}
+
+float32 b2ParallelSolver::SolveVelocityConstraints(b2ContactSolver* contactSolver)
+{
+	int32 threadCount = m_threadPool->GetThreadCount();
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		m_results[i].maxImpulseDelta = 0.0f;
+	}
+
+	b2ContactVelocityTask task;
+	task.contactSolver = contactSolver;
+	task.results = m_results;
+	for (int32 i = 0; i < m_contactColorCount; ++i)
+	{
+		int32 count = m_contactColors[i + 1] - m_contactColors[i];
+		bool serial = m_contactOverflow && i == m_contactColorCount - 1;
+		task.offset = m_contactColors[i];
+		m_threadPool->ParallelFor(&task, count, serial ? count : b2_contactGrain);
+	}
+
+	float32 maxImpulseDelta = 0.0f;
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		maxImpulseDelta = b2Max(maxImpulseDelta, m_results[i].maxImpulseDelta);
+	}
+	return maxImpulseDelta;
+}
+
+bool b2ParallelSolver::SolvePositionConstraints(b2ContactSolver* contactSolver)
+{
+	int32 threadCount = m_threadPool->GetThreadCount();
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		m_results[i].minSeparation = 0.0f;
+	}
+
+	b2ContactPositionTask task;
+	task.contactSolver = contactSolver;
+	task.results = m_results;
+	for (int32 i = 0; i < m_contactColorCount; ++i)
+	{
+		int32 count = m_contactColors[i + 1] - m_contactColors[i];
+		bool serial = m_contactOverflow && i == m_contactColorCount - 1;
+		task.offset = m_contactColors[i];
+		m_threadPool->ParallelFor(&task, count, serial ? count : b2_contactGrain);
+	}
+
+	float32 minSeparation = 0.0f;
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		minSeparation = b2Min(minSeparation, m_results[i].minSeparation);
+	}
+
+	// Same tolerance as b2ContactSolver::SolvePositionConstraints.
+	return minSeparation >= -3.0f * b2_linearSlop;
+}
+
+bool b2ParallelSolver::SolvePositionConstraints(b2JointSolver* jointSolver, const b2SolverData& data)
+{
+	int32 threadCount = m_threadPool->GetThreadCount();
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		m_results[i].jointsOkay = true;
+	}
+
+	b2JointPositionTask task;
+	task.jointSolver = jointSolver;
+	task.data = &data;
+	task.results = m_results;
+	for (int32 i = 0; i < m_jointColorCount; ++i)
+	{
+		int32 count = jointSolver->GetItemCount(i);
+		bool serial = m_jointOverflow && i == m_jointColorCount - 1;
+		task.color = i;
+		m_threadPool->ParallelFor(&task, count, serial ? count : b2_jointGrain);
+	}
+
+	bool jointsOkay = true;
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		jointsOkay = jointsOkay && m_results[i].jointsOkay;
+	}
+	return jointsOkay;
+}
@@ -0,0 +1,90 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_PARALLEL_SOLVER_H
+#define B2_PARALLEL_SOLVER_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+
+class b2Body;
+class b2Contact;
+class b2Joint;
+class b2ContactSolver;
+class b2JointSolver;
+class b2StackAllocator;
+class b2ThreadPool;
+struct b2ParallelResult;
+
+struct b2ParallelSolverDef
+{
+	b2Contact** contacts;
+	int32 contactCount;
+	b2Joint** joints;
+	int32 jointCount;
+	int32 bodyCount;
+	b2ThreadPool* threadPool;
+	b2StackAllocator* allocator;
+};
+
+/// Solves the constraints of a large island on the threads of a pool. The contacts
+/// and the joints are colored so that the constraints of a color don't share a
+/// dynamic body. The colors are solved one after the other and the constraints of
+/// a color in parallel. The colors only depend on the island order, so the result
+/// is the same whatever the number of threads.
+class b2ParallelSolver
+{
+public:
+	/// Sort the contacts and the joints of the island by color, in place. Build the
+	/// contact and joint solvers afterward. Does nothing without a pool or when the
+	/// island has less than b2_minParallelConstraints constraints.
+	b2ParallelSolver(b2ParallelSolverDef* def);
+	~b2ParallelSolver();
+
+	/// Is the island solved in parallel?
+	bool IsActive() const { return m_threadPool != NULL; }
+
+	/// One sweep over the joint colors.
+	void SolveVelocityConstraints(b2JointSolver* jointSolver, const b2SolverData& data);
+
+	/// One sweep over the contact colors. Returns the largest change of an accumulated impulse.
+	float32 SolveVelocityConstraints(b2ContactSolver* contactSolver);
+
+	bool SolvePositionConstraints(b2ContactSolver* contactSolver);
+	bool SolvePositionConstraints(b2JointSolver* jointSolver, const b2SolverData& data);
+
+	// The island index of a dynamic body, -1 for the others.
+	static int32 GetDynamicIndex(const b2Body* body);
+
+	b2ThreadPool* m_threadPool;
+	b2StackAllocator* m_allocator;
+
+	// Per thread results.
+	b2ParallelResult* m_results;
+
+	// The offsets of the non empty colors. The last color is solved on one thread
+	// when it holds the constraints that got no color.
+	int32 m_contactColors[b2_graphColorCount + 2];
+	int32 m_contactColorCount;
+	bool m_contactOverflow;
+	int32 m_jointColors[b2_graphColorCount + 2];
+	int32 m_jointColorCount;
+	bool m_jointOverflow;
+};
+
+#endif
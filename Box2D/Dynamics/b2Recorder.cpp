@@ -0,0 +1,1122 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2Recorder.h>
+#include <Box2D/Dynamics/b2Scene.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
+#include <Box2D/Dynamics/Joints/b2GearJoint.h>
+#include <Box2D/Dynamics/Joints/b2MouseJoint.h>
+#include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
+#include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Dynamics/Joints/b2WheelJoint.h>
+#include <cstring>
+
+// The body flags that only live during a step.
+#define b2_transientBodyFlags	(b2Body::e_islandFlag | b2Body::e_toiFlag)
+
+// The number of float arguments of a joint setter.
+static int32 b2GetJointArgCount(int32 op)
+{
+	return (op == b2_recordSetLimits || op == b2_recordSetTarget) ? 2 : 1;
+}
+
+// The index of a fixture in its body list.
+static int32 b2GetFixtureIndex(const b2Fixture* fixture)
+{
+	int32 index = 0;
+	for (const b2Fixture* f = fixture->GetBody()->GetFixtureList(); f != fixture; f = f->GetNext())
+	{
+		++index;
+	}
+	return index;
+}
+
+b2Recorder::b2Recorder(b2World* world)
+{
+	b2Assert(world->m_recorder == NULL);
+	b2Assert(world->IsLocked() == false);
+
+	m_world = world;
+	m_data = NULL;
+	m_size = 0;
+	m_capacity = 0;
+	m_states = NULL;
+	m_stateCapacity = 0;
+	m_bodyIdCount = 0;
+	m_jointIdCount = 0;
+	m_stepCount = 0;
+	m_loading = false;
+
+	uint32 header[2] = {b2_recordMagic, b2_recordVersion};
+	Write(header, sizeof(header));
+
+	GetSettings(&m_settings);
+	WriteOp(b2_recordSettings);
+	Write(&m_settings, sizeof(b2RecordSettings));
+
+	// Record the bodies, their fixtures and the joints in creation order, the
+	// reverse of the lists.
+	int32 count = b2Max(world->m_bodyCount, world->m_jointCount);
+	void** items = (void**)b2Alloc(b2Max(count, 1) * sizeof(void*));
+
+	count = 0;
+	for (b2Body* b = world->m_bodyList; b; b = b->m_next)
+	{
+		items[count++] = b;
+	}
+
+	while (count > 0)
+	{
+		b2Body* b = (b2Body*)items[--count];
+		RecordCreateBody(b);
+
+		b2Fixture** fixtures = (b2Fixture**)b2Alloc(b2Max(b->m_fixtureCount, 1) * sizeof(b2Fixture*));
+		int32 fixtureCount = 0;
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			fixtures[fixtureCount++] = f;
+		}
+		while (fixtureCount > 0)
+		{
+			RecordCreateFixture(fixtures[--fixtureCount]);
+		}
+		b2Free(fixtures);
+	}
+
+	for (b2Joint* j = world->m_jointList; j; j = j->m_next)
+	{
+		items[count++] = j;
+	}
+
+	while (count > 0)
+	{
+		RecordCreateJoint((b2Joint*)items[--count], NULL);
+	}
+
+	b2Free(items);
+
+	world->m_recorder = this;
+}
+
+b2Recorder::~b2Recorder()
+{
+	m_world->m_recorder = NULL;
+	b2Free(m_data);
+	b2Free(m_states);
+}
+
+uint32 b2Recorder::ComputeHash(const b2World* world)
+{
+	// FNV-1a over the bits of the positions and velocities.
+	uint32 hash = 2166136261U;
+	for (const b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		float32 values[6] = {b->m_xf.p.x, b->m_xf.p.y, b->m_sweep.a,
+			b->m_linearVelocity.x, b->m_linearVelocity.y, b->m_angularVelocity};
+		const unsigned char* bytes = (const unsigned char*)values;
+		for (int32 i = 0; i < (int32)sizeof(values); ++i)
+		{
+			hash = (hash ^ bytes[i]) * 16777619U;
+		}
+	}
+	return hash;
+}
+
+void b2Recorder::Write(const void* data, int32 size)
+{
+	if (m_size + size > m_capacity)
+	{
+		int32 capacity = b2Max(2 * m_capacity, m_size + size);
+		capacity = b2Max(capacity, 4096);
+		char* newData = (char*)b2Alloc(capacity);
+		if (m_data)
+		{
+			memcpy(newData, m_data, m_size);
+			b2Free(m_data);
+		}
+		m_data = newData;
+		m_capacity = capacity;
+	}
+
+	memcpy(m_data + m_size, data, size);
+	m_size += size;
+}
+
+void b2Recorder::WriteOp(int32 op)
+{
+	uint8 byte = (uint8)op;
+	Write(&byte, 1);
+}
+
+void b2Recorder::WriteIndex(int32 index)
+{
+	// 7 bits per byte, most indices take one.
+	b2Assert(index >= 0);
+	uint32 value = (uint32)index;
+	uint8 bytes[5];
+	int32 count = 0;
+	while (value >= 0x80)
+	{
+		bytes[count++] = (uint8)(value | 0x80);
+		value >>= 7;
+	}
+	bytes[count++] = (uint8)value;
+	Write(bytes, count);
+}
+
+void b2Recorder::WriteFloat(float32 x)
+{
+	Write(&x, sizeof(float32));
+}
+
+void b2Recorder::WriteFixture(b2Fixture* fixture)
+{
+	int32 polygonCount = 0;
+	int32 vertexCount = 0;
+	b2CountFixture(fixture, &polygonCount, &vertexCount);
+
+	b2ScenePolygon* polygons = (b2ScenePolygon*)b2Alloc(b2Max(polygonCount, 1) * sizeof(b2ScenePolygon));
+	b2Vec2* vertices = (b2Vec2*)b2Alloc(b2Max(vertexCount, 1) * sizeof(b2Vec2));
+
+	b2SceneFixture record;
+	memset((void*)&record, 0, sizeof(b2SceneFixture));
+	polygonCount = 0;
+	vertexCount = 0;
+	b2SaveFixture(&record, fixture, polygons, &polygonCount, vertices, &vertexCount);
+
+	Write(&record, sizeof(b2SceneFixture));
+	WriteIndex(polygonCount);
+	Write(polygons, polygonCount * sizeof(b2ScenePolygon));
+	WriteIndex(vertexCount);
+	Write(vertices, vertexCount * sizeof(b2Vec2));
+
+	b2Free(vertices);
+	b2Free(polygons);
+}
+
+void b2Recorder::GrowStates(int32 count)
+{
+	if (count <= m_stateCapacity)
+	{
+		return;
+	}
+
+	int32 capacity = b2Max(2 * m_stateCapacity, count);
+	capacity = b2Max(capacity, 64);
+	b2RecordBodyState* states = (b2RecordBodyState*)b2Alloc(capacity * sizeof(b2RecordBodyState));
+	if (m_states)
+	{
+		memcpy(states, m_states, m_stateCapacity * sizeof(b2RecordBodyState));
+		b2Free(m_states);
+	}
+	m_states = states;
+	m_stateCapacity = capacity;
+}
+
+void b2Recorder::GetSettings(b2RecordSettings* settings) const
+{
+	const b2World* w = m_world;
+	settings->gravity = w->m_gravity;
+	settings->inv_dt0 = w->m_inv_dt0;
+	settings->velocityTolerance = w->m_velocityTolerance;
+	settings->minVelocityIterations = w->m_minVelocityIterations;
+	settings->softSubSteps = w->m_softSubSteps;
+	settings->allowSleep = w->m_allowSleep;
+	settings->warmStarting = w->m_warmStarting;
+	settings->continuousPhysics = w->m_continuousPhysics;
+	settings->subStepping = w->m_subStepping;
+	settings->speculativeContacts = w->m_speculativeContacts;
+	settings->adaptiveMargins = w->m_adaptiveMargins;
+	settings->autoClearForces = w->GetAutoClearForces();
+	settings->stepComplete = w->m_stepComplete;
+}
+
+void b2Recorder::GetBodyState(b2RecordBodyState* state, const b2Body* body)
+{
+	state->pose.xf = body->m_xf;
+	state->pose.sweep = body->m_sweep;
+	state->pose.position0 = body->m_position0;
+	state->pose.angle0 = body->m_angle0;
+	state->velocity.v = body->m_linearVelocity;
+	state->velocity.w = body->m_angularVelocity;
+	state->force.force = body->m_force;
+	state->force.torque = body->m_torque;
+	state->flags.type = body->m_type;
+	state->flags.flags = body->m_flags & ~b2_transientBodyFlags;
+	state->flags.sleepTime = body->m_sleepTime;
+	state->mass.mass = body->m_mass;
+	state->mass.invMass = body->m_invMass;
+	state->mass.I = body->m_I;
+	state->mass.invI = body->m_invI;
+	state->damping.linearDamping = body->m_linearDamping;
+	state->damping.angularDamping = body->m_angularDamping;
+	state->damping.gravityScale = body->m_gravityScale;
+}
+
+void b2Recorder::RecordCreateBody(b2Body* body)
+{
+	body->m_recordId = m_bodyIdCount++;
+	GrowStates(m_bodyIdCount);
+	m_states[body->m_recordId].dirty = true;
+
+	if (m_loading)
+	{
+		return;
+	}
+
+	b2SceneBody record;
+	memset((void*)&record, 0, sizeof(b2SceneBody));
+	b2SaveBody(&record, body, true);
+
+	WriteOp(b2_recordCreateBody);
+	Write(&record, sizeof(b2SceneBody));
+}
+
+void b2Recorder::RecordDestroyBody(int32 id)
+{
+	WriteOp(b2_recordDestroyBody);
+	WriteIndex(id);
+}
+
+void b2Recorder::RecordCreateFixture(b2Fixture* fixture)
+{
+	if (m_loading)
+	{
+		return;
+	}
+
+	WriteOp(b2_recordCreateFixture);
+	WriteIndex(fixture->m_body->m_recordId);
+	WriteFixture(fixture);
+}
+
+void b2Recorder::RecordDestroyFixture(b2Fixture* fixture)
+{
+	WriteOp(b2_recordDestroyFixture);
+	WriteIndex(fixture->m_body->m_recordId);
+	WriteIndex(b2GetFixtureIndex(fixture));
+}
+
+void b2Recorder::RecordCreateJoint(b2Joint* joint, const b2JointDef* def)
+{
+	joint->m_recordId = m_jointIdCount++;
+
+	if (m_loading)
+	{
+		return;
+	}
+
+	// Keep the values of the definition when there is one, reading them back
+	// from the joint may round them.
+	b2SceneJoint record;
+	memset((void*)&record, 0, sizeof(b2SceneJoint));
+	if (def)
+	{
+		b2SaveJointDef(&record, def);
+	}
+	else
+	{
+		b2SaveJoint(&record, joint);
+	}
+
+	record.bodyA = joint->m_bodyA->m_recordId;
+	record.bodyB = joint->m_bodyB->m_recordId;
+	if (joint->m_type == e_gearJoint)
+	{
+		b2GearJointDef gearDef;
+		((b2GearJoint*)joint)->GetDef(&gearDef);
+		record.joint1 = gearDef.joint1->m_recordId;
+		record.joint2 = gearDef.joint2->m_recordId;
+	}
+
+	WriteOp(b2_recordCreateJoint);
+	Write(&record, sizeof(b2SceneJoint));
+}
+
+void b2Recorder::RecordDestroyJoint(b2Joint* joint)
+{
+	WriteOp(b2_recordDestroyJoint);
+	WriteIndex(joint->m_recordId);
+}
+
+void b2Recorder::RecordSetTransform(b2Body* body, const b2Vec2& position, float32 angle)
+{
+	WriteOp(b2_recordSetTransform);
+	WriteIndex(body->m_recordId);
+	WriteFloat(position.x);
+	WriteFloat(position.y);
+	WriteFloat(angle);
+}
+
+void b2Recorder::RecordSetType(b2Body* body, int32 type)
+{
+	WriteOp(b2_recordSetType);
+	WriteIndex(body->m_recordId);
+	WriteIndex(type);
+}
+
+void b2Recorder::RecordSetActive(b2Body* body, bool flag)
+{
+	WriteOp(b2_recordSetActive);
+	WriteIndex(body->m_recordId);
+	WriteIndex(flag ? 1 : 0);
+}
+
+void b2Recorder::RecordSetSensor(b2Fixture* fixture, bool flag)
+{
+	WriteOp(b2_recordSetSensor);
+	WriteIndex(fixture->m_body->m_recordId);
+	WriteIndex(b2GetFixtureIndex(fixture));
+	WriteIndex(flag ? 1 : 0);
+}
+
+void b2Recorder::RecordSetFilterData(b2Fixture* fixture, const b2Filter& filter)
+{
+	WriteOp(b2_recordSetFilterData);
+	WriteIndex(fixture->m_body->m_recordId);
+	WriteIndex(b2GetFixtureIndex(fixture));
+	Write(&filter, sizeof(b2Filter));
+}
+
+void b2Recorder::RecordJoint(int32 op, b2Joint* joint, float32 a, float32 b)
+{
+	if (m_loading)
+	{
+		return;
+	}
+
+	WriteOp(op);
+	WriteIndex(joint->m_recordId);
+	WriteFloat(a);
+	if (b2GetJointArgCount(op) == 2)
+	{
+		WriteFloat(b);
+	}
+}
+
+void b2Recorder::BeginLoad(const void* data, int32 size)
+{
+	WriteOp(b2_recordLoad);
+	WriteIndex(size);
+	Write(data, size);
+	m_loading = true;
+}
+
+void b2Recorder::EndLoad()
+{
+	m_loading = false;
+}
+
+void b2Recorder::BeginStep(float32 dt, int32 velocityIterations, int32 positionIterations)
+{
+	b2RecordSettings settings;
+	GetSettings(&settings);
+	if (memcmp(&settings, &m_settings, sizeof(b2RecordSettings)) != 0)
+	{
+		m_settings = settings;
+		WriteOp(b2_recordSettings);
+		Write(&m_settings, sizeof(b2RecordSettings));
+	}
+
+	// Write the parts of the bodies changed since the last step.
+	for (b2Body* b = m_world->m_bodyList; b; b = b->m_next)
+	{
+		b2RecordBodyState* last = m_states + b->m_recordId;
+		b2RecordBodyState state;
+		GetBodyState(&state, b);
+
+		int32 mask = b2RecordBodyState::e_all;
+		if (last->dirty == false)
+		{
+			mask = 0;
+			mask |= memcmp(&state.pose, &last->pose, sizeof(state.pose)) ? b2RecordBodyState::e_pose : 0;
+			mask |= memcmp(&state.velocity, &last->velocity, sizeof(state.velocity)) ? b2RecordBodyState::e_velocity : 0;
+			mask |= memcmp(&state.force, &last->force, sizeof(state.force)) ? b2RecordBodyState::e_force : 0;
+			mask |= memcmp(&state.flags, &last->flags, sizeof(state.flags)) ? b2RecordBodyState::e_flags : 0;
+			mask |= memcmp(&state.mass, &last->mass, sizeof(state.mass)) ? b2RecordBodyState::e_mass : 0;
+			mask |= memcmp(&state.damping, &last->damping, sizeof(state.damping)) ? b2RecordBodyState::e_damping : 0;
+		}
+
+		if (mask == 0)
+		{
+			continue;
+		}
+
+		WriteOp(b2_recordBodyState);
+		WriteIndex(b->m_recordId);
+		WriteIndex(mask);
+		if (mask & b2RecordBodyState::e_pose) Write(&state.pose, sizeof(state.pose));
+		if (mask & b2RecordBodyState::e_velocity) Write(&state.velocity, sizeof(state.velocity));
+		if (mask & b2RecordBodyState::e_force) Write(&state.force, sizeof(state.force));
+		if (mask & b2RecordBodyState::e_flags) Write(&state.flags, sizeof(state.flags));
+		if (mask & b2RecordBodyState::e_mass) Write(&state.mass, sizeof(state.mass));
+		if (mask & b2RecordBodyState::e_damping) Write(&state.damping, sizeof(state.damping));
+	}
+
+	WriteOp(b2_recordStep);
+	WriteFloat(dt);
+	WriteIndex(velocityIterations);
+	WriteIndex(positionIterations);
+}
+
+void b2Recorder::EndStep()
+{
+	for (b2Body* b = m_world->m_bodyList; b; b = b->m_next)
+	{
+		b2RecordBodyState* state = m_states + b->m_recordId;
+		GetBodyState(state, b);
+		state->dirty = false;
+	}
+
+	GetSettings(&m_settings);
+	++m_stepCount;
+
+	uint32 hash = ComputeHash(m_world);
+	WriteOp(b2_recordHash);
+	Write(&hash, sizeof(uint32));
+}
+
+b2Replayer::b2Replayer(b2World* world, const void* data, int32 size)
+{
+	m_world = world;
+	m_data = (const char*)data;
+	m_size = size;
+	m_offset = 0;
+
+	m_bodies = NULL;
+	m_bodyCount = 0;
+	m_bodyCapacity = 0;
+	m_joints = NULL;
+	m_jointCount = 0;
+	m_jointCapacity = 0;
+
+	m_stepCount = 0;
+	m_diverged = false;
+	m_error = false;
+
+	uint32 header[2];
+	if (Read(header, sizeof(header)) == false || header[0] != b2_recordMagic || header[1] != b2_recordVersion)
+	{
+		m_error = true;
+	}
+}
+
+b2Replayer::~b2Replayer()
+{
+	b2Free(m_bodies);
+	b2Free(m_joints);
+}
+
+b2Body* b2Replayer::GetBody(int32 id)
+{
+	return (0 <= id && id < m_bodyCount) ? m_bodies[id] : NULL;
+}
+
+b2Joint* b2Replayer::GetJoint(int32 id)
+{
+	return (0 <= id && id < m_jointCount) ? m_joints[id] : NULL;
+}
+
+bool b2Replayer::Read(void* data, int32 size)
+{
+	if (size < 0 || size > m_size - m_offset)
+	{
+		return false;
+	}
+
+	memcpy(data, m_data + m_offset, size);
+	m_offset += size;
+	return true;
+}
+
+bool b2Replayer::ReadIndex(int32* index)
+{
+	uint32 value = 0;
+	for (int32 shift = 0; shift < 35; shift += 7)
+	{
+		uint8 byte;
+		if (Read(&byte, 1) == false)
+		{
+			return false;
+		}
+
+		value |= (uint32)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			*index = (int32)value;
+			return *index >= 0;
+		}
+	}
+	return false;
+}
+
+bool b2Replayer::ReadFloat(float32* x)
+{
+	return Read(x, sizeof(float32));
+}
+
+b2Body* b2Replayer::ReadBody()
+{
+	int32 id;
+	if (ReadIndex(&id) == false)
+	{
+		return NULL;
+	}
+	return GetBody(id);
+}
+
+b2Fixture* b2Replayer::ReadFixture()
+{
+	b2Body* body = ReadBody();
+	int32 index;
+	if (body == NULL || ReadIndex(&index) == false)
+	{
+		return NULL;
+	}
+
+	b2Fixture* f = body->GetFixtureList();
+	while (f && index > 0)
+	{
+		f = f->GetNext();
+		--index;
+	}
+	return f;
+}
+
+b2Joint* b2Replayer::ReadJoint()
+{
+	int32 id;
+	if (ReadIndex(&id) == false)
+	{
+		return NULL;
+	}
+	return GetJoint(id);
+}
+
+void b2Replayer::AddBody(b2Body* body)
+{
+	if (m_bodyCount == m_bodyCapacity)
+	{
+		m_bodyCapacity = b2Max(2 * m_bodyCapacity, 64);
+		b2Body** bodies = (b2Body**)b2Alloc(m_bodyCapacity * sizeof(b2Body*));
+		if (m_bodies)
+		{
+			memcpy(bodies, m_bodies, m_bodyCount * sizeof(b2Body*));
+			b2Free(m_bodies);
+		}
+		m_bodies = bodies;
+	}
+	m_bodies[m_bodyCount++] = body;
+}
+
+void b2Replayer::AddJoint(b2Joint* joint)
+{
+	if (m_jointCount == m_jointCapacity)
+	{
+		m_jointCapacity = b2Max(2 * m_jointCapacity, 16);
+		b2Joint** joints = (b2Joint**)b2Alloc(m_jointCapacity * sizeof(b2Joint*));
+		if (m_joints)
+		{
+			memcpy(joints, m_joints, m_jointCount * sizeof(b2Joint*));
+			b2Free(m_joints);
+		}
+		m_joints = joints;
+	}
+	m_joints[m_jointCount++] = joint;
+}
+
+void b2Replayer::SetSettings(const b2RecordSettings& settings)
+{
+	b2World* w = m_world;
+	w->m_gravity = settings.gravity;
+	w->m_inv_dt0 = settings.inv_dt0;
+	w->m_velocityTolerance = settings.velocityTolerance;
+	w->m_minVelocityIterations = settings.minVelocityIterations;
+	w->m_softSubSteps = settings.softSubSteps;
+	w->m_allowSleep = settings.allowSleep != 0;
+	w->m_warmStarting = settings.warmStarting != 0;
+	w->m_continuousPhysics = settings.continuousPhysics != 0;
+	w->m_subStepping = settings.subStepping != 0;
+	w->m_speculativeContacts = settings.speculativeContacts != 0;
+	if (w->m_adaptiveMargins != (settings.adaptiveMargins != 0))
+	{
+		w->SetAdaptiveMargins(settings.adaptiveMargins != 0);
+	}
+	w->SetAutoClearForces(settings.autoClearForces != 0);
+	w->m_stepComplete = settings.stepComplete != 0;
+}
+
+void b2Replayer::SetBodyState(b2Body* body, const b2RecordBodyState& state, int32 mask)
+{
+	if (mask & b2RecordBodyState::e_pose)
+	{
+		body->m_xf = state.pose.xf;
+		body->m_sweep = state.pose.sweep;
+		body->m_position0 = state.pose.position0;
+		body->m_angle0 = state.pose.angle0;
+	}
+
+	if (mask & b2RecordBodyState::e_velocity)
+	{
+		body->m_linearVelocity = state.velocity.v;
+		body->m_angularVelocity = state.velocity.w;
+	}
+
+	if (mask & b2RecordBodyState::e_force)
+	{
+		body->m_force = state.force.force;
+		body->m_torque = state.force.torque;
+	}
+
+	if (mask & b2RecordBodyState::e_flags)
+	{
+		body->m_type = (b2BodyType)state.flags.type;
+		body->m_flags = (uint16)((body->m_flags & b2_transientBodyFlags) | (state.flags.flags & ~b2_transientBodyFlags));
+		body->m_sleepTime = state.flags.sleepTime;
+	}
+
+	if (mask & b2RecordBodyState::e_mass)
+	{
+		body->m_mass = state.mass.mass;
+		body->m_invMass = state.mass.invMass;
+		body->m_I = state.mass.I;
+		body->m_invI = state.mass.invI;
+	}
+
+	if (mask & b2RecordBodyState::e_damping)
+	{
+		body->m_linearDamping = state.damping.linearDamping;
+		body->m_angularDamping = state.damping.angularDamping;
+		body->m_gravityScale = state.damping.gravityScale;
+	}
+}
+
+bool b2Replayer::Apply(int32 op)
+{
+	switch (op)
+	{
+	case b2_recordSettings:
+		{
+			b2RecordSettings settings;
+			if (Read(&settings, sizeof(b2RecordSettings)) == false)
+			{
+				return false;
+			}
+			SetSettings(settings);
+		}
+		return true;
+
+	case b2_recordLoad:
+		{
+			// Copy the scene to align it.
+			int32 size;
+			if (ReadIndex(&size) == false || size < (int32)sizeof(b2SceneHeader) || size > m_size - m_offset)
+			{
+				return false;
+			}
+
+			void* scene = b2Alloc(size);
+			Read(scene, size);
+
+			const b2SceneHeader* header = (const b2SceneHeader*)scene;
+			int32 bodyCount = header->bodyCount;
+			int32 jointCount = header->jointCount;
+			b2Body** bodies = NULL;
+			bool ok = 0 <= bodyCount && bodyCount <= size && 0 <= jointCount && jointCount <= size;
+			if (ok)
+			{
+				bodies = (b2Body**)b2Alloc(b2Max(bodyCount, 1) * sizeof(b2Body*));
+				ok = m_world->Load(scene, size, bodies);
+			}
+
+			if (ok)
+			{
+				for (int32 i = 0; i < bodyCount; ++i)
+				{
+					AddBody(bodies[i]);
+				}
+
+				// The new joints are at the head of the list, last created first.
+				b2Joint* j = m_world->GetJointList();
+				for (int32 i = 0; i < jointCount - 1; ++i)
+				{
+					j = j->GetNext();
+				}
+				for (int32 i = 0; i < jointCount; ++i)
+				{
+					AddJoint(j);
+					j = j->m_prev;
+				}
+			}
+
+			b2Free(bodies);
+			b2Free(scene);
+			return ok;
+		}
+
+	case b2_recordCreateBody:
+		{
+			b2SceneBody record;
+			if (Read(&record, sizeof(b2SceneBody)) == false ||
+				record.type < b2_staticBody || record.type > b2_dynamicBody)
+			{
+				return false;
+			}
+			AddBody(b2LoadBody(m_world, &record));
+		}
+		return true;
+
+	case b2_recordDestroyBody:
+		{
+			int32 id;
+			if (ReadIndex(&id) == false || GetBody(id) == NULL)
+			{
+				return false;
+			}
+			m_world->DestroyBody(m_bodies[id]);
+			m_bodies[id] = NULL;
+		}
+		return true;
+
+	case b2_recordCreateFixture:
+		{
+			b2Body* body = ReadBody();
+			b2SceneFixture record;
+			int32 polygonCount, vertexCount;
+			if (body == NULL || Read(&record, sizeof(b2SceneFixture)) == false ||
+				ReadIndex(&polygonCount) == false || polygonCount > m_size)
+			{
+				return false;
+			}
+
+			b2ScenePolygon* polygons = (b2ScenePolygon*)b2Alloc(b2Max(polygonCount, 1) * sizeof(b2ScenePolygon));
+			b2Vec2* vertices = NULL;
+			bool ok = Read(polygons, polygonCount * sizeof(b2ScenePolygon)) &&
+				ReadIndex(&vertexCount) && vertexCount <= m_size;
+			if (ok)
+			{
+				vertices = (b2Vec2*)b2Alloc(b2Max(vertexCount, 1) * sizeof(b2Vec2));
+				ok = Read(vertices, vertexCount * sizeof(b2Vec2)) &&
+					b2IsValidFixture(&record, polygons, polygonCount, vertexCount);
+			}
+
+			if (ok)
+			{
+				b2LoadFixture(body, &record, polygons, vertices);
+			}
+
+			b2Free(vertices);
+			b2Free(polygons);
+			return ok;
+		}
+
+	case b2_recordDestroyFixture:
+		{
+			b2Fixture* fixture = ReadFixture();
+			if (fixture == NULL)
+			{
+				return false;
+			}
+			fixture->GetBody()->DestroyFixture(fixture);
+		}
+		return true;
+
+	case b2_recordCreateJoint:
+		{
+			b2SceneJoint record;
+			if (Read(&record, sizeof(b2SceneJoint)) == false ||
+				GetBody(record.bodyA) == NULL || GetBody(record.bodyB) == NULL ||
+				record.bodyA == record.bodyB || record.type <= e_unknownJoint || record.type > e_ropeJoint)
+			{
+				return false;
+			}
+
+			if (record.type == e_gearJoint)
+			{
+				b2Joint* joint1 = GetJoint(record.joint1);
+				b2Joint* joint2 = GetJoint(record.joint2);
+				if (joint1 == NULL || joint2 == NULL ||
+					(joint1->GetType() != e_revoluteJoint && joint1->GetType() != e_prismaticJoint) ||
+					(joint2->GetType() != e_revoluteJoint && joint2->GetType() != e_prismaticJoint))
+				{
+					return false;
+				}
+			}
+
+			AddJoint(b2LoadJoint(m_world, &record, m_bodies, m_joints));
+		}
+		return true;
+
+	case b2_recordDestroyJoint:
+		{
+			int32 id;
+			if (ReadIndex(&id) == false || GetJoint(id) == NULL)
+			{
+				return false;
+			}
+			m_world->DestroyJoint(m_joints[id]);
+			m_joints[id] = NULL;
+		}
+		return true;
+
+	case b2_recordBodyState:
+		{
+			b2Body* body = ReadBody();
+			int32 mask;
+			if (body == NULL || ReadIndex(&mask) == false)
+			{
+				return false;
+			}
+
+			b2RecordBodyState state;
+			bool ok = true;
+			if (mask & b2RecordBodyState::e_pose) ok = ok && Read(&state.pose, sizeof(state.pose));
+			if (mask & b2RecordBodyState::e_velocity) ok = ok && Read(&state.velocity, sizeof(state.velocity));
+			if (mask & b2RecordBodyState::e_force) ok = ok && Read(&state.force, sizeof(state.force));
+			if (mask & b2RecordBodyState::e_flags) ok = ok && Read(&state.flags, sizeof(state.flags));
+			if (mask & b2RecordBodyState::e_mass) ok = ok && Read(&state.mass, sizeof(state.mass));
+			if (mask & b2RecordBodyState::e_damping) ok = ok && Read(&state.damping, sizeof(state.damping));
+			if (ok == false || ((mask & b2RecordBodyState::e_flags) &&
+				(state.flags.type < b2_staticBody || state.flags.type > b2_dynamicBody)))
+			{
+				return false;
+			}
+			SetBodyState(body, state, mask);
+		}
+		return true;
+
+	case b2_recordSetTransform:
+		{
+			b2Body* body = ReadBody();
+			b2Vec2 position;
+			float32 angle;
+			if (body == NULL || ReadFloat(&position.x) == false || ReadFloat(&position.y) == false ||
+				ReadFloat(&angle) == false)
+			{
+				return false;
+			}
+			body->SetTransform(position, angle);
+		}
+		return true;
+
+	case b2_recordSetType:
+		{
+			b2Body* body = ReadBody();
+			int32 type;
+			if (body == NULL || ReadIndex(&type) == false || type > b2_dynamicBody)
+			{
+				return false;
+			}
+			body->SetType((b2BodyType)type);
+		}
+		return true;
+
+	case b2_recordSetActive:
+		{
+			b2Body* body = ReadBody();
+			int32 flag;
+			if (body == NULL || ReadIndex(&flag) == false)
+			{
+				return false;
+			}
+			body->SetActive(flag != 0);
+		}
+		return true;
+
+	case b2_recordSetSensor:
+		{
+			b2Fixture* fixture = ReadFixture();
+			int32 flag;
+			if (fixture == NULL || ReadIndex(&flag) == false)
+			{
+				return false;
+			}
+			fixture->SetSensor(flag != 0);
+		}
+		return true;
+
+	case b2_recordSetFilterData:
+		{
+			b2Fixture* fixture = ReadFixture();
+			b2Filter filter;
+			if (fixture == NULL || Read(&filter, sizeof(b2Filter)) == false)
+			{
+				return false;
+			}
+			fixture->SetFilterData(filter);
+		}
+		return true;
+
+	case b2_recordEnableLimit:
+	case b2_recordSetLimits:
+	case b2_recordEnableMotor:
+	case b2_recordSetMotorSpeed:
+	case b2_recordSetMaxMotor:
+	case b2_recordSetTarget:
+	case b2_recordSetMaxForce:
+	case b2_recordSetMaxTorque:
+	case b2_recordSetFrequency:
+	case b2_recordSetDampingRatio:
+	case b2_recordSetRatio:
+		{
+			b2Joint* joint = ReadJoint();
+			float32 a, b = 0.0f;
+			if (joint == NULL || ReadFloat(&a) == false ||
+				(b2GetJointArgCount(op) == 2 && ReadFloat(&b) == false))
+			{
+				return false;
+			}
+
+			b2JointType type = joint->GetType();
+			switch (op)
+			{
+			case b2_recordEnableLimit:
+				if (type == e_revoluteJoint) ((b2RevoluteJoint*)joint)->EnableLimit(a != 0.0f);
+				else if (type == e_prismaticJoint) ((b2PrismaticJoint*)joint)->EnableLimit(a != 0.0f);
+				else return false;
+				break;
+
+			case b2_recordSetLimits:
+				if (type == e_revoluteJoint) ((b2RevoluteJoint*)joint)->SetLimits(a, b);
+				else if (type == e_prismaticJoint) ((b2PrismaticJoint*)joint)->SetLimits(a, b);
+				else return false;
+				break;
+
+			case b2_recordEnableMotor:
+				if (type == e_revoluteJoint) ((b2RevoluteJoint*)joint)->EnableMotor(a != 0.0f);
+				else if (type == e_prismaticJoint) ((b2PrismaticJoint*)joint)->EnableMotor(a != 0.0f);
+				else if (type == e_wheelJoint) ((b2WheelJoint*)joint)->EnableMotor(a != 0.0f);
+				else return false;
+				break;
+
+			case b2_recordSetMotorSpeed:
+				if (type == e_revoluteJoint) ((b2RevoluteJoint*)joint)->SetMotorSpeed(a);
+				else if (type == e_prismaticJoint) ((b2PrismaticJoint*)joint)->SetMotorSpeed(a);
+				else if (type == e_wheelJoint) ((b2WheelJoint*)joint)->SetMotorSpeed(a);
+				else return false;
+				break;
+
+			case b2_recordSetMaxMotor:
+				if (type == e_revoluteJoint) ((b2RevoluteJoint*)joint)->SetMaxMotorTorque(a);
+				else if (type == e_prismaticJoint) ((b2PrismaticJoint*)joint)->SetMaxMotorForce(a);
+				else if (type == e_wheelJoint) ((b2WheelJoint*)joint)->SetMaxMotorTorque(a);
+				else return false;
+				break;
+
+			case b2_recordSetTarget:
+				if (type != e_mouseJoint) return false;
+				((b2MouseJoint*)joint)->SetTarget(b2Vec2(a, b));
+				break;
+
+			case b2_recordSetMaxForce:
+				if (type == e_mouseJoint) ((b2MouseJoint*)joint)->SetMaxForce(a);
+				else if (type == e_frictionJoint) ((b2FrictionJoint*)joint)->SetMaxForce(a);
+				else return false;
+				break;
+
+			case b2_recordSetMaxTorque:
+				if (type != e_frictionJoint) return false;
+				((b2FrictionJoint*)joint)->SetMaxTorque(a);
+				break;
+
+			case b2_recordSetFrequency:
+				if (type != e_mouseJoint) return false;
+				((b2MouseJoint*)joint)->SetFrequency(a);
+				break;
+
+			case b2_recordSetDampingRatio:
+				if (type != e_mouseJoint) return false;
+				((b2MouseJoint*)joint)->SetDampingRatio(a);
+				break;
+
+			case b2_recordSetRatio:
+				if (type != e_gearJoint) return false;
+				((b2GearJoint*)joint)->SetRatio(a);
+				break;
+			}
+		}
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+bool b2Replayer::Step()
+{
+	if (m_error || m_diverged)
+	{
+		return false;
+	}
+
+	for (;;)
+	{
+		uint8 op;
+		if (Read(&op, 1) == false)
+		{
+			// The end of the stream.
+			return false;
+		}
+
+		if (op != b2_recordStep)
+		{
+			if (Apply(op) == false)
+			{
+				m_error = true;
+				return false;
+			}
+			continue;
+		}
+
+		float32 dt;
+		int32 velocityIterations, positionIterations;
+		uint8 hashOp;
+		uint32 hash;
+		if (ReadFloat(&dt) == false || ReadIndex(&velocityIterations) == false ||
+			ReadIndex(&positionIterations) == false)
+		{
+			m_error = true;
+			return false;
+		}
+
+		m_world->Step(dt, velocityIterations, positionIterations);
+		++m_stepCount;
+
+		if (Read(&hashOp, 1) == false || hashOp != b2_recordHash || Read(&hash, sizeof(uint32)) == false)
+		{
+			m_error = true;
+			return false;
+		}
+
+		m_diverged = hash != b2Recorder::ComputeHash(m_world);
+		return m_diverged == false;
+	}
+}
+
+int32 b2Replayer::FindDivergence()
+{
+	while (Step())
+	{
+	}
+
+	return m_diverged ? m_stepCount - 1 : -1;
+}
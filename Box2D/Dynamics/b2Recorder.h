@@ -0,0 +1,296 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_RECORDER_H
+#define B2_RECORDER_H
+
+#include <Box2D/Common/b2Math.h>
+
+class b2World;
+class b2Body;
+class b2Fixture;
+class b2Joint;
+struct b2JointDef;
+struct b2Filter;
+
+/// "B2RC" in little endian.
+#define b2_recordMagic		0x43523242
+#define b2_recordVersion	1
+
+/// The operations of a recording. Each is a byte followed by its arguments.
+enum b2RecordOp
+{
+	b2_recordStep = 1,
+	b2_recordHash,
+	b2_recordSettings,
+	b2_recordLoad,
+	b2_recordCreateBody,
+	b2_recordDestroyBody,
+	b2_recordCreateFixture,
+	b2_recordDestroyFixture,
+	b2_recordCreateJoint,
+	b2_recordDestroyJoint,
+	b2_recordBodyState,
+	b2_recordSetTransform,
+	b2_recordSetType,
+	b2_recordSetActive,
+	b2_recordSetSensor,
+	b2_recordSetFilterData,
+
+	// Joint setters, with one or two float arguments.
+	b2_recordEnableLimit,
+	b2_recordSetLimits,
+	b2_recordEnableMotor,
+	b2_recordSetMotorSpeed,
+	b2_recordSetMaxMotor,
+	b2_recordSetTarget,
+	b2_recordSetMaxForce,
+	b2_recordSetMaxTorque,
+	b2_recordSetFrequency,
+	b2_recordSetDampingRatio,
+	b2_recordSetRatio
+};
+
+// The world settings that change the simulation.
+struct b2RecordSettings
+{
+	b2Vec2 gravity;
+	float32 inv_dt0;
+	float32 velocityTolerance;
+	int32 minVelocityIterations;
+	int32 softSubSteps;
+	uint8 allowSleep;
+	uint8 warmStarting;
+	uint8 continuousPhysics;
+	uint8 subStepping;
+	uint8 speculativeContacts;
+	uint8 adaptiveMargins;
+	uint8 autoClearForces;
+	uint8 stepComplete;
+};
+
+// The state of a body written by b2_recordBodyState, in groups.
+struct b2RecordBodyState
+{
+	enum
+	{
+		e_pose		= 0x01,
+		e_velocity	= 0x02,
+		e_force		= 0x04,
+		e_flags		= 0x08,
+		e_mass		= 0x10,
+		e_damping	= 0x20,
+		e_all		= 0x3F
+	};
+
+	struct Pose
+	{
+		b2Transform xf;
+		b2Sweep sweep;
+		b2Vec2 position0;
+		float32 angle0;
+	} pose;
+
+	struct Velocity
+	{
+		b2Vec2 v;
+		float32 w;
+	} velocity;
+
+	struct Force
+	{
+		b2Vec2 force;
+		float32 torque;
+	} force;
+
+	struct Flags
+	{
+		int32 type;
+		int32 flags;
+		float32 sleepTime;
+	} flags;
+
+	struct Mass
+	{
+		float32 mass, invMass;
+		float32 I, invI;
+	} mass;
+
+	struct Damping
+	{
+		float32 linearDamping;
+		float32 angularDamping;
+		float32 gravityScale;
+	} damping;
+
+	// Does the state still have to be written in full?
+	bool dirty;
+};
+
+/// Records a world to a compact binary stream that b2Replayer plays back
+/// step by step. The stream starts with the bodies, fixtures and joints the
+/// world has when the recorder is created, then holds the calls made between
+/// the steps, each step and a hash of the bodies after it.
+///
+/// The calls that touch the broad-phase or the contacts (creating and destroying
+/// bodies, fixtures and joints, SetTransform, SetType, SetActive, SetSensor,
+/// SetFilterData) and the joint setters are recorded as they're made. The rest of
+/// the body state (velocities, forces, flags, mass, damping) and the world settings
+/// are compared with their values at the end of the previous step, so they're
+/// recorded whatever the setter. Not recorded: the fixture friction, restitution and
+/// density setters, the distance joint and wheel spring setters and the particles.
+///
+/// The replay is exact when the recording starts before the first step: the
+/// contacts and joint impulses of an earlier step are not in the stream.
+class b2Recorder
+{
+public:
+	/// Start recording a world. Only one recorder at a time.
+	b2Recorder(b2World* world);
+
+	/// Stop recording.
+	~b2Recorder();
+
+	/// Get the stream, valid until the next recorded call.
+	const void* GetData() const { return m_data; }
+	int32 GetSize() const { return m_size; }
+
+	/// Get the number of steps recorded.
+	int32 GetStepCount() const { return m_stepCount; }
+
+	/// Hash the positions and velocities of the bodies of a world.
+	static uint32 ComputeHash(const b2World* world);
+
+	// Called by the world, the bodies, the fixtures and the joints.
+	void RecordCreateBody(b2Body* body);
+	void RecordDestroyBody(int32 id);
+	void RecordCreateFixture(b2Fixture* fixture);
+	void RecordDestroyFixture(b2Fixture* fixture);
+	void RecordCreateJoint(b2Joint* joint, const b2JointDef* def);
+	void RecordDestroyJoint(b2Joint* joint);
+	void RecordSetTransform(b2Body* body, const b2Vec2& position, float32 angle);
+	void RecordSetType(b2Body* body, int32 type);
+	void RecordSetActive(b2Body* body, bool flag);
+	void RecordSetSensor(b2Fixture* fixture, bool flag);
+	void RecordSetFilterData(b2Fixture* fixture, const b2Filter& filter);
+	void RecordJoint(int32 op, b2Joint* joint, float32 a, float32 b);
+	void BeginLoad(const void* data, int32 size);
+	void EndLoad();
+	void BeginStep(float32 dt, int32 velocityIterations, int32 positionIterations);
+	void EndStep();
+
+private:
+
+	void Write(const void* data, int32 size);
+	void WriteOp(int32 op);
+	void WriteIndex(int32 index);
+	void WriteFloat(float32 x);
+	void WriteFixture(b2Fixture* fixture);
+
+	void GrowStates(int32 count);
+	void GetSettings(b2RecordSettings* settings) const;
+	static void GetBodyState(b2RecordBodyState* state, const b2Body* body);
+
+	b2World* m_world;
+
+	char* m_data;
+	int32 m_size;
+	int32 m_capacity;
+
+	// The body states at the end of the last step, by body id.
+	b2RecordBodyState* m_states;
+	int32 m_stateCapacity;
+
+	b2RecordSettings m_settings;
+
+	int32 m_bodyIdCount;
+	int32 m_jointIdCount;
+	int32 m_stepCount;
+	bool m_loading;
+};
+
+/// Plays a b2Recorder stream back into an empty world, for example to debug a
+/// run headless. Each step checks the hash of the bodies against the recorded one.
+class b2Replayer
+{
+public:
+	/// The world should be empty and the stream must remain in scope.
+	b2Replayer(b2World* world, const void* data, int32 size);
+	~b2Replayer();
+
+	/// Apply the calls recorded before the next step, take the step and check
+	/// the hash.
+	/// @return false at the end of the stream, if the stream is corrupt or if
+	/// the hash differs.
+	bool Step();
+
+	/// Replay until the end of the stream or the first step whose hash differs.
+	/// @return the index of that step, or -1 if there is none.
+	int32 FindDivergence();
+
+	/// Get the number of steps replayed.
+	int32 GetStepCount() const { return m_stepCount; }
+
+	/// Has a step ended with a different hash?
+	bool HasDiverged() const { return m_diverged; }
+
+	/// Is the stream corrupt or of another version?
+	bool HasError() const { return m_error; }
+
+	/// Get a body or a joint by its recording id, in creation order from the
+	/// start of the recording. NULL if destroyed.
+	b2Body* GetBody(int32 id);
+	b2Joint* GetJoint(int32 id);
+
+private:
+
+	bool Read(void* data, int32 size);
+	bool ReadIndex(int32* index);
+	bool ReadFloat(float32* x);
+	b2Body* ReadBody();
+	b2Fixture* ReadFixture();
+	b2Joint* ReadJoint();
+
+	void AddBody(b2Body* body);
+	void AddJoint(b2Joint* joint);
+
+	void SetSettings(const b2RecordSettings& settings);
+	static void SetBodyState(b2Body* body, const b2RecordBodyState& state, int32 mask);
+
+	// Apply one operation, false on error.
+	bool Apply(int32 op);
+
+	b2World* m_world;
+	const char* m_data;
+	int32 m_size;
+	int32 m_offset;
+
+	b2Body** m_bodies;
+	int32 m_bodyCount;
+	int32 m_bodyCapacity;
+
+	b2Joint** m_joints;
+	int32 m_jointCount;
+	int32 m_jointCapacity;
+
+	int32 m_stepCount;
+	bool m_diverged;
+	bool m_error;
+};
+
+#endif
@@ -0,0 +1,1025 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2Scene.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2Recorder.h>
+#include <Box2D/Dynamics/Joints/b2DistanceJoint.h>
+#include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
+#include <Box2D/Dynamics/Joints/b2GearJoint.h>
+#include <Box2D/Dynamics/Joints/b2MouseJoint.h>
+#include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
+#include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
+#include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
+#include <Box2D/Dynamics/Joints/b2RopeJoint.h>
+#include <Box2D/Dynamics/Joints/b2WeldJoint.h>
+#include <Box2D/Dynamics/Joints/b2WheelJoint.h>
+#include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CompoundShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <cstring>
+
+// Is [first, first + count) inside [0, total)?
+static bool b2IsValidRange(int32 first, int32 count, int32 total)
+{
+	return 0 <= first && first <= total && 0 <= count && count <= total - first;
+}
+
+// Is an array of count records of recordSize bytes at offset inside the scene?
+static bool b2IsValidArray(int32 offset, int32 count, int32 recordSize, int32 sceneSize)
+{
+	if (offset < (int32)sizeof(b2SceneHeader) || offset > sceneSize || (offset & 3) != 0)
+	{
+		return false;
+	}
+
+	return 0 <= count && count <= (sceneSize - offset) / recordSize;
+}
+
+bool b2IsValidFixture(const b2SceneFixture* fixture, const b2ScenePolygon* polygons, int32 polygonCount, int32 vertexCount)
+{
+	switch (fixture->shapeType)
+	{
+	case b2Shape::e_circle:
+	case b2Shape::e_edge:
+		return true;
+
+	case b2Shape::e_polygon:
+	case b2Shape::e_compound:
+		if ((fixture->shapeType == b2Shape::e_polygon && fixture->count != 1) ||
+			b2IsValidRange(fixture->first, fixture->count, polygonCount) == false)
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < fixture->count; ++i)
+		{
+			const b2ScenePolygon* polygon = polygons + fixture->first + i;
+			if (polygon->vertexCount < 3 || polygon->vertexCount > b2_maxPolygonVertices ||
+				b2IsValidRange(polygon->firstVertex, polygon->vertexCount, vertexCount) == false)
+			{
+				return false;
+			}
+		}
+		return true;
+
+	case b2Shape::e_chain:
+		return fixture->count >= 2 && b2IsValidRange(fixture->first, fixture->count, vertexCount);
+
+	default:
+		return false;
+	}
+}
+
+// Check every index of the scene before anything is created.
+static bool b2IsValidScene(const void* data, int32 size)
+{
+	if (((size_t)data & 3) != 0 || size < (int32)sizeof(b2SceneHeader))
+	{
+		return false;
+	}
+
+	const char* base = (const char*)data;
+	const b2SceneHeader* header = (const b2SceneHeader*)base;
+	if (header->magic != b2_sceneMagic || header->version != b2_sceneVersion)
+	{
+		return false;
+	}
+
+	int32 sceneSize = header->size;
+	if (sceneSize > size ||
+		b2IsValidArray(header->bodyOffset, header->bodyCount, sizeof(b2SceneBody), sceneSize) == false ||
+		b2IsValidArray(header->fixtureOffset, header->fixtureCount, sizeof(b2SceneFixture), sceneSize) == false ||
+		b2IsValidArray(header->polygonOffset, header->polygonCount, sizeof(b2ScenePolygon), sceneSize) == false ||
+		b2IsValidArray(header->vertexOffset, header->vertexCount, sizeof(b2Vec2), sceneSize) == false ||
+		b2IsValidArray(header->jointOffset, header->jointCount, sizeof(b2SceneJoint), sceneSize) == false)
+	{
+		return false;
+	}
+
+	const b2SceneBody* bodies = (const b2SceneBody*)(base + header->bodyOffset);
+	for (int32 i = 0; i < header->bodyCount; ++i)
+	{
+		const b2SceneBody* body = bodies + i;
+		if (body->type < b2_staticBody || body->type > b2_dynamicBody ||
+			b2IsValidRange(body->firstFixture, body->fixtureCount, header->fixtureCount) == false)
+		{
+			return false;
+		}
+	}
+
+	const b2SceneFixture* fixtures = (const b2SceneFixture*)(base + header->fixtureOffset);
+	const b2ScenePolygon* polygons = (const b2ScenePolygon*)(base + header->polygonOffset);
+	for (int32 i = 0; i < header->fixtureCount; ++i)
+	{
+		if (b2IsValidFixture(fixtures + i, polygons, header->polygonCount, header->vertexCount) == false)
+		{
+			return false;
+		}
+	}
+
+	const b2SceneJoint* joints = (const b2SceneJoint*)(base + header->jointOffset);
+	for (int32 i = 0; i < header->jointCount; ++i)
+	{
+		const b2SceneJoint* joint = joints + i;
+		if (b2IsValidRange(joint->bodyA, 1, header->bodyCount) == false ||
+			b2IsValidRange(joint->bodyB, 1, header->bodyCount) == false ||
+			joint->bodyA == joint->bodyB)
+		{
+			return false;
+		}
+
+		switch (joint->type)
+		{
+		case e_revoluteJoint:
+		case e_prismaticJoint:
+		case e_distanceJoint:
+		case e_pulleyJoint:
+		case e_mouseJoint:
+		case e_wheelJoint:
+		case e_weldJoint:
+		case e_frictionJoint:
+		case e_ropeJoint:
+			break;
+
+		case e_gearJoint:
+			// The geared joints come first.
+			if (b2IsValidRange(joint->joint1, 1, i) == false || b2IsValidRange(joint->joint2, 1, i) == false)
+			{
+				return false;
+			}
+			for (int32 j = 0; j < 2; ++j)
+			{
+				int32 type = joints[j == 0 ? joint->joint1 : joint->joint2].type;
+				if (type != e_revoluteJoint && type != e_prismaticJoint)
+				{
+					return false;
+				}
+			}
+			break;
+
+		default:
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void b2SaveBody(b2SceneBody* out, const b2Body* body, bool state)
+{
+	out->type = body->GetType();
+	out->flags |= body->IsSleepingAllowed() ? b2_sceneAllowSleep : 0;
+	out->flags |= (body->IsAwake() || state == false) ? b2_sceneAwake : 0;
+	out->flags |= body->IsFixedRotation() ? b2_sceneFixedRotation : 0;
+	out->flags |= body->IsBullet() ? b2_sceneBullet : 0;
+	out->flags |= body->IsActive() ? b2_sceneActive : 0;
+	out->flags |= body->IsContactEventsEnabled() ? b2_sceneContactEvents : 0;
+	out->position = body->m_xf.p;
+	out->angle = body->m_sweep.a;
+	if (state)
+	{
+		out->linearVelocity = body->m_linearVelocity;
+		out->angularVelocity = body->m_angularVelocity;
+		out->sleepTime = body->m_sleepTime;
+	}
+	out->linearDamping = body->m_linearDamping;
+	out->angularDamping = body->m_angularDamping;
+	out->gravityScale = body->m_gravityScale;
+
+	b2MassData massData;
+	body->GetMassData(&massData);
+	out->mass = massData.mass;
+	out->center = massData.center;
+	out->I = massData.I;
+}
+
+b2Body* b2LoadBody(b2World* world, const b2SceneBody* body)
+{
+	b2BodyDef bd;
+	bd.type = (b2BodyType)body->type;
+	bd.position = body->position;
+	bd.angle = body->angle;
+	bd.linearVelocity = body->linearVelocity;
+	bd.angularVelocity = body->angularVelocity;
+	bd.linearDamping = body->linearDamping;
+	bd.angularDamping = body->angularDamping;
+	bd.allowSleep = (body->flags & b2_sceneAllowSleep) != 0;
+	bd.awake = (body->flags & b2_sceneAwake) != 0;
+	bd.fixedRotation = (body->flags & b2_sceneFixedRotation) != 0;
+	bd.bullet = (body->flags & b2_sceneBullet) != 0;
+	bd.contactEvents = (body->flags & b2_sceneContactEvents) != 0;
+	bd.active = (body->flags & b2_sceneActive) != 0;
+	bd.gravityScale = body->gravityScale;
+
+	b2Body* b = world->CreateBody(&bd);
+	b->m_sleepTime = body->sleepTime;
+	return b;
+}
+
+static void b2SetPolygon(b2PolygonShape* shape, const b2ScenePolygon* polygon, const b2Vec2* vertices)
+{
+	shape->Set(vertices + polygon->firstVertex, polygon->vertexCount);
+}
+
+b2Fixture* b2LoadFixture(b2Body* body, const b2SceneFixture* fixture, const b2ScenePolygon* polygons, const b2Vec2* vertices)
+{
+	b2FixtureDef fd;
+	fd.friction = fixture->friction;
+	fd.restitution = fixture->restitution;
+	fd.density = fixture->density;
+	fd.isSensor = fixture->isSensor != 0;
+	fd.filter.categoryBits = (uint16)fixture->categoryBits;
+	fd.filter.maskBits = (uint16)fixture->maskBits;
+	fd.filter.groupIndex = (int16)fixture->groupIndex;
+
+	switch (fixture->shapeType)
+	{
+	case b2Shape::e_circle:
+		{
+			b2CircleShape circle;
+			circle.m_radius = fixture->radius;
+			circle.m_p = fixture->points[0];
+			fd.shape = &circle;
+			return body->CreateFixture(&fd);
+		}
+
+	case b2Shape::e_edge:
+		{
+			b2EdgeShape edge;
+			edge.Set(fixture->points[0], fixture->points[1]);
+			edge.m_radius = fixture->radius;
+			edge.m_vertex0 = fixture->points[2];
+			edge.m_vertex3 = fixture->points[3];
+			edge.m_hasVertex0 = (fixture->shapeFlags & b2_sceneHasVertex0) != 0;
+			edge.m_hasVertex3 = (fixture->shapeFlags & b2_sceneHasVertex3) != 0;
+			fd.shape = &edge;
+			return body->CreateFixture(&fd);
+		}
+
+	case b2Shape::e_polygon:
+		{
+			b2PolygonShape polygon;
+			b2SetPolygon(&polygon, polygons + fixture->first, vertices);
+			polygon.m_radius = fixture->radius;
+			fd.shape = &polygon;
+			return body->CreateFixture(&fd);
+		}
+
+	case b2Shape::e_chain:
+		{
+			b2ChainShape chain;
+			chain.CreateChain(vertices + fixture->first, fixture->count);
+			chain.m_radius = fixture->radius;
+			if (fixture->shapeFlags & b2_sceneHasVertex0)
+			{
+				chain.SetPrevVertex(fixture->points[0]);
+			}
+			if (fixture->shapeFlags & b2_sceneHasVertex3)
+			{
+				chain.SetNextVertex(fixture->points[1]);
+			}
+			fd.shape = &chain;
+			return body->CreateFixture(&fd);
+		}
+
+	case b2Shape::e_compound:
+		{
+			b2CompoundShape compound;
+			for (int32 i = 0; i < fixture->count; ++i)
+			{
+				b2PolygonShape child;
+				b2SetPolygon(&child, polygons + fixture->first + i, vertices);
+				compound.AddChild(child);
+			}
+			compound.m_radius = fixture->radius;
+			fd.shape = &compound;
+			return body->CreateFixture(&fd);
+		}
+
+	default:
+		b2Assert(false);
+		return NULL;
+	}
+}
+
+void b2CountFixture(const b2Fixture* fixture, int32* polygonCount, int32* vertexCount)
+{
+	const b2Shape* shape = fixture->GetShape();
+	if (shape->m_type == b2Shape::e_polygon)
+	{
+		*polygonCount += 1;
+		*vertexCount += ((const b2PolygonShape*)shape)->m_vertexCount;
+	}
+	else if (shape->m_type == b2Shape::e_compound)
+	{
+		const b2CompoundShape* compound = (const b2CompoundShape*)shape;
+		int32 childCount = compound->GetChildCount();
+		*polygonCount += childCount;
+		for (int32 i = 0; i < childCount; ++i)
+		{
+			*vertexCount += compound->GetChild(i)->m_vertexCount;
+		}
+	}
+	else if (shape->m_type == b2Shape::e_chain)
+	{
+		*vertexCount += ((const b2ChainShape*)shape)->GetVertexCount();
+	}
+}
+
+void b2SaveFixture(b2SceneFixture* out, const b2Fixture* fixture, b2ScenePolygon* polygons,
+						  int32* polygonCount, b2Vec2* vertices, int32* vertexCount)
+{
+	const b2Shape* shape = fixture->GetShape();
+	out->shapeType = shape->m_type;
+	out->radius = shape->m_radius;
+
+	// The record is zeroed by the caller. The ghost vertices of edges and chains
+	// are only written when set, they aren't initialized otherwise.
+	switch (shape->m_type)
+	{
+	case b2Shape::e_circle:
+		out->points[0] = ((const b2CircleShape*)shape)->m_p;
+		break;
+
+	case b2Shape::e_edge:
+		{
+			const b2EdgeShape* edge = (const b2EdgeShape*)shape;
+			out->points[0] = edge->m_vertex1;
+			out->points[1] = edge->m_vertex2;
+			if (edge->m_hasVertex0)
+			{
+				out->points[2] = edge->m_vertex0;
+				out->shapeFlags |= b2_sceneHasVertex0;
+			}
+			if (edge->m_hasVertex3)
+			{
+				out->points[3] = edge->m_vertex3;
+				out->shapeFlags |= b2_sceneHasVertex3;
+			}
+		}
+		break;
+
+	case b2Shape::e_polygon:
+	case b2Shape::e_compound:
+		{
+			int32 childCount = 1;
+			const b2PolygonShape* children = (const b2PolygonShape*)shape;
+			if (shape->m_type == b2Shape::e_compound)
+			{
+				childCount = shape->GetChildCount();
+				children = childCount > 0 ? ((const b2CompoundShape*)shape)->GetChild(0) : NULL;
+			}
+
+			out->first = *polygonCount;
+			out->count = childCount;
+			for (int32 i = 0; i < childCount; ++i)
+			{
+				const b2PolygonShape* child = children + i;
+				b2ScenePolygon* polygon = polygons + (*polygonCount)++;
+				polygon->firstVertex = *vertexCount;
+				polygon->vertexCount = child->m_vertexCount;
+				memcpy(vertices + *vertexCount, child->m_vertices, child->m_vertexCount * sizeof(b2Vec2));
+				*vertexCount += child->m_vertexCount;
+			}
+		}
+		break;
+
+	case b2Shape::e_chain:
+		{
+			const b2ChainShape* chain = (const b2ChainShape*)shape;
+			out->first = *vertexCount;
+			out->count = chain->GetVertexCount();
+			memcpy(vertices + *vertexCount, chain->GetVertices(), out->count * sizeof(b2Vec2));
+			*vertexCount += out->count;
+			if (chain->HasPrevVertex())
+			{
+				out->points[0] = chain->GetPrevVertex();
+				out->shapeFlags |= b2_sceneHasVertex0;
+			}
+			if (chain->HasNextVertex())
+			{
+				out->points[1] = chain->GetNextVertex();
+				out->shapeFlags |= b2_sceneHasVertex3;
+			}
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+
+	out->friction = fixture->GetFriction();
+	out->restitution = fixture->GetRestitution();
+	out->density = fixture->GetDensity();
+	out->isSensor = fixture->IsSensor() ? 1 : 0;
+	out->categoryBits = fixture->GetFilterData().categoryBits;
+	out->maskBits = fixture->GetFilterData().maskBits;
+	out->groupIndex = fixture->GetFilterData().groupIndex;
+}
+
+void b2SaveJointDef(b2SceneJoint* out, const b2JointDef* jointDef)
+{
+	out->type = jointDef->type;
+	out->flags = jointDef->collideConnected ? b2_sceneCollideConnected : 0;
+
+	switch (jointDef->type)
+	{
+	case e_distanceJoint:
+		{
+			const b2DistanceJointDef* def = (const b2DistanceJointDef*)jointDef;
+			out->localAnchorA = def->localAnchorA;
+			out->localAnchorB = def->localAnchorB;
+			out->length = def->length;
+			out->frequencyHz = def->frequencyHz;
+			out->dampingRatio = def->dampingRatio;
+		}
+		break;
+
+	case e_frictionJoint:
+		{
+			const b2FrictionJointDef* def = (const b2FrictionJointDef*)jointDef;
+			out->localAnchorA = def->localAnchorA;
+			out->localAnchorB = def->localAnchorB;
+			out->maxForce = def->maxForce;
+			out->maxTorque = def->maxTorque;
+		}
+		break;
+
+	case e_gearJoint:
+		{
+			const b2GearJointDef* def = (const b2GearJointDef*)jointDef;
+			out->ratio = def->ratio;
+		}
+		break;
+
+	case e_mouseJoint:
+		{
+			const b2MouseJointDef* def = (const b2MouseJointDef*)jointDef;
+			out->localAnchorB = def->target;
+			out->target = def->target;
+			out->maxForce = def->maxForce;
+			out->frequencyHz = def->frequencyHz;
+			out->dampingRatio = def->dampingRatio;
+		}
+		break;
+
+	case e_prismaticJoint:
+		{
+			const b2PrismaticJointDef* def = (const b2PrismaticJointDef*)jointDef;
+			out->localAnchorA = def->localAnchorA;
+			out->localAnchorB = def->localAnchorB;
+			out->localAxisA = def->localAxisA;
+			out->referenceAngle = def->referenceAngle;
+			out->flags |= def->enableLimit ? b2_sceneEnableLimit : 0;
+			out->lower = def->lowerTranslation;
+			out->upper = def->upperTranslation;
+			out->flags |= def->enableMotor ? b2_sceneEnableMotor : 0;
+			out->maxMotor = def->maxMotorForce;
+			out->motorSpeed = def->motorSpeed;
+		}
+		break;
+
+	case e_pulleyJoint:
+		{
+			const b2PulleyJointDef* def = (const b2PulleyJointDef*)jointDef;
+			out->groundAnchorA = def->groundAnchorA;
+			out->groundAnchorB = def->groundAnchorB;
+			out->localAnchorA = def->localAnchorA;
+			out->localAnchorB = def->localAnchorB;
+			out->length = def->lengthA;
+			out->lengthB = def->lengthB;
+			out->ratio = def->ratio;
+		}
+		break;
+
+	case e_revoluteJoint:
+		{
+			const b2RevoluteJointDef* def = (const b2RevoluteJointDef*)jointDef;
+			out->localAnchorA = def->localAnchorA;
+			out->localAnchorB = def->localAnchorB;
+			out->referenceAngle = def->referenceAngle;
+			out->flags |= def->enableLimit ? b2_sceneEnableLimit : 0;
+			out->lower = def->lowerAngle;
+			out->upper = def->upperAngle;
+			out->flags |= def->enableMotor ? b2_sceneEnableMotor : 0;
+			out->maxMotor = def->maxMotorTorque;
+			out->motorSpeed = def->motorSpeed;
+		}
+		break;
+
+	case e_ropeJoint:
+		{
+			const b2RopeJointDef* def = (const b2RopeJointDef*)jointDef;
+			out->localAnchorA = def->localAnchorA;
+			out->localAnchorB = def->localAnchorB;
+			out->length = def->maxLength;
+		}
+		break;
+
+	case e_weldJoint:
+		{
+			const b2WeldJointDef* def = (const b2WeldJointDef*)jointDef;
+			out->localAnchorA = def->localAnchorA;
+			out->localAnchorB = def->localAnchorB;
+			out->referenceAngle = def->referenceAngle;
+		}
+		break;
+
+	case e_wheelJoint:
+		{
+			const b2WheelJointDef* def = (const b2WheelJointDef*)jointDef;
+			out->localAnchorA = def->localAnchorA;
+			out->localAnchorB = def->localAnchorB;
+			out->localAxisA = def->localAxisA;
+			out->flags |= def->enableMotor ? b2_sceneEnableMotor : 0;
+			out->maxMotor = def->maxMotorTorque;
+			out->motorSpeed = def->motorSpeed;
+			out->frequencyHz = def->frequencyHz;
+			out->dampingRatio = def->dampingRatio;
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+}
+
+void b2SaveJoint(b2SceneJoint* out, b2Joint* joint)
+{
+	switch (joint->GetType())
+	{
+	case e_distanceJoint:
+		{
+			b2DistanceJointDef def;
+			((b2DistanceJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+		}
+		break;
+
+	case e_frictionJoint:
+		{
+			b2FrictionJointDef def;
+			((b2FrictionJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+		}
+		break;
+
+	case e_gearJoint:
+		{
+			b2GearJointDef def;
+			((b2GearJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+		}
+		break;
+
+	case e_mouseJoint:
+		{
+			b2MouseJointDef def;
+			((b2MouseJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+			out->target = ((b2MouseJoint*)joint)->GetTarget();
+		}
+		break;
+
+	case e_prismaticJoint:
+		{
+			b2PrismaticJointDef def;
+			((b2PrismaticJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+		}
+		break;
+
+	case e_pulleyJoint:
+		{
+			b2PulleyJointDef def;
+			((b2PulleyJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+		}
+		break;
+
+	case e_revoluteJoint:
+		{
+			b2RevoluteJointDef def;
+			((b2RevoluteJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+		}
+		break;
+
+	case e_ropeJoint:
+		{
+			b2RopeJointDef def;
+			((b2RopeJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+		}
+		break;
+
+	case e_weldJoint:
+		{
+			b2WeldJointDef def;
+			((b2WeldJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+		}
+		break;
+
+	case e_wheelJoint:
+		{
+			b2WheelJointDef def;
+			((b2WheelJoint*)joint)->GetDef(&def);
+			b2SaveJointDef(out, &def);
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+}
+
+b2Joint* b2LoadJoint(b2World* world, const b2SceneJoint* joint, b2Body** bodies, b2Joint** joints)
+{
+	b2Body* bodyA = bodies[joint->bodyA];
+	b2Body* bodyB = bodies[joint->bodyB];
+	bool collideConnected = (joint->flags & b2_sceneCollideConnected) != 0;
+	bool enableLimit = (joint->flags & b2_sceneEnableLimit) != 0;
+	bool enableMotor = (joint->flags & b2_sceneEnableMotor) != 0;
+
+	switch (joint->type)
+	{
+	case e_distanceJoint:
+		{
+			b2DistanceJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.localAnchorA = joint->localAnchorA;
+			def.localAnchorB = joint->localAnchorB;
+			def.length = joint->length;
+			def.frequencyHz = joint->frequencyHz;
+			def.dampingRatio = joint->dampingRatio;
+			return world->CreateJoint(&def);
+		}
+
+	case e_frictionJoint:
+		{
+			b2FrictionJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.localAnchorA = joint->localAnchorA;
+			def.localAnchorB = joint->localAnchorB;
+			def.maxForce = joint->maxForce;
+			def.maxTorque = joint->maxTorque;
+			return world->CreateJoint(&def);
+		}
+
+	case e_gearJoint:
+		{
+			b2GearJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.joint1 = joints[joint->joint1];
+			def.joint2 = joints[joint->joint2];
+			def.ratio = joint->ratio;
+			return world->CreateJoint(&def);
+		}
+
+	case e_mouseJoint:
+		{
+			b2MouseJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.target = joint->localAnchorB;
+			def.maxForce = joint->maxForce;
+			def.frequencyHz = joint->frequencyHz;
+			def.dampingRatio = joint->dampingRatio;
+			b2MouseJoint* mouse = (b2MouseJoint*)world->CreateJoint(&def);
+			if ((joint->target == def.target) == false)
+			{
+				mouse->SetTarget(joint->target);
+			}
+			return mouse;
+		}
+
+	case e_prismaticJoint:
+		{
+			b2PrismaticJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.localAnchorA = joint->localAnchorA;
+			def.localAnchorB = joint->localAnchorB;
+			def.localAxisA = joint->localAxisA;
+			def.referenceAngle = joint->referenceAngle;
+			def.enableLimit = enableLimit;
+			def.lowerTranslation = joint->lower;
+			def.upperTranslation = joint->upper;
+			def.enableMotor = enableMotor;
+			def.maxMotorForce = joint->maxMotor;
+			def.motorSpeed = joint->motorSpeed;
+			return world->CreateJoint(&def);
+		}
+
+	case e_pulleyJoint:
+		{
+			b2PulleyJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.groundAnchorA = joint->groundAnchorA;
+			def.groundAnchorB = joint->groundAnchorB;
+			def.localAnchorA = joint->localAnchorA;
+			def.localAnchorB = joint->localAnchorB;
+			def.lengthA = joint->length;
+			def.lengthB = joint->lengthB;
+			def.ratio = joint->ratio;
+			return world->CreateJoint(&def);
+		}
+
+	case e_revoluteJoint:
+		{
+			b2RevoluteJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.localAnchorA = joint->localAnchorA;
+			def.localAnchorB = joint->localAnchorB;
+			def.referenceAngle = joint->referenceAngle;
+			def.enableLimit = enableLimit;
+			def.lowerAngle = joint->lower;
+			def.upperAngle = joint->upper;
+			def.enableMotor = enableMotor;
+			def.maxMotorTorque = joint->maxMotor;
+			def.motorSpeed = joint->motorSpeed;
+			return world->CreateJoint(&def);
+		}
+
+	case e_ropeJoint:
+		{
+			b2RopeJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.localAnchorA = joint->localAnchorA;
+			def.localAnchorB = joint->localAnchorB;
+			def.maxLength = joint->length;
+			return world->CreateJoint(&def);
+		}
+
+	case e_weldJoint:
+		{
+			b2WeldJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.localAnchorA = joint->localAnchorA;
+			def.localAnchorB = joint->localAnchorB;
+			def.referenceAngle = joint->referenceAngle;
+			return world->CreateJoint(&def);
+		}
+
+	case e_wheelJoint:
+		{
+			b2WheelJointDef def;
+			def.bodyA = bodyA;
+			def.bodyB = bodyB;
+			def.collideConnected = collideConnected;
+			def.localAnchorA = joint->localAnchorA;
+			def.localAnchorB = joint->localAnchorB;
+			def.localAxisA = joint->localAxisA;
+			def.enableMotor = enableMotor;
+			def.maxMotorTorque = joint->maxMotor;
+			def.motorSpeed = joint->motorSpeed;
+			def.frequencyHz = joint->frequencyHz;
+			def.dampingRatio = joint->dampingRatio;
+			return world->CreateJoint(&def);
+		}
+
+	default:
+		b2Assert(false);
+		return NULL;
+	}
+}
+
+int32 b2World::Save(void* buffer, int32 capacity, uint32 flags)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return 0;
+	}
+
+	int32 fixtureCount = 0;
+	int32 polygonCount = 0;
+	int32 vertexCount = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			++fixtureCount;
+			b2CountFixture(f, &polygonCount, &vertexCount);
+		}
+	}
+
+	b2SceneHeader header;
+	header.magic = b2_sceneMagic;
+	header.version = b2_sceneVersion;
+	header.flags = flags;
+	header.gravity = m_gravity;
+	header.bodyCount = m_bodyCount;
+	header.fixtureCount = fixtureCount;
+	header.polygonCount = polygonCount;
+	header.vertexCount = vertexCount;
+	header.jointCount = m_jointCount;
+
+	int32 offset = sizeof(b2SceneHeader);
+	header.bodyOffset = offset;
+	offset += m_bodyCount * sizeof(b2SceneBody);
+	header.fixtureOffset = offset;
+	offset += fixtureCount * sizeof(b2SceneFixture);
+	header.polygonOffset = offset;
+	offset += polygonCount * sizeof(b2ScenePolygon);
+	header.vertexOffset = offset;
+	offset += vertexCount * sizeof(b2Vec2);
+	header.jointOffset = offset;
+	offset += m_jointCount * sizeof(b2SceneJoint);
+	header.size = offset;
+
+	if (buffer == NULL || capacity < header.size)
+	{
+		return header.size;
+	}
+
+	b2Assert(((size_t)buffer & 3) == 0);
+
+	char* base = (char*)buffer;
+	memset(base, 0, header.size);
+	memcpy(base, &header, sizeof(b2SceneHeader));
+
+	b2SceneBody* bodies = (b2SceneBody*)(base + header.bodyOffset);
+	b2SceneFixture* fixtures = (b2SceneFixture*)(base + header.fixtureOffset);
+	b2ScenePolygon* polygons = (b2ScenePolygon*)(base + header.polygonOffset);
+	b2Vec2* vertices = (b2Vec2*)(base + header.vertexOffset);
+	b2SceneJoint* joints = (b2SceneJoint*)(base + header.jointOffset);
+
+	// The lists are walked from the last created item, which goes last.
+	bool state = (flags & b2_sceneState) != 0;
+	int32 bodyIndex = m_bodyCount;
+	int32 fixtureEnd = fixtureCount;
+	polygonCount = 0;
+	vertexCount = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_islandIndex = --bodyIndex;
+
+		b2SceneBody* out = bodies + bodyIndex;
+		b2SaveBody(out, b, state);
+
+		out->fixtureCount = b->m_fixtureCount;
+		out->firstFixture = fixtureEnd - b->m_fixtureCount;
+		fixtureEnd = out->firstFixture;
+
+		int32 fixtureIndex = out->firstFixture + out->fixtureCount;
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			b2SaveFixture(fixtures + --fixtureIndex, f, polygons, &polygonCount, vertices, &vertexCount);
+		}
+	}
+
+	int32 jointIndex = m_jointCount;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_index = --jointIndex;
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		b2SceneJoint* out = joints + j->m_index;
+		out->bodyA = j->m_bodyA->m_islandIndex;
+		out->bodyB = j->m_bodyB->m_islandIndex;
+		b2SaveJoint(out, j);
+
+		if (j->m_type == e_gearJoint)
+		{
+			b2GearJointDef def;
+			((b2GearJoint*)j)->GetDef(&def);
+			out->joint1 = def.joint1->m_index;
+			out->joint2 = def.joint2->m_index;
+		}
+	}
+
+	return header.size;
+}
+
+bool b2World::Load(const void* data, int32 size, b2Body** bodies)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked() || b2IsValidScene(data, size) == false)
+	{
+		return false;
+	}
+
+	// The recorder keeps the scene instead of the objects created from it.
+	if (m_recorder)
+	{
+		m_recorder->BeginLoad(data, size);
+	}
+
+	const char* base = (const char*)data;
+	const b2SceneHeader* header = (const b2SceneHeader*)base;
+	const b2SceneBody* bodyRecords = (const b2SceneBody*)(base + header->bodyOffset);
+	const b2SceneFixture* fixtures = (const b2SceneFixture*)(base + header->fixtureOffset);
+	const b2ScenePolygon* polygons = (const b2ScenePolygon*)(base + header->polygonOffset);
+	const b2Vec2* vertices = (const b2Vec2*)(base + header->vertexOffset);
+	const b2SceneJoint* jointRecords = (const b2SceneJoint*)(base + header->jointOffset);
+
+	m_gravity = header->gravity;
+
+	b2Body** created = bodies;
+	if (created == NULL)
+	{
+		created = (b2Body**)b2Alloc(b2Max(header->bodyCount, 1) * sizeof(b2Body*));
+	}
+
+	// Build the broad-phase tree once all the proxies are there.
+	m_contactManager.m_broadPhase.BeginBulkInsert();
+
+	for (int32 i = 0; i < header->bodyCount; ++i)
+	{
+		const b2SceneBody* record = bodyRecords + i;
+
+		b2Body* body = b2LoadBody(this, record);
+
+		for (int32 j = 0; j < record->fixtureCount; ++j)
+		{
+			b2LoadFixture(body, fixtures + record->firstFixture + j, polygons, vertices);
+		}
+
+		// Restore a mass set by SetMassData.
+		if (body->m_type == b2_dynamicBody)
+		{
+			b2MassData massData;
+			body->GetMassData(&massData);
+			if (massData.mass != record->mass || massData.I != record->I ||
+				massData.center.x != record->center.x || massData.center.y != record->center.y)
+			{
+				massData.mass = record->mass;
+				massData.center = record->center;
+				massData.I = record->I;
+				body->SetMassData(&massData);
+			}
+		}
+
+		// The mass updates above carry the velocity along with the center of mass
+		// of a spinning body. Restore the saved velocities once the mass is final.
+		body->m_linearVelocity = record->linearVelocity;
+		body->m_angularVelocity = record->angularVelocity;
+
+		created[i] = body;
+	}
+
+	m_contactManager.m_broadPhase.EndBulkInsert();
+
+	b2Joint** joints = (b2Joint**)b2Alloc(b2Max(header->jointCount, 1) * sizeof(b2Joint*));
+	for (int32 i = 0; i < header->jointCount; ++i)
+	{
+		joints[i] = b2LoadJoint(this, jointRecords + i, created, joints);
+	}
+	b2Free(joints);
+
+	if (created != bodies)
+	{
+		b2Free(created);
+	}
+
+	if (m_recorder)
+	{
+		m_recorder->EndLoad();
+	}
+
+	return true;
+}
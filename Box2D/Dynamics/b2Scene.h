@@ -0,0 +1,211 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_SCENE_H
+#define B2_SCENE_H
+
+#include <Box2D/Common/b2Math.h>
+
+class b2World;
+class b2Body;
+class b2Fixture;
+class b2Joint;
+struct b2JointDef;
+
+/// The binary scene format written by b2World::Save and read by b2World::Load.
+/// A scene is a header followed by arrays of fixed size records. The fields are
+/// 4 bytes wide, in native byte order, and the records refer to each other by
+/// index. b2World::Load reads the records in place, so a scene can be memory
+/// mapped and loaded without a parsing pass.
+///
+/// The bodies, the fixtures of each body and the joints are stored in creation
+/// order, the reverse of the world lists, so a loaded world has the same lists.
+
+/// "B2SC" in little endian.
+#define b2_sceneMagic		0x43533242
+#define b2_sceneVersion		1
+
+/// b2World::Save flags.
+enum b2SceneFlags
+{
+	/// Save the velocities and the sleep state of the bodies. Otherwise the
+	/// bodies are loaded at rest and awake.
+	b2_sceneState	= 0x0001
+};
+
+struct b2SceneHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint32 flags;
+
+	/// The size of the whole scene in bytes.
+	int32 size;
+
+	b2Vec2 gravity;
+
+	int32 bodyCount;
+	int32 fixtureCount;
+	int32 polygonCount;
+	int32 vertexCount;
+	int32 jointCount;
+
+	/// The offsets of the record arrays from the start of the scene, in bytes.
+	int32 bodyOffset;
+	int32 fixtureOffset;
+	int32 polygonOffset;
+	int32 vertexOffset;
+	int32 jointOffset;
+};
+
+/// b2SceneBody::flags.
+enum b2SceneBodyFlags
+{
+	b2_sceneAllowSleep		= 0x0001,
+	b2_sceneAwake			= 0x0002,
+	b2_sceneFixedRotation	= 0x0004,
+	b2_sceneBullet			= 0x0008,
+	b2_sceneActive			= 0x0010,
+	b2_sceneContactEvents	= 0x0020
+};
+
+struct b2SceneBody
+{
+	int32 type;
+	uint32 flags;
+	b2Vec2 position;
+	float32 angle;
+	b2Vec2 linearVelocity;
+	float32 angularVelocity;
+	float32 sleepTime;
+	float32 linearDamping;
+	float32 angularDamping;
+	float32 gravityScale;
+
+	/// The mass data, applied if the fixtures give something else.
+	float32 mass;
+	b2Vec2 center;
+	float32 I;
+
+	int32 firstFixture;
+	int32 fixtureCount;
+};
+
+/// b2SceneFixture::shapeFlags.
+enum b2SceneShapeFlags
+{
+	b2_sceneHasVertex0		= 0x0001,	///< edge vertex0, chain previous vertex
+	b2_sceneHasVertex3		= 0x0002	///< edge vertex3, chain next vertex
+};
+
+/// A fixture and its shape. A polygon refers to one b2ScenePolygon, a compound
+/// to count of them. A chain refers to count vertices. The points are:
+/// - circle: the center.
+/// - edge: vertex1, vertex2, vertex0, vertex3.
+/// - chain: the previous vertex, the next vertex.
+struct b2SceneFixture
+{
+	int32 shapeType;
+	float32 radius;
+	int32 first;
+	int32 count;
+	b2Vec2 points[4];
+	uint32 shapeFlags;
+
+	float32 friction;
+	float32 restitution;
+	float32 density;
+	uint32 isSensor;
+	uint32 categoryBits;
+	uint32 maskBits;
+	int32 groupIndex;
+};
+
+/// A convex polygon, on its own or a child of a compound.
+struct b2ScenePolygon
+{
+	int32 firstVertex;
+	int32 vertexCount;
+};
+
+/// b2SceneJoint::flags.
+enum b2SceneJointFlags
+{
+	b2_sceneCollideConnected	= 0x0001,
+	b2_sceneEnableLimit			= 0x0002,
+	b2_sceneEnableMotor			= 0x0004
+};
+
+/// The union of the joint definitions. A mouse joint keeps its anchor in
+/// world coordinates in localAnchorB. A gear joint refers to two earlier joints.
+struct b2SceneJoint
+{
+	int32 type;
+	int32 bodyA;
+	int32 bodyB;
+	uint32 flags;
+
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	b2Vec2 localAxisA;
+	b2Vec2 groundAnchorA;
+	b2Vec2 groundAnchorB;
+	b2Vec2 target;
+
+	float32 referenceAngle;
+	float32 lower;
+	float32 upper;
+	float32 maxMotor;
+	float32 motorSpeed;
+	float32 frequencyHz;
+	float32 dampingRatio;
+	float32 length;
+	float32 lengthB;
+	float32 ratio;
+	float32 maxForce;
+	float32 maxTorque;
+
+	int32 joint1;
+	int32 joint2;
+};
+
+/// Conversions between the objects and the records, used by b2World::Save,
+/// b2World::Load and b2Recorder. The fixture range of a body is left to the
+/// caller, and so are the body and joint indices of a joint.
+/// The polygons and vertices of a fixture are appended at polygons[*polygonCount]
+/// and vertices[*vertexCount], b2CountFixture adds their numbers. b2SaveJointDef keeps the definition values as
+/// given, b2SaveJoint reads them back from the joint. b2LoadJoint looks up its
+/// indices in bodies and joints. b2LoadBody sets the velocities through the
+/// body definition, so adding fixtures afterwards changes them like it would
+/// for the original body.
+void b2SaveBody(b2SceneBody* out, const b2Body* body, bool state);
+b2Body* b2LoadBody(b2World* world, const b2SceneBody* body);
+/// Are the shape type and the polygon and vertex ranges of a fixture valid?
+bool b2IsValidFixture(const b2SceneFixture* fixture, const b2ScenePolygon* polygons, int32 polygonCount,
+					  int32 vertexCount);
+
+void b2CountFixture(const b2Fixture* fixture, int32* polygonCount, int32* vertexCount);
+void b2SaveFixture(b2SceneFixture* out, const b2Fixture* fixture, b2ScenePolygon* polygons,
+				   int32* polygonCount, b2Vec2* vertices, int32* vertexCount);
+b2Fixture* b2LoadFixture(b2Body* body, const b2SceneFixture* fixture, const b2ScenePolygon* polygons,
+						 const b2Vec2* vertices);
+void b2SaveJoint(b2SceneJoint* out, b2Joint* joint);
+void b2SaveJointDef(b2SceneJoint* out, const b2JointDef* def);
+b2Joint* b2LoadJoint(b2World* world, const b2SceneJoint* joint, b2Body** bodies, b2Joint** joints);
+
+#endif
@@ -21,7 +21,13 @@
 
 #include <Box2D/Common/b2Math.h>
 
-/// Profiling data. Times are in milliseconds.
+class b2ThreadPool;
+
+/// Profiling data. Times are in milliseconds. Iteration counts are summed over
+/// the islands solved in the step. The broad-phase churn counts the proxies
+/// re-inserted in the tree, the moves buffered for new pairs and the contacts
+/// kept only because the fat AABBs overlap. The polygon collisions count the
+/// calls with a separating axis cache and those that skipped the full search.
 struct b2Profile
 {
 	float32 step;
@@ -32,6 +38,40 @@ struct b2Profile
 	float32 solvePosition;
 	float32 broadphase;
 	float32 solveTOI;
+	float32 particles;
+	int32 velocityIterations;
+	int32 positionIterations;
+	int32 islandCount;
+	int32 reinsertCount;
+	int32 bufferedMoveCount;
+	int32 falsePairCount;
+	int32 satCallCount;
+	int32 satCacheHitCount;
+	int32 gjkCallCount;		// GJK queries of speculative contacts and time of impact
+	int32 gjkIterCount;
+	int32 toiCallCount;
+	int32 toiIterCount;
+	int32 toiRootIterCount;
+	int32 skippedIslandCount;	// islands left for a later step by the level of detail
+	float32 skippedSolve;		// estimate of the solver time saved by skipping them
+};
+
+/// Memory used by a world, in bytes. The bodies, fixtures, contacts and joints
+/// are counted with the size of their block in the block allocator, so they
+/// add up to less than the chunks it holds, which include the free blocks.
+struct b2MemoryReport
+{
+	int32 bodies;
+	int32 fixtures;			// with their proxies and shapes
+	int32 shapes;			// chain and compound data allocated with b2Alloc
+	int32 contacts;
+	int32 joints;
+	int32 particles;
+	int32 broadPhase;
+	int32 blockAllocator;	// chunks held by the block allocator, used or free
+	int32 stack;			// stack allocators of the step
+	int32 stackPeak;		// largest stack allocation of a step
+	int32 total;			// everything allocated by the world, except the world itself
 };
 
 /// This is an internal structure.
@@ -42,6 +82,10 @@ struct b2TimeStep
 	float32 dtRatio;	// dt * inv_dt0
 	int32 velocityIterations;
 	int32 positionIterations;
+	int32 minVelocityIterations;
+	float32 velocityTolerance;	// impulse delta below which velocity iterations stop, 0 to run them all
+	int32 subStepCount;	// soft step sub-steps, 0 for the iterative solver
+	b2ThreadPool* threadPool;	// solves large islands in parallel, NULL for a single thread
 	bool warmStarting;
 };
 
@@ -20,6 +20,7 @@
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2Island.h>
+#include <Box2D/Dynamics/b2Recorder.h>
 #include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
@@ -28,11 +29,17 @@
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CompoundShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2ThreadPool.h>
+#include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Particle/b2ParticleSystem.h>
 #include <new>
+#include <algorithm>
+#include <cstring>
 
 b2World::b2World(const b2Vec2& gravity, bool doSleep)
 {
@@ -41,6 +48,7 @@ b2World::b2World(const b2Vec2& gravity, bool doSleep)
 
 	m_bodyList = NULL;
 	m_jointList = NULL;
+	m_particleSystemList = NULL;
 
 	m_bodyCount = 0;
 	m_jointCount = 0;
@@ -48,6 +56,25 @@ b2World::b2World(const b2Vec2& gravity, bool doSleep)
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
+	m_speculativeContacts = false;
+	m_adaptiveMargins = false;
+	m_contactEventsEnabled = false;
+
+	m_softSubSteps = 0;
+
+	m_velocityTolerance = 0.0f;
+	m_minVelocityIterations = 1;
+
+	m_threadPool = NULL;
+	m_recorder = NULL;
+	m_stackAllocator = NULL;
+
+	m_regionSize = 0.0f;
+	m_threadAllocators = NULL;
+	m_threadAllocatorCount = 0;
+
+	m_lod = NULL;
+	m_stepIndex = 0;
 
 	m_stepComplete = true;
 
@@ -60,11 +87,24 @@ b2World::b2World(const b2Vec2& gravity, bool doSleep)
 
 	m_contactManager.m_allocator = &m_blockAllocator;
 
+	// Fill the contact registers here rather than on the first contact, which may
+	// be created by worlds stepping concurrently in a b2WorldGroup.
+	if (b2Contact::s_initialized == false)
+	{
+		b2Contact::InitializeRegisters();
+		b2Contact::s_initialized = true;
+	}
+
 	memset(&m_profile, 0, sizeof(b2Profile));
 }
 
 b2World::~b2World()
 {
+	while (m_particleSystemList)
+	{
+		DestroyParticleSystem(m_particleSystemList);
+	}
+
 	// Some shapes allocate using b2Alloc.
 	b2Body* b = m_bodyList;
 	while (b)
@@ -82,6 +122,18 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	if (m_stackAllocator)
+	{
+		m_stackAllocator->~b2StackAllocator();
+		b2Free(m_stackAllocator);
+	}
+
+	for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+	{
+		m_threadAllocators[i].~b2StackAllocator();
+	}
+	b2Free(m_threadAllocators);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -104,6 +156,25 @@ void b2World::SetDebugDraw(b2Draw* debugDraw)
 	m_debugDraw = debugDraw;
 }
 
+void b2World::SetLevelOfDetail(b2LevelOfDetail* lod)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_lod = lod;
+
+	// Forget the lag, the islands left behind are solved by the next step.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_skippedSteps = 0;
+		b->m_skippedTime = 0.0f;
+		b->m_solvedTime = 0.0f;
+	}
+}
+
 b2Body* b2World::CreateBody(const b2BodyDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -125,6 +196,11 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	if (m_recorder)
+	{
+		m_recorder->RecordCreateBody(b);
+	}
+
 	return b;
 }
 
@@ -137,6 +213,9 @@ void b2World::DestroyBody(b2Body* b)
 		return;
 	}
 
+	// The joints are recorded as they're destroyed, the body once they're gone.
+	int32 recordId = b->m_recordId;
+
 	// Delete the attached joints.
 	b2JointEdge* je = b->m_jointList;
 	while (je)
@@ -207,6 +286,11 @@ void b2World::DestroyBody(b2Body* b)
 	--m_bodyCount;
 	b->~b2Body();
 	m_blockAllocator.Free(b, sizeof(b2Body));
+
+	if (m_recorder)
+	{
+		m_recorder->RecordDestroyBody(recordId);
+	}
 }
 
 b2Joint* b2World::CreateJoint(const b2JointDef* def)
@@ -266,6 +350,11 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 
 	// Note: creating a joint doesn't wake the bodies.
 
+	if (m_recorder)
+	{
+		m_recorder->RecordCreateJoint(j, def);
+	}
+
 	return j;
 }
 
@@ -277,6 +366,11 @@ void b2World::DestroyJoint(b2Joint* j)
 		return;
 	}
 
+	if (m_recorder)
+	{
+		m_recorder->RecordDestroyJoint(j);
+	}
+
 	bool collideConnected = j->m_collideConnected;
 
 	// Remove from the doubly linked list.
@@ -364,170 +458,352 @@ void b2World::DestroyJoint(b2Joint* j)
 	}
 }
 
-// Find islands, integrate and solve constraints, solve position constraints
-void b2World::Solve(const b2TimeStep& step)
+b2ParticleSystem* b2World::CreateParticleSystem(const b2ParticleSystemDef* def)
 {
-	m_profile.solveInit = 0.0f;
-	m_profile.solveVelocity = 0.0f;
-	m_profile.solvePosition = 0.0f;
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return NULL;
+	}
 
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount,
-					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
+	void* mem = m_blockAllocator.Allocate(sizeof(b2ParticleSystem));
+	b2ParticleSystem* p = new (mem) b2ParticleSystem(def, this);
 
-	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	// Add to world doubly linked list.
+	p->m_prev = NULL;
+	p->m_next = m_particleSystemList;
+	if (m_particleSystemList)
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
+		m_particleSystemList->m_prev = p;
 	}
-	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	m_particleSystemList = p;
+
+	return p;
+}
+
+void b2World::DestroyParticleSystem(b2ParticleSystem* p)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
 	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
+		return;
 	}
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
+
+	// Remove from the world doubly linked list.
+	if (p->m_prev)
 	{
-		j->m_islandFlag = false;
+		p->m_prev->m_next = p->m_next;
 	}
 
-	// Build and simulate all awake islands.
-	int32 stackSize = m_bodyCount;
-	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	if (p->m_next)
 	{
-		if (seed->m_flags & b2Body::e_islandFlag)
+		p->m_next->m_prev = p->m_prev;
+	}
+
+	if (p == m_particleSystemList)
+	{
+		m_particleSystemList = p->m_next;
+	}
+
+	p->~b2ParticleSystem();
+	m_blockAllocator.Free(p, sizeof(b2ParticleSystem));
+}
+
+// Find islands, integrate and solve constraints, solve position constraints
+void b2World::AddIsland(b2Body* seed, b2Island* island, b2Body** stack)
+{
+	int32 stackCount = 0;
+	stack[stackCount++] = seed;
+	seed->m_flags |= b2Body::e_islandFlag;
+
+	// Perform a depth first search (DFS) on the constraint graph.
+	while (stackCount > 0)
+	{
+		// Grab the next body off the stack and add it to the island.
+		b2Body* b = stack[--stackCount];
+		b2Assert(b->IsActive() == true);
+		island->Add(b);
+
+		// Make sure the body is awake.
+		b->SetAwake(true);
+
+		// Keep the transform before the step for GetInterpolatedTransform.
+		b->m_position0 = b->m_xf.p;
+		b->m_angle0 = b->m_sweep.a;
+
+		// To keep islands as small as possible, we don't
+		// propagate islands across static bodies.
+		if (b->GetType() == b2_staticBody)
 		{
 			continue;
 		}
 
-		if (seed->IsAwake() == false || seed->IsActive() == false)
+		// Search all contacts connected to this body.
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
 		{
-			continue;
+			b2Contact* contact = ce->contact;
+
+			// Has this contact already been added to an island?
+			if (contact->m_flags & b2Contact::e_islandFlag)
+			{
+				continue;
+			}
+
+			// Is this contact solid and touching, or about to?
+			bool speculative = (contact->m_flags & b2Contact::e_speculativeFlag) == b2Contact::e_speculativeFlag;
+			if (contact->IsEnabled() == false ||
+				(contact->IsTouching() == false && speculative == false))
+			{
+				continue;
+			}
+
+			// Skip sensors.
+			bool sensorA = contact->m_fixtureA->m_isSensor;
+			bool sensorB = contact->m_fixtureB->m_isSensor;
+			if (sensorA || sensorB)
+			{
+				continue;
+			}
+
+			island->Add(contact);
+			contact->m_flags |= b2Contact::e_islandFlag;
+
+			b2Body* other = ce->other;
+
+			// Was the other body already added to this island?
+			if (other->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
+
+			b2Assert(stackCount < m_bodyCount);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
 		}
 
-		// The seed can be dynamic or kinematic.
-		if (seed->GetType() == b2_staticBody)
+		// Search all joints connect to this body.
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
 		{
-			continue;
+			if (je->joint->m_islandFlag == true)
+			{
+				continue;
+			}
+
+			b2Body* other = je->other;
+
+			// Don't simulate joints connected to inactive bodies.
+			if (other->IsActive() == false)
+			{
+				continue;
+			}
+
+			island->Add(je->joint);
+			je->joint->m_islandFlag = true;
+
+			if (other->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
+
+			b2Assert(stackCount < m_bodyCount);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
 		}
+	}
+}
 
-		// Reset island and stack.
-		island.Clear();
-		int32 stackCount = 0;
-		stack[stackCount++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
+bool b2World::PrepareIsland(b2Body** bodies, int32 count, const b2TimeStep& step, b2TimeStep* islandStep)
+{
+	*islandStep = step;
+	if (m_lod == NULL)
+	{
+		return true;
+	}
+
+	// The island goes at the rate of its most important body and catches up
+	// with the body that lags the least, so no body jumps ahead of the world.
+	b2Body* seed = NULL;
+	int32 interval = b2_maxStepInterval;
+	int32 skippedSteps = 0;
+	float32 skippedTime = b2_maxFloat;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Body* b = bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
 
-		// Perform a depth first search (DFS) on the constraint graph.
-		while (stackCount > 0)
+		if (seed == NULL)
 		{
-			// Grab the next body off the stack and add it to the island.
-			b2Body* b = stack[--stackCount];
-			b2Assert(b->IsActive() == true);
-			island.Add(b);
+			seed = b;
+		}
+
+		interval = b2Min(interval, m_lod->GetStepInterval(b));
+		skippedSteps = b2Max(skippedSteps, int32(b->m_skippedSteps));
+		skippedTime = b2Min(skippedTime, b->m_skippedTime);
+	}
+	interval = b2Max(interval, 1);
+
+	if (seed == NULL)
+	{
+		return true;
+	}
 
-			// Make sure the body is awake.
-			b->SetAwake(true);
+	// The phase of the seed spreads the far islands over the steps. An island
+	// that changed seed waits at most one interval.
+	bool solve = interval == 1 ||
+		(m_stepIndex + uint32(seed->m_lodPhase)) % uint32(interval) == 0 ||
+		skippedSteps + 1 >= interval;
 
-			// To keep islands as small as possible, we don't
-			// propagate islands across static bodies.
+	if (solve == false)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			b2Body* b = bodies[i];
 			if (b->GetType() == b2_staticBody)
 			{
 				continue;
 			}
 
-			// Search all contacts connected to this body.
-			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
-			{
-				b2Contact* contact = ce->contact;
+			++b->m_skippedSteps;
+			b->m_skippedTime += step.dt;
 
-				// Has this contact already been added to an island?
-				if (contact->m_flags & b2Contact::e_islandFlag)
-				{
-					continue;
-				}
+			// The body stands still for the continuous collision.
+			b->m_sweep.c0 = b->m_sweep.c;
+			b->m_sweep.a0 = b->m_sweep.a;
+		}
+		return false;
+	}
 
-				// Is this contact solid and touching?
-				if (contact->IsEnabled() == false ||
-					contact->IsTouching() == false)
-				{
-					continue;
-				}
+	islandStep->dt = step.dt + skippedTime;
+	islandStep->inv_dt = islandStep->dt > 0.0f ? 1.0f / islandStep->dt : 0.0f;
 
-				// Skip sensors.
-				bool sensorA = contact->m_fixtureA->m_isSensor;
-				bool sensorB = contact->m_fixtureB->m_isSensor;
-				if (sensorA || sensorB)
-				{
-					continue;
-				}
+	// The warm starting impulses come from the last step of the island, which
+	// may be longer or shorter than the step of the world.
+	if (seed->m_solvedTime > 0.0f)
+	{
+		islandStep->dtRatio = islandStep->dt / seed->m_solvedTime;
+	}
+	if (interval > 1)
+	{
+		m_lod->GetIterations(interval, &islandStep->velocityIterations, &islandStep->positionIterations);
+	}
 
-				island.Add(contact);
-				contact->m_flags |= b2Contact::e_islandFlag;
+	for (int32 i = 0; i < count; ++i)
+	{
+		bodies[i]->m_skippedSteps = 0;
+		bodies[i]->m_skippedTime = 0.0f;
+		bodies[i]->m_solvedTime = islandStep->dt;
+	}
+	return true;
+}
 
-				b2Body* other = ce->other;
+void b2World::Solve(const b2TimeStep& step)
+{
+	m_profile.solveInit = 0.0f;
+	m_profile.solveVelocity = 0.0f;
+	m_profile.solvePosition = 0.0f;
+	m_profile.velocityIterations = 0;
+	m_profile.positionIterations = 0;
+	m_profile.islandCount = 0;
+	m_profile.skippedIslandCount = 0;
+	m_profile.skippedSolve = 0.0f;
 
-				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+	// Clear all the island flags.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+	}
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->m_flags &= ~b2Contact::e_islandFlag;
+	}
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_islandFlag = false;
+	}
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+	int32 solvedCount = 0;
+	int32 skippedCount = 0;
+	if (m_threadPool && m_regionSize > 0.0f)
+	{
+		SolveRegions(step, &solvedCount, &skippedCount);
+	}
+	else
+	{
+		// Size the island for the worst case.
+		b2Island island(m_bodyCount,
+						m_contactManager.m_contactCount,
+						m_jointCount,
+						m_stackAllocator,
+						m_contactManager.m_contactListener);
+
+		// Build and simulate all awake islands.
+		b2Body** stack = (b2Body**)m_stackAllocator->Allocate(m_bodyCount * sizeof(b2Body*));
+		for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+		{
+			if (seed->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
 			}
 
-			// Search all joints connect to this body.
-			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			if (seed->IsAwake() == false || seed->IsActive() == false)
 			{
-				if (je->joint->m_islandFlag == true)
-				{
-					continue;
-				}
+				continue;
+			}
 
-				b2Body* other = je->other;
+			// The seed can be dynamic or kinematic.
+			if (seed->GetType() == b2_staticBody)
+			{
+				continue;
+			}
 
-				// Don't simulate joints connected to inactive bodies.
-				if (other->IsActive() == false)
-				{
-					continue;
-				}
+			island.Clear();
+			AddIsland(seed, &island, stack);
 
-				island.Add(je->joint);
-				je->joint->m_islandFlag = true;
+			int32 itemCount = island.m_bodyCount + island.m_contactCount + island.m_jointCount;
+			b2TimeStep islandStep;
+			if (PrepareIsland(island.m_bodies, island.m_bodyCount, step, &islandStep))
+			{
+				b2Profile profile;
+				island.Solve(&profile, islandStep, m_gravity, m_allowSleep);
+				m_profile.solveInit += profile.solveInit;
+				m_profile.solveVelocity += profile.solveVelocity;
+				m_profile.solvePosition += profile.solvePosition;
+				m_profile.velocityIterations += profile.velocityIterations;
+				m_profile.positionIterations += profile.positionIterations;
+				++m_profile.islandCount;
+				solvedCount += itemCount;
+			}
+			else
+			{
+				++m_profile.skippedIslandCount;
+				skippedCount += itemCount;
+			}
 
-				if (other->m_flags & b2Body::e_islandFlag)
+			// Post solve cleanup.
+			for (int32 i = 0; i < island.m_bodyCount; ++i)
+			{
+				// Allow static bodies to participate in other islands.
+				b2Body* b = island.m_bodies[i];
+				if (b->GetType() == b2_staticBody)
 				{
-					continue;
+					b->m_flags &= ~b2Body::e_islandFlag;
 				}
-
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
 			}
 		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
-
-		// Post solve cleanup.
-		for (int32 i = 0; i < island.m_bodyCount; ++i)
-		{
-			// Allow static bodies to participate in other islands.
-			b2Body* b = island.m_bodies[i];
-			if (b->GetType() == b2_staticBody)
-			{
-				b->m_flags &= ~b2Body::e_islandFlag;
-			}
-		}
+		m_stackAllocator->Free(stack);
 	}
 
-	m_stackAllocator.Free(stack);
+	// Guess the time the skipped islands would have taken from the solved ones.
+	if (solvedCount > 0)
+	{
+		float32 solveTime = m_profile.solveInit + m_profile.solveVelocity + m_profile.solvePosition;
+		m_profile.skippedSolve = solveTime * skippedCount / solvedCount;
+	}
+	++m_stepIndex;
 
 	{
 		b2Timer timer;
@@ -540,13 +816,22 @@ void b2World::Solve(const b2TimeStep& step)
 				continue;
 			}
 
-			if (b->GetType() == b2_staticBody)
+			// Neither did the bodies of skipped islands.
+			if (b->GetType() == b2_staticBody || b->m_skippedSteps > 0)
 			{
 				continue;
 			}
 
-			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+			// Update fixtures (for broad-phase). Speculative contacts have to
+			// exist before the shapes meet, so the AABBs cover the next step.
+			if (m_speculativeContacts)
+			{
+				b->SynchronizeFixtures(step.dt);
+			}
+			else
+			{
+				b->SynchronizeFixtures();
+			}
 		}
 
 		// Look for new contacts.
@@ -555,10 +840,306 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 }
 
+// An island gathered by SolveRegions and the region of its first body.
+struct b2RegionIsland
+{
+	b2IslandRange range;
+	b2TimeStep step;
+	int32 x;
+	int32 y;
+};
+
+// Sorts the island indices by region, then in the order the islands were found.
+struct b2RegionLessThan
+{
+	bool operator()(int32 a, int32 b) const
+	{
+		const b2RegionIsland* islandA = islands + a;
+		const b2RegionIsland* islandB = islands + b;
+		if (islandA->y != islandB->y)
+		{
+			return islandA->y < islandB->y;
+		}
+		if (islandA->x != islandB->x)
+		{
+			return islandA->x < islandB->x;
+		}
+		return a < b;
+	}
+
+	const b2RegionIsland* islands;
+};
+
+// The solver profile summed by a thread, padded to a cache line.
+struct b2RegionProfile
+{
+	float32 solveInit;
+	float32 solveVelocity;
+	float32 solvePosition;
+	int32 velocityIterations;
+	int32 positionIterations;
+	char padding[44];
+};
+
+// Solves the islands of a range of regions, one region at a time.
+struct b2RegionTask : public b2ParallelTask
+{
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		b2StackAllocator* allocator = world->m_stackAllocator;
+		if (threadIndex > 0)
+		{
+			allocator = world->m_threadAllocators + threadIndex - 1;
+		}
+
+		b2RegionProfile* sum = profiles + threadIndex;
+		for (int32 i = regionStarts[begin]; i < regionStarts[end]; ++i)
+		{
+			const b2RegionIsland* record = records + order[i];
+			b2Island island(islands, record->range, allocator);
+
+			b2TimeStep step = record->step;
+			step.threadPool = NULL;
+
+			b2Profile profile;
+			island.Solve(&profile, step, world->m_gravity, world->m_allowSleep);
+			sum->solveInit += profile.solveInit;
+			sum->solveVelocity += profile.solveVelocity;
+			sum->solvePosition += profile.solvePosition;
+			sum->velocityIterations += profile.velocityIterations;
+			sum->positionIterations += profile.positionIterations;
+		}
+	}
+
+	b2World* world;
+	b2Island* islands;
+	const b2RegionIsland* records;
+	const int32* order;
+	const int32* regionStarts;
+	b2RegionProfile* profiles;
+};
+
+// The region of a coordinate. Far away bodies share the outer regions.
+static int32 b2GetRegion(float32 x, float32 inv_size)
+{
+	float32 region = b2Clamp(floorf(x * inv_size), -1048576.0f, 1048576.0f);
+	return (int32)region;
+}
+
+void b2World::SolveRegions(const b2TimeStep& step, int32* solvedCount, int32* skippedCount)
+{
+	int32 threadCount = m_threadPool->GetThreadCount();
+	if (m_threadAllocatorCount < threadCount - 1)
+	{
+		for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+		{
+			m_threadAllocators[i].~b2StackAllocator();
+		}
+		b2Free(m_threadAllocators);
+
+		m_threadAllocatorCount = threadCount - 1;
+		m_threadAllocators = (b2StackAllocator*)b2Alloc(m_threadAllocatorCount * sizeof(b2StackAllocator));
+		for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+		{
+			new (m_threadAllocators + i) b2StackAllocator;
+		}
+	}
+
+	// Gather all the awake islands in one. A static body is flagged once for all
+	// the islands and moved to the end of the arrays, where the islands share it.
+	// The solvers of the islands only store the velocity of a static body
+	// unchanged, since it has no mass.
+	int32 contactCount = m_contactManager.m_contactCount;
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	b2Island islands(m_bodyCount, contactCount, m_jointCount, m_stackAllocator, NULL);
+	if (listener)
+	{
+		islands.m_impulses = (b2ContactImpulse*)m_stackAllocator->Allocate(b2Max(contactCount, 1) * sizeof(b2ContactImpulse));
+	}
+
+	b2RegionIsland* records = (b2RegionIsland*)m_stackAllocator->Allocate(m_bodyCount * sizeof(b2RegionIsland));
+	b2Body** statics = (b2Body**)m_stackAllocator->Allocate(m_bodyCount * sizeof(b2Body*));
+	b2Body** stack = (b2Body**)m_stackAllocator->Allocate(m_bodyCount * sizeof(b2Body*));
+	int32 islandCount = 0;
+	int32 staticCount = 0;
+	float32 inv_size = 1.0f / m_regionSize;
+
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2RegionIsland* record = records + islandCount++;
+		record->range.bodyStart = islands.m_bodyCount;
+		record->range.contactStart = islands.m_contactCount;
+		record->range.jointStart = islands.m_jointCount;
+		record->x = b2GetRegion(seed->m_sweep.c.x, inv_size);
+		record->y = b2GetRegion(seed->m_sweep.c.y, inv_size);
+
+		AddIsland(seed, &islands, stack);
+
+		int32 bodyCount = record->range.bodyStart;
+		for (int32 i = record->range.bodyStart; i < islands.m_bodyCount; ++i)
+		{
+			b2Body* b = islands.m_bodies[i];
+			if (b->GetType() == b2_staticBody)
+			{
+				statics[staticCount++] = b;
+				continue;
+			}
+
+			b->m_islandIndex = bodyCount;
+			islands.m_bodies[bodyCount++] = b;
+		}
+		islands.m_bodyCount = bodyCount;
+
+		record->range.bodyCount = bodyCount - record->range.bodyStart;
+		record->range.contactCount = islands.m_contactCount - record->range.contactStart;
+		record->range.jointCount = islands.m_jointCount - record->range.jointStart;
+
+		// Drop a skipped island. Its static bodies keep their slots.
+		const b2IslandRange& range = record->range;
+		int32 itemCount = range.bodyCount + range.contactCount + range.jointCount;
+		if (PrepareIsland(islands.m_bodies + range.bodyStart, range.bodyCount, step, &record->step) == false)
+		{
+			islands.m_bodyCount = range.bodyStart;
+			islands.m_contactCount = range.contactStart;
+			islands.m_jointCount = range.jointStart;
+			--islandCount;
+			++m_profile.skippedIslandCount;
+			*skippedCount += itemCount;
+			continue;
+		}
+		*solvedCount += itemCount;
+	}
+
+	m_stackAllocator->Free(stack);
+
+	for (int32 i = 0; i < staticCount; ++i)
+	{
+		b2Body* b = statics[i];
+		int32 index = islands.m_bodyCount++;
+		b->m_islandIndex = index;
+		islands.m_bodies[index] = b;
+
+		b->m_sweep.c0 = b->m_sweep.c;
+		b->m_sweep.a0 = b->m_sweep.a;
+		islands.m_positions[index].c = b->m_sweep.c;
+		islands.m_positions[index].a = b->m_sweep.a;
+		islands.m_velocities[index].v = b->m_linearVelocity;
+		islands.m_velocities[index].w = b->m_angularVelocity;
+
+		// Allow the continuous solver to add the static body to its islands.
+		b->m_flags &= ~b2Body::e_islandFlag;
+	}
+
+	// Sort the islands by region. Large islands are left out.
+	int32* order = (int32*)m_stackAllocator->Allocate(b2Max(islandCount, 1) * sizeof(int32));
+	int32 orderCount = 0;
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange& range = records[i].range;
+		if (range.contactCount + range.jointCount < b2_minParallelConstraints)
+		{
+			order[orderCount++] = i;
+		}
+	}
+
+	b2RegionLessThan lessThan;
+	lessThan.islands = records;
+	std::sort(order, order + orderCount, lessThan);
+
+	int32* regionStarts = (int32*)m_stackAllocator->Allocate((orderCount + 1) * sizeof(int32));
+	int32 regionCount = 0;
+	for (int32 i = 0; i < orderCount; ++i)
+	{
+		const b2RegionIsland* record = records + order[i];
+		if (i == 0 || record->x != records[order[i - 1]].x || record->y != records[order[i - 1]].y)
+		{
+			regionStarts[regionCount++] = i;
+		}
+	}
+	regionStarts[regionCount] = orderCount;
+
+	b2RegionProfile* profiles = (b2RegionProfile*)m_stackAllocator->Allocate(threadCount * sizeof(b2RegionProfile));
+	memset(profiles, 0, threadCount * sizeof(b2RegionProfile));
+
+	b2RegionTask task;
+	task.world = this;
+	task.islands = &islands;
+	task.records = records;
+	task.order = order;
+	task.regionStarts = regionStarts;
+	task.profiles = profiles;
+	m_threadPool->ParallelFor(&task, regionCount, 1);
+
+	// Large islands use all the threads, one after the other.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange& range = records[i].range;
+		if (range.contactCount + range.jointCount < b2_minParallelConstraints)
+		{
+			continue;
+		}
+
+		b2Island island(&islands, range, m_stackAllocator);
+
+		b2Profile profile;
+		island.Solve(&profile, records[i].step, m_gravity, m_allowSleep);
+		m_profile.solveInit += profile.solveInit;
+		m_profile.solveVelocity += profile.solveVelocity;
+		m_profile.solvePosition += profile.solvePosition;
+		m_profile.velocityIterations += profile.velocityIterations;
+		m_profile.positionIterations += profile.positionIterations;
+	}
+
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		m_profile.solveInit += profiles[i].solveInit;
+		m_profile.solveVelocity += profiles[i].solveVelocity;
+		m_profile.solvePosition += profiles[i].solvePosition;
+		m_profile.velocityIterations += profiles[i].velocityIterations;
+		m_profile.positionIterations += profiles[i].positionIterations;
+	}
+	m_profile.islandCount = islandCount;
+
+	// Report the impulses in the order the islands were found.
+	if (listener)
+	{
+		for (int32 i = 0; i < islands.m_contactCount; ++i)
+		{
+			listener->PostSolve(islands.m_contacts[i], islands.m_impulses + i);
+		}
+	}
+
+	m_stackAllocator->Free(profiles);
+	m_stackAllocator->Free(regionStarts);
+	m_stackAllocator->Free(order);
+	m_stackAllocator->Free(statics);
+	m_stackAllocator->Free(records);
+	if (listener)
+	{
+		m_stackAllocator->Free(islands.m_impulses);
+	}
+}
+
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
-	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, m_stackAllocator, m_contactManager.m_contactListener);
 
 	if (m_stepComplete)
 	{
@@ -670,6 +1251,11 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 				b2TOIOutput output;
 				b2TimeOfImpact(&output, &input);
+				++m_contactManager.m_toiCallCount;
+				m_contactManager.m_toiIterCount += output.iterations;
+				m_contactManager.m_toiRootIterCount += output.rootIterations;
+				m_contactManager.m_gjkCallCount += output.distanceCalls;
+				m_contactManager.m_gjkIterCount += output.distanceIterations;
 
 				// Beta is the fraction of the remaining portion of the .
 				float32 beta = output.t;
@@ -714,7 +1300,9 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		bB->Advance(minAlpha);
 
 		// The TOI contact likely has some new contact points.
-		minContact->Update(m_contactManager.m_contactListener);
+		bool wasTouching = minContact->IsTouching();
+		minContact->Update(m_contactManager.m_contactListener, 0.0f);
+		m_contactManager.AddEvents(minContact, wasTouching, minContact->IsTouching());
 		minContact->m_flags &= ~b2Contact::e_toiFlag;
 		++minContact->m_toiCount;
 
@@ -794,7 +1382,9 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					}
 
 					// Update the contact points
-					contact->Update(m_contactManager.m_contactListener);
+					bool wasTouching = contact->IsTouching();
+					contact->Update(m_contactManager.m_contactListener, 0.0f);
+					m_contactManager.AddEvents(contact, wasTouching, contact->IsTouching());
 
 					// Was the contact disabled by the user?
 					if (contact->IsEnabled() == false)
@@ -841,6 +1431,10 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.dtRatio = 1.0f;
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
+		subStep.subStepCount = 0;
+		subStep.threadPool = NULL;
+		subStep.velocityTolerance = 0.0f;
+		subStep.minVelocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
 
@@ -880,6 +1474,11 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 {
 	b2Timer stepTimer;
 
+	if (m_recorder)
+	{
+		m_recorder->BeginStep(dt, velocityIterations, positionIterations);
+	}
+
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_flags & e_newFixture)
 	{
@@ -889,10 +1488,31 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 
 	m_flags |= e_locked;
 
+	if (m_stackAllocator == NULL)
+	{
+		void* mem = b2Alloc(sizeof(b2StackAllocator));
+		m_stackAllocator = new (mem) b2StackAllocator;
+	}
+
+	m_contactManager.m_broadPhase.ResetCounters();
+	m_contactManager.m_satCallCount = 0;
+	m_contactManager.m_satCacheHitCount = 0;
+	m_contactManager.m_gjkCallCount = 0;
+	m_contactManager.m_gjkIterCount = 0;
+	m_contactManager.m_toiCallCount = 0;
+	m_contactManager.m_toiIterCount = 0;
+	m_contactManager.m_toiRootIterCount = 0;
+	m_contactManager.ClearEvents();
+	m_contactManager.m_recordEvents = m_contactEventsEnabled;
+
 	b2TimeStep step;
 	step.dt = dt;
 	step.velocityIterations	= velocityIterations;
 	step.positionIterations = positionIterations;
+	step.subStepCount = m_softSubSteps;
+	step.threadPool = m_threadPool;
+	step.velocityTolerance = m_velocityTolerance;
+	step.minVelocityIterations = m_minVelocityIterations;
 	if (dt > 0.0f)
 	{
 		step.inv_dt = 1.0f / dt;
@@ -909,10 +1529,22 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	// Update contacts. This is where some contacts are destroyed.
 	{
 		b2Timer timer;
+		m_contactManager.m_speculativeTime = m_speculativeContacts ? step.dt : 0.0f;
 		m_contactManager.Collide();
 		m_profile.collide = timer.GetMilliseconds();
 	}
 
+	// Move the particles first, the impulses they apply are integrated with the bodies.
+	if (m_stepComplete && step.dt > 0.0f && m_particleSystemList)
+	{
+		b2Timer timer;
+		for (b2ParticleSystem* p = m_particleSystemList; p; p = p->GetNext())
+		{
+			p->Solve(step);
+		}
+		m_profile.particles = timer.GetMilliseconds();
+	}
+
 	// Integrate velocities, solve velocity constraints, and integrate positions.
 	if (m_stepComplete && step.dt > 0.0f)
 	{
@@ -921,8 +1553,8 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 		m_profile.solve = timer.GetMilliseconds();
 	}
 
-	// Handle TOI events.
-	if (m_continuousPhysics && step.dt > 0.0f)
+	// Handle TOI events. Speculative contacts replace them.
+	if (b2_enableContinuous && m_continuousPhysics && m_speculativeContacts == false && step.dt > 0.0f)
 	{
 		b2Timer timer;
 		SolveTOI(step);
@@ -940,8 +1572,24 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	}
 
 	m_flags &= ~e_locked;
-
+	m_contactManager.m_recordEvents = false;
+
+	m_profile.reinsertCount = m_contactManager.m_broadPhase.GetReinsertCount();
+	m_profile.bufferedMoveCount = m_contactManager.m_broadPhase.GetBufferedMoveCount();
+	m_profile.falsePairCount = m_contactManager.m_falsePairCount;
+	m_profile.satCallCount = m_contactManager.m_satCallCount;
+	m_profile.satCacheHitCount = m_contactManager.m_satCacheHitCount;
+	m_profile.gjkCallCount = m_contactManager.m_gjkCallCount;
+	m_profile.gjkIterCount = m_contactManager.m_gjkIterCount;
+	m_profile.toiCallCount = m_contactManager.m_toiCallCount;
+	m_profile.toiIterCount = m_contactManager.m_toiIterCount;
+	m_profile.toiRootIterCount = m_contactManager.m_toiRootIterCount;
 	m_profile.step = stepTimer.GetMilliseconds();
+
+	if (m_recorder)
+	{
+		m_recorder->EndStep();
+	}
 }
 
 void b2World::ClearForces()
@@ -973,6 +1621,42 @@ void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
 	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
 }
 
+// Reports the children of a compound hit by the ray. The hierarchy is walked
+// with the ray in the body frame, the children are cast with the world ray.
+struct b2CompoundRayCastWrapper
+{
+	float32 RayCastCallback(const b2RayCastInput& localInput, int32 childIndex)
+	{
+		b2RayCastInput childInput = *input;
+		childInput.maxFraction = localInput.maxFraction;
+		b2RayCastOutput output;
+		bool hit = fixture->RayCast(&output, childInput, childIndex);
+		if (hit == false)
+		{
+			return localInput.maxFraction;
+		}
+
+		float32 fraction = output.fraction;
+		b2Vec2 point = (1.0f - fraction) * input->p1 + fraction * input->p2;
+		float32 value = callback->ReportFixture(fixture, point, output.normal, fraction);
+		if (value == 0.0f)
+		{
+			terminated = true;
+		}
+		else if (value > 0.0f)
+		{
+			maxFraction = value;
+		}
+		return value;
+	}
+
+	const b2RayCastInput* input;
+	b2Fixture* fixture;
+	b2RayCastCallback* callback;
+	float32 maxFraction;
+	bool terminated;
+};
+
 struct b2WorldRayCastWrapper
 {
 	float32 RayCastCallback(const b2RayCastInput& input, int32 proxyId)
@@ -980,18 +1664,51 @@ struct b2WorldRayCastWrapper
 		void* userData = broadPhase->GetUserData(proxyId);
 		b2FixtureProxy* proxy = (b2FixtureProxy*)userData;
 		b2Fixture* fixture = proxy->fixture;
-		int32 index = proxy->childIndex;
-		b2RayCastOutput output;
-		bool hit = fixture->RayCast(&output, input, index);
 
-		if (hit)
+		if (fixture->GetType() == b2Shape::e_compound)
+		{
+			const b2Transform& xf = fixture->GetBody()->GetTransform();
+			b2RayCastInput localInput;
+			localInput.p1 = b2MulT(xf, input.p1);
+			localInput.p2 = b2MulT(xf, input.p2);
+			localInput.maxFraction = input.maxFraction;
+
+			b2CompoundRayCastWrapper wrapper;
+			wrapper.input = &input;
+			wrapper.fixture = fixture;
+			wrapper.callback = callback;
+			wrapper.maxFraction = input.maxFraction;
+			wrapper.terminated = false;
+			((b2CompoundShape*)fixture->GetShape())->RayCast(&wrapper, localInput);
+			return wrapper.terminated ? 0.0f : wrapper.maxFraction;
+		}
+
+		// A chain proxy covers several edges.
+		b2RayCastInput childInput = input;
+		for (int32 i = 0; i < proxy->childCount; ++i)
 		{
-			float32 fraction = output.fraction;
-			b2Vec2 point = (1.0f - fraction) * input.p1 + fraction * input.p2;
-			return callback->ReportFixture(fixture, point, output.normal, fraction);
+			int32 index = proxy->childIndex + i;
+			b2RayCastOutput output;
+			bool hit = fixture->RayCast(&output, childInput, index);
+
+			if (hit)
+			{
+				float32 fraction = output.fraction;
+				b2Vec2 point = (1.0f - fraction) * input.p1 + fraction * input.p2;
+				float32 value = callback->ReportFixture(fixture, point, output.normal, fraction);
+				if (value == 0.0f)
+				{
+					return 0.0f;
+				}
+
+				if (value > 0.0f)
+				{
+					childInput.maxFraction = value;
+				}
+			}
 		}
 
-		return input.maxFraction;
+		return childInput.maxFraction;
 	}
 
 	const b2BroadPhase* broadPhase;
@@ -1067,6 +1784,25 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
 		}
 		break;
+
+	case b2Shape::e_compound:
+		{
+			b2CompoundShape* compound = (b2CompoundShape*)fixture->GetShape();
+			for (int32 i = 0; i < compound->GetChildCount(); ++i)
+			{
+				const b2PolygonShape* poly = compound->GetChild(i);
+				int32 vertexCount = poly->m_vertexCount;
+				b2Vec2 vertices[b2_maxPolygonVertices];
+
+				for (int32 j = 0; j < vertexCount; ++j)
+				{
+					vertices[j] = b2Mul(xf, poly->m_vertices[j]);
+				}
+
+				m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
+			}
+		}
+		break;
             
     default:
         break;
@@ -1152,6 +1888,11 @@ void b2World::DrawDebugData()
 				}
 			}
 		}
+
+		for (b2ParticleSystem* p = m_particleSystemList; p; p = p->GetNext())
+		{
+			p->Draw(m_debugDraw);
+		}
 	}
 
 	if (flags & b2Draw::e_jointBit)
@@ -1237,3 +1978,88 @@ float32 b2World::GetTreeQuality() const
 {
 	return m_contactManager.m_broadPhase.GetTreeQuality();
 }
+
+b2MemoryReport b2World::GetMemoryReport() const
+{
+	b2MemoryReport report;
+	report.bodies = m_bodyCount * b2BlockAllocator::GetBlockSize(sizeof(b2Body));
+	report.fixtures = 0;
+	report.shapes = 0;
+	report.contacts = 0;
+	report.joints = 0;
+	report.particles = 0;
+
+	for (const b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (const b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			report.fixtures += f->GetMemory();
+
+			const b2Shape* shape = f->m_shape;
+			if (shape->m_type == b2Shape::e_chain)
+			{
+				report.shapes += ((const b2ChainShape*)shape)->GetMemory();
+			}
+			else if (shape->m_type == b2Shape::e_compound)
+			{
+				report.shapes += ((const b2CompoundShape*)shape)->GetMemory();
+			}
+		}
+	}
+
+	for (const b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		report.contacts += c->GetMemory();
+	}
+
+	for (const b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		report.joints += j->GetMemory();
+	}
+
+	// The particle systems are in the block allocator, their arrays aren't.
+	int32 particleArrays = 0;
+	for (const b2ParticleSystem* p = m_particleSystemList; p; p = p->m_next)
+	{
+		particleArrays += p->GetMemory();
+		report.particles += b2BlockAllocator::GetBlockSize(sizeof(b2ParticleSystem));
+	}
+	report.particles += particleArrays;
+
+	report.broadPhase = m_contactManager.m_broadPhase.GetMemory();
+	report.blockAllocator = m_blockAllocator.GetMemory();
+
+	report.stack = m_threadAllocatorCount * sizeof(b2StackAllocator);
+	report.stackPeak = 0;
+	if (m_stackAllocator)
+	{
+		report.stack += sizeof(b2StackAllocator);
+		report.stackPeak = m_stackAllocator->GetMaxAllocation();
+	}
+
+	for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+	{
+		report.stackPeak = b2Max(report.stackPeak, m_threadAllocators[i].GetMaxAllocation());
+	}
+
+	report.total = report.blockAllocator + report.shapes + particleArrays + report.broadPhase + report.stack;
+	return report;
+}
+
+b2ContactEvents b2World::GetContactEvents() const
+{
+	b2ContactEvents events;
+	events.beginEvents = m_contactManager.m_beginEvents.GetData();
+	events.beginCount = m_contactManager.m_beginEvents.GetCount();
+	events.endEvents = m_contactManager.m_endEvents.GetData();
+	events.endCount = m_contactManager.m_endEvents.GetCount();
+	events.hitEvents = m_contactManager.m_hitEvents.GetData();
+	events.hitCount = m_contactManager.m_hitEvents.GetCount();
+	return events;
+}
+
+void b2World::SetAdaptiveMargins(bool flag)
+{
+	m_adaptiveMargins = flag;
+	m_contactManager.m_broadPhase.SetAdaptiveMargins(flag);
+}
@@ -30,10 +30,14 @@ struct b2AABB;
 struct b2BodyDef;
 struct b2Color;
 struct b2JointDef;
+struct b2ParticleSystemDef;
 class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2ParticleSystem;
+class b2Island;
+class b2Recorder;
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -87,6 +91,15 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyJoint(b2Joint* joint);
 
+	/// Create a particle system given a definition. No reference to the definition
+	/// is retained. The particles are solved in Step, before the bodies.
+	/// @warning This function is locked during callbacks.
+	b2ParticleSystem* CreateParticleSystem(const b2ParticleSystemDef* def);
+
+	/// Destroy a particle system and all its particles.
+	/// @warning This function is locked during callbacks.
+	void DestroyParticleSystem(b2ParticleSystem* system);
+
 	/// Take a time step. This performs collision detection, integration,
 	/// and constraint solution.
 	/// @param timeStep the amount of time to simulate, this should not vary.
@@ -122,6 +135,24 @@ public:
 	/// @param point2 the ray ending point
 	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
 
+	/// Write the bodies, fixtures and joints in the binary scene format, see
+	/// b2Scene.h. The user data and the contacts are not saved.
+	/// @param buffer 4 byte aligned, may be NULL to get the size.
+	/// @param flags see b2SceneFlags.
+	/// @return the size of the scene. Nothing is written if it exceeds capacity.
+	/// @warning This function is locked during callbacks.
+	int32 Save(void* buffer, int32 capacity, uint32 flags);
+
+	/// Add the bodies, fixtures and joints of a scene to the world and set its
+	/// gravity. The scene is read in place, so it may be memory mapped. The new
+	/// proxies are inserted in the broad-phase in bulk.
+	/// @param data 4 byte aligned.
+	/// @param bodies if not NULL, receives the new bodies in the order of the scene.
+	/// @return false if the data isn't a valid scene of this version. Nothing is
+	/// created then.
+	/// @warning This function is locked during callbacks.
+	bool Load(const void* data, int32 size, b2Body** bodies);
+
 	/// Get the world body list. With the returned body, use b2Body::GetNext to get
 	/// the next body in the world list. A NULL body indicates the end of the list.
 	/// @return the head of the world body list.
@@ -134,6 +165,11 @@ public:
 	b2Joint* GetJointList();
 	const b2Joint* GetJointList() const;
 
+	/// Get the world particle system list. With the returned system, use
+	/// b2ParticleSystem::GetNext to get the next system in the world list.
+	b2ParticleSystem* GetParticleSystemList() { return m_particleSystemList; }
+	const b2ParticleSystem* GetParticleSystemList() const { return m_particleSystemList; }
+
 	/// Get the world contact list. With the returned contact, use b2Contact::GetNext to get
 	/// the next contact in the world list. A NULL contact indicates the end of the list.
 	/// @return the head of the world contact list.
@@ -151,6 +187,98 @@ public:
 	/// Enable/disable single stepped continuous physics. For testing.
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 
+	/// Enable/disable speculative contacts, a cheaper alternative to continuous physics.
+	/// Shapes that are apart but can meet within the step at their current velocities
+	/// get a contact point that only removes the velocity closing the gap, so fast
+	/// bodies stop at the surface instead of tunneling. There is no serial TOI pass:
+	/// continuous physics is skipped while this is on. The AABBs cover the motion of
+	/// the next step. Speculative contacts are not touching but they get PreSolve.
+	/// Off by default: the larger AABBs make the collide pass slower, which only
+	/// pays off when the TOI pass is busy, and the volley scenes don't get faster.
+	void SetSpeculativeContacts(bool flag) { m_speculativeContacts = flag; }
+
+	/// Are speculative contacts on?
+	bool GetSpeculativeContacts() const { return m_speculativeContacts; }
+
+	/// Enable/disable the contact event buffers. During each step, the contacts of
+	/// sensors and of bodies with contact events enabled (see b2BodyDef::contactEvents)
+	/// record when they begin and end touching, and the hits faster than
+	/// b2_hitEventThreshold. Read them with GetContactEvents once Step returns,
+	/// no callback is involved. The contact listener, if any, is still called.
+	void SetContactEventsEnabled(bool flag) { m_contactEventsEnabled = flag; }
+
+	/// Are the contact event buffers enabled?
+	bool IsContactEventsEnabled() const { return m_contactEventsEnabled; }
+
+	/// Get the contact events recorded by the last step.
+	b2ContactEvents GetContactEvents() const;
+
+	/// Enable/disable adaptive fat AABB margins. Proxies that keep leaving their fat
+	/// AABB predict their motion further, so fast bodies are re-inserted in the
+	/// broad-phase less often, and proxies that barely move get smaller margins, so
+	/// fewer contacts are kept for shapes that are apart. The churn is reported in
+	/// the profile.
+	void SetAdaptiveMargins(bool flag);
+
+	/// Are adaptive fat AABB margins on?
+	bool GetAdaptiveMargins() const { return m_adaptiveMargins; }
+
+	/// Select the soft step solver. Each time step is split into this many sub-steps, each
+	/// one solving soft contacts once with bias and relaxing once without. The velocity and
+	/// position iteration counts given to Step are then ignored, except by continuous physics.
+	/// Use 0 (the default) for the iterative solver.
+	void SetSoftStepping(int32 subStepCount) { m_softSubSteps = b2Max(subStepCount, 0); }
+
+	/// Get the number of soft step sub-steps, 0 when the iterative solver is used.
+	int32 GetSoftStepping() const { return m_softSubSteps; }
+
+	/// Let converged islands stop the velocity iterations early. An island stops once no
+	/// constraint impulse changed by more than the tolerance (in N*s) during an iteration,
+	/// after at least minIterations. The velocityIterations given to Step is the maximum.
+	/// A tolerance of 0 (the default) always runs all the iterations. The iterations used
+	/// are reported in the profile.
+	void SetAdaptiveIterations(float32 tolerance, int32 minIterations)
+	{
+		m_velocityTolerance = b2Max(tolerance, 0.0f);
+		m_minVelocityIterations = b2Max(minIterations, 1);
+	}
+
+	/// Solve the constraints of large islands on the threads of this pool, see
+	/// b2ParallelSolver. The world doesn't own the pool. Islands solved in parallel
+	/// give the same result whatever the number of threads, but not the same as
+	/// without a pool. The soft step solver and continuous physics use one thread.
+	void SetThreadPool(b2ThreadPool* threadPool) { m_threadPool = threadPool; }
+
+	/// Get the thread pool, NULL if the world uses a single thread.
+	b2ThreadPool* GetThreadPool() const { return m_threadPool; }
+
+	/// Solve the islands of separate regions concurrently on the threads of the
+	/// pool. The world is split in square regions of this size, in meters, and an
+	/// island belongs to the region of its first body for the step. Islands meet
+	/// only at static bodies, which the regions share read-only, so wide worlds on
+	/// a single ground body scale with the threads. The bodies move exactly as
+	/// without regions. The contact listener gets PostSolve once all the islands
+	/// are solved. Large islands are still solved one at a time by b2ParallelSolver.
+	/// Use 0 (the default) to solve the islands one after the other.
+	void SetRegionSize(float32 size) { m_regionSize = b2Max(size, 0.0f); }
+
+	/// Get the region size, 0 when the islands are solved one after the other.
+	float32 GetRegionSize() const { return m_regionSize; }
+
+	/// Solve the islands far from the player less often, see b2LevelOfDetail.
+	/// An island left out of a step is still collided but doesn't move. When it
+	/// is solved again, it takes the time it missed in one larger step, so it
+	/// keeps up with the rest of the world. Its forces only act on the steps that
+	/// solve it. A replay needs the same level of detail. The world doesn't own
+	/// it, use NULL (the default) to solve every island every step.
+	void SetLevelOfDetail(b2LevelOfDetail* lod);
+
+	/// Get the level of detail, NULL if every island is solved every step.
+	b2LevelOfDetail* GetLevelOfDetail() const { return m_lod; }
+
+	/// Get the recorder of the world, see b2Recorder. NULL if not recording.
+	b2Recorder* GetRecorder() const { return m_recorder; }
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
@@ -194,6 +322,10 @@ public:
 	/// Get the current profile.
 	const b2Profile& GetProfile() const;
 
+	/// Count the memory used by the world. This walks the bodies, contacts and
+	/// joints, don't call it every step.
+	b2MemoryReport GetMemoryReport() const;
+
 private:
 
 	// m_flags
@@ -206,17 +338,37 @@ private:
 
 	friend class b2Body;
 	friend class b2Fixture;
+	friend class b2Contact;
 	friend class b2ContactManager;
 	friend class b2Controller;
+	friend class b2ParticleSystem;
+	friend class b2WorldGroup;
+	friend class b2Recorder;
+	friend class b2Replayer;
+	friend struct b2RegionTask;
 
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
+	// Add the bodies, contacts and joints connected to the seed to the island.
+	void AddIsland(b2Body* seed, b2Island* island, b2Body** stack);
+
+	// Decide if an island is solved this step and with which time step. A skipped
+	// island only adds the step to the lag of its bodies.
+	bool PrepareIsland(b2Body** bodies, int32 count, const b2TimeStep& step, b2TimeStep* islandStep);
+
+	// Solve the islands by region on the thread pool, see SetRegionSize. Counts
+	// the bodies, contacts and joints of the islands solved and skipped.
+	void SolveRegions(const b2TimeStep& step, int32* solvedCount, int32* skippedCount);
+
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
 	b2BlockAllocator m_blockAllocator;
-	b2StackAllocator m_stackAllocator;
+
+	// Scratch memory of the step, allocated by the first step. b2WorldGroup swaps
+	// in the one of the thread stepping the world.
+	b2StackAllocator* m_stackAllocator;
 
 	int32 m_flags;
 
@@ -224,6 +376,7 @@ private:
 
 	b2Body* m_bodyList;
 	b2Joint* m_jointList;
+	b2ParticleSystem* m_particleSystemList;
 
 	int32 m_bodyCount;
 	int32 m_jointCount;
@@ -242,6 +395,28 @@ private:
 	bool m_warmStarting;
 	bool m_continuousPhysics;
 	bool m_subStepping;
+	bool m_speculativeContacts;
+	bool m_adaptiveMargins;
+	bool m_contactEventsEnabled;
+
+	int32 m_softSubSteps;
+
+	float32 m_velocityTolerance;
+	int32 m_minVelocityIterations;
+
+	b2ThreadPool* m_threadPool;
+	b2Recorder* m_recorder;
+
+	float32 m_regionSize;
+
+	// Scratch memory of the pool threads other than the calling one, for regions.
+	b2StackAllocator* m_threadAllocators;
+	int32 m_threadAllocatorCount;
+
+	b2LevelOfDetail* m_lod;
+
+	// The number of solved steps, to stagger the far islands.
+	uint32 m_stepIndex;
 
 	bool m_stepComplete;
 
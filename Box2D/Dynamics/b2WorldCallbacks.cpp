@@ -18,6 +18,7 @@
 
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2Body.h>
 
 // Return true if contact calculations should be performed between these two shapes.
 // If you implement your own collision filter you may want to build from this implementation.
@@ -34,3 +35,41 @@ bool b2ContactFilter::ShouldCollide(b2Fixture* fixtureA, b2Fixture* fixtureB)
 	bool collide = (filterA.maskBits & filterB.categoryBits) != 0 && (filterA.categoryBits & filterB.maskBits) != 0;
 	return collide;
 }
+
+b2RegionOfInterest::b2RegionOfInterest()
+{
+	aabb.lowerBound.SetZero();
+	aabb.upperBound.SetZero();
+	falloff = 10.0f;
+	maxInterval = 4;
+	farVelocityIterations = 0;
+	farPositionIterations = 0;
+}
+
+int32 b2RegionOfInterest::GetStepInterval(b2Body* body)
+{
+	b2Vec2 p = body->GetWorldCenter();
+	b2Vec2 d = b2Max(b2Max(aabb.lowerBound - p, p - aabb.upperBound), b2Vec2_zero);
+	float32 distance = d.Length();
+
+	int32 interval = 1;
+	while (distance > falloff && interval < maxInterval)
+	{
+		interval *= 2;
+		distance -= falloff;
+	}
+	return b2Min(interval, maxInterval);
+}
+
+void b2RegionOfInterest::GetIterations(int32 interval, int32* velocityIterations, int32* positionIterations)
+{
+	B2_NOT_USED(interval);
+	if (farVelocityIterations > 0)
+	{
+		*velocityIterations = farVelocityIterations;
+	}
+	if (farPositionIterations > 0)
+	{
+		*positionIterations = farPositionIterations;
+	}
+}
@@ -19,7 +19,8 @@
 #ifndef B2_WORLD_CALLBACKS_H
 #define B2_WORLD_CALLBACKS_H
 
-#include <Box2D/Common/b2Settings.h>
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Collision/b2Collision.h>
 
 struct b2Vec2;
 struct b2Transform;
@@ -69,6 +70,44 @@ struct b2ContactImpulse
 	int32 count;
 };
 
+/// A contact started touching. Recorded by b2World::Step when contact events are
+/// enabled, see b2World::SetContactEventsEnabled.
+struct b2ContactBeginEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+};
+
+/// A contact stopped touching, or was destroyed while touching.
+struct b2ContactEndEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+};
+
+/// A contact started touching faster than b2_hitEventThreshold. The point is
+/// where the shapes approach the fastest, the normal points from A to B.
+struct b2ContactHitEvent
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2Vec2 point;
+	b2Vec2 normal;
+	float32 approachSpeed;
+};
+
+/// The contact events recorded by the last time step. The arrays are owned by
+/// the world and are valid until the next step or until a fixture is destroyed.
+struct b2ContactEvents
+{
+	const b2ContactBeginEvent* beginEvents;
+	int32 beginCount;
+	const b2ContactEndEvent* endEvents;
+	int32 endCount;
+	const b2ContactHitEvent* hitEvents;
+	int32 hitCount;
+};
+
 /// Implement this class to get contact information. You can use these results for
 /// things like sounds and game logic. You can also get contact results by
 /// traversing the contact lists after the time step. However, you might miss
@@ -96,6 +135,8 @@ public:
 	/// Note: this is called only for awake bodies.
 	/// Note: this is called even when the number of contact points is zero.
 	/// Note: this is not called for sensors.
+	/// Note: with speculative contacts, this is also called for contacts that
+	/// don't touch yet but may during the step.
 	/// Note: if you set the number of contact points to zero, you will not
 	/// get an EndContact callback. However, you may get a BeginContact callback
 	/// the next step.
@@ -118,6 +159,56 @@ public:
 	}
 };
 
+/// Implement this class to solve the islands nobody watches less often than the
+/// others. See b2World::SetLevelOfDetail.
+class b2LevelOfDetail
+{
+public:
+	virtual ~b2LevelOfDetail() {}
+
+	/// Return how many steps apart the body needs to be solved, 1 for every step.
+	/// An island is solved at the rate of its most important body. Called once per
+	/// step for the bodies of awake islands.
+	virtual int32 GetStepInterval(b2Body* body) = 0;
+
+	/// Adjust the iterations of an island solved every interval steps, interval > 1.
+	/// They start with the iterations given to b2World::Step. Unchanged by default.
+	virtual void GetIterations(int32 interval, int32* velocityIterations, int32* positionIterations)
+	{
+		B2_NOT_USED(interval);
+		B2_NOT_USED(velocityIterations);
+		B2_NOT_USED(positionIterations);
+	}
+};
+
+/// A level of detail around a box, usually the view. The bodies in the box are
+/// solved every step. Outside of it, the step interval doubles every falloff
+/// meters, up to maxInterval.
+class b2RegionOfInterest : public b2LevelOfDetail
+{
+public:
+	b2RegionOfInterest();
+
+	int32 GetStepInterval(b2Body* body);
+
+	/// Use farVelocityIterations and farPositionIterations when set.
+	void GetIterations(int32 interval, int32* velocityIterations, int32* positionIterations);
+
+	/// The box solved every step.
+	b2AABB aabb;
+
+	/// The distance from the box, in meters, that doubles the step interval.
+	float32 falloff;
+
+	/// The largest step interval. A body moves by the whole interval at once, keep
+	/// it small for bodies that may still be seen.
+	int32 maxInterval;
+
+	/// The iterations of the islands solved less often, 0 to keep the ones of the step.
+	int32 farVelocityIterations;
+	int32 farPositionIterations;
+};
+
 /// Callback class for AABB queries.
 /// See b2World::Query
 class b2QueryCallback
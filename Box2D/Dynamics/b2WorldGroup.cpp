@@ -0,0 +1,142 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2WorldGroup.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2ThreadPool.h>
+#include <cstring>
+#include <new>
+
+struct b2WorldGroupTask : public b2ParallelTask
+{
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		group->StepWorlds(begin, end, threadIndex);
+	}
+
+	b2WorldGroup* group;
+};
+
+b2WorldGroup::b2WorldGroup(int32 threadCount)
+{
+	void* mem = b2Alloc(sizeof(b2ThreadPool));
+	m_threadPool = new (mem) b2ThreadPool(threadCount);
+
+	// The pool may have started fewer threads than asked.
+	m_stackAllocatorCount = m_threadPool->GetThreadCount();
+	m_stackAllocators = (b2StackAllocator*)b2Alloc(m_stackAllocatorCount * sizeof(b2StackAllocator));
+	for (int32 i = 0; i < m_stackAllocatorCount; ++i)
+	{
+		new (m_stackAllocators + i) b2StackAllocator;
+	}
+
+	m_worlds = NULL;
+	m_worldCount = 0;
+	m_worldCapacity = 0;
+
+	m_timeStep = 0.0f;
+	m_velocityIterations = 0;
+	m_positionIterations = 0;
+}
+
+b2WorldGroup::~b2WorldGroup()
+{
+	m_threadPool->~b2ThreadPool();
+	b2Free(m_threadPool);
+
+	for (int32 i = 0; i < m_stackAllocatorCount; ++i)
+	{
+		m_stackAllocators[i].~b2StackAllocator();
+	}
+	b2Free(m_stackAllocators);
+
+	b2Free(m_worlds);
+}
+
+void b2WorldGroup::AddWorld(b2World* world)
+{
+	b2Assert(world->IsLocked() == false);
+
+	if (m_worldCount == m_worldCapacity)
+	{
+		b2World** old = m_worlds;
+		m_worldCapacity = b2Max(2 * m_worldCapacity, 16);
+		m_worlds = (b2World**)b2Alloc(m_worldCapacity * sizeof(b2World*));
+		if (old)
+		{
+			memcpy(m_worlds, old, m_worldCount * sizeof(b2World*));
+			b2Free(old);
+		}
+	}
+
+	m_worlds[m_worldCount++] = world;
+
+	// The world borrows the scratch memory of the threads from now on.
+	if (world->m_stackAllocator)
+	{
+		world->m_stackAllocator->~b2StackAllocator();
+		b2Free(world->m_stackAllocator);
+		world->m_stackAllocator = NULL;
+	}
+}
+
+void b2WorldGroup::RemoveWorld(b2World* world)
+{
+	for (int32 i = 0; i < m_worldCount; ++i)
+	{
+		if (m_worlds[i] == world)
+		{
+			m_worlds[i] = m_worlds[--m_worldCount];
+			return;
+		}
+	}
+
+	b2Assert(false);
+}
+
+b2World* b2WorldGroup::GetWorld(int32 index)
+{
+	b2Assert(0 <= index && index < m_worldCount);
+	return m_worlds[index];
+}
+
+void b2WorldGroup::StepWorlds(int32 begin, int32 end, int32 threadIndex)
+{
+	b2StackAllocator* allocator = m_stackAllocators + threadIndex;
+	for (int32 i = begin; i < end; ++i)
+	{
+		b2World* world = m_worlds[i];
+		b2Assert(world->m_threadPool == NULL);
+
+		world->m_stackAllocator = allocator;
+		world->Step(m_timeStep, m_velocityIterations, m_positionIterations);
+		world->m_stackAllocator = NULL;
+	}
+}
+
+void b2WorldGroup::Step(float32 timeStep, int32 velocityIterations, int32 positionIterations)
+{
+	m_timeStep = timeStep;
+	m_velocityIterations = velocityIterations;
+	m_positionIterations = positionIterations;
+
+	b2WorldGroupTask task;
+	task.group = this;
+	m_threadPool->ParallelFor(&task, m_worldCount, 1);
+}
@@ -0,0 +1,88 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_WORLD_GROUP_H
+#define B2_WORLD_GROUP_H
+
+#include <Box2D/Common/b2Settings.h>
+
+class b2World;
+class b2ThreadPool;
+class b2StackAllocator;
+
+/// Steps many independent worlds together on the threads of one pool. The
+/// threads take the worlds one at a time, so a thread done with cheap worlds
+/// picks up the ones left while another thread is busy with an expensive one.
+/// Each thread has its own scratch memory for the step, which the worlds of the
+/// group borrow instead of allocating one each.
+///
+/// A world is stepped by one thread at a time, so the world callbacks are called
+/// from the pool threads and listeners shared by several worlds must be thread
+/// safe. The worlds must not have a thread pool of their own. Each world counts
+/// its own collision queries in its b2Profile.
+class b2WorldGroup
+{
+public:
+	/// Start a pool of threadCount threads, including the calling one.
+	b2WorldGroup(int32 threadCount);
+
+	/// Stop the threads. The worlds are not destroyed.
+	~b2WorldGroup();
+
+	/// Add a world to the group. The group doesn't own the world. A world belongs
+	/// to one group at most.
+	void AddWorld(b2World* world);
+
+	/// Remove a world from the group. The last world takes its index.
+	void RemoveWorld(b2World* world);
+
+	/// Get the number of worlds.
+	int32 GetWorldCount() const { return m_worldCount; }
+
+	/// Get a world by index.
+	b2World* GetWorld(int32 index);
+
+	/// Step every world, see b2World::Step. Returns once all the worlds are done.
+	void Step(float32 timeStep, int32 velocityIterations, int32 positionIterations);
+
+	/// Get the pool stepping the worlds.
+	b2ThreadPool* GetThreadPool() { return m_threadPool; }
+
+private:
+
+	friend struct b2WorldGroupTask;
+
+	// Step the worlds [begin, end) with the scratch memory of the thread.
+	void StepWorlds(int32 begin, int32 end, int32 threadIndex);
+
+	b2ThreadPool* m_threadPool;
+
+	// One per pool thread.
+	b2StackAllocator* m_stackAllocators;
+	int32 m_stackAllocatorCount;
+
+	b2World** m_worlds;
+	int32 m_worldCount;
+	int32 m_worldCapacity;
+
+	float32 m_timeStep;
+	int32 m_velocityIterations;
+	int32 m_positionIterations;
+};
+
+#endif
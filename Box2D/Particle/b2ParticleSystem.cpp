@@ -0,0 +1,764 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Particle/b2ParticleSystem.h>
+#include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2CompoundShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <Box2D/Common/b2Draw.h>
+#include <Box2D/Common/b2ThreadPool.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2World.h>
+
+#include <algorithm>
+#include <string.h>
+
+// Touching particles kept per particle. A tight pile has about 6.
+static const int32 b2_particleNeighborCount = 16;
+
+// Particles per range handed to a thread.
+static const int32 b2_particleGrain = 128;
+
+// Automatic sub-steps, see Solve.
+static const float32 b2_particleSubStepFraction = 0.01f;
+static const int32 b2_minParticleSubSteps = 4;
+static const int32 b2_maxParticleSubSteps = 8;
+
+// Contact passes per sub-step. The corrections spread slowly through a pile, with
+// fewer passes a deep pile sinks.
+static const int32 b2_particleIterations = 4;
+
+// Scale of the contact corrections. More overshoots in deep piles.
+static const float32 b2_particleRelaxation = 1.0f;
+
+// The cell of a particle. The cell coordinates are 16 bit each, rows first, so
+// the particles are sorted by row then by column. This wraps beyond 32768 cells
+// from the origin.
+struct b2ParticleProxy
+{
+	uint32 tag;
+	int32 index;
+
+	bool operator<(const b2ParticleProxy& other) const
+	{
+		return tag < other.tag || (tag == other.tag && index < other.index);
+	}
+};
+
+// A fixture near a particle, as the plane of the closest surface point at the
+// beginning of the sub-step.
+struct b2ParticleBodyContact
+{
+	int32 index;
+	b2Body* body;
+	b2Vec2 point;
+	b2Vec2 normal;	// from the body to the particle
+	float32 share;	// part of the correction taken by the particle
+	float32 mass;	// effective mass along the normal
+};
+
+static inline int32 b2ParticleCell(float32 x, float32 inv_diameter)
+{
+	return (int32)floorf(x * inv_diameter);
+}
+
+static inline uint32 b2ParticleTag(int32 x, int32 y)
+{
+	return ((uint32)(y + 0x8000) << 16) + (uint32)(x + 0x8000);
+}
+
+// The first proxy of a cell or of the next cells.
+static inline const b2ParticleProxy* b2LowerBound(const b2ParticleProxy* begin, const b2ParticleProxy* end, uint32 tag)
+{
+	b2ParticleProxy proxy;
+	proxy.tag = tag;
+	proxy.index = -1;
+	return std::lower_bound(begin, end, proxy);
+}
+
+template <typename T>
+static T* b2Grow(T* array, int32 count, int32 capacity)
+{
+	T* grown = (T*)b2Alloc(capacity * sizeof(T));
+	if (array)
+	{
+		memcpy(grown, array, count * sizeof(T));
+		b2Free(array);
+	}
+	return grown;
+}
+
+// The signed distance from a point to a child of a shape and the direction
+// away from the shape. The distance is negative inside polygons.
+static void b2ComputeDistance(const b2Shape* shape, int32 childIndex, const b2Transform& xf,
+							  const b2Vec2& point, float32* distance, b2Vec2* normal)
+{
+	b2EdgeShape edge;
+	switch (shape->GetType())
+	{
+	case b2Shape::e_circle:
+		{
+			const b2CircleShape* circle = (b2CircleShape*)shape;
+			b2Vec2 d = point - b2Mul(xf, circle->m_p);
+			float32 length = d.Normalize();
+			*distance = length - circle->m_radius;
+			*normal = length > b2_epsilon ? d : b2Vec2(0.0f, 1.0f);
+		}
+		return;
+
+	case b2Shape::e_compound:
+		shape = ((b2CompoundShape*)shape)->GetChild(childIndex);
+		break;
+
+	case b2Shape::e_chain:
+		((b2ChainShape*)shape)->GetChildEdge(&edge, childIndex);
+		shape = &edge;
+		break;
+
+	default:
+		break;
+	}
+
+	b2Vec2 p = b2MulT(xf, point);
+
+	if (shape->GetType() == b2Shape::e_edge)
+	{
+		const b2EdgeShape* e = (b2EdgeShape*)shape;
+		b2Vec2 v1 = e->m_vertex1;
+		b2Vec2 v2 = e->m_vertex2;
+		b2Vec2 e12 = v2 - v1;
+		float32 t = b2Dot(p - v1, e12) / b2Max(b2Dot(e12, e12), b2_epsilon);
+		b2Vec2 d = p - (v1 + b2Clamp(t, 0.0f, 1.0f) * e12);
+		float32 length = d.Normalize();
+		if (length < b2_epsilon)
+		{
+			d.Set(-e12.y, e12.x);
+			d.Normalize();
+		}
+		*distance = length - e->m_radius;
+		*normal = b2Mul(xf.q, d);
+		return;
+	}
+
+	// Same as b2CollidePolygonAndCircle: the face of largest separation, then
+	// its vertex regions.
+	b2Assert(shape->GetType() == b2Shape::e_polygon);
+	const b2PolygonShape* polygon = (b2PolygonShape*)shape;
+	int32 count = polygon->m_vertexCount;
+	const b2Vec2* vertices = polygon->m_vertices;
+	const b2Vec2* normals = polygon->m_normals;
+
+	int32 face = 0;
+	float32 separation = -b2_maxFloat;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 s = b2Dot(normals[i], p - vertices[i]);
+		if (s > separation)
+		{
+			separation = s;
+			face = i;
+		}
+	}
+
+	b2Vec2 v1 = vertices[face];
+	b2Vec2 v2 = vertices[face + 1 < count ? face + 1 : 0];
+	b2Vec2 d = normals[face];
+	if (separation > 0.0f)
+	{
+		if (b2Dot(p - v1, v2 - v1) <= 0.0f)
+		{
+			d = p - v1;
+			separation = d.Normalize();
+		}
+		else if (b2Dot(p - v2, v1 - v2) <= 0.0f)
+		{
+			d = p - v2;
+			separation = d.Normalize();
+		}
+	}
+
+	*distance = separation - polygon->m_radius;
+	*normal = b2Mul(xf.q, d);
+}
+
+struct b2ParticleTask : public b2ParallelTask
+{
+	enum Pass
+	{
+		e_predict,
+		e_findNeighbors,
+		e_solveContacts,
+		e_applyCorrections,
+		e_updateVelocities
+	};
+
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+		switch (pass)
+		{
+		case e_predict:
+			system->Predict(begin, end);
+			break;
+		case e_findNeighbors:
+			system->FindNeighbors(begin, end);
+			break;
+		case e_solveContacts:
+			system->SolveContacts(begin, end);
+			break;
+		case e_applyCorrections:
+			system->ApplyCorrections(begin, end);
+			break;
+		case e_updateVelocities:
+			system->UpdateVelocities(begin, end);
+			break;
+		}
+	}
+
+	b2ParticleSystem* system;
+	int32 pass;
+};
+
+struct b2ParticleQueryWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		if (fixture->IsSensor())
+		{
+			return true;
+		}
+
+		if (proxy->childCount == 1)
+		{
+			system->AddBodyContacts(fixture->GetBody(), fixture->GetShape(), proxy->childIndex, proxy->aabb);
+			return true;
+		}
+
+		// Chain and compound proxies cover several children. Each child only
+		// scans the cells around its own box.
+		const b2Shape* shape = fixture->GetShape();
+		const b2Transform& xf = fixture->GetBody()->GetTransform();
+		for (int32 i = 0; i < proxy->childCount; ++i)
+		{
+			int32 childIndex = proxy->childIndex + i;
+			b2AABB aabb;
+			shape->ComputeAABB(&aabb, xf, childIndex);
+			system->AddBodyContacts(fixture->GetBody(), shape, childIndex, aabb);
+		}
+		return true;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2ParticleSystem* system;
+};
+
+b2ParticleSystem::b2ParticleSystem(const b2ParticleSystemDef* def, b2World* world)
+{
+	b2Assert(def->radius > 0.0f);
+	b2Assert(def->density > 0.0f);
+
+	m_def = *def;
+	m_world = world;
+	m_prev = NULL;
+	m_next = NULL;
+
+	m_count = 0;
+	m_capacity = 0;
+	m_px = NULL;
+	m_py = NULL;
+	m_p0x = NULL;
+	m_p0y = NULL;
+	m_vx = NULL;
+	m_vy = NULL;
+	m_dpx = NULL;
+	m_dpy = NULL;
+	m_neighbors = NULL;
+	m_neighborCounts = NULL;
+	m_proxies = NULL;
+	m_proxyCount = 0;
+
+	m_bodyContacts = NULL;
+	m_bodyContactCount = 0;
+	m_bodyContactCapacity = 0;
+
+	m_threadPool = NULL;
+	m_inv_diameter = 0.5f / def->radius;
+}
+
+b2ParticleSystem::~b2ParticleSystem()
+{
+	b2Free(m_px);
+	b2Free(m_py);
+	b2Free(m_p0x);
+	b2Free(m_p0y);
+	b2Free(m_vx);
+	b2Free(m_vy);
+	b2Free(m_dpx);
+	b2Free(m_dpy);
+	b2Free(m_neighbors);
+	b2Free(m_neighborCounts);
+	b2Free(m_proxies);
+	b2Free(m_bodyContacts);
+}
+
+void b2ParticleSystem::Reserve(int32 capacity)
+{
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+
+	capacity = b2Max(capacity, 2 * m_capacity);
+	m_px = b2Grow(m_px, m_count, capacity);
+	m_py = b2Grow(m_py, m_count, capacity);
+	m_vx = b2Grow(m_vx, m_count, capacity);
+	m_vy = b2Grow(m_vy, m_count, capacity);
+
+	// Rebuilt every sub-step.
+	b2Free(m_p0x);
+	b2Free(m_p0y);
+	b2Free(m_dpx);
+	b2Free(m_dpy);
+	b2Free(m_neighbors);
+	b2Free(m_neighborCounts);
+	b2Free(m_proxies);
+	m_p0x = (float32*)b2Alloc(capacity * sizeof(float32));
+	m_p0y = (float32*)b2Alloc(capacity * sizeof(float32));
+	m_dpx = (float32*)b2Alloc(capacity * sizeof(float32));
+	m_dpy = (float32*)b2Alloc(capacity * sizeof(float32));
+	m_neighbors = (int32*)b2Alloc(capacity * b2_particleNeighborCount * sizeof(int32));
+	m_neighborCounts = (int32*)b2Alloc(capacity * sizeof(int32));
+	m_proxies = (b2ParticleProxy*)b2Alloc(capacity * sizeof(b2ParticleProxy));
+	m_proxyCount = 0;
+
+	m_capacity = capacity;
+}
+
+int32 b2ParticleSystem::GetMemory() const
+{
+	int32 particleSize = 8 * sizeof(float32) + (b2_particleNeighborCount + 1) * sizeof(int32) +
+		sizeof(b2ParticleProxy);
+	return m_capacity * particleSize + m_bodyContactCapacity * sizeof(b2ParticleBodyContact);
+}
+
+int32 b2ParticleSystem::CreateParticle(const b2Vec2& position, const b2Vec2& velocity)
+{
+	b2Assert(m_world->IsLocked() == false);
+	if (m_world->IsLocked())
+	{
+		return -1;
+	}
+
+	Reserve(m_count + 1);
+
+	int32 index = m_count++;
+	m_px[index] = position.x;
+	m_py[index] = position.y;
+	m_vx[index] = velocity.x;
+	m_vy[index] = velocity.y;
+	m_proxyCount = 0;
+	return index;
+}
+
+void b2ParticleSystem::DestroyParticle(int32 index)
+{
+	b2Assert(m_world->IsLocked() == false);
+	b2Assert(0 <= index && index < m_count);
+	if (m_world->IsLocked())
+	{
+		return;
+	}
+
+	--m_count;
+	m_px[index] = m_px[m_count];
+	m_py[index] = m_py[m_count];
+	m_vx[index] = m_vx[m_count];
+	m_vy[index] = m_vy[m_count];
+	m_proxyCount = 0;
+}
+
+b2Vec2 b2ParticleSystem::GetPosition(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return b2Vec2(m_px[index], m_py[index]);
+}
+
+b2Vec2 b2ParticleSystem::GetVelocity(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return b2Vec2(m_vx[index], m_vy[index]);
+}
+
+void b2ParticleSystem::SetVelocity(int32 index, const b2Vec2& velocity)
+{
+	b2Assert(0 <= index && index < m_count);
+	m_vx[index] = velocity.x;
+	m_vy[index] = velocity.y;
+}
+
+float32 b2ParticleSystem::GetParticleMass() const
+{
+	float32 diameter = 2.0f * m_def.radius;
+	return m_def.density * diameter * diameter;
+}
+
+void b2ParticleSystem::Solve(const b2TimeStep& step)
+{
+	if (m_count == 0)
+	{
+		return;
+	}
+
+	float32 diameter = 2.0f * m_def.radius;
+	float32 gravity = m_def.gravityScale * m_world->GetGravity().Length();
+
+	// Enough sub-steps for gravity to move a particle by a small part of its
+	// radius per sub-step.
+	int32 subStepCount = m_def.subStepCount;
+	if (subStepCount <= 0)
+	{
+		subStepCount = (int32)ceilf(b2Sqrt(gravity / (b2_particleSubStepFraction * m_def.radius)) * step.dt);
+		subStepCount = b2Clamp(subStepCount, b2_minParticleSubSteps, b2_maxParticleSubSteps);
+	}
+
+	// A particle moves at most one diameter per sub-step, so it can't cross a
+	// fixture without being found near it first.
+	m_threadPool = step.threadPool;
+	m_h = step.dt / subStepCount;
+	m_inv_h = 1.0f / m_h;
+	m_gravity = m_h * m_def.gravityScale * m_world->GetGravity();
+	m_maxVelocitySqr = diameter * diameter * m_inv_h * m_inv_h;
+
+	for (int32 i = 0; i < subStepCount; ++i)
+	{
+		Run(b2ParticleTask::e_predict);
+		UpdateProxies();
+		Run(b2ParticleTask::e_findNeighbors);
+		UpdateBodyContacts();
+		for (int32 j = 0; j < b2_particleIterations; ++j)
+		{
+			Run(b2ParticleTask::e_solveContacts);
+			Run(b2ParticleTask::e_applyCorrections);
+			SolveBodyContacts();
+		}
+		Run(b2ParticleTask::e_updateVelocities);
+	}
+}
+
+void b2ParticleSystem::Run(int32 pass)
+{
+	b2ParticleTask task;
+	task.system = this;
+	task.pass = pass;
+	if (m_threadPool)
+	{
+		m_threadPool->ParallelFor(&task, m_count, b2_particleGrain);
+	}
+	else
+	{
+		task.Execute(0, m_count, 0);
+	}
+}
+
+void b2ParticleSystem::Predict(int32 begin, int32 end)
+{
+	for (int32 i = begin; i < end; ++i)
+	{
+		float32 vx = m_vx[i] + m_gravity.x;
+		float32 vy = m_vy[i] + m_gravity.y;
+		float32 vSqr = vx * vx + vy * vy;
+		if (vSqr > m_maxVelocitySqr)
+		{
+			float32 s = b2Sqrt(m_maxVelocitySqr / vSqr);
+			vx *= s;
+			vy *= s;
+		}
+
+		m_p0x[i] = m_px[i];
+		m_p0y[i] = m_py[i];
+		m_px[i] += m_h * vx;
+		m_py[i] += m_h * vy;
+	}
+}
+
+void b2ParticleSystem::UpdateProxies()
+{
+	if (m_proxyCount != m_count)
+	{
+		for (int32 i = 0; i < m_count; ++i)
+		{
+			m_proxies[i].index = i;
+		}
+		m_proxyCount = m_count;
+	}
+
+	b2Vec2 lower(b2_maxFloat, b2_maxFloat);
+	b2Vec2 upper(-b2_maxFloat, -b2_maxFloat);
+	for (int32 k = 0; k < m_count; ++k)
+	{
+		int32 i = m_proxies[k].index;
+		m_proxies[k].tag = b2ParticleTag(b2ParticleCell(m_px[i], m_inv_diameter), b2ParticleCell(m_py[i], m_inv_diameter));
+		lower = b2Min(lower, b2Vec2(m_px[i], m_py[i]));
+		upper = b2Max(upper, b2Vec2(m_px[i], m_py[i]));
+	}
+
+	// The proxies are still almost sorted from the previous sub-step.
+	std::sort(m_proxies, m_proxies + m_count);
+
+	m_aabb.lowerBound = lower;
+	m_aabb.upperBound = upper;
+}
+
+void b2ParticleSystem::FindNeighbors(int32 begin, int32 end)
+{
+	const b2ParticleProxy* proxyEnd = m_proxies + m_count;
+	float32 diameter = 2.0f * m_def.radius;
+	float32 diameterSqr = diameter * diameter;
+	if (begin == end)
+	{
+		return;
+	}
+
+	// The touching particles are in the 3 x 3 cells around. The proxies are
+	// sorted, so the first proxy of each of the 3 rows only moves forward.
+	const b2ParticleProxy* rows[3];
+	for (int32 row = 0; row < 3; ++row)
+	{
+		uint32 first = m_proxies[begin].tag + 0x10000 * row - 0x10001;
+		rows[row] = b2LowerBound(m_proxies, proxyEnd, first);
+	}
+
+	for (int32 k = begin; k < end; ++k)
+	{
+		int32 i = m_proxies[k].index;
+		uint32 tag = m_proxies[k].tag;
+		int32* neighbors = m_neighbors + i * b2_particleNeighborCount;
+		int32 count = 0;
+
+		for (int32 row = 0; row < 3; ++row)
+		{
+			uint32 first = tag + 0x10000 * row - 0x10001;
+			uint32 last = first + 2;
+			while (rows[row] < proxyEnd && rows[row]->tag < first)
+			{
+				++rows[row];
+			}
+
+			for (const b2ParticleProxy* proxy = rows[row]; proxy < proxyEnd && proxy->tag <= last; ++proxy)
+			{
+				int32 j = proxy->index;
+				float32 dx = m_px[j] - m_px[i];
+				float32 dy = m_py[j] - m_py[i];
+				if (j != i && dx * dx + dy * dy < diameterSqr && count < b2_particleNeighborCount)
+				{
+					neighbors[count++] = j;
+				}
+			}
+		}
+
+		m_neighborCounts[i] = count;
+	}
+}
+
+void b2ParticleSystem::UpdateBodyContacts()
+{
+	m_bodyContactCount = 0;
+
+	// The particles moved by up to one diameter since the beginning of the sub-step.
+	float32 margin = 4.0f * m_def.radius;
+	b2AABB aabb;
+	aabb.lowerBound = m_aabb.lowerBound - b2Vec2(margin, margin);
+	aabb.upperBound = m_aabb.upperBound + b2Vec2(margin, margin);
+
+	b2ParticleQueryWrapper wrapper;
+	wrapper.broadPhase = &m_world->m_contactManager.m_broadPhase;
+	wrapper.system = this;
+	wrapper.broadPhase->Query(&wrapper, aabb);
+}
+
+void b2ParticleSystem::AddBodyContacts(b2Body* body, const b2Shape* shape, int32 childIndex, const b2AABB& aabb)
+{
+	const b2ParticleProxy* proxyEnd = m_proxies + m_count;
+	const b2Transform& xf = body->GetTransform();
+	float32 invMass = 1.0f / GetParticleMass();
+
+	// A fixture is kept up to one diameter away from the beginning of the
+	// sub-step, the farthest a particle moves in one sub-step. The cells are
+	// those of the predicted positions.
+	float32 reach = 3.0f * m_def.radius;
+	float32 margin = reach + 2.0f * m_def.radius;
+	int32 x1 = b2ParticleCell(aabb.lowerBound.x - margin, m_inv_diameter);
+	int32 x2 = b2ParticleCell(aabb.upperBound.x + margin, m_inv_diameter);
+	int32 y1 = b2ParticleCell(aabb.lowerBound.y - margin, m_inv_diameter);
+	int32 y2 = b2ParticleCell(aabb.upperBound.y + margin, m_inv_diameter);
+
+	for (int32 y = y1; y <= y2; ++y)
+	{
+		uint32 last = b2ParticleTag(x2, y);
+		for (const b2ParticleProxy* proxy = b2LowerBound(m_proxies, proxyEnd, b2ParticleTag(x1, y));
+			 proxy < proxyEnd && proxy->tag <= last; ++proxy)
+		{
+			int32 i = proxy->index;
+			b2Vec2 p0(m_p0x[i], m_p0y[i]);
+			float32 distance;
+			b2Vec2 normal;
+			b2ComputeDistance(shape, childIndex, xf, p0, &distance, &normal);
+			if (distance >= reach)
+			{
+				continue;
+			}
+
+			if (m_bodyContactCount == m_bodyContactCapacity)
+			{
+				int32 capacity = b2Max(2 * m_bodyContactCapacity, 256);
+				m_bodyContacts = b2Grow(m_bodyContacts, m_bodyContactCount, capacity);
+				m_bodyContactCapacity = capacity;
+			}
+
+			b2Vec2 point = p0 - distance * normal;
+			float32 rn = b2Cross(point - body->m_sweep.c, normal);
+			float32 invM = invMass + body->m_invMass + body->m_invI * rn * rn;
+
+			b2ParticleBodyContact* contact = m_bodyContacts + m_bodyContactCount++;
+			contact->index = i;
+			contact->body = body;
+			contact->point = point;
+			contact->normal = normal;
+			contact->share = invMass / invM;
+			contact->mass = 1.0f / invM;
+		}
+	}
+}
+
+void b2ParticleSystem::SolveContacts(int32 begin, int32 end)
+{
+	// Each overlap is shared by the two particles and found from both sides.
+	// A pair is scaled down by the larger contact count of its particles, so a
+	// particle never moves by more than the average of its corrections and the
+	// pass only writes to the particles of the range.
+	float32 diameter = 2.0f * m_def.radius;
+	float32 friction = m_def.friction;
+	for (int32 i = begin; i < end; ++i)
+	{
+		const int32* neighbors = m_neighbors + i * b2_particleNeighborCount;
+		int32 count = m_neighborCounts[i];
+		float32 dx = 0.0f;
+		float32 dy = 0.0f;
+		for (int32 k = 0; k < count; ++k)
+		{
+			int32 j = neighbors[k];
+			float32 nx = m_px[i] - m_px[j];
+			float32 ny = m_py[i] - m_py[j];
+			float32 length = b2Sqrt(nx * nx + ny * ny);
+			float32 overlap = diameter - length;
+			if (overlap <= 0.0f || length < b2_epsilon)
+			{
+				continue;
+			}
+
+			// Both particles of a pair take the same part of the correction, so
+			// the momentum is kept.
+			float32 share = 0.5f * b2_particleRelaxation / b2Max(count, m_neighborCounts[j]);
+			float32 inv_length = 1.0f / length;
+			nx *= inv_length;
+			ny *= inv_length;
+			dx += share * overlap * nx;
+			dy += share * overlap * ny;
+
+			// Static friction: undo the relative sliding of the sub-step, up to
+			// friction times the overlap.
+			float32 rx = (m_px[i] - m_p0x[i]) - (m_px[j] - m_p0x[j]);
+			float32 ry = (m_py[i] - m_p0y[i]) - (m_py[j] - m_p0y[j]);
+			float32 rn = rx * nx + ry * ny;
+			float32 tx = rx - rn * nx;
+			float32 ty = ry - rn * ny;
+			float32 slide = b2Sqrt(tx * tx + ty * ty);
+			float32 s = slide > friction * overlap ? friction * overlap / slide : 1.0f;
+			dx -= share * s * tx;
+			dy -= share * s * ty;
+		}
+
+		m_dpx[i] = dx;
+		m_dpy[i] = dy;
+	}
+}
+
+void b2ParticleSystem::ApplyCorrections(int32 begin, int32 end)
+{
+	for (int32 i = begin; i < end; ++i)
+	{
+		m_px[i] += m_dpx[i];
+		m_py[i] += m_dpy[i];
+	}
+}
+
+void b2ParticleSystem::SolveBodyContacts()
+{
+	// The fixtures come last so the particles end outside of them. The bodies
+	// take the momentum of their share of the correction.
+	float32 friction = m_def.friction;
+	for (int32 k = 0; k < m_bodyContactCount; ++k)
+	{
+		const b2ParticleBodyContact* contact = m_bodyContacts + k;
+		int32 i = contact->index;
+		b2Vec2 p(m_px[i], m_py[i]);
+		b2Vec2 n = contact->normal;
+		float32 overlap = m_def.radius - b2Dot(p - contact->point, n);
+		if (overlap <= 0.0f)
+		{
+			continue;
+		}
+
+		// Sliding relative to the body surface.
+		b2Vec2 p0(m_p0x[i], m_p0y[i]);
+		b2Vec2 r = (p - p0) - m_h * contact->body->GetLinearVelocityFromWorldPoint(contact->point);
+		b2Vec2 t = r - b2Dot(r, n) * n;
+		float32 slide = t.Length();
+		float32 s = slide > friction * overlap ? friction * overlap / slide : 1.0f;
+
+		b2Vec2 correction = overlap * n - s * t;
+		p += contact->share * correction;
+		m_px[i] = p.x;
+		m_py[i] = p.y;
+		contact->body->ApplyLinearImpulse(-contact->mass * m_inv_h * correction, contact->point);
+	}
+}
+
+void b2ParticleSystem::UpdateVelocities(int32 begin, int32 end)
+{
+	for (int32 i = begin; i < end; ++i)
+	{
+		m_vx[i] = m_inv_h * (m_px[i] - m_p0x[i]);
+		m_vy[i] = m_inv_h * (m_py[i] - m_p0y[i]);
+	}
+}
+
+void b2ParticleSystem::Draw(b2Draw* draw) const
+{
+	b2Color color(0.5f, 0.6f, 0.9f);
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		draw->DrawCircle(b2Vec2(m_px[i], m_py[i]), m_def.radius, color);
+	}
+}
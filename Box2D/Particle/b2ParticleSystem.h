@@ -0,0 +1,197 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_PARTICLE_SYSTEM_H
+#define B2_PARTICLE_SYSTEM_H
+
+#include <Box2D/Collision/b2Collision.h>
+
+class b2Body;
+class b2Draw;
+class b2Shape;
+class b2World;
+class b2ThreadPool;
+struct b2TimeStep;
+struct b2ParticleProxy;
+struct b2ParticleBodyContact;
+
+/// A particle system definition holds the properties shared by all the particles
+/// of a system.
+struct b2ParticleSystemDef
+{
+	b2ParticleSystemDef()
+	{
+		radius = 0.05f;
+		density = 1.0f;
+		friction = 0.3f;
+		gravityScale = 1.0f;
+		subStepCount = 0;
+	}
+
+	/// The radius of the particles, usually in meters.
+	float32 radius;
+
+	/// The density of the particles, usually in kg/m^2. A particle weighs
+	/// density * (2 * radius)^2.
+	float32 density;
+
+	/// The friction coefficient between two particles and between a particle and
+	/// a fixture, usually in the range [0,1]. Sand needs some, a ball pit doesn't.
+	float32 friction;
+
+	/// Scale the gravity applied to the particles.
+	float32 gravityScale;
+
+	/// The number of times the particles are solved per world step. Use 0 to
+	/// pick it from the gravity, the radius and the time step.
+	int32 subStepCount;
+};
+
+/// Simulates many small round grains without the cost of one body and one
+/// fixture per grain. The particles are stored in structure of arrays and
+/// sorted once per sub-step by cells as large as a particle, so the touching
+/// particles are found in the neighbor cells. The contacts are solved on the
+/// positions: every particle moves by at most the average of the corrections of
+/// its contacts, so a pass only writes to its own particles. Such passes are split
+/// among the threads of the world pool, if any, and the result doesn't depend
+/// on the thread count. The particles collide with the fixtures found through
+/// the world broad-phase and push dynamic bodies back.
+/// Create particle systems with b2World::CreateParticleSystem.
+class b2ParticleSystem
+{
+public:
+
+	/// Add a particle and return its index.
+	/// @warning This function is locked during callbacks.
+	int32 CreateParticle(const b2Vec2& position, const b2Vec2& velocity);
+
+	/// Remove a particle. The last particle takes its index.
+	/// @warning This function is locked during callbacks.
+	void DestroyParticle(int32 index);
+
+	/// Get the number of particles.
+	int32 GetParticleCount() const { return m_count; }
+
+	///
+	b2Vec2 GetPosition(int32 index) const;
+
+	///
+	b2Vec2 GetVelocity(int32 index) const;
+
+	///
+	void SetVelocity(int32 index, const b2Vec2& velocity);
+
+	/// Get the radius of the particles.
+	float32 GetRadius() const { return m_def.radius; }
+
+	/// Get the mass of one particle.
+	float32 GetParticleMass() const;
+
+	/// Get the next particle system in the world list.
+	b2ParticleSystem* GetNext() { return m_next; }
+	const b2ParticleSystem* GetNext() const { return m_next; }
+
+	/// Draw the particles as circles.
+	void Draw(b2Draw* draw) const;
+
+	/// Get the number of bytes allocated for the particles and their contacts.
+	int32 GetMemory() const;
+
+private:
+
+	friend class b2World;
+	friend struct b2ParticleTask;
+	friend struct b2ParticleQueryWrapper;
+
+	b2ParticleSystem(const b2ParticleSystemDef* def, b2World* world);
+	~b2ParticleSystem();
+
+	void Reserve(int32 capacity);
+
+	// Advance the particles. Called by the world before the bodies are solved,
+	// so the impulses applied to the bodies are integrated in the same step.
+	void Solve(const b2TimeStep& step);
+
+	// Sort the particles by cell.
+	void UpdateProxies();
+
+	// Find the fixtures near the particles.
+	void UpdateBodyContacts();
+	void AddBodyContacts(b2Body* body, const b2Shape* shape, int32 childIndex, const b2AABB& aabb);
+
+	// Push the particles out of the fixtures. This touches the bodies and runs
+	// on one thread.
+	void SolveBodyContacts();
+
+	// Passes over the particles [begin, end), see b2ParticleTask.
+	void Predict(int32 begin, int32 end);
+	void FindNeighbors(int32 begin, int32 end);
+	void SolveContacts(int32 begin, int32 end);
+	void ApplyCorrections(int32 begin, int32 end);
+	void UpdateVelocities(int32 begin, int32 end);
+
+	// Run a pass over all the particles, on the world pool if any.
+	void Run(int32 pass);
+
+	b2ParticleSystemDef m_def;
+	b2World* m_world;
+
+	b2ParticleSystem* m_prev;
+	b2ParticleSystem* m_next;
+
+	int32 m_count;
+	int32 m_capacity;
+
+	// Particles. The positions at the beginning of the sub-step are kept in
+	// m_p0x and m_p0y, the position corrections of a pass in m_dpx and m_dpy.
+	float32* m_px;
+	float32* m_py;
+	float32* m_p0x;
+	float32* m_p0y;
+	float32* m_vx;
+	float32* m_vy;
+	float32* m_dpx;
+	float32* m_dpy;
+
+	// Up to b2_particleNeighborCount touching particles per particle. Each pair
+	// is found from both sides.
+	int32* m_neighbors;
+	int32* m_neighborCounts;
+
+	// The particles sorted by cell.
+	b2ParticleProxy* m_proxies;
+	b2AABB m_aabb;
+
+	// The number of proxies, reset by CreateParticle and DestroyParticle to
+	// rebuild them.
+	int32 m_proxyCount;
+
+	b2ParticleBodyContact* m_bodyContacts;
+	int32 m_bodyContactCount;
+	int32 m_bodyContactCapacity;
+
+	// Sub-step constants.
+	b2ThreadPool* m_threadPool;
+	b2Vec2 m_gravity;
+	float32 m_h;
+	float32 m_inv_h;
+	float32 m_inv_diameter;
+	float32 m_maxVelocitySqr;
+};
+
+#endif
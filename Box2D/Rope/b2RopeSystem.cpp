@@ -0,0 +1,410 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Rope/b2RopeSystem.h>
+#include <Box2D/Common/b2Draw.h>
+#include <Box2D/Common/b2ThreadPool.h>
+
+#include <string.h>
+
+// Ropes per range handed to a thread.
+static const int32 b2_ropeGrain = 8;
+
+struct b2RopeRange
+{
+	int32 start;
+	int32 count;
+	b2Vec2 gravity;
+	float32 damping;
+};
+
+struct b2RopeTask : public b2ParallelTask
+{
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		B2_NOT_USED(threadIndex);
+		system->StepRopes(begin, end, h, iterations);
+	}
+
+	b2RopeSystem* system;
+	float32 h;
+	int32 iterations;
+};
+
+// Polynomial atan2, cheaper than the library call in the bend sweep. The error
+// is below 1e-5 radians. The rest angles are measured with it too.
+static inline float32 b2RopeAtan2(float32 y, float32 x)
+{
+	float32 ax = b2Abs(x);
+	float32 ay = b2Abs(y);
+	float32 mx = b2Max(ax, ay);
+	float32 mn = b2Min(ax, ay);
+	float32 a = mn / b2Max(mx, FLT_MIN);
+	float32 s = a * a;
+	float32 r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+	r = ay > ax ? 0.5f * b2_pi - r : r;
+	r = x < 0.0f ? b2_pi - r : r;
+	return y < 0.0f ? -r : r;
+}
+
+static float32* b2Grow(float32* array, int32 count, int32 capacity)
+{
+	float32* grown = (float32*)b2Alloc(capacity * sizeof(float32));
+	if (array)
+	{
+		memcpy(grown, array, count * sizeof(float32));
+		b2Free(array);
+	}
+	return grown;
+}
+
+// Stretch sweep over the vertices [begin, end), every other constraint from first.
+// The relative error (L0 - L) / L is approximated by (L0^2 - L^2) / (L0^2 + L^2),
+// which is exact at the rest length and needs no square root, so the sweep
+// vectorizes. The divisions are guarded with FLT_MIN rather than branches.
+static void b2SolveStretch(float32* px, float32* py, const float32* ims,
+						   const float32* Ls, const float32* k2s, int32 first, int32 end)
+{
+	for (int32 i = first; i < end - 1; i += 2)
+	{
+		float32 dx = px[i + 1] - px[i];
+		float32 dy = py[i + 1] - py[i];
+		float32 L0sqr = Ls[i] * Ls[i];
+		float32 Lsqr = dx * dx + dy * dy;
+		float32 error = (L0sqr - Lsqr) / b2Max(L0sqr + Lsqr, FLT_MIN);
+
+		float32 im1 = ims[i];
+		float32 im2 = ims[i + 1];
+		float32 s = k2s[i] * error / b2Max(im1 + im2, FLT_MIN);
+
+		px[i] -= s * im1 * dx;
+		py[i] -= s * im1 * dy;
+		px[i + 1] += s * im2 * dx;
+		py[i + 1] += s * im2 * dy;
+	}
+}
+
+// Bend sweep over the vertices [begin, end), every third constraint from first.
+static void b2SolveBend(float32* px, float32* py, const float32* ims,
+						const float32* as, const float32* k3s, int32 first, int32 end)
+{
+	for (int32 i = first; i < end - 2; i += 3)
+	{
+		float32 d1x = px[i + 1] - px[i];
+		float32 d1y = py[i + 1] - py[i];
+		float32 d2x = px[i + 2] - px[i + 1];
+		float32 d2y = py[i + 2] - py[i + 1];
+
+		float32 L1sqr = d1x * d1x + d1y * d1y;
+		float32 L2sqr = d2x * d2x + d2y * d2y;
+		bool degenerate = L1sqr * L2sqr == 0.0f;
+		float32 inv1 = 1.0f / b2Max(L1sqr, FLT_MIN);
+		float32 inv2 = 1.0f / b2Max(L2sqr, FLT_MIN);
+		inv1 = degenerate ? 0.0f : inv1;
+		inv2 = degenerate ? 0.0f : inv2;
+
+		float32 angle = b2RopeAtan2(d1x * d2y - d1y * d2x, d1x * d2x + d1y * d2y);
+
+		// J1 = -Jd1, J2 = Jd1 - Jd2, J3 = Jd2 with Jd1 = -skew(d1) / L1sqr and Jd2 = skew(d2) / L2sqr.
+		float32 J1x = -inv1 * d1y;
+		float32 J1y = inv1 * d1x;
+		float32 J3x = -inv2 * d2y;
+		float32 J3y = inv2 * d2x;
+		float32 J2x = -J1x - J3x;
+		float32 J2y = -J1y - J3y;
+
+		float32 m1 = ims[i];
+		float32 m2 = ims[i + 1];
+		float32 m3 = ims[i + 2];
+		float32 mass = m1 * (J1x * J1x + J1y * J1y) + m2 * (J2x * J2x + J2y * J2y) + m3 * (J3x * J3x + J3y * J3y);
+
+		// Both angles are in [-pi, pi].
+		float32 C = angle - as[i];
+		C = C > b2_pi ? C - 2.0f * b2_pi : C;
+		C = C < -b2_pi ? C + 2.0f * b2_pi : C;
+
+		// A degenerate bend has a zero Jacobian. Dividing by the clamped mass would
+		// overflow and the positions would get inf * 0 = NaN, so it gets no impulse.
+		float32 impulse = -k3s[i] * C / b2Max(mass, FLT_MIN);
+		impulse = mass > b2_epsilon * b2_epsilon ? impulse : 0.0f;
+
+		px[i] += m1 * impulse * J1x;
+		py[i] += m1 * impulse * J1y;
+		px[i + 1] += m2 * impulse * J2x;
+		py[i + 1] += m2 * impulse * J2y;
+		px[i + 2] += m3 * impulse * J3x;
+		py[i + 2] += m3 * impulse * J3y;
+	}
+}
+
+b2RopeSystem::b2RopeSystem()
+{
+	m_threadPool = NULL;
+	m_ropes = NULL;
+	m_ropeCount = 0;
+	m_ropeCapacity = 0;
+	m_vertexCount = 0;
+	m_vertexCapacity = 0;
+	m_px = NULL;
+	m_py = NULL;
+	m_p0x = NULL;
+	m_p0y = NULL;
+	m_vx = NULL;
+	m_vy = NULL;
+	m_ims = NULL;
+	m_Ls = NULL;
+	m_k2s = NULL;
+	m_as = NULL;
+	m_k3s = NULL;
+}
+
+b2RopeSystem::~b2RopeSystem()
+{
+	Clear();
+}
+
+void b2RopeSystem::Clear()
+{
+	b2Free(m_ropes);
+	b2Free(m_px);
+	b2Free(m_py);
+	b2Free(m_p0x);
+	b2Free(m_p0y);
+	b2Free(m_vx);
+	b2Free(m_vy);
+	b2Free(m_ims);
+	b2Free(m_Ls);
+	b2Free(m_k2s);
+	b2Free(m_as);
+	b2Free(m_k3s);
+
+	m_ropes = NULL;
+	m_ropeCount = 0;
+	m_ropeCapacity = 0;
+	m_vertexCount = 0;
+	m_vertexCapacity = 0;
+	m_px = NULL;
+	m_py = NULL;
+	m_p0x = NULL;
+	m_p0y = NULL;
+	m_vx = NULL;
+	m_vy = NULL;
+	m_ims = NULL;
+	m_Ls = NULL;
+	m_k2s = NULL;
+	m_as = NULL;
+	m_k3s = NULL;
+}
+
+void b2RopeSystem::Reserve(int32 vertexCapacity)
+{
+	if (vertexCapacity <= m_vertexCapacity)
+	{
+		return;
+	}
+
+	vertexCapacity = b2Max(vertexCapacity, 2 * m_vertexCapacity);
+	m_px = b2Grow(m_px, m_vertexCount, vertexCapacity);
+	m_py = b2Grow(m_py, m_vertexCount, vertexCapacity);
+	m_p0x = b2Grow(m_p0x, m_vertexCount, vertexCapacity);
+	m_p0y = b2Grow(m_p0y, m_vertexCount, vertexCapacity);
+	m_vx = b2Grow(m_vx, m_vertexCount, vertexCapacity);
+	m_vy = b2Grow(m_vy, m_vertexCount, vertexCapacity);
+	m_ims = b2Grow(m_ims, m_vertexCount, vertexCapacity);
+	m_Ls = b2Grow(m_Ls, m_vertexCount, vertexCapacity);
+	m_k2s = b2Grow(m_k2s, m_vertexCount, vertexCapacity);
+	m_as = b2Grow(m_as, m_vertexCount, vertexCapacity);
+	m_k3s = b2Grow(m_k3s, m_vertexCount, vertexCapacity);
+	m_vertexCapacity = vertexCapacity;
+}
+
+int32 b2RopeSystem::CreateRope(const b2RopeDef* def)
+{
+	b2Assert(def->count >= 3);
+
+	if (m_ropeCount == m_ropeCapacity)
+	{
+		m_ropeCapacity = b2Max(2 * m_ropeCapacity, 16);
+		b2RopeRange* ropes = (b2RopeRange*)b2Alloc(m_ropeCapacity * sizeof(b2RopeRange));
+		if (m_ropes)
+		{
+			memcpy(ropes, m_ropes, m_ropeCount * sizeof(b2RopeRange));
+			b2Free(m_ropes);
+		}
+		m_ropes = ropes;
+	}
+
+	Reserve(m_vertexCount + def->count);
+
+	b2RopeRange* rope = m_ropes + m_ropeCount;
+	rope->start = m_vertexCount;
+	rope->count = def->count;
+	rope->gravity = def->gravity;
+	rope->damping = def->damping;
+
+	int32 start = rope->start;
+	for (int32 i = 0; i < def->count; ++i)
+	{
+		int32 j = start + i;
+		m_px[j] = m_p0x[j] = def->vertices[i].x;
+		m_py[j] = m_p0y[j] = def->vertices[i].y;
+		m_vx[j] = 0.0f;
+		m_vy[j] = 0.0f;
+
+		float32 m = def->masses[i];
+		m_ims[j] = m > 0.0f ? 1.0f / m : 0.0f;
+
+		m_Ls[j] = 0.0f;
+		m_k2s[j] = 0.0f;
+		m_as[j] = 0.0f;
+		m_k3s[j] = 0.0f;
+	}
+
+	for (int32 i = 0; i < def->count - 1; ++i)
+	{
+		m_Ls[start + i] = b2Distance(def->vertices[i], def->vertices[i + 1]);
+		m_k2s[start + i] = def->k2;
+	}
+
+	for (int32 i = 0; i < def->count - 2; ++i)
+	{
+		b2Vec2 d1 = def->vertices[i + 1] - def->vertices[i];
+		b2Vec2 d2 = def->vertices[i + 2] - def->vertices[i + 1];
+		m_as[start + i] = b2RopeAtan2(b2Cross(d1, d2), b2Dot(d1, d2));
+		m_k3s[start + i] = def->k3;
+	}
+
+	m_vertexCount += def->count;
+	return m_ropeCount++;
+}
+
+int32 b2RopeSystem::GetVertexCount(int32 rope) const
+{
+	b2Assert(0 <= rope && rope < m_ropeCount);
+	return m_ropes[rope].count;
+}
+
+b2Vec2 b2RopeSystem::GetVertex(int32 rope, int32 index) const
+{
+	b2Assert(0 <= rope && rope < m_ropeCount);
+	b2Assert(0 <= index && index < m_ropes[rope].count);
+	int32 i = m_ropes[rope].start + index;
+	return b2Vec2(m_px[i], m_py[i]);
+}
+
+void b2RopeSystem::SetVertex(int32 rope, int32 index, const b2Vec2& position)
+{
+	b2Assert(0 <= rope && rope < m_ropeCount);
+	b2Assert(0 <= index && index < m_ropes[rope].count);
+	int32 i = m_ropes[rope].start + index;
+	m_px[i] = position.x;
+	m_py[i] = position.y;
+}
+
+void b2RopeSystem::SetAngle(int32 rope, float32 angle)
+{
+	b2Assert(0 <= rope && rope < m_ropeCount);
+
+	// The bend sweep expects rest angles in [-pi, pi].
+	angle = b2Atan2(sinf(angle), cosf(angle));
+
+	const b2RopeRange* range = m_ropes + rope;
+	for (int32 i = 0; i < range->count - 2; ++i)
+	{
+		m_as[range->start + i] = angle;
+	}
+}
+
+void b2RopeSystem::Step(float32 h, int32 iterations)
+{
+	if (h == 0.0f || m_ropeCount == 0)
+	{
+		return;
+	}
+
+	if (m_threadPool)
+	{
+		b2RopeTask task;
+		task.system = this;
+		task.h = h;
+		task.iterations = iterations;
+		m_threadPool->ParallelFor(&task, m_ropeCount, b2_ropeGrain);
+	}
+	else
+	{
+		StepRopes(0, m_ropeCount, h, iterations);
+	}
+}
+
+void b2RopeSystem::StepRopes(int32 begin, int32 end, float32 h, int32 iterations)
+{
+	for (int32 r = begin; r < end; ++r)
+	{
+		const b2RopeRange* rope = m_ropes + r;
+		float32 d = expf(- h * rope->damping);
+		float32 gx = h * rope->gravity.x;
+		float32 gy = h * rope->gravity.y;
+
+		for (int32 i = rope->start; i < rope->start + rope->count; ++i)
+		{
+			m_p0x[i] = m_px[i];
+			m_p0y[i] = m_py[i];
+			bool moves = m_ims[i] > 0.0f;
+			m_vx[i] = d * (moves ? m_vx[i] + gx : m_vx[i]);
+			m_vy[i] = d * (moves ? m_vy[i] + gy : m_vy[i]);
+			m_px[i] += h * m_vx[i];
+			m_py[i] += h * m_vy[i];
+		}
+	}
+
+	// The constraints across two ropes have no stiffness, the sweeps run over
+	// all the vertices of the range at once.
+	int32 first = m_ropes[begin].start;
+	int32 last = m_ropes[end - 1].start + m_ropes[end - 1].count;
+	for (int32 i = 0; i < iterations; ++i)
+	{
+		b2SolveStretch(m_px, m_py, m_ims, m_Ls, m_k2s, first, last);
+		b2SolveStretch(m_px, m_py, m_ims, m_Ls, m_k2s, first + 1, last);
+		b2SolveBend(m_px, m_py, m_ims, m_as, m_k3s, first, last);
+		b2SolveBend(m_px, m_py, m_ims, m_as, m_k3s, first + 1, last);
+		b2SolveBend(m_px, m_py, m_ims, m_as, m_k3s, first + 2, last);
+		b2SolveStretch(m_px, m_py, m_ims, m_Ls, m_k2s, first, last);
+		b2SolveStretch(m_px, m_py, m_ims, m_Ls, m_k2s, first + 1, last);
+	}
+
+	float32 inv_h = 1.0f / h;
+	for (int32 i = first; i < last; ++i)
+	{
+		m_vx[i] = inv_h * (m_px[i] - m_p0x[i]);
+		m_vy[i] = inv_h * (m_py[i] - m_p0y[i]);
+	}
+}
+
+void b2RopeSystem::Draw(b2Draw* draw) const
+{
+	b2Color c(0.4f, 0.5f, 0.7f);
+
+	for (int32 r = 0; r < m_ropeCount; ++r)
+	{
+		const b2RopeRange* rope = m_ropes + r;
+		for (int32 i = rope->start; i < rope->start + rope->count - 1; ++i)
+		{
+			draw->DrawSegment(b2Vec2(m_px[i], m_py[i]), b2Vec2(m_px[i + 1], m_py[i + 1]), c);
+		}
+	}
+}
@@ -0,0 +1,110 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_ROPE_SYSTEM_H
+#define B2_ROPE_SYSTEM_H
+
+#include <Box2D/Rope/b2Rope.h>
+
+class b2ThreadPool;
+struct b2RopeRange;
+
+/// Owns many ropes and steps them together. The vertices of all the ropes are
+/// stored one rope after the other in structure of arrays, and the stretch and
+/// bend constraints are indexed by their first vertex. The stretch constraints
+/// are solved in red-black order and the bend constraints in three colors, so
+/// the constraints of a sweep don't share a vertex and the stretch sweeps vectorize.
+/// This converges a little differently than b2Rope, which solves the
+/// constraints in rope order.
+class b2RopeSystem
+{
+public:
+	b2RopeSystem();
+	~b2RopeSystem();
+
+	/// Add a rope and return its index.
+	int32 CreateRope(const b2RopeDef* def);
+
+	/// Remove all the ropes.
+	void Clear();
+
+	/// Step all the ropes. Their ranges are split among the threads of the pool, if any.
+	void Step(float32 timeStep, int32 iterations);
+
+	/// Step the ropes on the threads of this pool. The system doesn't own the pool.
+	void SetThreadPool(b2ThreadPool* threadPool) { m_threadPool = threadPool; }
+
+	///
+	int32 GetRopeCount() const
+	{
+		return m_ropeCount;
+	}
+
+	///
+	int32 GetVertexCount(int32 rope) const;
+
+	///
+	b2Vec2 GetVertex(int32 rope, int32 index) const;
+
+	/// Move a vertex, for instance the anchor of a rope. This is the only way to
+	/// move a vertex without mass.
+	void SetVertex(int32 rope, int32 index, const b2Vec2& position);
+
+	/// Same as b2Rope::SetAngle, for one rope.
+	void SetAngle(int32 rope, float32 angle);
+
+	///
+	void Draw(b2Draw* draw) const;
+
+private:
+
+	void Reserve(int32 vertexCapacity);
+
+	// Step the ropes [begin, end).
+	void StepRopes(int32 begin, int32 end, float32 h, int32 iterations);
+
+	friend struct b2RopeTask;
+
+	b2ThreadPool* m_threadPool;
+
+	b2RopeRange* m_ropes;
+	int32 m_ropeCount;
+	int32 m_ropeCapacity;
+
+	int32 m_vertexCount;
+	int32 m_vertexCapacity;
+
+	// Vertices.
+	float32* m_px;
+	float32* m_py;
+	float32* m_p0x;
+	float32* m_p0y;
+	float32* m_vx;
+	float32* m_vy;
+	float32* m_ims;
+
+	// Stretch constraint between the vertices i and i + 1, no stiffness after the last vertex of a rope.
+	float32* m_Ls;
+	float32* m_k2s;
+
+	// Bend constraint of the vertices i, i + 1 and i + 2, no stiffness after the second last vertex of a rope.
+	float32* m_as;
+	float32* m_k3s;
+};
+
+#endif
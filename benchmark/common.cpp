@@ -0,0 +1,110 @@
+#include "common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+void resetPeakMemory()
+{
+#if defined(__linux__)
+    FILE* file = fopen("/proc/self/clear_refs","w");
+    if (!file) return;
+    fputs("5",file);
+    fclose(file);
+#endif
+}
+
+long peakMemory()
+{
+#if defined(__linux__)
+    FILE* file = fopen("/proc/self/status","r");
+    if (file) {
+        char line[256];
+        long value = -1;
+        while (fgets(line,sizeof(line),file)) {
+            if (sscanf(line,"VmHWM: %ld kB",&value)==1) break;
+        }
+        fclose(file);
+        if (value>=0) return value;
+    }
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF,&usage)==0) {
+#if defined(__APPLE__)
+        return usage.ru_maxrss/1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
+
+const ProfileField profileFields[] = {
+    {"step",&b2Profile::step},
+    {"collide",&b2Profile::collide},
+    {"solve",&b2Profile::solve},
+    {"solveInit",&b2Profile::solveInit},
+    {"solveVelocity",&b2Profile::solveVelocity},
+    {"solvePosition",&b2Profile::solvePosition},
+    {"broadphase",&b2Profile::broadphase},
+    {"solveTOI",&b2Profile::solveTOI},
+    {"particles",&b2Profile::particles},
+};
+const int profileFieldCount = sizeof(profileFields)/sizeof(profileFields[0]);
+
+float maxPenetration(const b2World* world)
+{
+    float penetration = 0;
+    for (const b2Contact* contact=world->GetContactList(); contact!=NULL; contact=contact->GetNext()) {
+        if (!contact->IsTouching()) continue;
+
+        const b2Fixture* fixtureA = contact->GetFixtureA();
+        const b2Fixture* fixtureB = contact->GetFixtureB();
+        const b2Transform& xfA = fixtureA->GetBody()->GetTransform();
+        const b2Transform& xfB = fixtureB->GetBody()->GetTransform();
+        const float radius = fixtureA->GetShape()->m_radius+fixtureB->GetShape()->m_radius;
+        const b2Manifold* manifold = contact->GetManifold();
+
+        for (int kk=0; kk<manifold->pointCount; kk++) {
+            float separation = 0;
+            switch (manifold->type) {
+            case b2Manifold::e_circles:
+                separation = (b2Mul(xfB,manifold->points[0].localPoint)-b2Mul(xfA,manifold->localPoint)).Length()-radius;
+                break;
+            case b2Manifold::e_faceA:
+                separation = b2Dot(b2Mul(xfB,manifold->points[kk].localPoint)-b2Mul(xfA,manifold->localPoint),b2Mul(xfA.q,manifold->localNormal))-radius;
+                break;
+            case b2Manifold::e_faceB:
+                separation = b2Dot(b2Mul(xfA,manifold->points[kk].localPoint)-b2Mul(xfB,manifold->localPoint),b2Mul(xfB.q,manifold->localNormal))-radius;
+                break;
+            }
+            penetration = std::max(penetration,-separation);
+        }
+    }
+    return penetration;
+}
+
+float maxJointError(const b2World* world)
+{
+    float error = 0;
+    for (const b2Joint* joint=world->GetJointList(); joint!=NULL; joint=joint->GetNext()) {
+        switch (joint->GetType()) {
+        case e_revoluteJoint:
+            error = std::max(error,(joint->GetAnchorB()-joint->GetAnchorA()).Length());
+            break;
+        case e_distanceJoint: {
+            const b2DistanceJoint* distance = static_cast<const b2DistanceJoint*>(joint);
+            error = std::max(error,fabsf((joint->GetAnchorB()-joint->GetAnchorA()).Length()-distance->GetLength()));
+            } break;
+        default:
+            break;
+        }
+    }
+    return error;
+}
@@ -0,0 +1,29 @@
+#ifndef __COMMON_H__
+#define __COMMON_H__
+
+#include <Box2D/Box2D.h>
+
+// Reset the peak resident memory counter when the platform allows it (linux
+// only), so that the next peakMemory() call covers only what follows.
+void resetPeakMemory();
+
+// Peak resident memory in kilobytes, or -1 when unknown.
+long peakMemory();
+
+// b2Profile fields reported by the benchmarks, in column order.
+struct ProfileField {
+    const char* name;
+    float32 b2Profile::* member;
+};
+
+extern const ProfileField profileFields[];
+extern const int profileFieldCount;
+
+// Deepest overlap between touching shapes, in meters. Tells how well the
+// solver keeps stacks apart.
+float maxPenetration(const b2World* world);
+
+// Largest drift of the revolute and distance joints, in meters.
+float maxJointError(const b2World* world);
+
+#endif
@@ -0,0 +1,183 @@
+#!/usr/bin/env python
+# coding: utf-8
+
+# Run box2d_benchmark several times and compare against a baseline.
+#
+#   compare.py --benchmark build/benchmark/box2d_benchmark
+#   compare.py --benchmark ... --update     (rewrite the baseline)
+#   compare.py --benchmark ... --soft 4     (soft step solver against the baseline)
+#   compare.py --benchmark ... --threads 4  (parallel island solver against the baseline)
+#   compare.py --benchmark ... --speculative (speculative contacts against TOI)
+#   compare.py --benchmark ... --adaptive-margins (adaptive fat AABBs against fixed ones)
+#   compare.py --benchmark ... --async      (world stepped on a background thread)
+#
+# Every run gives one sample per scene and per metric (mean step time, mean
+# b2Profile phases, broad-phase churn, worst penetration, joint error and
+# escaped bodies). Samples are summarized with median and MAD and
+# compared with a Mann-Whitney U test, so a single noisy run doesn't flag a
+# regression. The exit code is 1 when at least one metric is significantly
+# slower than the baseline by more than the threshold, or when a scene has
+# no baseline: a new scene must add itself to baseline.json.
+#
+# Timings depend on the machine: regenerate baseline.json with --update on
+# the machine used as a gate before trusting the comparison.
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+default_baseline = os.path.join(os.path.dirname(os.path.abspath(__file__)),"baseline.json")
+
+# Phases too short to be timed reliably (ms) and negligible quality errors
+# (m) are not compared.
+min_value = 0.02
+
+def median(values):
+    values = sorted(values)
+    count = len(values)
+    if count == 0: return 0.
+    if count % 2: return values[count//2]
+    return .5*(values[count//2-1]+values[count//2])
+
+def mad(values):
+    center = median(values)
+    return median([abs(value-center) for value in values])
+
+def mann_whitney(xs, ys):
+    """Return the one-sided p-value of xs being stochastically greater than ys.
+
+    The exact distribution of U is counted by dynamic programming, which is
+    cheap for the handful of runs we do. Ties count for one half."""
+    nx, ny = len(xs), len(ys)
+    if nx == 0 or ny == 0: return 1.
+    u = 0.
+    for x in xs:
+        for y in ys:
+            if x > y: u += 1.
+            elif x == y: u += .5
+
+    # counts[n][m][k] is the number of orderings of n xs and m ys with U=k.
+    counts = {}
+    def count(n, m, k):
+        if k < 0: return 0
+        if n == 0 or m == 0: return 1 if k == 0 else 0
+        key = (n,m,k)
+        if key not in counts:
+            counts[key] = count(n-1,m,k-m)+count(n,m-1,k)
+        return counts[key]
+
+    total = 0
+    tail = 0
+    threshold = int(u+.5)
+    for k in range(nx*ny+1):
+        value = count(nx,ny,k)
+        total += value
+        if k >= threshold: tail += value
+    return float(tail)/total
+
+def run_benchmark(benchmark, runs, scenes, steps, soft, tolerance, min_iterations, threads, speculative, adaptive_margins, async_step):
+    samples = {}
+    command = [benchmark,"--format","json"]
+    for scene in scenes: command += ["--scene",scene]
+    if steps: command += ["--steps",str(steps)]
+    if soft: command += ["--soft",str(soft)]
+    if tolerance: command += ["--tolerance",str(tolerance),"--min-iterations",str(min_iterations)]
+    if threads > 1: command += ["--threads",str(threads)]
+    if speculative: command += ["--speculative"]
+    if adaptive_margins: command += ["--adaptive-margins"]
+    if async_step: command += ["--async"]
+    for run in range(runs):
+        print("run %d/%d" % (run+1,runs), file=sys.stderr)
+        output = subprocess.check_output(command)
+        data = json.loads(output.decode("utf-8"))
+        for scene in data["scenes"]:
+            metrics = samples.setdefault(scene["name"],{})
+            metrics.setdefault("step",[]).append(scene["stepTime"]["mean"])
+            for phase,value in scene["profile"].items():
+                if phase == "step": continue
+                metrics.setdefault(phase,[]).append(value)
+            for counter,value in scene.get("broadphase",{}).items():
+                metrics.setdefault(counter,[]).append(value)
+            for measure,value in scene.get("quality",{}).items():
+                metrics.setdefault(measure,[]).append(value)
+    return samples
+
+def compare(baseline, current, threshold, alpha):
+    regressions = []
+    missing = []
+    print("%-16s %-14s %10s %10s %8s %8s %s" % ("scene","metric","baseline","current","change","p","status"))
+    for scene in sorted(current):
+        if scene not in baseline:
+            print("%-16s not in baseline, MISSING" % scene)
+            missing.append(scene)
+            continue
+        for metric in sorted(current[scene]):
+            if metric not in baseline[scene]: continue
+            xs = current[scene][metric]
+            ys = baseline[scene][metric]
+            reference = median(ys)
+            value = median(xs)
+            if max(reference,value) < min_value: continue
+            change = value/reference-1 if reference > 0 else 0.
+            p = mann_whitney(xs,ys)
+            status = ""
+            if p < alpha and change > threshold:
+                status = "REGRESSION"
+                regressions.append((scene,metric))
+            elif mann_whitney(ys,xs) < alpha and change < -threshold:
+                status = "improvement"
+            print("%-16s %-14s %10.4f %10.4f %+7.1f%% %8.4f %s" % (scene,metric,reference,value,100*change,p,status))
+    return regressions, missing
+
+def main():
+    parser = argparse.ArgumentParser(description="compare box2d_benchmark runs against a baseline")
+    parser.add_argument("--benchmark",default="box2d_benchmark",help="path to box2d_benchmark")
+    parser.add_argument("--baseline",default=default_baseline,help="baseline json file")
+    parser.add_argument("--runs",type=int,default=7,help="number of benchmark runs")
+    parser.add_argument("--scene",action="append",default=[],help="restrict to this scene (repeatable)")
+    parser.add_argument("--steps",type=int,default=0,help="override the step count of every scene")
+    parser.add_argument("--soft",type=int,default=0,help="soft step sub-steps, 0 for the iterative solver")
+    parser.add_argument("--tolerance",type=float,default=0,help="adaptive iterations impulse tolerance, 0 to run all")
+    parser.add_argument("--min-iterations",type=int,default=1,help="adaptive iterations lower bound")
+    parser.add_argument("--threads",type=int,default=1,help="threads solving large islands")
+    parser.add_argument("--speculative",action="store_true",help="speculative contacts instead of TOI")
+    parser.add_argument("--adaptive-margins",action="store_true",help="adapt the fat AABB margins to the motion")
+    parser.add_argument("--async",dest="async_step",action="store_true",help="step the world on a background thread")
+    parser.add_argument("--threshold",type=float,default=.10,help="relative slowdown ignored as noise")
+    parser.add_argument("--alpha",type=float,default=.01,help="significance level")
+    parser.add_argument("--update",action="store_true",help="write the runs as the new baseline")
+    args = parser.parse_args()
+
+    current = run_benchmark(args.benchmark,args.runs,args.scene,args.steps,args.soft,args.tolerance,args.min_iterations,args.threads,args.speculative,args.adaptive_margins,args.async_step)
+
+    for scene in sorted(current):
+        step = current[scene]["step"]
+        print("%-16s median %.4f ms mad %.4f ms" % (scene,median(step),mad(step)), file=sys.stderr)
+
+    if args.update:
+        with open(args.baseline,"w") as handle:
+            json.dump({"runs": args.runs, "steps": args.steps, "scenes": current},handle,indent=1,sort_keys=True)
+        print("baseline written to %s" % args.baseline)
+        return 0
+
+    with open(args.baseline) as handle:
+        baseline = json.load(handle)
+    if baseline.get("steps",0) != args.steps:
+        print("warning: baseline recorded with --steps %d" % baseline.get("steps",0), file=sys.stderr)
+
+    regressions, missing = compare(baseline["scenes"],current,args.threshold,args.alpha)
+    if missing:
+        print("%d scene(s) missing from the baseline, rerun with --update" % len(missing))
+    if regressions:
+        print("%d significant regression(s)" % len(regressions))
+    if missing or regressions:
+        return 1
+    print("no significant regression")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
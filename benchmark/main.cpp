@@ -0,0 +1,313 @@
+#include "scenes.h"
+#include "common.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+struct Result {
+    std::string name;
+    int steps;
+    float mean;
+    float min;
+    float max;
+    float p50;
+    float p90;
+    float p95;
+    float p99;
+    float total;
+    std::vector<float> profile;
+    int bodyCount;
+    int contactCount;
+    int jointCount;
+    long peakMemory;
+    float penetration;
+    float jointError;
+    int escaped;
+    float velocityIterations;
+    float positionIterations;
+    float islandCount;
+    float reinserts;
+    float bufferedMoves;
+    float falsePairs;
+    int satCalls;
+    int satCacheHits;
+    int gjkCalls;
+    int gjkIters;
+    int toiCalls;
+    int toiIters;
+    int toiRootIters;
+};
+
+static float percentile(const std::vector<float> &sorted, float fraction)
+{
+    if (sorted.empty()) return 0;
+    const size_t index = static_cast<size_t>(fraction*(sorted.size()-1)+.5);
+    return sorted[std::min(index,sorted.size()-1)];
+}
+
+struct Options {
+    int softSubSteps;
+    float tolerance;
+    int minIterations;
+    int threads;
+    bool speculative;
+    bool adaptiveMargins;
+    bool async;
+};
+
+static Result runScene(Scene* scene, int stepCount, const Options &options)
+{
+    resetPeakMemory();
+
+    b2World* world = new b2World(benchmarkGravity,true);
+    world->SetSoftStepping(options.softSubSteps);
+    world->SetSpeculativeContacts(options.speculative);
+    world->SetAdaptiveMargins(options.adaptiveMargins);
+    world->SetAdaptiveIterations(options.tolerance,options.minIterations);
+    b2ThreadPool* threadPool = options.threads>1 ? new b2ThreadPool(options.threads) : NULL;
+    world->SetThreadPool(threadPool);
+    Random random(benchmarkSeed);
+    scene->build(world,random);
+    b2AsyncStepper* stepper = options.async ? new b2AsyncStepper(world) : NULL;
+
+    Result result;
+    result.name = scene->getName();
+    result.steps = stepCount;
+    result.profile.assign(profileFieldCount,0);
+    result.penetration = 0;
+    result.jointError = 0;
+    result.velocityIterations = 0;
+    result.positionIterations = 0;
+    result.islandCount = 0;
+    result.reinserts = 0;
+    result.satCalls = 0;
+    result.satCacheHits = 0;
+    result.gjkCalls = 0;
+    result.gjkIters = 0;
+    result.toiCalls = 0;
+    result.toiIters = 0;
+    result.toiRootIters = 0;
+    result.bufferedMoves = 0;
+    result.falsePairs = 0;
+
+    std::vector<float> times;
+    times.reserve(stepCount);
+    for (int step=0; step<stepCount; step++) {
+        scene->preStep(world,step);
+
+        // The async stepper overlaps the world step with the scene extra work.
+        b2Timer timer;
+        if (stepper) {
+            stepper->Step(scene->getTimeStep(),scene->getVelocityIterations(),scene->getPositionIterations());
+            scene->stepExtra(scene->getTimeStep());
+            stepper->Wait();
+        } else {
+            world->Step(scene->getTimeStep(),scene->getVelocityIterations(),scene->getPositionIterations());
+            scene->stepExtra(scene->getTimeStep());
+        }
+        times.push_back(timer.GetMilliseconds());
+
+        const b2Profile& profile = world->GetProfile();
+        for (int kk=0; kk<profileFieldCount; kk++) result.profile[kk] += profile.*profileFields[kk].member;
+        result.velocityIterations += profile.velocityIterations;
+        result.positionIterations += profile.positionIterations;
+        result.islandCount += profile.islandCount;
+        result.reinserts += profile.reinsertCount;
+        result.bufferedMoves += profile.bufferedMoveCount;
+        result.falsePairs += profile.falsePairCount;
+        result.satCalls += profile.satCallCount;
+        result.satCacheHits += profile.satCacheHitCount;
+        result.gjkCalls += profile.gjkCallCount;
+        result.gjkIters += profile.gjkIterCount;
+        result.toiCalls += profile.toiCallCount;
+        result.toiIters += profile.toiIterCount;
+        result.toiRootIters += profile.toiRootIterCount;
+
+        result.penetration = std::max(result.penetration,maxPenetration(world));
+        result.jointError = std::max(result.jointError,maxJointError(world));
+    }
+
+    result.total = 0;
+    for (std::vector<float>::const_iterator iter=times.begin(); iter!=times.end(); iter++) result.total += *iter;
+    result.mean = stepCount>0 ? result.total/stepCount : 0;
+    for (int kk=0; kk<profileFieldCount; kk++) result.profile[kk] = stepCount>0 ? result.profile[kk]/stepCount : 0;
+    if (stepCount>0) {
+        result.velocityIterations /= stepCount;
+        result.positionIterations /= stepCount;
+        result.islandCount /= stepCount;
+        result.reinserts /= stepCount;
+        result.bufferedMoves /= stepCount;
+        result.falsePairs /= stepCount;
+    }
+
+    std::sort(times.begin(),times.end());
+    result.min = times.empty() ? 0 : times.front();
+    result.max = times.empty() ? 0 : times.back();
+    result.p50 = percentile(times,.50);
+    result.p90 = percentile(times,.90);
+    result.p95 = percentile(times,.95);
+    result.p99 = percentile(times,.99);
+
+    result.escaped = scene->countEscaped(world);
+    result.bodyCount = world->GetBodyCount();
+    result.contactCount = world->GetContactCount();
+    result.jointCount = world->GetJointCount();
+    result.peakMemory = peakMemory();
+
+    delete stepper;
+    scene->teardown();
+    delete world;
+    delete threadPool;
+
+    return result;
+}
+
+typedef std::vector<Result> Results;
+
+static void writeJson(FILE* output, const Results &results, const Options &options)
+{
+    fprintf(output,"{\n");
+    fprintf(output,"  \"seed\": %u,\n",benchmarkSeed);
+    fprintf(output,"  \"softSubSteps\": %d,\n",options.softSubSteps);
+    fprintf(output,"  \"tolerance\": %g,\n",options.tolerance);
+    fprintf(output,"  \"minIterations\": %d,\n",options.minIterations);
+    fprintf(output,"  \"threads\": %d,\n",options.threads);
+    fprintf(output,"  \"speculative\": %s,\n",options.speculative ? "true" : "false");
+    fprintf(output,"  \"adaptiveMargins\": %s,\n",options.adaptiveMargins ? "true" : "false");
+    fprintf(output,"  \"async\": %s,\n",options.async ? "true" : "false");
+    fprintf(output,"  \"timeStep\": %g,\n",benchmarkTimeStep);
+    fprintf(output,"  \"scenes\": [\n");
+    for (Results::const_iterator iter=results.begin(); iter!=results.end(); iter++) {
+        fprintf(output,"    {\n");
+        fprintf(output,"      \"name\": \"%s\",\n",iter->name.c_str());
+        fprintf(output,"      \"steps\": %d,\n",iter->steps);
+        fprintf(output,"      \"stepTime\": {\"mean\": %f, \"min\": %f, \"max\": %f, \"p50\": %f, \"p90\": %f, \"p95\": %f, \"p99\": %f, \"total\": %f},\n",
+                iter->mean,iter->min,iter->max,iter->p50,iter->p90,iter->p95,iter->p99,iter->total);
+        fprintf(output,"      \"profile\": {");
+        for (int kk=0; kk<profileFieldCount; kk++) {
+            fprintf(output,"%s\"%s\": %f",kk ? ", " : "",profileFields[kk].name,iter->profile[kk]);
+        }
+        fprintf(output,"},\n");
+        fprintf(output,"      \"bodies\": %d,\n",iter->bodyCount);
+        fprintf(output,"      \"contacts\": %d,\n",iter->contactCount);
+        fprintf(output,"      \"joints\": %d,\n",iter->jointCount);
+        fprintf(output,"      \"iterations\": {\"velocity\": %f, \"position\": %f, \"islands\": %f},\n",iter->velocityIterations,iter->positionIterations,iter->islandCount);
+        fprintf(output,"      \"broadphase\": {\"reinserts\": %f, \"bufferedMoves\": %f, \"falsePairs\": %f},\n",iter->reinserts,iter->bufferedMoves,iter->falsePairs);
+        fprintf(output,"      \"quality\": {\"penetration\": %f, \"jointError\": %f, \"escaped\": %d},\n",iter->penetration,iter->jointError,iter->escaped);
+        fprintf(output,"      \"satCache\": {\"calls\": %d, \"hits\": %d},\n",iter->satCalls,iter->satCacheHits);
+        fprintf(output,"      \"collision\": {\"gjkCalls\": %d, \"gjkIters\": %d, \"toiCalls\": %d, \"toiIters\": %d, \"toiRootIters\": %d},\n",
+                iter->gjkCalls,iter->gjkIters,iter->toiCalls,iter->toiIters,iter->toiRootIters);
+        fprintf(output,"      \"peakMemoryKb\": %ld\n",iter->peakMemory);
+        fprintf(output,"    }%s\n",iter+1!=results.end() ? "," : "");
+    }
+    fprintf(output,"  ]\n");
+    fprintf(output,"}\n");
+}
+
+static void writeCsv(FILE* output, const Results &results)
+{
+    fprintf(output,"scene,steps,mean,min,max,p50,p90,p95,p99,total");
+    for (int kk=0; kk<profileFieldCount; kk++) fprintf(output,",%s",profileFields[kk].name);
+    fprintf(output,",velocityIterations,positionIterations,islands,reinserts,bufferedMoves,falsePairs,bodies,contacts,joints,penetration,jointError,escaped,satCalls,satCacheHits,gjkCalls,gjkIters,toiCalls,toiIters,toiRootIters,peakMemoryKb\n");
+    for (Results::const_iterator iter=results.begin(); iter!=results.end(); iter++) {
+        fprintf(output,"%s,%d,%f,%f,%f,%f,%f,%f,%f,%f",
+                iter->name.c_str(),iter->steps,iter->mean,iter->min,iter->max,iter->p50,iter->p90,iter->p95,iter->p99,iter->total);
+        for (int kk=0; kk<profileFieldCount; kk++) fprintf(output,",%f",iter->profile[kk]);
+        fprintf(output,",%f,%f,%f",iter->velocityIterations,iter->positionIterations,iter->islandCount);
+        fprintf(output,",%f,%f,%f",iter->reinserts,iter->bufferedMoves,iter->falsePairs);
+        fprintf(output,",%d,%d,%d,%f,%f,%d,%d,%d",iter->bodyCount,iter->contactCount,iter->jointCount,iter->penetration,iter->jointError,iter->escaped,iter->satCalls,iter->satCacheHits);
+        fprintf(output,",%d,%d,%d,%d,%d,%ld\n",iter->gjkCalls,iter->gjkIters,iter->toiCalls,iter->toiIters,iter->toiRootIters,iter->peakMemory);
+    }
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr,"usage: %s [--list] [--scene name]... [--steps count] [--soft substeps]\n"
+                   "          [--tolerance impulse] [--min-iterations count] [--threads count]\n"
+                   "          [--speculative] [--adaptive-margins] [--async]\n"
+                   "          [--format json|csv] [--output file]\n",program);
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> selected;
+    int steps = -1;
+    Options options;
+    options.softSubSteps = 0;
+    options.tolerance = 0;
+    options.minIterations = 1;
+    options.threads = 1;
+    options.speculative = false;
+    options.adaptiveMargins = false;
+    options.async = false;
+    bool csv = false;
+    bool list = false;
+    const char* outputName = NULL;
+
+    for (int kk=1; kk<argc; kk++) {
+        const std::string arg = argv[kk];
+        const bool hasValue = kk+1<argc;
+        if (arg=="--list") list = true;
+        else if (arg=="--scene" && hasValue) selected.push_back(argv[++kk]);
+        else if (arg=="--steps" && hasValue) steps = atoi(argv[++kk]);
+        else if (arg=="--soft" && hasValue) options.softSubSteps = atoi(argv[++kk]);
+        else if (arg=="--tolerance" && hasValue) options.tolerance = atof(argv[++kk]);
+        else if (arg=="--min-iterations" && hasValue) options.minIterations = atoi(argv[++kk]);
+        else if (arg=="--threads" && hasValue) options.threads = atoi(argv[++kk]);
+        else if (arg=="--speculative") options.speculative = true;
+        else if (arg=="--adaptive-margins") options.adaptiveMargins = true;
+        else if (arg=="--async") options.async = true;
+        else if (arg=="--output" && hasValue) outputName = argv[++kk];
+        else if (arg=="--format" && hasValue) {
+            const std::string format = argv[++kk];
+            if (format=="csv") csv = true;
+            else if (format!="json") { usage(argv[0]); return 1; }
+        } else { usage(argv[0]); return 1; }
+    }
+
+    Scenes scenes = createScenes();
+
+    if (list) {
+        for (Scenes::const_iterator iter=scenes.begin(); iter!=scenes.end(); iter++) printf("%s\n",(*iter)->getName());
+        destroyScenes(scenes);
+        return 0;
+    }
+
+    for (std::vector<std::string>::const_iterator name=selected.begin(); name!=selected.end(); name++) {
+        bool found = false;
+        for (Scenes::const_iterator iter=scenes.begin(); iter!=scenes.end(); iter++) found |= *name==(*iter)->getName();
+        if (!found) {
+            fprintf(stderr,"unknown scene %s\n",name->c_str());
+            destroyScenes(scenes);
+            return 1;
+        }
+    }
+
+    Results results;
+    for (Scenes::const_iterator iter=scenes.begin(); iter!=scenes.end(); iter++) {
+        Scene* scene = *iter;
+        if (!selected.empty() && std::find(selected.begin(),selected.end(),scene->getName())==selected.end()) continue;
+        results.push_back(runScene(scene,steps>=0 ? steps : scene->getStepCount(),options));
+        fprintf(stderr,"%s: %.3f ms/step\n",results.back().name.c_str(),results.back().mean);
+    }
+    destroyScenes(scenes);
+
+    FILE* output = stdout;
+    if (outputName) {
+        output = fopen(outputName,"w");
+        if (!output) {
+            fprintf(stderr,"can't open %s\n",outputName);
+            return 1;
+        }
+    }
+
+    if (csv) writeCsv(output,results);
+    else writeJson(output,results,options);
+
+    if (output!=stdout) fclose(output);
+
+    return 0;
+}
@@ -0,0 +1,363 @@
+// Scaling harness: builds parameterized worlds and sweeps the body count and
+// the number of workers, printing one CSV line per configuration.
+//
+// Each worker steps its own independent world (built from its own seed) and
+// the throughput column tells how well independent worlds run side by side.
+// The solver threads are given to every world as a b2ThreadPool, they solve
+// the large islands of that world in parallel.
+
+#include "scenes.h"
+#include "common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+enum SizeDistribution {
+    FIXED_SIZE,
+    UNIFORM_SIZE,
+    BIMODAL_SIZE
+};
+
+static const char* sizeNames[] = {"fixed","uniform","bimodal"};
+
+struct Config {
+    int bodyCount;
+    int workers;
+    int solverThreads;
+    float density;
+    float sleepingFraction;
+    SizeDistribution sizes;
+    float circleWeight;
+    float boxWeight;
+    float polygonWeight;
+    bool gravity;
+    int steps;
+    int warmup;
+};
+
+struct WorkerResult {
+    std::vector<float> times;
+    std::vector<float> profile;
+    float timed;
+    int contactCount;
+    int awakeCount;
+};
+
+static float maxRadius(SizeDistribution sizes)
+{
+    switch (sizes) {
+        case UNIFORM_SIZE: return .75;
+        case BIMODAL_SIZE: return 1;
+        default: return .5;
+    }
+}
+
+static float drawRadius(SizeDistribution sizes, Random &random)
+{
+    switch (sizes) {
+        case UNIFORM_SIZE: return random.uniform(.25,.75);
+        case BIMODAL_SIZE: return random.uniform(0,1)<.9 ? .25 : 1;
+        default: return .5;
+    }
+}
+
+static void addBody(b2World* world, const Config &config, const b2Vec2 &pos, bool awake, Random &random)
+{
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_dynamicBody;
+    bodyDef.position = pos;
+    bodyDef.angle = random.uniform(-b2_pi,b2_pi);
+    bodyDef.awake = awake;
+    if (awake && !config.gravity) bodyDef.linearVelocity.Set(random.uniform(-5,5),random.uniform(-5,5));
+    b2Body* body = world->CreateBody(&bodyDef);
+
+    const float radius = drawRadius(config.sizes,random);
+    const float total = config.circleWeight+config.boxWeight+config.polygonWeight;
+    const float pick = random.uniform(0,total);
+
+    if (pick<config.circleWeight) {
+        b2CircleShape shape;
+        shape.m_radius = radius;
+        body->CreateFixture(&shape,1);
+    } else if (pick<config.circleWeight+config.boxWeight) {
+        b2PolygonShape shape;
+        shape.SetAsBox(radius/sqrt(2.),radius/sqrt(2.));
+        body->CreateFixture(&shape,1);
+    } else {
+        const int count = 5+random.next()%4;
+        b2Vec2 vertices[b2_maxPolygonVertices];
+        for (int kk=0; kk<count; kk++) {
+            const float angle = 2*b2_pi*kk/count;
+            vertices[kk].Set(radius*cos(angle),radius*sin(angle));
+        }
+        b2PolygonShape shape;
+        shape.Set(vertices,count);
+        body->CreateFixture(&shape,1);
+    }
+
+    if (!awake) body->SetAwake(false);
+}
+
+// Fill a walled box with count bodies, one per randomly chosen grid cell, so
+// that the fraction of occupied cells is the requested density. Returns the
+// width of the box.
+static float addContainer(b2World* world, const Config &config, float left, int count, bool awake, Random &random)
+{
+    if (count<=0) return 0;
+
+    const float cell = 2.2*maxRadius(config.sizes);
+    const int cellCount = static_cast<int>(ceil(count/b2Clamp(config.density,.01f,1.f)));
+    const int columns = static_cast<int>(ceil(sqrt(static_cast<float>(cellCount))));
+    const int rows = (cellCount+columns-1)/columns;
+    const float width = columns*cell;
+    const float height = rows*cell;
+
+    b2BodyDef groundDef;
+    groundDef.position.Set(left,0);
+    b2Body* ground = world->CreateBody(&groundDef);
+    b2PolygonShape wall;
+    wall.SetAsBox(width/2.+1,.5,b2Vec2(width/2.,-.5),0);
+    ground->CreateFixture(&wall,0);
+    wall.SetAsBox(width/2.+1,.5,b2Vec2(width/2.,height+.5),0);
+    ground->CreateFixture(&wall,0);
+    wall.SetAsBox(.5,height/2.,b2Vec2(-.5,height/2.),0);
+    ground->CreateFixture(&wall,0);
+    wall.SetAsBox(.5,height/2.,b2Vec2(width+.5,height/2.),0);
+    ground->CreateFixture(&wall,0);
+
+    std::vector<int> cells(columns*rows);
+    for (size_t kk=0; kk<cells.size(); kk++) cells[kk] = kk;
+    for (size_t kk=cells.size()-1; kk>0; kk--) std::swap(cells[kk],cells[random.next()%(kk+1)]);
+
+    for (int kk=0; kk<count; kk++) {
+        const int column = cells[kk]%columns;
+        const int row = cells[kk]/columns;
+        addBody(world,config,b2Vec2(left+(column+.5)*cell,(row+.5)*cell),awake,random);
+    }
+
+    return width;
+}
+
+static void runWorker(const Config &config, uint32 seed, WorkerResult &result)
+{
+    b2World* world = new b2World(config.gravity ? benchmarkGravity : b2Vec2(0,0),true);
+    b2ThreadPool* threadPool = config.solverThreads>1 ? new b2ThreadPool(config.solverThreads) : NULL;
+    world->SetThreadPool(threadPool);
+    Random random(seed);
+
+    const int sleepingCount = static_cast<int>(config.bodyCount*b2Clamp(config.sleepingFraction,0.f,1.f));
+    const float width = addContainer(world,config,0,config.bodyCount-sleepingCount,true,random);
+    addContainer(world,config,width+10,sleepingCount,false,random);
+
+    for (int step=0; step<config.warmup; step++) world->Step(benchmarkTimeStep,8,3);
+
+    result.times.clear();
+    result.times.reserve(config.steps);
+    result.profile.assign(profileFieldCount,0);
+    b2Timer timed;
+    for (int step=0; step<config.steps; step++) {
+        b2Timer timer;
+        world->Step(benchmarkTimeStep,8,3);
+        result.times.push_back(timer.GetMilliseconds());
+
+        const b2Profile& profile = world->GetProfile();
+        for (int kk=0; kk<profileFieldCount; kk++) result.profile[kk] += profile.*profileFields[kk].member;
+    }
+    result.timed = timed.GetMilliseconds();
+
+    result.contactCount = world->GetContactCount();
+    result.awakeCount = 0;
+    for (const b2Body* body=world->GetBodyList(); body!=NULL; body=body->GetNext()) {
+        if (body->GetType()==b2_dynamicBody && body->IsAwake()) result.awakeCount++;
+    }
+
+    delete world;
+    delete threadPool;
+}
+
+struct WorkerTask {
+    const Config* config;
+    uint32 seed;
+    WorkerResult* result;
+};
+
+static void* workerMain(void* data)
+{
+    WorkerTask* task = static_cast<WorkerTask*>(data);
+    runWorker(*task->config,task->seed,*task->result);
+    return NULL;
+}
+
+static void runWorkers(const Config &config, std::vector<WorkerResult> &results)
+{
+    results.resize(config.workers);
+    std::vector<WorkerTask> tasks(config.workers);
+    for (int kk=0; kk<config.workers; kk++) {
+        tasks[kk].config = &config;
+        tasks[kk].seed = benchmarkSeed+kk;
+        tasks[kk].result = &results[kk];
+    }
+
+#if defined(__linux__) || defined(__APPLE__)
+    std::vector<pthread_t> threads(config.workers);
+    for (int kk=1; kk<config.workers; kk++) pthread_create(&threads[kk],NULL,workerMain,&tasks[kk]);
+    workerMain(&tasks[0]);
+    for (int kk=1; kk<config.workers; kk++) pthread_join(threads[kk],NULL);
+#else
+    for (int kk=0; kk<config.workers; kk++) workerMain(&tasks[kk]);
+#endif
+}
+
+static void writeHeader(FILE* output)
+{
+    fprintf(output,"bodies,workers,solverThreads,density,sizes,mix,sleeping,gravity,steps,msPerStep,p95,usPerBody,bodyStepsPerSecond,awake,contacts");
+    for (int kk=0; kk<profileFieldCount; kk++) fprintf(output,",%s",profileFields[kk].name);
+    fprintf(output,",peakMemoryKb\n");
+}
+
+static void runConfig(FILE* output, const Config &config)
+{
+    resetPeakMemory();
+
+    std::vector<WorkerResult> results;
+    runWorkers(config,results);
+
+    std::vector<float> times;
+    std::vector<float> profile(profileFieldCount,0);
+    float timed = 0;
+    float awake = 0;
+    float contacts = 0;
+    for (std::vector<WorkerResult>::const_iterator iter=results.begin(); iter!=results.end(); iter++) {
+        times.insert(times.end(),iter->times.begin(),iter->times.end());
+        for (int kk=0; kk<profileFieldCount; kk++) profile[kk] += iter->profile[kk];
+        timed = std::max(timed,iter->timed);
+        awake += iter->awakeCount;
+        contacts += iter->contactCount;
+    }
+
+    float mean = 0;
+    for (std::vector<float>::const_iterator iter=times.begin(); iter!=times.end(); iter++) mean += *iter;
+    if (!times.empty()) mean /= times.size();
+    std::sort(times.begin(),times.end());
+    const float p95 = times.empty() ? 0 : times[static_cast<size_t>(.95*(times.size()-1)+.5)];
+    const float samples = std::max(static_cast<size_t>(1),times.size());
+    const float throughput = timed>0 ? 1000.*config.bodyCount*config.steps*config.workers/timed : 0;
+
+    fprintf(output,"%d,%d,%d,%g,%s,%g:%g:%g,%g,%d,%d,%f,%f,%f,%.0f,%.0f,%.0f",
+            config.bodyCount,config.workers,config.solverThreads,config.density,sizeNames[config.sizes],
+            config.circleWeight,config.boxWeight,config.polygonWeight,
+            config.sleepingFraction,config.gravity,config.steps,
+            mean,p95,1000.*mean/config.bodyCount,throughput,
+            awake/config.workers,contacts/config.workers);
+    for (int kk=0; kk<profileFieldCount; kk++) fprintf(output,",%f",profile[kk]/samples);
+    fprintf(output,",%ld\n",peakMemory());
+    fflush(output);
+}
+
+template <typename Type>
+static std::vector<Type> parseList(const char* arg)
+{
+    std::vector<Type> values;
+    std::string list = arg;
+    size_t start = 0;
+    while (start<=list.size()) {
+        size_t end = list.find(',',start);
+        if (end==std::string::npos) end = list.size();
+        if (end>start) values.push_back(static_cast<Type>(atof(list.substr(start,end-start).c_str())));
+        start = end+1;
+    }
+    return values;
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr,"usage: %s [--bodies n,...] [--workers n,...] [--solver-threads n,...]\n"
+                   "          [--density f,...] [--sleeping f,...]\n"
+                   "          [--sizes fixed|uniform|bimodal] [--mix circles:boxes:polygons] [--gravity 0|1]\n"
+                   "          [--steps count] [--warmup count] [--output file]\n",program);
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> bodyCounts;
+    bodyCounts.push_back(100);
+    bodyCounts.push_back(300);
+    bodyCounts.push_back(1000);
+    bodyCounts.push_back(3000);
+    bodyCounts.push_back(10000);
+    bodyCounts.push_back(30000);
+    bodyCounts.push_back(100000);
+    std::vector<int> workerCounts(1,1);
+    std::vector<int> solverThreadCounts(1,1);
+    std::vector<float> densities(1,.3);
+    std::vector<float> sleepingFractions(1,0);
+    const char* outputName = NULL;
+
+    Config config;
+    config.sizes = UNIFORM_SIZE;
+    config.circleWeight = 1;
+    config.boxWeight = 1;
+    config.polygonWeight = 0;
+    config.gravity = true;
+    config.steps = 100;
+    config.warmup = 20;
+
+    for (int kk=1; kk<argc; kk++) {
+        const std::string arg = argv[kk];
+        if (kk+1>=argc) { usage(argv[0]); return 1; }
+        const char* value = argv[++kk];
+        if (arg=="--bodies") bodyCounts = parseList<int>(value);
+        else if (arg=="--workers") workerCounts = parseList<int>(value);
+        else if (arg=="--solver-threads") solverThreadCounts = parseList<int>(value);
+        else if (arg=="--density") densities = parseList<float>(value);
+        else if (arg=="--sleeping") sleepingFractions = parseList<float>(value);
+        else if (arg=="--gravity") config.gravity = atoi(value)!=0;
+        else if (arg=="--steps") config.steps = atoi(value);
+        else if (arg=="--warmup") config.warmup = atoi(value);
+        else if (arg=="--output") outputName = value;
+        else if (arg=="--sizes") {
+            const std::string sizes = value;
+            if (sizes=="fixed") config.sizes = FIXED_SIZE;
+            else if (sizes=="uniform") config.sizes = UNIFORM_SIZE;
+            else if (sizes=="bimodal") config.sizes = BIMODAL_SIZE;
+            else { usage(argv[0]); return 1; }
+        } else if (arg=="--mix") {
+            if (sscanf(value,"%f:%f:%f",&config.circleWeight,&config.boxWeight,&config.polygonWeight)!=3 ||
+                config.circleWeight+config.boxWeight+config.polygonWeight<=0) { usage(argv[0]); return 1; }
+        } else { usage(argv[0]); return 1; }
+    }
+
+    FILE* output = stdout;
+    if (outputName) {
+        output = fopen(outputName,"w");
+        if (!output) {
+            fprintf(stderr,"can't open %s\n",outputName);
+            return 1;
+        }
+    }
+
+    writeHeader(output);
+    for (std::vector<float>::const_iterator density=densities.begin(); density!=densities.end(); density++)
+    for (std::vector<float>::const_iterator sleeping=sleepingFractions.begin(); sleeping!=sleepingFractions.end(); sleeping++)
+    for (std::vector<int>::const_iterator workers=workerCounts.begin(); workers!=workerCounts.end(); workers++)
+    for (std::vector<int>::const_iterator solverThreads=solverThreadCounts.begin(); solverThreads!=solverThreadCounts.end(); solverThreads++)
+    for (std::vector<int>::const_iterator bodies=bodyCounts.begin(); bodies!=bodyCounts.end(); bodies++) {
+        config.density = *density;
+        config.sleepingFraction = *sleeping;
+        config.workers = std::max(1,*workers);
+        config.solverThreads = std::max(1,*solverThreads);
+        config.bodyCount = *bodies;
+        runConfig(output,config);
+    }
+
+    if (output!=stdout) fclose(output);
+
+    return 0;
+}
@@ -0,0 +1,1157 @@
+#include "scenes.h"
+
+#include <algorithm>
+#include <cmath>
+
+Random::Random(uint32 seed)
+    : state(seed)
+{
+}
+
+uint32 Random::next()
+{
+    state = 1664525u*state + 1013904223u;
+    return state;
+}
+
+float Random::uniform(float min, float max)
+{
+    const float unit = (next() >> 8) / 16777216.;
+    return min + (max-min)*unit;
+}
+
+Scene::Scene(const char* name, int stepCount, int velocityIterations, int positionIterations)
+    : name(name), stepCount(stepCount), velocityIterations(velocityIterations), positionIterations(positionIterations), timeStep(benchmarkTimeStep)
+{
+}
+
+Scene::~Scene()
+{
+}
+
+const char* Scene::getName() const { return name; }
+int Scene::getStepCount() const { return stepCount; }
+int Scene::getVelocityIterations() const { return velocityIterations; }
+int Scene::getPositionIterations() const { return positionIterations; }
+float Scene::getTimeStep() const { return timeStep; }
+
+void Scene::preStep(b2World* world, int step)
+{
+    B2_NOT_USED(world);
+    B2_NOT_USED(step);
+}
+
+void Scene::stepExtra(float dt)
+{
+    B2_NOT_USED(dt);
+}
+
+int Scene::countEscaped(const b2World* world) const
+{
+    B2_NOT_USED(world);
+    return 0;
+}
+
+void Scene::teardown()
+{
+}
+
+static b2Body* addGround(b2World* world, float halfWidth)
+{
+    b2BodyDef bodyDef;
+    b2Body* ground = world->CreateBody(&bodyDef);
+
+    b2EdgeShape shape;
+    shape.Set(b2Vec2(-halfWidth,0),b2Vec2(halfWidth,0));
+    ground->CreateFixture(&shape,0);
+    return ground;
+}
+
+static b2Body* addBox(b2World* world, const b2Vec2 &pos, float halfWidth, float halfHeight, float density=1)
+{
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_dynamicBody;
+    bodyDef.position = pos;
+
+    b2PolygonShape shape;
+    shape.SetAsBox(halfWidth,halfHeight);
+
+    b2Body* body = world->CreateBody(&bodyDef);
+    body->CreateFixture(&shape,density);
+    return body;
+}
+
+// Stack of boxes in a triangle, the classic stacking test.
+class PyramidScene : public Scene {
+public:
+    PyramidScene() : Scene("pyramid",600) {}
+
+    void build(b2World* world, Random& random)
+    {
+        B2_NOT_USED(random);
+        addGround(world,40);
+
+        const int rows = 20;
+        const float half = .5;
+        b2Vec2 x(-7,.75);
+        for (int ii=0; ii<rows; ii++) {
+            b2Vec2 y = x;
+            for (int jj=ii; jj<rows; jj++) {
+                addBox(world,y,half,half,5);
+                y += b2Vec2(1.125,0);
+            }
+            x += b2Vec2(.5625,1);
+        }
+    }
+};
+
+// Rotating container filled with many small boxes, one added per step.
+class TumblerScene : public Scene {
+public:
+    TumblerScene() : Scene("tumbler",1000), count(0) {}
+
+    void build(b2World* world, Random& random)
+    {
+        B2_NOT_USED(random);
+        count = 0;
+
+        b2BodyDef groundDef;
+        b2Body* ground = world->CreateBody(&groundDef);
+
+        b2BodyDef bodyDef;
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.allowSleep = false;
+        bodyDef.position.Set(0,10);
+        b2Body* body = world->CreateBody(&bodyDef);
+
+        b2PolygonShape shape;
+        shape.SetAsBox(.5,10,b2Vec2(10,0),0);
+        body->CreateFixture(&shape,5);
+        shape.SetAsBox(.5,10,b2Vec2(-10,0),0);
+        body->CreateFixture(&shape,5);
+        shape.SetAsBox(10,.5,b2Vec2(0,10),0);
+        body->CreateFixture(&shape,5);
+        shape.SetAsBox(10,.5,b2Vec2(0,-10),0);
+        body->CreateFixture(&shape,5);
+
+        b2RevoluteJointDef jointDef;
+        jointDef.bodyA = ground;
+        jointDef.bodyB = body;
+        jointDef.localAnchorA.Set(0,10);
+        jointDef.localAnchorB.Set(0,0);
+        jointDef.referenceAngle = 0;
+        jointDef.motorSpeed = .05*b2_pi;
+        jointDef.maxMotorTorque = 1e8;
+        jointDef.enableMotor = true;
+        world->CreateJoint(&jointDef);
+    }
+
+    void preStep(b2World* world, int step)
+    {
+        B2_NOT_USED(step);
+        if (count>=maxCount) return;
+        addBox(world,b2Vec2(0,10),.125,.125);
+        count++;
+    }
+protected:
+    static const int maxCount = 800;
+    int count;
+};
+
+// Heap of circles of slightly different sizes in a static bin.
+class CirclePileScene : public Scene {
+public:
+    CirclePileScene() : Scene("circle_pile",600) {}
+
+    void build(b2World* world, Random& random)
+    {
+        b2BodyDef groundDef;
+        b2Body* ground = world->CreateBody(&groundDef);
+        b2PolygonShape wall;
+        wall.SetAsBox(15,.5,b2Vec2(0,-.5),0);
+        ground->CreateFixture(&wall,0);
+        wall.SetAsBox(.5,20,b2Vec2(-15.5,20),0);
+        ground->CreateFixture(&wall,0);
+        wall.SetAsBox(.5,20,b2Vec2(15.5,20),0);
+        ground->CreateFixture(&wall,0);
+
+        const int columns = 40;
+        const int rows = 25;
+        for (int ii=0; ii<rows; ii++) {
+            for (int jj=0; jj<columns; jj++) {
+                b2BodyDef bodyDef;
+                bodyDef.type = b2_dynamicBody;
+                bodyDef.position.Set(-14.5+.72*jj+random.uniform(-.05,.05),1+.72*ii);
+
+                b2CircleShape shape;
+                shape.m_radius = random.uniform(.2,.3);
+
+                b2FixtureDef fixtureDef;
+                fixtureDef.shape = &shape;
+                fixtureDef.density = 1;
+                fixtureDef.friction = .3;
+                fixtureDef.restitution = .2;
+
+                world->CreateBody(&bodyDef)->CreateFixture(&fixtureDef);
+            }
+        }
+    }
+};
+
+// Ten thousand grains in a particle system with a few boxes dropped on top.
+class ParticlePileScene : public Scene {
+public:
+    ParticlePileScene() : Scene("particle_pile",400) {}
+
+    void build(b2World* world, Random& random)
+    {
+        b2BodyDef groundDef;
+        b2Body* ground = world->CreateBody(&groundDef);
+        b2PolygonShape wall;
+        wall.SetAsBox(15,.5,b2Vec2(0,-.5),0);
+        ground->CreateFixture(&wall,0);
+        wall.SetAsBox(.5,10,b2Vec2(-15.5,10),0);
+        ground->CreateFixture(&wall,0);
+        wall.SetAsBox(.5,10,b2Vec2(15.5,10),0);
+        ground->CreateFixture(&wall,0);
+
+        b2ParticleSystemDef particleDef;
+        particleDef.radius = .05;
+        particleDef.friction = .3;
+        b2ParticleSystem* particles = world->CreateParticleSystem(&particleDef);
+
+        const int columns = 250;
+        const int rows = 40;
+        for (int ii=0; ii<rows; ii++) {
+            const float offset = random.uniform(0,.05);
+            for (int jj=0; jj<columns; jj++) {
+                const b2Vec2 position(-12.5+.1*jj+offset,.5+.1*ii);
+                particles->CreateParticle(position,b2Vec2(0,0));
+            }
+        }
+
+        const int boxCount = 10;
+        for (int kk=0; kk<boxCount; kk++) {
+            b2BodyDef bodyDef;
+            bodyDef.type = b2_dynamicBody;
+            bodyDef.position.Set(-11.25+2.5*kk,7);
+            bodyDef.angle = random.uniform(-.5,.5);
+
+            b2PolygonShape shape;
+            shape.SetAsBox(.5,.5);
+            world->CreateBody(&bodyDef)->CreateFixture(&shape,kk%2 ? .5 : 2);
+        }
+    }
+};
+
+// Long rolling terrain made of a single chain with motorized cars on it.
+class TerrainScene : public Scene {
+public:
+    TerrainScene() : Scene("chain_terrain",900) {}
+
+    void build(b2World* world, Random& random)
+    {
+        const int vertexCount = 2000;
+        const std::vector<b2Vec2> vertices = makeTerrain(random,vertexCount);
+
+        b2BodyDef groundDef;
+        b2Body* ground = world->CreateBody(&groundDef);
+        b2ChainShape chain;
+        chain.CreateChain(&vertices[0],vertexCount);
+        ground->CreateFixture(&chain,0);
+
+        const int carCount = 20;
+        for (int kk=0; kk<carCount; kk++) {
+            const int index = vertexCount/2-carCount*4+kk*8;
+            addCar(world,vertices[index]+b2Vec2(0,2.5));
+        }
+    }
+protected:
+    TerrainScene(const char* name, int stepCount) : Scene(name,stepCount) {}
+
+    // Bumpy height field with one vertex per meter, centered on x=0.
+    static std::vector<b2Vec2> makeTerrain(Random& random, int vertexCount)
+    {
+        std::vector<b2Vec2> vertices(vertexCount);
+        float height = 0;
+        float slope = 0;
+        for (int kk=0; kk<vertexCount; kk++) {
+            slope = b2Clamp(slope+random.uniform(-.1,.1),-.4f,.4f);
+            height += slope;
+            if (height<-10 || height>10) slope = -slope;
+            vertices[kk].Set(kk-vertexCount/2.,height);
+        }
+        return vertices;
+    }
+
+    b2Body* addCar(b2World* world, const b2Vec2 &pos)
+    {
+        b2Body* chassis = addBox(world,pos,1.5,.4);
+
+        b2CircleShape circle;
+        circle.m_radius = .45;
+
+        b2FixtureDef fixtureDef;
+        fixtureDef.shape = &circle;
+        fixtureDef.density = 1;
+        fixtureDef.friction = .9;
+
+        const float offsets[] = {-1.,1.};
+        for (int kk=0; kk<2; kk++) {
+            b2BodyDef bodyDef;
+            bodyDef.type = b2_dynamicBody;
+            bodyDef.position = pos+b2Vec2(offsets[kk],-.65);
+            b2Body* wheel = world->CreateBody(&bodyDef);
+            wheel->CreateFixture(&fixtureDef);
+
+            b2WheelJointDef jointDef;
+            jointDef.Initialize(chassis,wheel,wheel->GetPosition(),b2Vec2(0,1));
+            jointDef.motorSpeed = -20;
+            jointDef.maxMotorTorque = 40;
+            jointDef.enableMotor = true;
+            jointDef.frequencyHz = 4;
+            jointDef.dampingRatio = .7;
+            world->CreateJoint(&jointDef);
+        }
+
+        return chassis;
+    }
+};
+
+// Very long terrain streamed in chunks: only the chunks around the cars are
+// in the world. Every chunk is its own chain fixture with ghost vertices on
+// its neighbours, so the cars cross the seams smoothly.
+class StreamedTerrainScene : public TerrainScene {
+public:
+    StreamedTerrainScene() : TerrainScene("chain_streamed",900), ground(NULL) {}
+
+    void build(b2World* world, Random& random)
+    {
+        vertices = makeTerrain(random,vertexCount);
+        chunks.assign((vertexCount-1+chunkEdges-1)/chunkEdges,static_cast<b2Fixture*>(NULL));
+
+        b2BodyDef groundDef;
+        ground = world->CreateBody(&groundDef);
+
+        cars.clear();
+        const int carCount = 20;
+        for (int kk=0; kk<carCount; kk++) {
+            const int index = 2*chunkEdges+kk*8;
+            cars.push_back(addCar(world,vertices[index]+b2Vec2(0,2.5)));
+        }
+        stream();
+    }
+
+    void preStep(b2World* world, int step)
+    {
+        B2_NOT_USED(world);
+        B2_NOT_USED(step);
+        stream();
+    }
+
+    void teardown()
+    {
+        ground = NULL;
+        cars.clear();
+        chunks.clear();
+        vertices.clear();
+    }
+protected:
+    static const int vertexCount = 50000;
+    static const int chunkEdges = 256;
+
+    // Create the chunks within a margin of the cars and destroy the others.
+    void stream()
+    {
+        float minX = b2_maxFloat;
+        float maxX = -b2_maxFloat;
+        for (std::vector<b2Body*>::const_iterator iter=cars.begin(); iter!=cars.end(); iter++) {
+            minX = std::min(minX,(*iter)->GetPosition().x);
+            maxX = std::max(maxX,(*iter)->GetPosition().x);
+        }
+
+        const float margin = 64;
+        for (int kk=0; kk<static_cast<int>(chunks.size()); kk++) {
+            const int first = kk*chunkEdges;
+            const int last = std::min(first+chunkEdges,vertexCount-1);
+            const bool needed = vertices[last].x>=minX-margin && vertices[first].x<=maxX+margin;
+            if (needed && !chunks[kk]) {
+                b2ChainShape chain;
+                chain.CreateChain(&vertices[first],last-first+1);
+                if (first>0) chain.SetPrevVertex(vertices[first-1]);
+                if (last<vertexCount-1) chain.SetNextVertex(vertices[last+1]);
+                chunks[kk] = ground->CreateFixture(&chain,0);
+            } else if (!needed && chunks[kk]) {
+                ground->DestroyFixture(chunks[kk]);
+                chunks[kk] = NULL;
+            }
+        }
+    }
+
+    std::vector<b2Vec2> vertices;
+    std::vector<b2Fixture*> chunks;
+    std::vector<b2Body*> cars;
+    b2Body* ground;
+};
+
+// Level decorated with thousands of static blocks held by a single compound
+// fixture, with multi-piece compound crates falling on it.
+class CompoundScene : public Scene {
+public:
+    CompoundScene() : Scene("compound",600) {}
+
+    void build(b2World* world, Random& random)
+    {
+        b2BodyDef groundDef;
+        b2Body* ground = world->CreateBody(&groundDef);
+
+        b2CompoundShape level;
+        b2PolygonShape block;
+        for (int ii=0; ii<400; ii++) {
+            const float x = -40+.2*ii;
+            block.SetAsBox(.1,random.uniform(.2,.4),b2Vec2(x,0),0);
+            level.AddChild(block);
+        }
+        for (int ii=0; ii<2; ii++) {
+            const float side = ii ? 1 : -1;
+            for (int jj=0; jj<200; jj++) {
+                block.SetAsBox(.15,.05,b2Vec2(40.15*side,.1*jj),0);
+                level.AddChild(block);
+            }
+        }
+        for (int ii=0; ii<12; ii++) {
+            for (int jj=0; jj<40; jj++) {
+                const b2Vec2 center(-38+1.9*jj+(ii%2)*.95,4+1.5*ii);
+                block.SetAsBox(.08,.08,center,random.uniform(0,b2_pi));
+                level.AddChild(block);
+            }
+        }
+        ground->CreateFixture(&level,0);
+
+        const int crateCount = 300;
+        for (int ii=0; ii<crateCount; ii++) {
+            b2BodyDef bodyDef;
+            bodyDef.type = b2_dynamicBody;
+            bodyDef.position.Set(random.uniform(-37,37),24+.5*ii);
+            bodyDef.angle = random.uniform(0,b2_pi);
+
+            // L-shaped crate built of small planks.
+            b2CompoundShape crate;
+            for (int jj=0; jj<4; jj++) {
+                block.SetAsBox(.2,.1,b2Vec2(.4*jj,0),0);
+                crate.AddChild(block);
+                block.SetAsBox(.1,.2,b2Vec2(0,.3+.4*jj),0);
+                crate.AddChild(block);
+            }
+
+            b2FixtureDef fixtureDef;
+            fixtureDef.shape = &crate;
+            fixtureDef.density = 1;
+            fixtureDef.friction = .4;
+            world->CreateBody(&bodyDef)->CreateFixture(&fixtureDef);
+        }
+    }
+};
+
+// Many independent b2Rope, stepped next to an otherwise empty world.
+class RopesScene : public Scene {
+public:
+    RopesScene() : Scene("ropes",600) {}
+    ~RopesScene() { teardown(); }
+
+    void build(b2World* world, Random& random)
+    {
+        B2_NOT_USED(world);
+        teardown();
+
+        const int ropeCount = 100;
+        const int vertexCount = 40;
+        std::vector<b2Vec2> vertices(vertexCount);
+        std::vector<float32> masses(vertexCount);
+        for (int kk=0; kk<ropeCount; kk++) {
+            const b2Vec2 anchor(kk-ropeCount/2.,20);
+            const float angle = random.uniform(-.5,.5);
+            for (int ll=0; ll<vertexCount; ll++) {
+                vertices[ll] = anchor+.25*ll*b2Vec2(cos(angle),sin(angle));
+                masses[ll] = 1;
+            }
+            masses[0] = 0;
+
+            b2RopeDef def;
+            def.vertices = &vertices[0];
+            def.count = vertexCount;
+            def.masses = &masses[0];
+            def.gravity = benchmarkGravity;
+            def.damping = .1;
+            def.k2 = 1;
+            def.k3 = .5;
+
+            b2Rope* rope = new b2Rope;
+            rope->Initialize(&def);
+            ropes.push_back(rope);
+        }
+    }
+
+    void stepExtra(float dt)
+    {
+        for (Ropes::const_iterator iter=ropes.begin(); iter!=ropes.end(); iter++) {
+            (*iter)->Step(dt,8);
+        }
+    }
+
+    void teardown()
+    {
+        for (Ropes::const_iterator iter=ropes.begin(); iter!=ropes.end(); iter++) {
+            delete *iter;
+        }
+        ropes.clear();
+    }
+protected:
+    typedef std::vector<b2Rope*> Ropes;
+    Ropes ropes;
+};
+
+// The same ropes as RopesScene, batched in one b2RopeSystem.
+class RopeSystemScene : public Scene {
+public:
+    RopeSystemScene() : Scene("rope_system",600) {}
+
+    void build(b2World* world, Random& random)
+    {
+        ropes.Clear();
+        ropes.SetThreadPool(world->GetThreadPool());
+
+        const int ropeCount = 100;
+        const int vertexCount = 40;
+        std::vector<b2Vec2> vertices(vertexCount);
+        std::vector<float32> masses(vertexCount);
+        for (int kk=0; kk<ropeCount; kk++) {
+            const b2Vec2 anchor(kk-ropeCount/2.,20);
+            const float angle = random.uniform(-.5,.5);
+            for (int ll=0; ll<vertexCount; ll++) {
+                vertices[ll] = anchor+.25*ll*b2Vec2(cos(angle),sin(angle));
+                masses[ll] = 1;
+            }
+            masses[0] = 0;
+
+            b2RopeDef def;
+            def.vertices = &vertices[0];
+            def.count = vertexCount;
+            def.masses = &masses[0];
+            def.gravity = benchmarkGravity;
+            def.damping = .1;
+            def.k2 = 1;
+            def.k3 = .5;
+            ropes.CreateRope(&def);
+        }
+    }
+
+    void stepExtra(float dt)
+    {
+        ropes.Step(dt,8);
+    }
+
+    void teardown()
+    {
+        ropes.Clear();
+        ropes.SetThreadPool(NULL);
+    }
+protected:
+    b2RopeSystem ropes;
+};
+
+// Jointed characters falling on stairs.
+class RagdollsScene : public Scene {
+public:
+    RagdollsScene() : Scene("ragdolls",900) {}
+
+    void build(b2World* world, Random& random)
+    {
+        b2Body* ground = addGround(world,60);
+
+        for (int kk=0; kk<20; kk++) {
+            b2PolygonShape step;
+            step.SetAsBox(1.5,.25,b2Vec2(-30+3*kk,10-.5*kk),0);
+            ground->CreateFixture(&step,0);
+        }
+
+        const int ragdollCount = 40;
+        for (int kk=0; kk<ragdollCount; kk++) {
+            addRagdoll(world,b2Vec2(-30+1.5*kk+random.uniform(-.2,.2),15+3*(kk%4)));
+        }
+    }
+protected:
+    b2Body* addLimb(b2World* world, const b2Vec2 &pos, float halfWidth, float halfHeight)
+    {
+        b2BodyDef bodyDef;
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.position = pos;
+
+        b2PolygonShape shape;
+        shape.SetAsBox(halfWidth,halfHeight);
+
+        b2FixtureDef fixtureDef;
+        fixtureDef.shape = &shape;
+        fixtureDef.density = 1;
+        fixtureDef.friction = .4;
+        fixtureDef.filter.groupIndex = -1;
+
+        b2Body* body = world->CreateBody(&bodyDef);
+        body->CreateFixture(&fixtureDef);
+        return body;
+    }
+
+    void addHinge(b2World* world, b2Body* a, b2Body* b, const b2Vec2 &pos, float lower, float upper)
+    {
+        b2RevoluteJointDef jointDef;
+        jointDef.Initialize(a,b,pos);
+        jointDef.enableLimit = true;
+        jointDef.lowerAngle = lower;
+        jointDef.upperAngle = upper;
+        world->CreateJoint(&jointDef);
+    }
+
+    void addRagdoll(b2World* world, const b2Vec2 &pos)
+    {
+        b2Body* torso = addLimb(world,pos,.25,.6);
+
+        b2BodyDef headDef;
+        headDef.type = b2_dynamicBody;
+        headDef.position = pos+b2Vec2(0,.95);
+        b2Body* head = world->CreateBody(&headDef);
+        b2CircleShape circle;
+        circle.m_radius = .3;
+        b2FixtureDef headFixture;
+        headFixture.shape = &circle;
+        headFixture.density = 1;
+        headFixture.filter.groupIndex = -1;
+        head->CreateFixture(&headFixture);
+        addHinge(world,torso,head,pos+b2Vec2(0,.65),-.5,.5);
+
+        const float sides[] = {-1.,1.};
+        for (int kk=0; kk<2; kk++) {
+            const float side = sides[kk];
+
+            b2Body* upperArm = addLimb(world,pos+b2Vec2(.45*side,.3),.1,.3);
+            addHinge(world,torso,upperArm,pos+b2Vec2(.3*side,.55),-2,2);
+            b2Body* lowerArm = addLimb(world,pos+b2Vec2(.45*side,-.3),.1,.3);
+            addHinge(world,upperArm,lowerArm,pos+b2Vec2(.45*side,0),-2,0);
+
+            b2Body* upperLeg = addLimb(world,pos+b2Vec2(.15*side,-.95),.12,.35);
+            addHinge(world,torso,upperLeg,pos+b2Vec2(.15*side,-.6),-1.5,.5);
+            b2Body* lowerLeg = addLimb(world,pos+b2Vec2(.15*side,-1.65),.1,.35);
+            addHinge(world,upperLeg,lowerLeg,pos+b2Vec2(.15*side,-1.3),0,2);
+        }
+    }
+};
+
+// Continuous collision stress: fast bullets shot into a wall of boxes.
+class BulletsScene : public Scene {
+public:
+    BulletsScene() : Scene("bullets",600), random(benchmarkSeed) {}
+
+    void build(b2World* world, Random& random)
+    {
+        B2_NOT_USED(random);
+        this->random = Random(benchmarkSeed+1);
+        addGround(world,60);
+
+        for (int ii=0; ii<10; ii++) {
+            for (int jj=0; jj<10; jj++) {
+                addBox(world,b2Vec2(10+1.05*jj,.5+1.02*ii),.5,.5);
+            }
+        }
+    }
+
+    void preStep(b2World* world, int step)
+    {
+        if (step%5) return;
+
+        b2BodyDef bodyDef;
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.bullet = true;
+        bodyDef.position.Set(-30,random.uniform(.5,10));
+        bodyDef.linearVelocity.Set(150,random.uniform(-2,2));
+
+        b2PolygonShape shape;
+        shape.SetAsBox(.1,.1);
+
+        b2Body* bullet = world->CreateBody(&bodyDef);
+        bullet->CreateFixture(&shape,20);
+    }
+
+    // Bodies under the ground went through it.
+    int countEscaped(const b2World* world) const
+    {
+        int count = 0;
+        for (const b2Body* body=world->GetBodyList(); body; body=body->GetNext()) {
+            const b2Vec2 position = body->GetPosition();
+            if (position.y<-1 && b2Abs(position.x)<60) count++;
+        }
+        return count;
+    }
+protected:
+    Random random;
+};
+
+// Headless copy of the walker built by robot/world.cpp World::addRobot,
+// with the default RobotDef.
+class RobotScene : public Scene {
+public:
+    RobotScene() : Scene("robot",1200,6,2), main(NULL), engine(NULL), running(false) {}
+
+    void build(b2World* world, Random& random)
+    {
+        B2_NOT_USED(random);
+        running = false;
+
+        b2BodyDef groundDef;
+        groundDef.position.Set(0,-2);
+        b2PolygonShape groundShape;
+        groundShape.SetAsBox(100,2);
+        b2Body* ground = world->CreateBody(&groundDef);
+        ground->CreateFixture(&groundShape,0);
+
+        const b2Vec2 center = b2Vec2(-30,0)+b2Vec2(0,(legHeight+footHeight)*1.1);
+
+        {
+            b2BodyDef bodyDef;
+            bodyDef.type = b2_dynamicBody;
+            bodyDef.position = center;
+
+            b2Vec2 points[] = {b2Vec2(mainLength/2.,0),b2Vec2(0,mainHeight/2.),b2Vec2(-mainLength/2.,0),b2Vec2(0,-mainHeight/2.)};
+            b2PolygonShape shape;
+            shape.Set(points,4);
+
+            b2FixtureDef fixtureDef;
+            fixtureDef.shape = &shape;
+            fixtureDef.density = 1;
+            fixtureDef.friction = 0;
+            fixtureDef.restitution = 0;
+
+            main = world->CreateBody(&bodyDef);
+            main->CreateFixture(&fixtureDef);
+        }
+        b2Joint* fix0 = addHingeJoint(world,main,ground,center-b2Vec2(mainLength/3.,0));
+        b2Joint* fix1 = addHingeJoint(world,main,ground,center+b2Vec2(mainLength/3.,0));
+
+        b2Body* motor = NULL;
+        {
+            b2BodyDef bodyDef;
+            bodyDef.type = b2_dynamicBody;
+            bodyDef.position = center;
+
+            b2CircleShape shape;
+            shape.m_radius = motorRadius;
+
+            b2FixtureDef fixtureDef;
+            fixtureDef.shape = &shape;
+            fixtureDef.density = 1;
+            fixtureDef.friction = .3;
+            fixtureDef.restitution = .6;
+
+            motor = world->CreateBody(&bodyDef);
+            motor->CreateFixture(&fixtureDef);
+        }
+        engine = static_cast<b2RevoluteJoint*>(addHingeJoint(world,motor,main,motor->GetWorldCenter(),10000,0));
+
+        for (int kk=0; kk<legNumber; kk++) {
+            rotateEngine(world,kk*2*b2_pi/legNumber);
+            buildLegPair(world,center,motor,kk);
+        }
+
+        world->DestroyJoint(fix0);
+        world->DestroyJoint(fix1);
+    }
+
+    void preStep(b2World* world, int step)
+    {
+        B2_NOT_USED(world);
+        if (running) return;
+        if (step>=300 || main->GetLinearVelocity().Length()<1e-1) {
+            engine->SetMotorSpeed(b2_pi);
+            running = true;
+        }
+    }
+protected:
+    b2Joint* addDistanceJoint(b2World* world, b2Body* a, b2Body* b, const b2Vec2 &ca, const b2Vec2 &cb)
+    {
+        b2DistanceJointDef jointDef;
+        jointDef.Initialize(a,b,ca,cb);
+        return world->CreateJoint(&jointDef);
+    }
+
+    b2Joint* addHingeJoint(b2World* world, b2Body* a, b2Body* b, const b2Vec2 &pos, float torque=-1, float speed=0)
+    {
+        b2RevoluteJointDef jointDef;
+        jointDef.Initialize(a,b,pos);
+        if (torque>=0) {
+            jointDef.enableMotor = true;
+            jointDef.maxMotorTorque = torque;
+            jointDef.motorSpeed = speed;
+        }
+        return world->CreateJoint(&jointDef);
+    }
+
+    b2Body* addLegPart(b2World* world, const b2Vec2 &pos, const b2Vec2* points, float friction, int category)
+    {
+        b2BodyDef bodyDef;
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.position = pos;
+
+        b2PolygonShape shape;
+        shape.Set(points,3);
+
+        b2FixtureDef fixtureDef;
+        fixtureDef.shape = &shape;
+        fixtureDef.density = .2;
+        fixtureDef.friction = friction;
+        fixtureDef.restitution = 0;
+        fixtureDef.filter.categoryBits = 1 << (category+1);
+        fixtureDef.filter.maskBits = 1;
+
+        b2Body* body = world->CreateBody(&bodyDef);
+        body->CreateFixture(&fixtureDef);
+        return body;
+    }
+
+    void buildLeg(b2World* world, const b2Vec2 &base, const b2Vec2 &ex, const b2Vec2 &ey, b2Body* motor, int category)
+    {
+        b2Vec2 upperPoints[] = {b2Vec2(0,0),b2Vec2(0,0),b2Vec2(0,0)};
+        if (ex.x>0) {
+            upperPoints[1] = legWidth*ex;
+            upperPoints[2] = (motorRadius+upperExtension)*ey;
+        } else {
+            upperPoints[2] = legWidth*ex;
+            upperPoints[1] = (motorRadius+upperExtension)*ey;
+        }
+        b2Body* upperPart = addLegPart(world,base,upperPoints,0,category);
+        addHingeJoint(world,upperPart,main,base);
+        addDistanceJoint(world,motor,upperPart,motor->GetWorldCenter()-b2Vec2(0,motorRadius),base+(motorRadius+upperExtension)*ey);
+
+        b2Vec2 lowerPoints[] = {b2Vec2(0,0),b2Vec2(0,0),b2Vec2(0,0)};
+        if (ex.x>0) {
+            lowerPoints[1] = -footHeight*ey;
+            lowerPoints[2] = legWidth*ex;
+        } else {
+            lowerPoints[2] = -footHeight*ey;
+            lowerPoints[1] = legWidth*ex;
+        }
+        b2Body* lowerPart = addLegPart(world,base-legHeight*ey,lowerPoints,1,category);
+        addDistanceJoint(world,upperPart,lowerPart,base,base-legHeight*ey);
+        addDistanceJoint(world,upperPart,lowerPart,base+legWidth*ex,base+legWidth*ex-legHeight*ey);
+        addDistanceJoint(world,motor,lowerPart,motor->GetWorldCenter()-b2Vec2(0,motorRadius),base-legHeight*ey);
+    }
+
+    void buildLegPair(b2World* world, const b2Vec2 &center, b2Body* motor, int category)
+    {
+        {   // left leg
+            const b2Vec2 ex(-cos(legAngle),sin(legAngle));
+            const b2Vec2 ey(sin(legAngle),cos(legAngle));
+            buildLeg(world,center-b2Vec2(mainLength/2.,0),ex,ey,motor,category);
+        }
+
+        {   // right leg
+            const b2Vec2 ex(cos(legAngle),sin(legAngle));
+            const b2Vec2 ey(-sin(legAngle),cos(legAngle));
+            buildLeg(world,center+b2Vec2(mainLength/2.,0),ex,ey,motor,category);
+        }
+    }
+
+    // Same servo loop as World::rotateEngine, without the exception.
+    void rotateEngine(b2World* world, float angle)
+    {
+        const float tau = 2;
+        const float tol = 1e-2;
+        float time = 0;
+        while (time<20*tau) {
+            const float error = engine->GetJointAngle()-angle;
+            if (fabs(error)<tol) break;
+            engine->SetMotorSpeed(-error/tau);
+            world->Step(benchmarkTimeStep,velocityIterations,positionIterations);
+            time += benchmarkTimeStep;
+        }
+    }
+
+    static const float motorRadius;
+    static const float mainLength;
+    static const float mainHeight;
+    static const float upperExtension;
+    static const float legWidth;
+    static const float legHeight;
+    static const float legAngle;
+    static const float footHeight;
+    static const int legNumber = 4;
+
+    b2Body* main;
+    b2RevoluteJoint* engine;
+    bool running;
+};
+
+// RobotDef defaults from robot/robot.cpp.
+const float RobotScene::motorRadius = 1.5;
+const float RobotScene::mainLength = 10.;
+const float RobotScene::mainHeight = 2;
+const float RobotScene::upperExtension = 3;
+const float RobotScene::legWidth = 3;
+const float RobotScene::legHeight = 5;
+const float RobotScene::legAngle = 15/180.*b2_pi;
+const float RobotScene::footHeight = 5;
+
+// Hanging chains of revolute joints next to a net of distance joints pinned
+// by its top row. Joint solving dominates.
+class JointsScene : public Scene {
+public:
+    JointsScene() : Scene("joints",600) {}
+
+    void build(b2World* world, Random& random)
+    {
+        B2_NOT_USED(random);
+
+        b2BodyDef groundDef;
+        b2Body* ground = world->CreateBody(&groundDef);
+
+        b2PolygonShape link;
+        link.SetAsBox(.25,.05);
+        b2FixtureDef linkDef;
+        linkDef.shape = &link;
+        linkDef.density = 1;
+        linkDef.filter.groupIndex = -1;
+
+        const int chainCount = 20;
+        const int linkCount = 100;
+        for (int ii=0; ii<chainCount; ii++) {
+            b2Body* previous = ground;
+            for (int jj=0; jj<linkCount; jj++) {
+                b2BodyDef bodyDef;
+                bodyDef.type = b2_dynamicBody;
+                bodyDef.position.Set(60*ii+.5*jj+.25,20);
+                b2Body* body = world->CreateBody(&bodyDef);
+                body->CreateFixture(&linkDef);
+
+                b2RevoluteJointDef jointDef;
+                jointDef.Initialize(previous,body,b2Vec2(60*ii+.5*jj,20));
+                world->CreateJoint(&jointDef);
+                previous = body;
+            }
+        }
+
+        b2CircleShape knot;
+        knot.m_radius = .05;
+        b2FixtureDef knotDef;
+        knotDef.shape = &knot;
+        knotDef.density = 1;
+        knotDef.filter.groupIndex = -1;
+
+        const int netSize = 40;
+        std::vector<b2Body*> knots(netSize*netSize);
+        for (int ii=0; ii<netSize; ii++) {
+            for (int jj=0; jj<netSize; jj++) {
+                b2BodyDef bodyDef;
+                bodyDef.type = ii==netSize-1 ? b2_staticBody : b2_dynamicBody;
+                bodyDef.position.Set(-50+.5*jj,.5*ii);
+                knots[ii*netSize+jj] = world->CreateBody(&bodyDef);
+                knots[ii*netSize+jj]->CreateFixture(&knotDef);
+            }
+        }
+        for (int ii=0; ii<netSize; ii++) {
+            for (int jj=0; jj<netSize; jj++) {
+                b2Body* knot = knots[ii*netSize+jj];
+                b2DistanceJointDef jointDef;
+                if (jj+1<netSize) {
+                    b2Body* other = knots[ii*netSize+jj+1];
+                    jointDef.Initialize(knot,other,knot->GetPosition(),other->GetPosition());
+                    world->CreateJoint(&jointDef);
+                }
+                if (ii+1<netSize) {
+                    b2Body* other = knots[(ii+1)*netSize+jj];
+                    jointDef.Initialize(knot,other,knot->GetPosition(),other->GetPosition());
+                    world->CreateJoint(&jointDef);
+                }
+            }
+        }
+    }
+};
+
+// Headless volley court from volley/gamedata.cpp: static court, kinematic
+// players running and jumping on a script, and the bouncy ball. The game
+// steps twice per frame with half the time step, the halfstep variant does
+// the same.
+class VolleyScene : public Scene {
+public:
+    VolleyScene(const char* name, int split) : Scene(name,1800*split,6,2), ball(NULL) { timeStep /= split; }
+
+    void build(b2World* world, Random& random)
+    {
+        B2_NOT_USED(random);
+        time = 0;
+
+        addStaticBox(world,b2Vec2(-courtWidth/4.-.5,-.5),courtWidth/2.+1,1);
+        addStaticBox(world,b2Vec2(courtWidth/4.+.5,-.5),courtWidth/2.+1,1);
+        addStaticBox(world,b2Vec2(0,courtHeight+.5),courtWidth+2,1);
+        addStaticBox(world,b2Vec2(courtWidth/2.+.5,courtHeight/2.),1,courtHeight+2);
+        addStaticBox(world,b2Vec2(-courtWidth/2.-.5,courtHeight/2.),1,courtHeight+2);
+        addStaticBall(world,b2Vec2(-courtWidth/2.,courtHeight),.6);
+        addStaticBall(world,b2Vec2(courtWidth/2.,courtHeight),.6);
+        addStaticBox(world,b2Vec2(0,netHeight/2.),netWidth,netHeight);
+
+        {
+            b2BodyDef bodyDef;
+            bodyDef.type = b2_dynamicBody;
+            bodyDef.position.Set(-courtWidth/4.,6);
+
+            b2CircleShape shape;
+            shape.m_radius = .75;
+
+            b2FixtureDef fixtureDef;
+            fixtureDef.shape = &shape;
+            fixtureDef.density = 1;
+            fixtureDef.friction = .6;
+            fixtureDef.restitution = .8;
+
+            ball = world->CreateBody(&bodyDef);
+            ball->SetLinearDamping(.2);
+            ball->CreateFixture(&fixtureDef);
+        }
+
+        for (int kk=0; kk<2; kk++) {
+            b2BodyDef bodyDef;
+            bodyDef.type = b2_kinematicBody;
+            bodyDef.position.Set((kk ? 1 : -1)*courtWidth/4.,0);
+
+            const int nverts = 8;
+            b2Vec2 verts[nverts];
+            for (int ll=0; ll<nverts; ll++) {
+                float angle = b2_pi*ll/(nverts-1);
+                verts[ll] = b2Vec2(playerRadius*cos(angle),playerRadius*sin(angle));
+            }
+            b2PolygonShape shape;
+            shape.Set(verts,nverts);
+
+            players[kk] = world->CreateBody(&bodyDef);
+            players[kk]->CreateFixture(&shape,1);
+            jumpTimes[kk] = -1;
+        }
+    }
+
+    // Same player kinematics as volley/gamehelper.cpp, driven by a fixed
+    // script instead of the keyboard.
+    void preStep(b2World* world, int step)
+    {
+        B2_NOT_USED(world);
+        time = step*timeStep;
+
+        for (int kk=0; kk<2; kk++) {
+            b2Body* player = players[kk];
+            const float xmin = kk ? netWidth/2.+playerRadius : -courtWidth/2.+playerRadius;
+            const float xmax = kk ? courtWidth/2.-playerRadius : -netWidth/2.-playerRadius;
+
+            float vx = sin(.9*time+kk) > 0 ? playerSpeed : -playerSpeed;
+            float vy = player->GetLinearVelocity().y;
+
+            if (jumpTimes[kk]<0 && fmod(time+kk,2.5f)<timeStep) jumpTimes[kk] = time;
+            if (jumpTimes[kk]>=0) {
+                if (time>jumpTimes[kk] && player->GetPosition().y<.05) {
+                    player->SetTransform(b2Vec2(player->GetPosition().x,0),0);
+                    vy = 0;
+                    jumpTimes[kk] = -1;
+                } else {
+                    vy = jumpFactor*(jumpSpeed-gravity*(time-jumpTimes[kk]));
+                }
+            }
+
+            const float x = player->GetPosition().x;
+            if ((x<=xmin && vx<0) || (x>=xmax && vx>0)) vx = 0;
+            player->SetLinearVelocity(b2Vec2(vx,vy));
+        }
+
+        // Serve again when the ball rests on the ground.
+        if (ball->GetPosition().y<1 && ball->GetLinearVelocity().Length()<.5) {
+            const float side = ball->GetPosition().x<0 ? -1 : 1;
+            ball->SetTransform(b2Vec2(side*courtWidth/4.,6),0);
+            ball->SetLinearVelocity(b2Vec2(0,0));
+            ball->SetAwake(true);
+        }
+    }
+
+    // The ball can only leave the court through a wall.
+    int countEscaped(const b2World* world) const
+    {
+        B2_NOT_USED(world);
+        const b2Vec2 position = ball->GetPosition();
+        return b2Abs(position.x)>courtWidth/2. || position.y<0 || position.y>courtHeight ? 1 : 0;
+    }
+protected:
+    void addStaticBox(b2World* world, const b2Vec2 &pos, float width, float height)
+    {
+        b2BodyDef bodyDef;
+        bodyDef.position = pos;
+        b2PolygonShape shape;
+        shape.SetAsBox(width/2.,height/2.);
+        world->CreateBody(&bodyDef)->CreateFixture(&shape,0);
+    }
+
+    void addStaticBall(b2World* world, const b2Vec2 &pos, float radius)
+    {
+        b2BodyDef bodyDef;
+        bodyDef.position = pos;
+        b2CircleShape shape;
+        shape.m_radius = radius;
+        world->CreateBody(&bodyDef)->CreateFixture(&shape,0);
+    }
+
+    static const float courtWidth;
+    static const float courtHeight;
+    static const float netHeight;
+    static const float netWidth;
+    static const float playerRadius;
+    static const float playerSpeed;
+    static const float jumpSpeed;
+    static const float jumpFactor;
+    static const float gravity;
+
+    float time;
+    b2Body* ball;
+    b2Body* players[2];
+    float jumpTimes[2];
+};
+
+// GameManager constants from volley/gamemanager.cpp.
+const float VolleyScene::courtWidth = 20;
+const float VolleyScene::courtHeight = 12;
+const float VolleyScene::netHeight = 3;
+const float VolleyScene::netWidth = .25;
+const float VolleyScene::playerRadius = 1.2;
+const float VolleyScene::playerSpeed = 8;
+const float VolleyScene::jumpSpeed = 5;
+const float VolleyScene::jumpFactor = 3.5;
+const float VolleyScene::gravity = 10;
+
+Scenes createScenes()
+{
+    Scenes scenes;
+    scenes.push_back(new PyramidScene);
+    scenes.push_back(new TumblerScene);
+    scenes.push_back(new CirclePileScene);
+    scenes.push_back(new ParticlePileScene);
+    scenes.push_back(new TerrainScene);
+    scenes.push_back(new StreamedTerrainScene);
+    scenes.push_back(new CompoundScene);
+    scenes.push_back(new RopesScene);
+    scenes.push_back(new RopeSystemScene);
+    scenes.push_back(new RagdollsScene);
+    scenes.push_back(new BulletsScene);
+    scenes.push_back(new RobotScene);
+    scenes.push_back(new JointsScene);
+    scenes.push_back(new VolleyScene("volley",1));
+    scenes.push_back(new VolleyScene("volley_halfstep",2));
+    return scenes;
+}
+
+void destroyScenes(Scenes &scenes)
+{
+    for (Scenes::const_iterator iter=scenes.begin(); iter!=scenes.end(); iter++) {
+        delete *iter;
+    }
+    scenes.clear();
+}
@@ -0,0 +1,67 @@
+#ifndef __SCENES_H__
+#define __SCENES_H__
+
+#include <Box2D/Box2D.h>
+#include <vector>
+
+// Every scene is built from this seed so that two builds of the engine
+// simulate exactly the same bodies.
+static const uint32 benchmarkSeed = 0x2012cafe;
+
+// World settings shared by all the scenes.
+static const float benchmarkTimeStep = 1./60.;
+static const b2Vec2 benchmarkGravity(0,-10);
+
+// Small linear congruential generator. We don't use rand() because its
+// sequence depends on the C library.
+class Random {
+public:
+    Random(uint32 seed=benchmarkSeed);
+    uint32 next();
+    float uniform(float min, float max);
+protected:
+    uint32 state;
+};
+
+class Scene {
+public:
+    Scene(const char* name, int stepCount, int velocityIterations=8, int positionIterations=3);
+    virtual ~Scene();
+
+    const char* getName() const;
+    int getStepCount() const;
+    int getVelocityIterations() const;
+    int getPositionIterations() const;
+    float getTimeStep() const;
+
+    // Populate an empty world. This is not timed.
+    virtual void build(b2World* world, Random& random) = 0;
+
+    // Called before every timed world step. Scenes spawning bodies or
+    // driving motors do it here.
+    virtual void preStep(b2World* world, int step);
+
+    // Work stepped next to the world (ropes for instance). This is timed.
+    virtual void stepExtra(float dt);
+
+    // Count the bodies that tunneled out of the scene, checked after the
+    // last step.
+    virtual int countEscaped(const b2World* world) const;
+
+    // Release anything not owned by the world.
+    virtual void teardown();
+protected:
+    const char* name;
+    int stepCount;
+    int velocityIterations;
+    int positionIterations;
+    float timeStep;
+};
+
+typedef std::vector<Scene*> Scenes;
+
+// Canonical scene set, in reporting order. The caller owns the scenes.
+Scenes createScenes();
+void destroyScenes(Scenes &scenes);
+
+#endif
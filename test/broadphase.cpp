@@ -0,0 +1,68 @@
+// Broad-phase regression tests.
+
+#include "check.h"
+
+#include <Box2D/Box2D.h>
+
+static b2AABB makeAABB(float32 x0, float32 y0, float32 x1, float32 y1)
+{
+    b2AABB aabb;
+    aabb.lowerBound.Set(x0, y0);
+    aabb.upperBound.Set(x1, y1);
+    return aabb;
+}
+
+struct PairCounter {
+    PairCounter(b2BroadPhase* broadPhase) : broadPhase(broadPhase), count(0) {}
+
+    void AddPair(void*, void*) { ++count; }
+
+    b2BroadPhase* broadPhase;
+    int count;
+};
+
+// An idle proxy shrinks its margin. The displacement prediction must not push
+// its fat AABB past the old one without buffering the move, otherwise a proxy
+// sitting just outside the old fat AABB is never paired with it.
+static void testIdleShrinkKeepsPairs()
+{
+    b2BroadPhase broadPhase;
+    broadPhase.SetAdaptiveMargins(true);
+
+    int dummy;
+    const b2AABB idle = makeAABB(0.0f, 0.0f, 1.0f, 1.0f);
+    const int32 proxyA = broadPhase.CreateProxy(idle, &dummy);
+    const b2AABB oldFat = broadPhase.GetFatAABB(proxyA);
+
+    // Just outside the old fat AABB of A.
+    const float32 x = oldFat.upperBound.x + b2_aabbExtension + 0.01f;
+    const int32 proxyB = broadPhase.CreateProxy(makeAABB(x, 0.0f, x + 1.0f, 1.0f), &dummy);
+    (void)proxyB;
+
+    PairCounter counter(&broadPhase);
+    broadPhase.UpdatePairs(&counter);
+    CHECK(counter.count == 0);
+
+    // A stays in place with a small displacement until its margin shrinks.
+    const b2Vec2 displacement(0.1f, 0.0f);
+    for (int i = 0; i < b2_aabbIdleMoves; ++i) {
+        broadPhase.MoveProxy(proxyA, idle, displacement);
+        broadPhase.UpdatePairs(&counter);
+    }
+
+    const b2AABB newFat = broadPhase.GetFatAABB(proxyA);
+    CHECK(oldFat.Contains(newFat));
+
+    // A moves into B. It leaves the old fat AABB but stays inside the one the
+    // unclipped prediction would give.
+    const b2AABB moved = makeAABB(x - 0.9f, 0.0f, x + 0.02f, 1.0f);
+    broadPhase.MoveProxy(proxyA, moved, displacement);
+    broadPhase.UpdatePairs(&counter);
+    CHECK(counter.count == 1);
+}
+
+int main()
+{
+    testIdleShrinkKeepsPairs();
+    return checkFailures();
+}
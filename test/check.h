@@ -0,0 +1,24 @@
+#ifndef __CHECK_H__
+#define __CHECK_H__
+
+#include <cstdio>
+
+// Minimal checks for the regression tests: a failed check prints its location
+// and the test returns checkFailures() as its exit status.
+static int checkFailureCount = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++checkFailureCount; \
+        } \
+    } while (0)
+
+static inline int checkFailures()
+{
+    if (checkFailureCount == 0) printf("ok\n");
+    return checkFailureCount == 0 ? 0 : 1;
+}
+
+#endif
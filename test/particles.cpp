@@ -0,0 +1,67 @@
+// Particle and fixture contact regression tests.
+
+#include "check.h"
+
+#include <Box2D/Box2D.h>
+
+static const int32 edgeCount = 64;
+
+// Drops a particle over the children 0 and 40 of the ground shape and returns
+// the lowest height they reach. Child 40 is in the second group of chain edges.
+static float32 dropParticles(const b2Shape& groundShape)
+{
+    b2World world(b2Vec2(0.0f, -10.0f), true);
+
+    b2BodyDef groundDef;
+    b2Body* ground = world.CreateBody(&groundDef);
+    ground->CreateFixture(&groundShape, 0.0f);
+
+    b2ParticleSystemDef particleDef;
+    b2ParticleSystem* particles = world.CreateParticleSystem(&particleDef);
+    particles->CreateParticle(b2Vec2(-edgeCount / 2 + 0.5f, 0.5f), b2Vec2(0.0f, 0.0f));
+    particles->CreateParticle(b2Vec2(-edgeCount / 2 + 40.5f, 0.5f), b2Vec2(0.0f, 0.0f));
+
+    float32 lowest = b2_maxFloat;
+    for (int32 i = 0; i < 120; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+        for (int32 j = 0; j < particles->GetParticleCount(); ++j)
+        {
+            lowest = b2Min(lowest, particles->GetPosition(j).y);
+        }
+    }
+    return lowest;
+}
+
+static void testParticlesRestOnChain()
+{
+    b2Vec2 vertices[edgeCount + 1];
+    for (int32 i = 0; i <= edgeCount; ++i)
+    {
+        vertices[i].Set(-edgeCount / 2 + 1.0f * i, 0.0f);
+    }
+    b2ChainShape chain;
+    chain.CreateChain(vertices, edgeCount + 1);
+
+    CHECK(dropParticles(chain) > 0.0f);
+}
+
+static void testParticlesRestOnCompound()
+{
+    b2CompoundShape compound;
+    b2PolygonShape block;
+    for (int32 i = 0; i < edgeCount; ++i)
+    {
+        block.SetAsBox(0.5f, 0.1f, b2Vec2(-edgeCount / 2 + 0.5f + 1.0f * i, -0.1f), 0.0f);
+        compound.AddChild(block);
+    }
+
+    CHECK(dropParticles(compound) > 0.0f);
+}
+
+int main()
+{
+    testParticlesRestOnChain();
+    testParticlesRestOnCompound();
+    return checkFailures();
+}
@@ -0,0 +1,82 @@
+// World ray cast regression tests.
+
+#include "check.h"
+
+#include <Box2D/Box2D.h>
+
+#include <cstdlib>
+
+struct ClosestHit : public b2RayCastCallback
+{
+    ClosestHit() : fraction(1.0f), count(0) {}
+
+    float32 ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float32 f)
+    {
+        B2_NOT_USED(fixture);
+        B2_NOT_USED(point);
+        B2_NOT_USED(normal);
+        fraction = f;
+        ++count;
+        return f;
+    }
+
+    float32 fraction;
+    int count;
+};
+
+static float32 randomFloat(float32 lo, float32 hi)
+{
+    return lo + (hi - lo) * (rand() / (float32)RAND_MAX);
+}
+
+// The closest hit on a moved and rotated compound must be the one found by
+// casting every child.
+static void testCompoundClosestHit()
+{
+    b2World world(b2Vec2(0.0f, 0.0f), true);
+
+    b2BodyDef bodyDef;
+    bodyDef.position.Set(3.0f, -2.0f);
+    bodyDef.angle = 0.7f;
+    b2Body* body = world.CreateBody(&bodyDef);
+
+    b2CompoundShape compound;
+    b2PolygonShape block;
+    srand(7);
+    for (int32 i = 0; i < 300; ++i)
+    {
+        b2Vec2 center(randomFloat(-20.0f, 20.0f), randomFloat(-20.0f, 20.0f));
+        block.SetAsBox(randomFloat(0.1f, 0.5f), randomFloat(0.1f, 0.5f), center, randomFloat(0.0f, b2_pi));
+        compound.AddChild(block);
+    }
+    b2Fixture* fixture = body->CreateFixture(&compound, 1.0f);
+
+    for (int32 i = 0; i < 200; ++i)
+    {
+        b2RayCastInput input;
+        input.p1.Set(randomFloat(-30.0f, 30.0f), randomFloat(-30.0f, 30.0f));
+        input.p2.Set(randomFloat(-30.0f, 30.0f), randomFloat(-30.0f, 30.0f));
+        input.maxFraction = 1.0f;
+
+        float32 expected = 1.0f;
+        for (int32 j = 0; j < compound.GetChildCount(); ++j)
+        {
+            b2RayCastOutput output;
+            if (fixture->RayCast(&output, input, j))
+            {
+                expected = b2Min(expected, output.fraction);
+            }
+        }
+
+        ClosestHit callback;
+        world.RayCast(&callback, input.p1, input.p2);
+        CHECK(callback.fraction == expected);
+        CHECK((callback.count > 0) == (expected < 1.0f));
+    }
+}
+
+int main()
+{
+    testCompoundClosestHit();
+    return checkFailures();
+}
@@ -0,0 +1,108 @@
+// Threaded solver regression tests.
+
+#include "check.h"
+
+#include <Box2D/Box2D.h>
+#include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2ThreadPool.h>
+
+#include <cstddef>
+#include <vector>
+
+static bool isAligned(const void* p)
+{
+    return (size_t)p % b2_stackAlignment == 0;
+}
+
+// b2SortByColor takes int32 color arrays and then a pointer array from the
+// same stack. Odd sized blocks must not push the later ones off alignment.
+static void testStackBlocksAreAligned()
+{
+    b2StackAllocator* allocator = new b2StackAllocator;
+
+    void* colors = allocator->Allocate(3 * sizeof(int32));
+    void* counts = allocator->Allocate(7 * sizeof(int32));
+    void* sorted = allocator->Allocate(5 * sizeof(void*));
+    void* large = allocator->Allocate(b2_stackSize);
+    CHECK(isAligned(colors));
+    CHECK(isAligned(counts));
+    CHECK(isAligned(sorted));
+    CHECK(isAligned(large));
+
+    allocator->Free(large);
+    allocator->Free(sorted);
+    allocator->Free(counts);
+    allocator->Free(colors);
+
+    delete allocator;
+}
+
+// A pyramid large enough for the graph colored solver. Returns the body
+// positions after a second of simulation.
+static std::vector<float32> runPyramid(b2ThreadPool* threadPool)
+{
+    b2World world(b2Vec2(0.0f, -10.0f), true);
+    world.SetThreadPool(threadPool);
+
+    b2BodyDef groundDef;
+    b2Body* ground = world.CreateBody(&groundDef);
+    b2PolygonShape groundBox;
+    groundBox.SetAsBox(40.0f, 0.5f);
+    ground->CreateFixture(&groundBox, 0.0f);
+
+    b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+
+    std::vector<b2Body*> bodies;
+    const int32 rows = 20;
+    for (int32 i = 0; i < rows; ++i)
+    {
+        for (int32 j = i; j < rows; ++j)
+        {
+            b2BodyDef bodyDef;
+            bodyDef.type = b2_dynamicBody;
+            bodyDef.position.Set(-10.0f + 0.5f * i + 1.0f * (j - i), 1.0f + 1.0f * i);
+            b2Body* body = world.CreateBody(&bodyDef);
+            body->CreateFixture(&box, 5.0f);
+            bodies.push_back(body);
+        }
+    }
+
+    for (int32 i = 0; i < 60; ++i)
+    {
+        world.Step(1.0f / 60.0f, 8, 3);
+    }
+
+    std::vector<float32> positions;
+    for (size_t i = 0; i < bodies.size(); ++i)
+    {
+        const b2Vec2 p = bodies[i]->GetPosition();
+        positions.push_back(p.x);
+        positions.push_back(p.y);
+        positions.push_back(bodies[i]->GetAngle());
+    }
+    return positions;
+}
+
+// The colored solver must give the same answer on every run, whatever the
+// threads pick up first.
+static void testThreadedPyramidIsRepeatable()
+{
+    b2ThreadPool threadPool(4);
+    const std::vector<float32> first = runPyramid(&threadPool);
+    for (int32 run = 0; run < 3; ++run)
+    {
+        const std::vector<float32> again = runPyramid(&threadPool);
+        CHECK(again == first);
+    }
+
+    // The pyramid still stands.
+    CHECK(first[first.size() - 2] > 15.0f);
+}
+
+int main()
+{
+    testStackBlocksAreAligned();
+    testThreadedPyramidIsRepeatable();
+    return checkFailures();
+}
@@ -130,13 +130,14 @@ void GameData::checkState(World* world)
 	}
     }
 
-    if (state==PLAYING) {
-	for (const b2ContactEdge* ce = ball->getBody()->GetContactList(); ce; ce = ce->next) {
-	    const b2Contact* contact = ce->contact;
-	    if (!contact->IsTouching()) continue;
+    // the ball records the contacts it starts during each step
+    const b2ContactEvents events = world->getContactEvents();
 
-	    const b2Body* body1 = contact->GetFixtureA()->GetBody();
-	    const b2Body* body2 = contact->GetFixtureB()->GetBody();
+    if (state==PLAYING) {
+	for (int kk=0; kk<events.beginCount; kk++) {
+	    const b2Body* body1 = events.beginEvents[kk].fixtureA->GetBody();
+	    const b2Body* body2 = events.beginEvents[kk].fixtureB->GetBody();
+	    if (body1!=body_ball && body2!=body_ball) continue;
 
 	    if(body1 == body_right_ground || body2 == body_right_ground){
 		last_scoring_team = left_team;
@@ -153,12 +154,10 @@ void GameData::checkState(World* world)
     }
 
     // update last touching player
-    for (const b2ContactEdge* ce = body_ball->GetContactList(); ce; ce = ce->next) {
-	const b2Contact* contact = ce->contact;
-	if (!contact->IsTouching()) continue;
-
-	const b2Body* body1 = contact->GetFixtureA()->GetBody();
-	const b2Body* body2 = contact->GetFixtureB()->GetBody();
+    for (int kk=0; kk<events.beginCount; kk++) {
+	const b2Body* body1 = events.beginEvents[kk].fixtureA->GetBody();
+	const b2Body* body2 = events.beginEvents[kk].fixtureB->GetBody();
+	if (body1!=body_ball && body2!=body_ball) continue;
 
 	if (body1==body_left_player || body2==body_left_player) {
 	    last_touching_player = left_player;
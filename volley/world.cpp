@@ -34,6 +34,7 @@ void World::initialize(const b2Vec2 &gravity)
     world->SetAutoClearForces(false);
     world->SetContinuousPhysics(true);
     world->SetSubStepping(false);
+    world->SetContactEventsEnabled(true);
 }
 
 b2Joint* World::addDistanceJoint(b2Body* a, b2Body* b, const b2Vec2 &ca, const b2Vec2 &cb, bool collide)
@@ -87,6 +88,12 @@ int World::getBodyCount() const
     return world->GetBodyCount();
 }
 
+b2ContactEvents World::getContactEvents() const
+{
+    Q_ASSERT(world);
+    return world->GetContactEvents();
+}
+
 int World::getJointCount() const
 {
     Q_ASSERT(world);
@@ -254,6 +261,7 @@ b2Body* World::addBall(const b2Vec2 &pos, float radius)
     b2BodyDef bodyDef;
     bodyDef.type = b2_dynamicBody;
     bodyDef.position = pos;
+    bodyDef.contactEvents = true;
     
     b2CircleShape shape;
     shape.m_radius = radius;
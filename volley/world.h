@@ -29,6 +29,7 @@ public:
   b2Body* addBird(float x, float y, float radius);
   bool allBodiesAsleep() const;
   int getBodyCount() const;
+  b2ContactEvents getContactEvents() const;
   b2Body* getFirstBody();
 
   b2Joint* addDistanceJoint(b2Body* a, b2Body* b, const b2Vec2 &ca, const b2Vec2 &cb, bool collide=false);